@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/ffi-test.dir/src/lib.c.o"
+  "CMakeFiles/ffi-test.dir/src/lib.c.o.d"
+  "libffi-test.pdb"
+  "libffi-test.so"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang C)
+  include(CMakeFiles/ffi-test.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
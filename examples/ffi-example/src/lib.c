@@ -19,10 +19,21 @@ Value dictu_ffi_test_callback(DictuVM *vm, int argCount, Value *args) {
     return callFunction(vm, args[0], argCount-1, funcs);
 }
 
+Value dictu_ffi_test_push(DictuVM *vm, int argCount, Value *args) {
+    if(argCount != 2 || !IS_LIST(args[0]))
+        return NIL_VAL;
+    ObjList *list = AS_LIST(args[0]);
+    // The list may share its values with a copy of it
+    makeListWritable(vm, list);
+    writeValueArray(vm, &list->values, args[1]);
+    return NIL_VAL;
+}
+
 int dictu_ffi_init(DictuVM *vm, Table *method_table) {
   defineNative(vm, method_table, "dictuFFITestAdd", dictu_ffi_test);
   defineNative(vm, method_table, "dictuFFITestStr", dictu_ffi_test_str);
   defineNative(vm, method_table, "dictuFFITestCallback", dictu_ffi_test_callback);
+  defineNative(vm, method_table, "dictuFFITestPush", dictu_ffi_test_push);
   defineNativeProperty(
     vm, method_table, "test",
         OBJ_VAL(copyString(vm, "Dictu!", 6)));
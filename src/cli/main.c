@@ -9,10 +9,12 @@
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <time.h>
 #ifdef _WIN32
 #include "../optionals/windowsapi.h"
 #define PATH_MAX MAX_PATH
 #else
+#include <sys/resource.h>
 #include <unistd.h>
 #endif
 
@@ -208,14 +210,81 @@ static const char *const usage[] = {
     NULL,
 };
 
+static double monotonicTime() {
+#ifdef _WIN32
+    return (double) GetTickCount64() / 1000;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+#endif
+}
+
+// Written for ops/benchmark.du, the peak resident set size is in bytes
+static void writeStats(char *path, double init, double run) {
+    FILE *file = fopen(path, "w");
+
+    if (file == NULL) {
+        fprintf(stderr, "Could not open file \"%s\".\n", path);
+        exit(74);
+    }
+
+#ifdef _WIN32
+    fprintf(file, "{\"init\": %f, \"run\": %f, \"peakRss\": null}\n", init, run);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    long peakRss = usage.ru_maxrss;
+
+#ifndef __APPLE__
+    // Everywhere but macOS reports kilobytes
+    peakRss *= 1024;
+#endif
+
+    fprintf(file, "{\"init\": %f, \"run\": %f, \"peakRss\": %ld}\n", init, run, peakRss);
+#endif
+
+    fclose(file);
+}
+
+// Splits the comma separated list of modules in place
+static int splitModules(char *list, char **modules, int max) {
+    int count = 0;
+
+    for (char *name = strtok(list, ","); name != NULL && count < max; name = strtok(NULL, ",")) {
+        modules[count++] = name;
+    }
+
+    return count;
+}
+
+static void writeImage(char *path, char *preload) {
+    char *modules[64];
+    int count = preload != NULL ? splitModules(preload, modules, 64) : 0;
+
+    if (!dictuWriteImage(path, modules, count)) {
+        exit(74);
+    }
+}
+
 int main(int argc, char *argv[]) {
     int version = 0;
     char *cmd = NULL;
+    char *image = NULL;
+    char *imageOut = NULL;
+    char *preload = NULL;
+    char *stats = NULL;
 
     struct argparse_option options[] = {
         OPT_HELP(),
         OPT_BOOLEAN('v', "version", &version, "Display Dictu version"),
         OPT_STRING('c', "cmd", &cmd, "Run program passed in as string"),
+        OPT_STRING('i', "image", &image, "Load the builtins from an image written with --write-image"),
+        OPT_STRING(0, "write-image", &imageOut, "Write the builtins to an image and exit"),
+        OPT_STRING(0, "preload", &preload, "Comma separated builtin modules to include in the image"),
+        OPT_STRING(0, "stats", &stats, "Write startup and run times and peak memory use as JSON to a file"),
         OPT_END(),
     };
 
@@ -228,23 +297,34 @@ int main(int argc, char *argv[]) {
         return 0;
     }
 
+    if (imageOut != NULL) {
+        writeImage(imageOut, preload);
+        return 0;
+    }
+
+    // An image that can not be used only costs the time it saves
+    if (image != NULL) {
+        dictuLoadImage(image);
+    }
+
+    double initStart = monotonicTime();
     DictuVM *vm = dictuInitVM(argc == 0, argc, argv);
+    double runStart = monotonicTime();
 
     if (cmd != NULL) {
         DictuInterpretResult result = dictuInterpret(vm, "repl", cmd);
         if (result == INTERPRET_COMPILE_ERROR) exit(65);
         if (result == INTERPRET_RUNTIME_ERROR) exit(70);
-        dictuFreeVM(vm);
-        return 0;
+    } else if (argc == 0) {
+        repl(vm);
+    } else {
+        runFile(vm, argv[0]);
     }
 
-    if (argc == 0) {
-        repl(vm);
-        dictuFreeVM(vm);
-        return 0;
+    if (stats != NULL) {
+        writeStats(stats, runStart - initStart, monotonicTime() - runStart);
     }
 
-    runFile(vm, argv[0]);
     dictuFreeVM(vm);
     return 0;
 }
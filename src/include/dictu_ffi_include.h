@@ -11,7 +11,7 @@ extern "C" {
 
 // This is used ti determine if we can safely load the function pointers without
 // UB.
-#define FFI_MOD_API_VERSION 3
+#define FFI_MOD_API_VERSION 5
 
 #define UNUSED(__x__) (void)__x__
 
@@ -171,7 +171,10 @@ typedef enum {
     OBJ_FILE,
     OBJ_ABSTRACT,
     OBJ_RESULT,
-    OBJ_UPVALUE
+    OBJ_UPVALUE,
+    OBJ_TUPLE,
+    OBJ_COROUTINE,
+    OBJ_RANGE
 } ObjType;
 
 #define OBJ_TYPE(value) (AS_OBJ(value)->type)
@@ -287,6 +290,7 @@ typedef struct {
     int privatePropertyCount;
     int *privatePropertyNames;
     int *privatePropertyIndexes;
+    bool isCoroutine;
 } ObjFunction;
 
 #define STACK_MAX (64 * UINT8_COUNT)
@@ -340,6 +344,16 @@ struct _vm {
     Obj **grayStack;
     int argc;
     char **argv;
+    Table tupleMethods;
+    ObjString *hashString;
+    ObjString *eqString;
+    Table coroutineMethods;
+    struct sObjCoroutine *coroutine;
+    struct sObjCoroutine *coroutines;
+    Table rangeMethods;
+    ObjString *iterString;
+    struct _vm *shared;
+    int gcPaused;
 };
 
 #define DICTU_MAJOR_VERSION "0"
@@ -365,11 +379,22 @@ struct sObjString {
     char *chars;
     uint32_t hash;
     int character_len;
+    // chars is a read-only mapping of a file rather than heap memory
+    bool mapped;
 };
 
+// Backing store shared between lists after a slice or shallow copy.
+// Lists sharing a store must call makeListWritable before mutating.
+typedef struct {
+    int refCount;
+    int capacity;
+    Value *values;
+} ListStorage;
+
 struct sObjList {
     Obj obj;
     ValueArray values;
+    ListStorage *shared;
 };
 
 typedef struct {
@@ -402,11 +427,22 @@ struct sObjFile {
     FILE *file;
     char *path;
     char *openType;
+    // Reused by every line read, grown to fit the longest line so far
+    char *lineBuffer;
+    size_t lineCapacity;
+    // The stdio buffer set by setBufferSize(), writes are flushed straight
+    // away while bufferSize is 0
+    char *buffer;
+    size_t bufferSize;
+    // Set by the first read, write, seek or setBufferSize() on the stream
+    bool used;
 };
 
 typedef void (*AbstractFreeFn)(DictuVM *vm, ObjAbstract *abstract);
 typedef void (*AbstractGrayFn)(DictuVM *vm, ObjAbstract *abstract);
 typedef char *(*AbstractTypeFn)(ObjAbstract *abstract);
+// Sets next and returns true for each value of a for-in loop, false once done
+typedef bool (*AbstractIterFn)(DictuVM *vm, ObjAbstract *abstract, Value *next);
 
 struct sObjAbstract {
     Obj obj;
@@ -416,6 +452,7 @@ struct sObjAbstract {
     AbstractGrayFn grayFunc;
     AbstractTypeFn type;
     bool excludeSelf;
+    AbstractIterFn iterate;
 };
 
 typedef enum { SUCCESS, ERR } ResultStatus;
@@ -514,7 +551,7 @@ typedef Value pop_t(DictuVM *vm);
 
 typedef bool isFalsey_t(Value value);
 
-typedef bool valuesEqual_t(Value a, Value b);
+typedef bool valuesEqual_t(DictuVM *vm, Value a, Value b);
 
 typedef void initValueArray_t(ValueArray *array);
 
@@ -524,11 +561,11 @@ typedef void freeValueArray_t(DictuVM *vm, ValueArray *array);
 
 typedef bool dictSet_t(DictuVM *vm, ObjDict *dict, Value key, Value value);
 
-typedef bool dictGet_t(ObjDict *dict, Value key, Value *value);
+typedef bool dictGet_t(DictuVM *vm, ObjDict *dict, Value key, Value *value);
 
 typedef bool dictDelete_t(DictuVM *vm, ObjDict *dict, Value key);
 
-typedef bool setGet_t(ObjSet *set, Value value);
+typedef bool setGet_t(DictuVM *vm, ObjSet *set, Value value);
 
 typedef bool setInsert_t(DictuVM *vm, ObjSet *set, Value value);
 
@@ -554,6 +591,8 @@ typedef void defineNativeProperty_t(DictuVM *vm, Table *table, const char *name,
 
 typedef Value callFunction_t(DictuVM* vm, Value function, int argCount, Value* args);
 
+typedef void makeListWritable_t(DictuVM *vm, ObjList *list);
+
 reallocate_t * reallocate = NULL;
 
 copyString_t *copyString = NULL;
@@ -622,6 +661,8 @@ defineNativeProperty_t *defineNativeProperty = NULL;
 
 callFunction_t *callFunction = NULL;
 
+makeListWritable_t *makeListWritable = NULL;
+
 // This needs to be implemented by the user and register all functions
 int dictu_ffi_init(DictuVM *vm, Table *method_table);
 
@@ -672,6 +713,7 @@ int dictu_internal_ffi_init(void **function_ptrs, DictuVM *vm,
     defineNativeProperty = (defineNativeProperty_t *)function_ptrs[count++];
     reallocate = (reallocate_t *)function_ptrs[count++];
     callFunction = (callFunction_t *)function_ptrs[count++];
+    makeListWritable = (makeListWritable_t *)function_ptrs[count++];
     int initResult = dictu_ffi_init(vm, methodTable);
     if (initResult > 0)
         return 3 + initResult;
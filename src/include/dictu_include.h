@@ -41,4 +41,12 @@ void dictuFreeVM(DictuVM *vm);
 
 DictuInterpretResult dictuInterpret(DictuVM *vm, char *moduleName, char *source);
 
+// Writes the builtins, along with the builtin modules named in preload, to
+// an image that later runs can load rather than building them again
+bool dictuWriteImage(const char *path, char **preload, int preloadCount);
+
+// Must be called before the first VM is created, returns false and leaves
+// the builtins to be built as normal if the image can not be used
+bool dictuLoadImage(const char *path);
+
 #endif //dictu_include_h
@@ -1,21 +1,21 @@
 #include "buffer.h"
 
-typedef struct {
-    uint8_t *bytes;
-    int size;
-    bool bigEndian;
-} Buffer;
-
-#define AS_BUFFER(v) ((Buffer *)AS_ABSTRACT(v)->data)
-
-ObjAbstract *newBufferObj(DictuVM *vm, double capacity);
-
 void freeBuffer(DictuVM *vm, ObjAbstract *abstract) {
     Buffer *buffer = (Buffer *)abstract->data;
-    FREE_ARRAY(vm, uint8_t, buffer->bytes, buffer->size);
+    if (buffer->view == NULL) {
+        FREE_ARRAY(vm, uint8_t, buffer->bytes, buffer->size);
+    }
     FREE(vm, Buffer, abstract->data);
 }
 
+void grayBuffer(DictuVM *vm, ObjAbstract *abstract) {
+    Buffer *buffer = (Buffer *)abstract->data;
+
+    if (buffer != NULL && buffer->view != NULL) {
+        grayObject(vm, (Obj *) buffer->view);
+    }
+}
+
 char *bufferToString(ObjAbstract *abstract) {
     UNUSED(abstract);
 
@@ -122,6 +122,11 @@ static Value bufferString(DictuVM *vm, int argCount, Value *args) {
     }
     Buffer *buffer = AS_BUFFER(args[0]);
 
+    // A view covers the whole of its string
+    if (buffer->view != NULL) {
+        return OBJ_VAL(buffer->view);
+    }
+
     return OBJ_VAL(copyString(vm, (const char *)buffer->bytes, buffer->size));
 }
 static Value bufferWriteint8(DictuVM *vm, int argCount, Value *args) {
@@ -918,28 +923,13 @@ static Value bufferSubArray(DictuVM *vm, int argCount, Value *args) {
     return newResultSuccess(vm, OBJ_VAL(newBuffer));
 }
 
-ObjAbstract *newBufferObj(DictuVM *vm, double capacity) {
-    ObjAbstract *abstract = newAbstract(vm, freeBuffer, bufferToString);
-    push(vm, OBJ_VAL(abstract));
-
-    Buffer *buffer = ALLOCATE(vm, Buffer, 1);
-    buffer->bigEndian = false;
-    buffer->bytes = ALLOCATE(vm, uint8_t, capacity);
-    memset(buffer->bytes, 0, capacity);
-    buffer->size = capacity;
-
-    /**
-     * Setup Buffer object methods
-     */
-    defineNative(vm, &abstract->values, "resize", bufferResize);
-    defineNative(vm, &abstract->values, "set", bufferSet);
+static void defineBufferReadMethods(DictuVM *vm, ObjAbstract *abstract) {
     defineNative(vm, &abstract->values, "get", bufferGet);
     defineNative(vm, &abstract->values, "subarray", bufferSubArray);
     defineNative(vm, &abstract->values, "string", bufferString);
     defineNative(vm, &abstract->values, "len", bufferLen);
     defineNative(vm, &abstract->values, "values", bufferValues);
 
-    defineNative(vm, &abstract->values, "writeString", bufferWriteString);
     defineNative(vm, &abstract->values, "readString", bufferReadString);
 
     defineNative(vm, &abstract->values, "readUInt64LE", bufferReadUint64LE);
@@ -953,6 +943,23 @@ ObjAbstract *newBufferObj(DictuVM *vm, double capacity) {
     defineNative(vm, &abstract->values, "readFloatLE", bufferReadfloat32LE);
     defineNative(vm, &abstract->values, "readDoubleLE", bufferReadfloat64LE);
 
+    defineNative(vm, &abstract->values, "readUInt64BE", bufferReadUint64BE);
+    defineNative(vm, &abstract->values, "readUInt32BE", bufferReadUint32BE);
+    defineNative(vm, &abstract->values, "readUInt16BE", bufferReadUint16BE);
+    defineNative(vm, &abstract->values, "readInt64BE", bufferReadint64BE);
+    defineNative(vm, &abstract->values, "readInt32BE", bufferReadint32BE);
+    defineNative(vm, &abstract->values, "readInt16BE", bufferReadint16BE);
+
+    defineNative(vm, &abstract->values, "readFloatBE", bufferReadfloat32BE);
+    defineNative(vm, &abstract->values, "readDoubleBE", bufferReadfloat64BE);
+}
+
+static void defineBufferWriteMethods(DictuVM *vm, ObjAbstract *abstract) {
+    defineNative(vm, &abstract->values, "resize", bufferResize);
+    defineNative(vm, &abstract->values, "set", bufferSet);
+
+    defineNative(vm, &abstract->values, "writeString", bufferWriteString);
+
     defineNative(vm, &abstract->values, "writeUInt64LE", bufferWriteUint64LE);
     defineNative(vm, &abstract->values, "writeUInt32LE", bufferWriteUint32LE);
     defineNative(vm, &abstract->values, "writeUInt16LE", bufferWriteUint16LE);
@@ -964,16 +971,6 @@ ObjAbstract *newBufferObj(DictuVM *vm, double capacity) {
     defineNative(vm, &abstract->values, "writeFloatLE", bufferWritefloat32LE);
     defineNative(vm, &abstract->values, "writeDoubleLE", bufferWritefloat64LE);
 
-    defineNative(vm, &abstract->values, "readUInt64BE", bufferReadUint64BE);
-    defineNative(vm, &abstract->values, "readUInt32BE", bufferReadUint32BE);
-    defineNative(vm, &abstract->values, "readUInt16BE", bufferReadUint16BE);
-    defineNative(vm, &abstract->values, "readInt64BE", bufferReadint64BE);
-    defineNative(vm, &abstract->values, "readInt32BE", bufferReadint32BE);
-    defineNative(vm, &abstract->values, "readInt16BE", bufferReadint16BE);
-
-    defineNative(vm, &abstract->values, "readFloatBE", bufferReadfloat32BE);
-    defineNative(vm, &abstract->values, "readDoubleBE", bufferReadfloat64BE);
-
     defineNative(vm, &abstract->values, "writeUInt64BE", bufferWriteUint64BE);
     defineNative(vm, &abstract->values, "writeUInt32BE", bufferWriteUint32BE);
     defineNative(vm, &abstract->values, "writeUInt16BE", bufferWriteUint16BE);
@@ -983,8 +980,46 @@ ObjAbstract *newBufferObj(DictuVM *vm, double capacity) {
 
     defineNative(vm, &abstract->values, "writeFloatBE", bufferWritefloat32BE);
     defineNative(vm, &abstract->values, "writeDoubleBE", bufferWritefloat64BE);
+}
+
+ObjAbstract *newBufferObj(DictuVM *vm, double capacity) {
+    ObjAbstract *abstract = newAbstract(vm, freeBuffer, bufferToString);
+    push(vm, OBJ_VAL(abstract));
+
+    Buffer *buffer = ALLOCATE(vm, Buffer, 1);
+    buffer->bigEndian = false;
+    buffer->bytes = ALLOCATE(vm, uint8_t, capacity);
+    memset(buffer->bytes, 0, capacity);
+    buffer->size = capacity;
+    buffer->view = NULL;
+
+    /**
+     * Setup Buffer object methods
+     */
+    defineBufferReadMethods(vm, abstract);
+    defineBufferWriteMethods(vm, abstract);
+
+    abstract->data = buffer;
+    pop(vm);
+
+    return abstract;
+}
+
+// Strings are immutable, so a buffer sharing a string's bytes only has the read methods
+static ObjAbstract *newBufferView(DictuVM *vm, ObjString *string) {
+    ObjAbstract *abstract = newAbstract(vm, freeBuffer, bufferToString);
+    push(vm, OBJ_VAL(abstract));
+
+    Buffer *buffer = ALLOCATE(vm, Buffer, 1);
+    buffer->bigEndian = false;
+    buffer->bytes = (uint8_t *) string->chars;
+    buffer->size = string->length;
+    buffer->view = string;
+
+    defineBufferReadMethods(vm, abstract);
 
     abstract->data = buffer;
+    abstract->grayFunc = grayBuffer;
     pop(vm);
 
     return abstract;
@@ -1010,6 +1045,25 @@ static Value newBuffer(DictuVM *vm, int argCount, Value *args) {
     return newResultSuccess(vm, OBJ_VAL(newBufferObj(vm, capacity)));
 }
 
+static Value newBufferViewNative(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "view() takes 1 argument (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[0])) {
+        runtimeError(vm, "view() argument must be a string");
+        return EMPTY_VAL;
+    }
+
+    ObjString *str = AS_STRING(args[0]);
+    if (str->length <= 0) {
+        return newResultError(vm, "string length needs to be greater than 0");
+    }
+
+    return newResultSuccess(vm, OBJ_VAL(newBufferView(vm, str)));
+}
+
 static Value newBufferFromString(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 1) {
         runtimeError(vm, "fromString() takes 1 argument (%d given).", argCount);
@@ -1039,6 +1093,7 @@ Value createBufferModule(DictuVM *vm) {
 
     defineNative(vm, &module->values, "new", newBuffer);
     defineNative(vm, &module->values, "fromString", newBufferFromString);
+    defineNative(vm, &module->values, "view", newBufferViewNative);
 
     pop(vm);
     pop(vm);
@@ -9,6 +9,21 @@
 
 #define IS_BIG_ENDIAN (!*(unsigned char *)&(uint16_t){1})
 
+typedef struct {
+    uint8_t *bytes;
+    int size;
+    bool bigEndian;
+    // The string a read-only view shares its bytes with, NULL if the buffer owns them
+    ObjString *view;
+} Buffer;
+
+#define AS_BUFFER(v) ((Buffer *)AS_ABSTRACT(v)->data)
+#define IS_BUFFER(v) (IS_ABSTRACT(v) && AS_ABSTRACT(v)->type == bufferToString)
+
+char *bufferToString(ObjAbstract *abstract);
+
+ObjAbstract *newBufferObj(DictuVM *vm, double capacity);
+
 Value createBufferModule(DictuVM *vm);
 
 #endif //dictu_buffer_h
\ No newline at end of file
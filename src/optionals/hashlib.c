@@ -127,6 +127,111 @@ static Value bcryptVerify(DictuVM *vm, int argCount, Value *args) {
     return BOOL_VAL(bcrypt_checkpass(stringA->chars, stringB->chars) == 0);
 }
 
+typedef struct {
+    char *pass;
+    char *goodHash;
+    int rounds;
+    char hash[BCRYPT_HASHSPACE];
+    int result;
+} BcryptRequest;
+
+static BcryptRequest *newBcryptRequest(ObjString *pass, ObjString *goodHash, int rounds) {
+    BcryptRequest *request = malloc(sizeof(BcryptRequest));
+    memset(request, 0, sizeof(BcryptRequest));
+    request->pass = strdup(pass->chars);
+    request->goodHash = goodHash == NULL ? NULL : strdup(goodHash->chars);
+    request->rounds = rounds;
+
+    return request;
+}
+
+static void freeBcryptRequest(void *data) {
+    BcryptRequest *request = data;
+
+    explicit_bzero(request->pass, strlen(request->pass));
+    free(request->pass);
+    free(request->goodHash);
+    free(request);
+}
+
+static void bcryptWork(void *data) {
+    BcryptRequest *request = data;
+
+    // bcrypt_gensalt and bcrypt_pass share static buffers, so the pool
+    // threads use the reentrant call instead
+    request->result = bcrypt_newhash(request->pass, request->rounds, request->hash, sizeof(request->hash));
+}
+
+static Value bcryptComplete(DictuVM *vm, void *data) {
+    BcryptRequest *request = data;
+    int result = request->result;
+    ObjString *hash = result == 0 ? copyString(vm, request->hash, strlen(request->hash)) : NULL;
+    freeBcryptRequest(request);
+
+    if (hash == NULL) {
+        return newResultError(vm, "Unable to hash the given string");
+    }
+
+    return newResultSuccess(vm, OBJ_VAL(hash));
+}
+
+static Value bcryptAsync(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "bcryptAsync() takes 1 or 2 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[0])) {
+        runtimeError(vm, "Argument passed to bcryptAsync() must be a string.");
+        return EMPTY_VAL;
+    }
+
+    int rounds = 8;
+
+    if (argCount == 2) {
+        if (!IS_NUMBER(args[1])) {
+            runtimeError(vm, "Optional argument passed to bcryptAsync() must be a number.");
+            return EMPTY_VAL;
+        }
+
+        rounds = AS_NUMBER(args[1]);
+    }
+
+    BcryptRequest *request = newBcryptRequest(AS_STRING(args[0]), NULL, rounds);
+
+    return newFuture(vm, NIL_VAL, request, bcryptWork, bcryptComplete, freeBcryptRequest);
+}
+
+static void bcryptVerifyWork(void *data) {
+    BcryptRequest *request = data;
+
+    request->result = bcrypt_checkpass(request->pass, request->goodHash);
+}
+
+static Value bcryptVerifyComplete(DictuVM *vm, void *data) {
+    BcryptRequest *request = data;
+    bool verified = request->result == 0;
+    freeBcryptRequest(request);
+
+    return newResultSuccess(vm, BOOL_VAL(verified));
+}
+
+static Value bcryptVerifyAsync(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 2) {
+        runtimeError(vm, "bcryptVerifyAsync() takes 2 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[0]) || !IS_STRING(args[1])) {
+        runtimeError(vm, "Arguments passed to bcryptVerifyAsync() must be a string.");
+        return EMPTY_VAL;
+    }
+
+    BcryptRequest *request = newBcryptRequest(AS_STRING(args[0]), AS_STRING(args[1]), 0);
+
+    return newFuture(vm, NIL_VAL, request, bcryptVerifyWork, bcryptVerifyComplete, freeBcryptRequest);
+}
+
 static Value verify(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 2) {
         runtimeError(vm, "verify() takes 2 arguments (%d given).", argCount);
@@ -162,6 +267,8 @@ Value createHashlibModule(DictuVM *vm) {
     defineNative(vm, &module->values, "bcrypt", bcrypt);
     defineNative(vm, &module->values, "verify", verify);
     defineNative(vm, &module->values, "bcryptVerify", bcryptVerify);
+    defineNative(vm, &module->values, "bcryptAsync", bcryptAsync);
+    defineNative(vm, &module->values, "bcryptVerifyAsync", bcryptVerifyAsync);
 
     pop(vm);
     pop(vm);
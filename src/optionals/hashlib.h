@@ -2,6 +2,7 @@
 #define dictu_hashlib_h
 
 #include "optionals.h"
+#include "../vm/future.h"
 #include "hashlib/utils.h"
 #include "hashlib/sha256.h"
 #include "hashlib/hmac.h"
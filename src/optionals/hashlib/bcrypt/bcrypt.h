@@ -29,6 +29,9 @@ typedef uint64_t u_int64_t;
 #define explicit_bzero(s,n) memset(s, 0, n)
 #define DEF_WEAK(f)
 
+#define	BCRYPT_HASHSPACE	61
+
+int bcrypt_newhash(const char *pass, int log_rounds, char *hash, size_t hashlen);
 char *bcrypt_pass(const char *pass, const char *salt);
 char *bcrypt_gensalt(u_int8_t log_rounds);
 int bcrypt_checkpass(const char *pass, const char *goodhash);
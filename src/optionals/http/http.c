@@ -235,6 +235,149 @@
 
 #define DEFAULT_REQUEST_TIMEOUT 20
 
+/**
+ * curl is initialised once for the whole process rather than around every
+ * request. Every easy handle is attached to one share handle so DNS lookups,
+ * TLS sessions and cookies outlive the handle that made them, whichever VM or
+ * thread made the request. libcurl does not support sharing the connection
+ * cache between threads, so connections are instead kept by one easy handle
+ * per thread which one-off requests borrow and reset rather than clean up.
+ */
+static CURLSH *curlShare = NULL;
+
+#ifndef _WIN32
+typedef struct {
+    CURL *curl;
+    bool inUse;
+} ThreadCurlHandle;
+
+static pthread_once_t curlInitOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t curlShareLocks[CURL_LOCK_DATA_LAST];
+static pthread_key_t curlHandleKey;
+
+static void lockCurlShare(CURL *handle, curl_lock_data data, curl_lock_access access, void *userData) {
+    UNUSED(handle);
+    UNUSED(access);
+    UNUSED(userData);
+
+    pthread_mutex_lock(&curlShareLocks[data]);
+}
+
+static void unlockCurlShare(CURL *handle, curl_lock_data data, void *userData) {
+    UNUSED(handle);
+    UNUSED(userData);
+
+    pthread_mutex_unlock(&curlShareLocks[data]);
+}
+
+static void freeThreadCurlHandle(void *data) {
+    ThreadCurlHandle *handle = data;
+
+    curl_easy_cleanup(handle->curl);
+    free(handle);
+}
+#else
+static bool curlInitialised = false;
+#endif
+
+static void initCurl(void) {
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+#ifndef _WIN32
+    pthread_key_create(&curlHandleKey, freeThreadCurlHandle);
+#endif
+
+    curlShare = curl_share_init();
+
+    if (curlShare == NULL) {
+        return;
+    }
+
+#ifndef _WIN32
+    for (int i = 0; i < CURL_LOCK_DATA_LAST; ++i) {
+        pthread_mutex_init(&curlShareLocks[i], NULL);
+    }
+
+    curl_share_setopt(curlShare, CURLSHOPT_LOCKFUNC, lockCurlShare);
+    curl_share_setopt(curlShare, CURLSHOPT_UNLOCKFUNC, unlockCurlShare);
+#endif
+    curl_share_setopt(curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(curlShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_COOKIE);
+}
+
+static void shareCurlHandle(CURL *curl) {
+    if (curlShare != NULL) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, curlShare);
+    }
+}
+
+// A handle of its own, for clients which keep it between requests
+static CURL *newCurlHandle(void) {
+#ifndef _WIN32
+    pthread_once(&curlInitOnce, initCurl);
+#else
+    if (!curlInitialised) {
+        initCurl();
+        curlInitialised = true;
+    }
+#endif
+
+    CURL *curl = curl_easy_init();
+
+    if (curl != NULL) {
+        shareCurlHandle(curl);
+    }
+
+    return curl;
+}
+
+// A handle for a single request, which must be given back with releaseCurlHandle()
+static CURL *acquireCurlHandle(void) {
+#ifndef _WIN32
+    pthread_once(&curlInitOnce, initCurl);
+
+    ThreadCurlHandle *handle = pthread_getspecific(curlHandleKey);
+
+    if (handle == NULL) {
+        CURL *curl = newCurlHandle();
+        handle = malloc(sizeof(ThreadCurlHandle));
+
+        if (curl == NULL || handle == NULL) {
+            free(handle);
+            return curl;
+        }
+
+        handle->curl = curl;
+        handle->inUse = false;
+        pthread_setspecific(curlHandleKey, handle);
+    }
+
+    if (!handle->inUse) {
+        handle->inUse = true;
+        return handle->curl;
+    }
+#endif
+
+    return newCurlHandle();
+}
+
+static void releaseCurlHandle(CURL *curl) {
+#ifndef _WIN32
+    ThreadCurlHandle *handle = pthread_getspecific(curlHandleKey);
+
+    // Resetting the options keeps the connections the handle has open
+    if (handle != NULL && handle->curl == curl) {
+        curl_easy_reset(curl);
+        shareCurlHandle(curl);
+        handle->inUse = false;
+        return;
+    }
+#endif
+
+    curl_easy_cleanup(curl);
+}
+
 static void createResponse(DictuVM *vm, Response *response) {
     response->vm = vm;
     response->headers = newList(vm);
@@ -337,7 +480,7 @@ static char *dictToPostArgs(ObjDict *dict) {
     return ret;
 }
 
-static bool setRequestHeaders(DictuVM *vm, struct curl_slist *list, CURL *curl, ObjList *headers) {
+static bool setRequestHeaders(DictuVM *vm, struct curl_slist **list, CURL *curl, ObjList *headers) {
     if (headers->values.count == 0) {
         return true;
     }
@@ -348,27 +491,16 @@ static bool setRequestHeaders(DictuVM *vm, struct curl_slist *list, CURL *curl,
             return false;
         }
 
-        list = curl_slist_append(list, AS_CSTRING(headers->values.values[i]));
+        *list = curl_slist_append(*list, AS_CSTRING(headers->values.values[i]));
     }
 
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, *list);
 
     return true;
 }
 
-static ObjInstance *endRequest(DictuVM *vm, CURL *curl, Response response, bool cleanup) {
-    // Get status code
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.statusCode);
-    ObjString *content;
-    if (response.res != NULL) {
-        content = takeString(vm, response.res, response.len);
-    } else {
-        content = copyString(vm, "", 0);
-    }
-
-    // Push to stack to avoid GC
-    push(vm, OBJ_VAL(content));
-
+// content and headers must already be reachable by the GC
+static ObjInstance *newResponseInstance(DictuVM *vm, ObjString *content, ObjList *headers, long statusCode) {
     Value rawModule;
     tableGet(&vm->modules, copyString(vm, "HTTP", 4), &rawModule);
 
@@ -386,16 +518,35 @@ static ObjInstance *endRequest(DictuVM *vm, CURL *curl, Response response, bool
 
     string = copyString(vm, "headers", 7);
     push(vm, OBJ_VAL(string));
-    tableSet(vm, &responseInstance->publicAttributes, string, OBJ_VAL(response.headers));
+    tableSet(vm, &responseInstance->publicAttributes, string, OBJ_VAL(headers));
     pop(vm);
 
     string = copyString(vm, "statusCode", 10);
     push(vm, OBJ_VAL(string));
-    tableSet(vm, &responseInstance->publicAttributes, string, NUMBER_VAL(response.statusCode));
+    tableSet(vm, &responseInstance->publicAttributes, string, NUMBER_VAL(statusCode));
     pop(vm);
 
     // Pop instance
     pop(vm);
+
+    return responseInstance;
+}
+
+static ObjInstance *endRequest(DictuVM *vm, CURL *curl, Response response, bool cleanup) {
+    // Get status code
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.statusCode);
+    ObjString *content;
+    if (response.res != NULL) {
+        content = takeString(vm, response.res, response.len);
+    } else {
+        content = copyString(vm, "", 0);
+    }
+
+    // Push to stack to avoid GC
+    push(vm, OBJ_VAL(content));
+
+    ObjInstance *responseInstance = newResponseInstance(vm, content, response.headers, response.statusCode);
+
     // Pop content
     pop(vm);
     // Pop headers from createResponse
@@ -403,8 +554,7 @@ static ObjInstance *endRequest(DictuVM *vm, CURL *curl, Response response, bool
 
     if (cleanup) {
         /* always cleanup */
-        curl_easy_cleanup(curl);
-        curl_global_cleanup();
+        releaseCurlHandle(curl);
     }
     
     return responseInstance;
@@ -446,8 +596,7 @@ static Value get(DictuVM *vm, int argCount, Value *args) {
     CURL *curl;
     CURLcode curlResponse;
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
+    curl = acquireCurlHandle();
 
     if (curl) {
         Response response;
@@ -457,8 +606,9 @@ static Value get(DictuVM *vm, int argCount, Value *args) {
         struct curl_slist *list = NULL;
 
         if (headers) {
-            if (!setRequestHeaders(vm, list, curl, headers)) {
+            if (!setRequestHeaders(vm, &list, curl, headers)) {
                 curl_slist_free_all(list);
+                releaseCurlHandle(curl);
                 return EMPTY_VAL;
             }
         }
@@ -482,8 +632,7 @@ static Value get(DictuVM *vm, int argCount, Value *args) {
         /* Check for errors */
         if (curlResponse != CURLE_OK) {
             /* always cleanup */
-            curl_easy_cleanup(curl);
-            curl_global_cleanup();
+            releaseCurlHandle(curl);
             pop(vm);
 
             char *errorString = (char *) curl_easy_strerror(curlResponse);
@@ -494,14 +643,206 @@ static Value get(DictuVM *vm, int argCount, Value *args) {
     }
 
     /* always cleanup */
-    curl_easy_cleanup(curl);
-    curl_global_cleanup();
+    releaseCurlHandle(curl);
     pop(vm);
 
     char *errorString = (char *) curl_easy_strerror(CURLE_FAILED_INIT);
     return newResultError(vm, errorString);
 }
 
+typedef struct {
+    char *url;
+    char **headers;
+    int headerCount;
+    long timeout;
+    char *content;
+    size_t length;
+    char **responseHeaders;
+    int responseHeaderCount;
+    int responseHeaderCapacity;
+    long statusCode;
+    CURLcode code;
+} AsyncRequest;
+
+static size_t writeAsyncResponse(char *ptr, size_t size, size_t nmemb, void *data) {
+    AsyncRequest *request = (AsyncRequest *) data;
+    size_t newLength = request->length + size * nmemb;
+    request->content = realloc(request->content, newLength + 1);
+
+    if (request->content == NULL) {
+        printf("Unable to allocate memory\n");
+        exit(71);
+    }
+
+    memcpy(request->content + request->length, ptr, size * nmemb);
+    request->content[newLength] = '\0';
+    request->length = newLength;
+
+    return size * nmemb;
+}
+
+static size_t writeAsyncHeaders(char *ptr, size_t size, size_t nitems, void *data) {
+    AsyncRequest *request = (AsyncRequest *) data;
+    // if nitems equals 2 its an empty header
+    if (nitems != 2) {
+        if (request->responseHeaderCount == request->responseHeaderCapacity) {
+            request->responseHeaderCapacity = GROW_CAPACITY(request->responseHeaderCapacity);
+            request->responseHeaders = realloc(request->responseHeaders, sizeof(char*) * request->responseHeaderCapacity);
+        }
+
+        request->responseHeaders[request->responseHeaderCount++] = strndup(ptr, (nitems - 2) * size);
+    }
+    return size * nitems;
+}
+
+static void freeAsyncRequest(void *data) {
+    AsyncRequest *request = data;
+
+    for (int i = 0; i < request->headerCount; ++i) {
+        free(request->headers[i]);
+    }
+
+    for (int i = 0; i < request->responseHeaderCount; ++i) {
+        free(request->responseHeaders[i]);
+    }
+
+    free(request->url);
+    free(request->headers);
+    free(request->content);
+    free(request->responseHeaders);
+    free(request);
+}
+
+static void getAsyncWork(void *data) {
+    AsyncRequest *request = data;
+    CURL *curl = acquireCurlHandle();
+
+    if (!curl) {
+        request->code = CURLE_FAILED_INIT;
+        return;
+    }
+
+    struct curl_slist *list = NULL;
+
+    for (int i = 0; i < request->headerCount; ++i) {
+        list = curl_slist_append(list, request->headers[i]);
+    }
+
+    if (list != NULL) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, list);
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, request->url);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, request->timeout);
+    // Timeouts must not rely on signals off the main thread
+    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "gzip");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeAsyncResponse);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, request);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, writeAsyncHeaders);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, request);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+
+    request->code = curl_easy_perform(curl);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &request->statusCode);
+
+    curl_slist_free_all(list);
+    releaseCurlHandle(curl);
+}
+
+static Value getAsyncComplete(DictuVM *vm, void *data) {
+    AsyncRequest *request = data;
+
+    if (request->code != CURLE_OK) {
+        char *errorString = (char *) curl_easy_strerror(request->code);
+        freeAsyncRequest(request);
+
+        return newResultError(vm, errorString);
+    }
+
+    ObjList *headers = newList(vm);
+    push(vm, OBJ_VAL(headers));
+
+    for (int i = 0; i < request->responseHeaderCount; ++i) {
+        Value header = OBJ_VAL(copyString(vm, request->responseHeaders[i], strlen(request->responseHeaders[i])));
+        // Push to stack to avoid GC
+        push(vm, header);
+        writeValueArray(vm, &headers->values, header);
+        pop(vm);
+    }
+
+    ObjString *content = copyString(vm, request->content == NULL ? "" : request->content, request->length);
+    push(vm, OBJ_VAL(content));
+
+    ObjInstance *responseInstance = newResponseInstance(vm, content, headers, request->statusCode);
+    push(vm, OBJ_VAL(responseInstance));
+    freeAsyncRequest(request);
+
+    Value result = newResultSuccess(vm, OBJ_VAL(responseInstance));
+    pop(vm);
+    pop(vm);
+    pop(vm);
+
+    return result;
+}
+
+static Value getAsync(DictuVM *vm, int argCount, Value *args) {
+    if (argCount < 1 || argCount > 3) {
+        runtimeError(vm, "getAsync() takes between 1 and 3 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    long timeout = DEFAULT_REQUEST_TIMEOUT;
+    ObjList *headers = NULL;
+
+    if (argCount == 3) {
+        if (!IS_NUMBER(args[2])) {
+            runtimeError(vm, "Timeout passed to getAsync() must be a number.");
+            return EMPTY_VAL;
+        }
+
+        timeout = AS_NUMBER(args[2]);
+        argCount--;
+    }
+
+    if (argCount == 2) {
+        if (!IS_LIST(args[1])) {
+            runtimeError(vm, "Headers passed to getAsync() must be a list.");
+            return EMPTY_VAL;
+        }
+
+        headers = AS_LIST(args[1]);
+
+        for (int i = 0; i < headers->values.count; ++i) {
+            if (!IS_STRING(headers->values.values[i])) {
+                runtimeError(vm, "Headers list must only contain strings");
+                return EMPTY_VAL;
+            }
+        }
+    }
+
+    if (!IS_STRING(args[0])) {
+        runtimeError(vm, "URL passed to getAsync() must be a string.");
+        return EMPTY_VAL;
+    }
+
+    AsyncRequest *request = malloc(sizeof(AsyncRequest));
+    memset(request, 0, sizeof(AsyncRequest));
+    request->url = strdup(AS_CSTRING(args[0]));
+    request->timeout = timeout;
+
+    if (headers != NULL && headers->values.count > 0) {
+        request->headerCount = headers->values.count;
+        request->headers = malloc(sizeof(char*) * headers->values.count);
+
+        for (int i = 0; i < headers->values.count; ++i) {
+            request->headers[i] = strdup(AS_CSTRING(headers->values.values[i]));
+        }
+    }
+
+    return newFuture(vm, NIL_VAL, request, getAsyncWork, getAsyncComplete, freeAsyncRequest);
+}
+
 static Value post(DictuVM *vm, int argCount, Value *args) {
     if (argCount < 1 || argCount > 4) {
         runtimeError(vm, "post() takes between 1 and 4 arguments (%d given).", argCount);
@@ -552,8 +893,7 @@ static Value post(DictuVM *vm, int argCount, Value *args) {
     CURL *curl;
     CURLcode curlResponse;
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
+    curl = acquireCurlHandle();
 
     if (curl) {
         Response response;
@@ -564,8 +904,9 @@ static Value post(DictuVM *vm, int argCount, Value *args) {
         struct curl_slist *list = NULL;
 
         if (headers) {
-            if (!setRequestHeaders(vm, list, curl, headers)) {
+            if (!setRequestHeaders(vm, &list, curl, headers)) {
                 curl_slist_free_all(list);
+                releaseCurlHandle(curl);
                 return EMPTY_VAL;
             }
         }
@@ -599,8 +940,7 @@ static Value post(DictuVM *vm, int argCount, Value *args) {
 
         if (curlResponse != CURLE_OK) {
             /* always cleanup */
-            curl_easy_cleanup(curl);
-            curl_global_cleanup();
+            releaseCurlHandle(curl);
             pop(vm);
 
             char *errorString = (char *) curl_easy_strerror(curlResponse);
@@ -611,8 +951,7 @@ static Value post(DictuVM *vm, int argCount, Value *args) {
     }
 
     /* always cleanup */
-    curl_easy_cleanup(curl);
-    curl_global_cleanup();
+    releaseCurlHandle(curl);
     pop(vm);
 
     char *errorString = (char *) curl_easy_strerror(CURLE_FAILED_INIT);
@@ -669,8 +1008,7 @@ static Value put(DictuVM *vm, int argCount, Value *args) {
     CURL *curl;
     CURLcode curlResponse;
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
+    curl = acquireCurlHandle();
 
     if (curl) {
         Response response;
@@ -681,8 +1019,9 @@ static Value put(DictuVM *vm, int argCount, Value *args) {
         struct curl_slist *list = NULL;
 
         if (headers) {
-            if (!setRequestHeaders(vm, list, curl, headers)) {
+            if (!setRequestHeaders(vm, &list, curl, headers)) {
                 curl_slist_free_all(list);
+                releaseCurlHandle(curl);
                 return EMPTY_VAL;
             }
         }
@@ -717,8 +1056,7 @@ static Value put(DictuVM *vm, int argCount, Value *args) {
 
         if (curlResponse != CURLE_OK) {
             /* always cleanup */
-            curl_easy_cleanup(curl);
-            curl_global_cleanup();
+            releaseCurlHandle(curl);
             pop(vm);
 
             char *errorString = (char *) curl_easy_strerror(curlResponse);
@@ -729,8 +1067,7 @@ static Value put(DictuVM *vm, int argCount, Value *args) {
     }
 
     /* always cleanup */
-    curl_easy_cleanup(curl);
-    curl_global_cleanup();
+    releaseCurlHandle(curl);
     pop(vm);
 
     char *errorString = (char *) curl_easy_strerror(CURLE_FAILED_INIT);
@@ -773,8 +1110,7 @@ static Value head(DictuVM *vm, int argCount, Value *args) {
     CURL *curl;
     CURLcode curlResponse;
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
+    curl = acquireCurlHandle();
 
     if (curl) {
         Response response;
@@ -784,8 +1120,9 @@ static Value head(DictuVM *vm, int argCount, Value *args) {
         struct curl_slist *list = NULL;
 
         if (headers) {
-            if (!setRequestHeaders(vm, list, curl, headers)) {
+            if (!setRequestHeaders(vm, &list, curl, headers)) {
                 curl_slist_free_all(list);
+                releaseCurlHandle(curl);
                 return EMPTY_VAL;
             }
         }
@@ -808,8 +1145,7 @@ static Value head(DictuVM *vm, int argCount, Value *args) {
         /* Check for errors */
         if (curlResponse != CURLE_OK) {
             /* always cleanup */
-            curl_easy_cleanup(curl);
-            curl_global_cleanup();
+            releaseCurlHandle(curl);
             pop(vm);
 
             char *errorString = (char *) curl_easy_strerror(curlResponse);
@@ -820,8 +1156,7 @@ static Value head(DictuVM *vm, int argCount, Value *args) {
     }
 
     /* always cleanup */
-    curl_easy_cleanup(curl);
-    curl_global_cleanup();
+    releaseCurlHandle(curl);
     pop(vm);
 
     char *errorString = (char *) curl_easy_strerror(CURLE_FAILED_INIT);
@@ -864,8 +1199,7 @@ static Value options(DictuVM *vm, int argCount, Value *args) {
     CURL *curl;
     CURLcode curlResponse;
 
-    curl_global_init(CURL_GLOBAL_DEFAULT);
-    curl = curl_easy_init();
+    curl = acquireCurlHandle();
 
     if (curl) {
         Response response;
@@ -875,8 +1209,9 @@ static Value options(DictuVM *vm, int argCount, Value *args) {
         struct curl_slist *list = NULL;
 
         if (headers) {
-            if (!setRequestHeaders(vm, list, curl, headers)) {
+            if (!setRequestHeaders(vm, &list, curl, headers)) {
                 curl_slist_free_all(list);
+                releaseCurlHandle(curl);
                 return EMPTY_VAL;
             }
         }
@@ -901,8 +1236,7 @@ static Value options(DictuVM *vm, int argCount, Value *args) {
         /* Check for errors */
         if (curlResponse != CURLE_OK) {
             /* always cleanup */
-            curl_easy_cleanup(curl);
-            curl_global_cleanup();
+            releaseCurlHandle(curl);
             pop(vm);
 
             char *errorString = (char *) curl_easy_strerror(curlResponse);
@@ -913,8 +1247,7 @@ static Value options(DictuVM *vm, int argCount, Value *args) {
     }
 
     /* always cleanup */
-    curl_easy_cleanup(curl);
-    curl_global_cleanup();
+    releaseCurlHandle(curl);
     pop(vm);
 
     char *errorString = (char *) curl_easy_strerror(CURLE_FAILED_INIT);
@@ -922,18 +1255,19 @@ static Value options(DictuVM *vm, int argCount, Value *args) {
 }
 
 typedef struct {
+    // Kept for the life of the client so its connections stay open between requests
     CURL *curl;
+    struct curl_slist *headers;
+    long timeout;
 } HttpClient;
 
 #define AS_HTTP_CLIENT(v) ((HttpClient*)AS_ABSTRACT(v)->data)
 
-struct curl_slist *headerChunk = NULL;
-
 void freeHttpClient(DictuVM *vm, ObjAbstract *abstract) {
     HttpClient *httpClient = (HttpClient*)abstract->data;
-    
+
     curl_easy_cleanup(httpClient->curl);
-    curl_global_cleanup();
+    curl_slist_free_all(httpClient->headers);
 
     FREE(vm, HttpClient, abstract->data);
 }
@@ -946,6 +1280,13 @@ char *httpClientToString(ObjAbstract *abstract) {
     return httpClientString;
 }
 
+// The handle is reused, so undo anything the method of the last request changed
+static void resetClientRequest(HttpClient *httpClient) {
+    curl_easy_setopt(httpClient->curl, CURLOPT_CUSTOMREQUEST, NULL);
+    curl_easy_setopt(httpClient->curl, CURLOPT_REQUEST_TARGET, NULL);
+    curl_easy_setopt(httpClient->curl, CURLOPT_HTTPGET, 1L);
+}
+
 static Value httpClientSetTimeout(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 1) {
         runtimeError(vm, "setTimeout() takes 1 argument (%d given).", argCount);
@@ -958,8 +1299,9 @@ static Value httpClientSetTimeout(DictuVM *vm, int argCount, Value *args) {
     }
 
     HttpClient *httpClient = AS_HTTP_CLIENT(args[0]);
+    httpClient->timeout = AS_NUMBER(args[1]);
 
-    curl_easy_setopt(httpClient->curl, CURLOPT_TIMEOUT, (long)AS_NUMBER(args[1]));
+    curl_easy_setopt(httpClient->curl, CURLOPT_TIMEOUT, httpClient->timeout);
 
     return NIL_VAL;
 }
@@ -1031,13 +1373,14 @@ static Value httpClientSetHeaders(DictuVM *vm, int argCount, Value *args) {
 
     ObjList *headers = AS_LIST(args[1]);
 
-    headerChunk = NULL;
+    curl_slist_free_all(httpClient->headers);
+    httpClient->headers = NULL;
 
     for (int h = 0; h < headers->values.count; h++) {
-        headerChunk = curl_slist_append(headerChunk, AS_CSTRING(headers->values.values[h]));
+        httpClient->headers = curl_slist_append(httpClient->headers, AS_CSTRING(headers->values.values[h]));
     }
-    
-    curl_easy_setopt(httpClient->curl, CURLOPT_HTTPHEADER, headerChunk);
+
+    curl_easy_setopt(httpClient->curl, CURLOPT_HTTPHEADER, httpClient->headers);
 
     return NIL_VAL;
 }
@@ -1116,6 +1459,8 @@ static Value httpClientGet(DictuVM *vm, int argCount, Value *args) {
         createResponse(vm, &response);
         char *url = AS_CSTRING(args[1]);
 
+        resetClientRequest(httpClient);
+
         curl_easy_setopt(httpClient->curl, CURLOPT_URL, url);
         curl_easy_setopt(httpClient->curl, CURLOPT_ACCEPT_ENCODING, "gzip");
         curl_easy_setopt(httpClient->curl, CURLOPT_WRITEFUNCTION, writeResponse);
@@ -1181,6 +1526,8 @@ static Value httpClientPost(DictuVM *vm, int argCount, Value *args) {
             postValue = postValueString->chars;
         }
 
+        resetClientRequest(httpClient);
+
         curl_easy_setopt(httpClient->curl, CURLOPT_URL, url);
         curl_easy_setopt(httpClient->curl, CURLOPT_ACCEPT_ENCODING, "gzip");
         curl_easy_setopt(httpClient->curl, CURLOPT_POSTFIELDS, postValue);
@@ -1251,6 +1598,8 @@ static Value httpClientPut(DictuVM *vm, int argCount, Value *args) {
             putValue = putValueString->chars;
         }
 
+        resetClientRequest(httpClient);
+
         curl_easy_setopt(httpClient->curl, CURLOPT_URL, url);
         curl_easy_setopt(httpClient->curl, CURLOPT_ACCEPT_ENCODING, "gzip");
         curl_easy_setopt(httpClient->curl, CURLOPT_POSTFIELDS, putValue);
@@ -1301,6 +1650,8 @@ static Value httpClientHead(DictuVM *vm, int argCount, Value *args) {
         createResponse(vm, &response);
         char *url = AS_CSTRING(args[1]);
 
+        resetClientRequest(httpClient);
+
         curl_easy_setopt(httpClient->curl, CURLOPT_URL, url);
         curl_easy_setopt(httpClient->curl, CURLOPT_NOBODY, 1L);
         curl_easy_setopt(httpClient->curl, CURLOPT_ACCEPT_ENCODING, "gzip");
@@ -1325,17 +1676,17 @@ static Value httpClientHead(DictuVM *vm, int argCount, Value *args) {
 }
 
 static Value httpClientOptions(DictuVM *vm, int argCount, Value *args) {
-    if (argCount < 0 || argCount > 3) {
+    if (argCount < 1 || argCount > 3) {
         runtimeError(vm, "options() takes between 1 and 3 arguments (%d given).", argCount);
         return EMPTY_VAL;
     }
 
-    long timeout = DEFAULT_REQUEST_TIMEOUT;
+    long timeout = -1;
     ObjList *headers = NULL;
 
     HttpClient *httpClient = AS_HTTP_CLIENT(args[0]);
 
-    if (argCount == 4) {
+    if (argCount == 3) {
         if (!IS_NUMBER(args[3])) {
             runtimeError(vm, "Timeout passed to options() must be a number.");
             return EMPTY_VAL;
@@ -1345,7 +1696,7 @@ static Value httpClientOptions(DictuVM *vm, int argCount, Value *args) {
         argCount--;
     }
 
-    if (argCount == 3) {
+    if (argCount == 2) {
         if (!IS_LIST(args[2])) {
             runtimeError(vm, "Headers passed to options() must be a list.");
             return EMPTY_VAL;
@@ -1361,58 +1712,285 @@ static Value httpClientOptions(DictuVM *vm, int argCount, Value *args) {
 
     CURLcode curlResponse;
 
-    if (httpClient) {
-        Response response;
-        createResponse(vm, &response);
-        char *url = AS_CSTRING(args[1]);
+    Response response;
+    createResponse(vm, &response);
+    char *url = AS_CSTRING(args[1]);
 
-        struct curl_slist *list = NULL;
+    struct curl_slist *list = NULL;
 
-        if (headers) {
-            if (!setRequestHeaders(vm, list, httpClient->curl, headers)) {
-                curl_slist_free_all(list);
-                return EMPTY_VAL;
-            }
+    if (headers) {
+        if (!setRequestHeaders(vm, &list, httpClient->curl, headers)) {
+            curl_slist_free_all(list);
+            curl_easy_setopt(httpClient->curl, CURLOPT_HTTPHEADER, httpClient->headers);
+            pop(vm);
+            return EMPTY_VAL;
         }
+    }
 
-        curl_easy_setopt(httpClient->curl, CURLOPT_URL, url);
-        curl_easy_setopt(httpClient->curl, CURLOPT_NOBODY, 1L);
+    if (timeout >= 0) {
         curl_easy_setopt(httpClient->curl, CURLOPT_TIMEOUT, timeout);
-        curl_easy_setopt(httpClient->curl, CURLOPT_CUSTOMREQUEST, "OPTIONS");
-        curl_easy_setopt(httpClient->curl, CURLOPT_REQUEST_TARGET, "*");
-        curl_easy_setopt(httpClient->curl, CURLOPT_ACCEPT_ENCODING, "gzip");
-        curl_easy_setopt(httpClient->curl, CURLOPT_HEADERFUNCTION, writeHeaders);
-        curl_easy_setopt(httpClient->curl, CURLOPT_HEADERDATA, &response);
-        curl_easy_setopt(httpClient->curl, CURLOPT_FOLLOWLOCATION, 1L);
+    }
 
-        /* Perform the request, res will get the return code */
-        curlResponse = curl_easy_perform(httpClient->curl);
+    resetClientRequest(httpClient);
 
-        if (headers) {
-            curl_slist_free_all(list);
+    curl_easy_setopt(httpClient->curl, CURLOPT_URL, url);
+    curl_easy_setopt(httpClient->curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(httpClient->curl, CURLOPT_CUSTOMREQUEST, "OPTIONS");
+    curl_easy_setopt(httpClient->curl, CURLOPT_REQUEST_TARGET, "*");
+    curl_easy_setopt(httpClient->curl, CURLOPT_ACCEPT_ENCODING, "gzip");
+    curl_easy_setopt(httpClient->curl, CURLOPT_HEADERDATA, &response);
+
+    /* Perform the request, res will get the return code */
+    curlResponse = curl_easy_perform(httpClient->curl);
+
+    // The headers and timeout passed in only apply to this request
+    if (headers) {
+        curl_easy_setopt(httpClient->curl, CURLOPT_HTTPHEADER, httpClient->headers);
+        curl_slist_free_all(list);
+    }
+
+    if (timeout >= 0) {
+        curl_easy_setopt(httpClient->curl, CURLOPT_TIMEOUT, httpClient->timeout);
+    }
+
+    /* Check for errors */
+    if (curlResponse != CURLE_OK) {
+        pop(vm);
+
+        char *errorString = (char *) curl_easy_strerror(curlResponse);
+        return newResultError(vm, errorString);
+    }
+
+    return newResultSuccess(vm, OBJ_VAL(endRequest(vm, httpClient->curl, response, false)));
+}
+
+#define DEFAULT_GET_ALL_CONCURRENCY 8
+
+/**
+ * One of the easy handles getAll() keeps in flight on its multi handle. Each
+ * is a copy of the client's handle, so it carries the client's headers,
+ * timeout and TLS options, and is reused for the next URL once its request
+ * completes. Response must stay the first member so the client's header
+ * callback can be handed a transfer.
+ */
+typedef struct {
+    Response response;
+    CURL *curl;
+    int index;
+    // Called with each chunk of the body rather than buffering it, when set
+    Value callback;
+} Transfer;
+
+static size_t streamResponse(char *ptr, size_t size, size_t nmemb, void *data) {
+    Transfer *transfer = (Transfer *) data;
+    DictuVM *vm = transfer->response.vm;
+
+    Value callbackArgs[2] = {NUMBER_VAL(transfer->index), OBJ_VAL(copyString(vm, ptr, size * nmemb))};
+
+    push(vm, callbackArgs[1]);
+    callFunction(vm, transfer->callback, 2, callbackArgs);
+    pop(vm);
+
+    return size * nmemb;
+}
+
+// The headers list is stored in the results until the request completes so the GC can reach it
+static void startTransfer(DictuVM *vm, CURLM *multi, Transfer *transfer, ObjList *urls, ObjList *results, int index) {
+    transfer->index = index;
+    transfer->response.vm = vm;
+    transfer->response.res = NULL;
+    transfer->response.len = 0;
+    transfer->response.firstIteration = true;
+    transfer->response.headers = newList(vm);
+    results->values.values[index] = OBJ_VAL(transfer->response.headers);
+
+    curl_easy_setopt(transfer->curl, CURLOPT_CUSTOMREQUEST, NULL);
+    curl_easy_setopt(transfer->curl, CURLOPT_REQUEST_TARGET, NULL);
+    curl_easy_setopt(transfer->curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(transfer->curl, CURLOPT_URL, AS_CSTRING(urls->values.values[index]));
+
+    curl_multi_add_handle(multi, transfer->curl);
+}
+
+static Value finishTransfer(DictuVM *vm, Transfer *transfer, CURLcode code) {
+    if (code != CURLE_OK) {
+        if (transfer->response.res != NULL) {
+            FREE_ARRAY(vm, char, transfer->response.res, transfer->response.len + 1);
         }
 
-        /* Check for errors */
-        if (curlResponse != CURLE_OK) {
-            /* always cleanup */
-            curl_easy_cleanup(httpClient->curl);
-            curl_global_cleanup();
-            pop(vm);
+        return newResultError(vm, (char *) curl_easy_strerror(code));
+    }
 
-            char *errorString = (char *) curl_easy_strerror(curlResponse);
-            return newResultError(vm, errorString);
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &transfer->response.statusCode);
+
+    ObjString *content;
+    if (transfer->response.res != NULL) {
+        content = takeString(vm, transfer->response.res, transfer->response.len);
+    } else {
+        content = copyString(vm, "", 0);
+    }
+
+    // Push to stack to avoid GC
+    push(vm, OBJ_VAL(content));
+    ObjInstance *responseInstance = newResponseInstance(vm, content, transfer->response.headers, transfer->response.statusCode);
+    push(vm, OBJ_VAL(responseInstance));
+
+    Value result = newResultSuccess(vm, OBJ_VAL(responseInstance));
+    pop(vm);
+    pop(vm);
+
+    return result;
+}
+
+static Value httpClientGetAll(DictuVM *vm, int argCount, Value *args) {
+    if (argCount < 1 || argCount > 3) {
+        runtimeError(vm, "getAll() takes between 1 and 3 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    int concurrency = DEFAULT_GET_ALL_CONCURRENCY;
+    Value callback = NIL_VAL;
+
+    if (argCount == 3) {
+        if (!IS_CLOSURE(args[3]) && !IS_FUNCTION(args[3]) && !IS_BOUND_METHOD(args[3]) && !IS_NATIVE(args[3])) {
+            runtimeError(vm, "Callback passed to getAll() must be a function.");
+            return EMPTY_VAL;
         }
 
-        return newResultSuccess(vm, OBJ_VAL(endRequest(vm, httpClient->curl, response, true)));
+        callback = args[3];
+        argCount--;
+    }
+
+    if (argCount == 2) {
+        if (!IS_NUMBER(args[2]) || AS_NUMBER(args[2]) < 1) {
+            runtimeError(vm, "Concurrency passed to getAll() must be a number greater than 0.");
+            return EMPTY_VAL;
+        }
+
+        concurrency = AS_NUMBER(args[2]);
+    }
+
+    if (!IS_LIST(args[1])) {
+        runtimeError(vm, "URLs passed to getAll() must be a list.");
+        return EMPTY_VAL;
+    }
+
+    ObjList *urls = AS_LIST(args[1]);
+
+    for (int i = 0; i < urls->values.count; ++i) {
+        if (!IS_STRING(urls->values.values[i])) {
+            runtimeError(vm, "URLs list must only contain strings");
+            return EMPTY_VAL;
+        }
+    }
+
+    HttpClient *httpClient = AS_HTTP_CLIENT(args[0]);
+
+    ObjList *results = newList(vm);
+    push(vm, OBJ_VAL(results));
+
+    for (int i = 0; i < urls->values.count; ++i) {
+        writeValueArray(vm, &results->values, NIL_VAL);
+    }
+
+    if (concurrency > urls->values.count) {
+        concurrency = urls->values.count;
+    }
+
+    CURLM *multi = curl_multi_init();
+    Transfer *transfers = ALLOCATE(vm, Transfer, concurrency);
+    int started = 0;
+    int active = 0;
+
+    for (; started < concurrency; ++started) {
+        Transfer *transfer = &transfers[started];
+        transfer->curl = curl_easy_duphandle(httpClient->curl);
+        transfer->callback = callback;
+
+        curl_easy_setopt(transfer->curl, CURLOPT_SHARE, curlShare);
+        curl_easy_setopt(transfer->curl, CURLOPT_PRIVATE, transfer);
+        curl_easy_setopt(transfer->curl, CURLOPT_ACCEPT_ENCODING, "gzip");
+        curl_easy_setopt(transfer->curl, CURLOPT_HEADERDATA, transfer);
+
+        if (IS_NIL(callback)) {
+            curl_easy_setopt(transfer->curl, CURLOPT_WRITEFUNCTION, writeResponse);
+        } else {
+            curl_easy_setopt(transfer->curl, CURLOPT_WRITEFUNCTION, streamResponse);
+        }
+
+        curl_easy_setopt(transfer->curl, CURLOPT_WRITEDATA, transfer);
+
+        startTransfer(vm, multi, transfer, urls, results, started);
+        active++;
+    }
+
+    CURLMcode multiCode = CURLM_OK;
+
+    while (active > 0) {
+        int running;
+        multiCode = curl_multi_perform(multi, &running);
+
+        if (multiCode == CURLM_OK && running > 0) {
+            multiCode = curl_multi_poll(multi, NULL, 0, 1000, NULL);
+        }
+
+        if (multiCode != CURLM_OK) {
+            break;
+        }
+
+        CURLMsg *message;
+        int queued;
+
+        while ((message = curl_multi_info_read(multi, &queued)) != NULL) {
+            if (message->msg != CURLMSG_DONE) {
+                continue;
+            }
+
+            Transfer *transfer;
+            curl_easy_getinfo(message->easy_handle, CURLINFO_PRIVATE, (char **) &transfer);
+            CURLcode code = message->data.result;
+
+            curl_multi_remove_handle(multi, transfer->curl);
+            results->values.values[transfer->index] = finishTransfer(vm, transfer, code);
+            active--;
+
+            // Hand the finished handle, and its open connection, to the next URL
+            if (started < urls->values.count) {
+                startTransfer(vm, multi, transfer, urls, results, started++);
+                active++;
+            }
+        }
+    }
+
+    for (int i = 0; i < concurrency; ++i) {
+        Transfer *transfer = &transfers[i];
+
+        // Only left running if the multi handle itself failed
+        if (multiCode != CURLM_OK && IS_LIST(results->values.values[transfer->index])) {
+            curl_multi_remove_handle(multi, transfer->curl);
+
+            if (transfer->response.res != NULL) {
+                FREE_ARRAY(vm, char, transfer->response.res, transfer->response.len + 1);
+            }
+        }
+
+        curl_easy_cleanup(transfer->curl);
+    }
+
+    FREE_ARRAY(vm, Transfer, transfers, concurrency);
+    curl_multi_cleanup(multi);
+
+    if (multiCode != CURLM_OK) {
+        for (int i = 0; i < results->values.count; ++i) {
+            if (IS_NIL(results->values.values[i]) || IS_LIST(results->values.values[i])) {
+                results->values.values[i] = newResultError(vm, (char *) curl_multi_strerror(multiCode));
+            }
+        }
     }
 
-    /* always cleanup */
-    curl_easy_cleanup(httpClient->curl);
-    curl_global_cleanup();
     pop(vm);
 
-    char *errorString = (char *) curl_easy_strerror(CURLE_FAILED_INIT);
-    return newResultError(vm, errorString);
+    return OBJ_VAL(results);
 }
 
 Value newHttpClient(DictuVM *vm, ObjDict *opts) {
@@ -1420,7 +1998,9 @@ Value newHttpClient(DictuVM *vm, ObjDict *opts) {
     push(vm, OBJ_VAL(abstract));
 
     HttpClient *httpClient = ALLOCATE(vm, HttpClient, 1);
-    httpClient->curl = curl_easy_init();
+    httpClient->curl = newCurlHandle();
+    httpClient->headers = NULL;
+    httpClient->timeout = 0;
     
     curl_easy_setopt(httpClient->curl, CURLOPT_HEADERFUNCTION, writeHeaders);
     curl_easy_setopt(httpClient->curl, CURLOPT_FOLLOWLOCATION, 1L);
@@ -1451,7 +2031,8 @@ Value newHttpClient(DictuVM *vm, ObjDict *opts) {
                     return EMPTY_VAL;
                 }
 
-                curl_easy_setopt(httpClient->curl, CURLOPT_TIMEOUT, (long)AS_NUMBER(entry->value));
+                httpClient->timeout = AS_NUMBER(entry->value);
+                curl_easy_setopt(httpClient->curl, CURLOPT_TIMEOUT, httpClient->timeout);
             } else if (strstr(key, "headers")) {
                 if (IS_EMPTY(entry->value)) {
                     continue;
@@ -1465,10 +2046,10 @@ Value newHttpClient(DictuVM *vm, ObjDict *opts) {
                 ObjList *headers = AS_LIST(entry->value);
 
                 for (int h = 0; h < headers->values.count; h++) {
-                    headerChunk = curl_slist_append(headerChunk, AS_CSTRING(headers->values.values[h]));
+                    httpClient->headers = curl_slist_append(httpClient->headers, AS_CSTRING(headers->values.values[h]));
                 }
-                
-                curl_easy_setopt(httpClient->curl, CURLOPT_HTTPHEADER, headerChunk);
+
+                curl_easy_setopt(httpClient->curl, CURLOPT_HTTPHEADER, httpClient->headers);
             } else if (strstr(key, "insecure")) {
                 if (IS_EMPTY(entry->value)) {
                     continue;
@@ -1559,6 +2140,7 @@ Value newHttpClient(DictuVM *vm, ObjDict *opts) {
     defineNative(vm, &abstract->values, "put", httpClientPut);
     defineNative(vm, &abstract->values, "head", httpClientHead);
     defineNative(vm, &abstract->values, "options", httpClientOptions);
+    defineNative(vm, &abstract->values, "getAll", httpClientGetAll);
     defineNative(vm, &abstract->values, "setTimeout", httpClientSetTimeout);
     defineNative(vm, &abstract->values, "setHeaders", httpClientSetHeaders);
     defineNative(vm, &abstract->values, "setInsecure", httpClientSetInsecure);
@@ -1829,6 +2411,7 @@ Value createHTTPModule(DictuVM *vm) {
      * Define Http methods
      */
     defineNative(vm, &module->values, "get", get);
+    defineNative(vm, &module->values, "getAsync", getAsync);
     defineNative(vm, &module->values, "post", post);
     defineNative(vm, &module->values, "put", put);
     defineNative(vm, &module->values, "head", head);
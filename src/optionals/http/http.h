@@ -3,6 +3,7 @@
 
 #include "../optionals.h"
 #include "../../vm/vm.h"
+#include "../../vm/future.h"
 
 #ifndef DISABLE_HTTP
 #include <curl/curl.h>
@@ -0,0 +1,1269 @@
+#include "httpServer.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+#include "httpServer/httpParser.h"
+#include "../vm/memory.h"
+
+// Writing to a socket the peer has closed shouldn't kill the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
+
+#define HTTP_SERVER_READ_SIZE 16384
+#define HTTP_SERVER_MAX_EVENTS 256
+
+#define DEFAULT_MAX_HEAD_SIZE 65536
+#define DEFAULT_MAX_BODY_SIZE (1024 * 1024)
+#define DEFAULT_IDLE_TIMEOUT 60000
+
+/**
+ * HTTPServer
+ *
+ * An HTTP/1.1 server that runs on the VM thread. Connections are kept alive
+ * between requests, and requests sent back to back without waiting for a
+ * response are answered in order. Each request is parsed where it was read,
+ * handed to the handler as a dict, and the handler's return value written
+ * back. Linux uses epoll, other platforms fall back to poll().
+ */
+typedef struct {
+    int fd;
+    // Unconsumed bytes run from inputStart to inputLength
+    char *input;
+    size_t inputStart;
+    size_t inputLength;
+    size_t inputCapacity;
+    // How far into the input the end of the current head has been searched for
+    size_t scanned;
+    bool headParsed;
+    HttpRequestHead head;
+    HttpChunkedDecoder chunked;
+    bool continueSent;
+    char *output;
+    size_t outputLength;
+    size_t outputCapacity;
+    size_t outputSent;
+    // Closed as soon as everything written has been sent
+    bool closing;
+    double lastActive;
+} HttpConnection;
+
+typedef enum {
+    KEY_METHOD,
+    KEY_PATH,
+    KEY_QUERY,
+    KEY_VERSION,
+    KEY_HEADERS,
+    KEY_BODY,
+    KEY_STATUS,
+    KEY_COUNT
+} HttpServerKey;
+
+static const char *keyNames[KEY_COUNT] = {
+    "method", "path", "query", "version", "headers", "body", "status"
+};
+
+typedef struct {
+    int listenFd;
+    int pollFd;
+    Value handler;
+    // Indexed by file descriptor
+    HttpConnection **connections;
+    int connectionCapacity;
+    int connectionCount;
+    size_t maxHeadSize;
+    size_t maxBodySize;
+    double idleTimeout;
+    double lastSweep;
+    bool running;
+    bool stopped;
+    // close() was called from a handler, so happens once run() returns
+    bool closePending;
+    // Interned once rather than hashed for every request
+    ObjString *keys[KEY_COUNT];
+    char date[40];
+    time_t dateSecond;
+} HttpServer;
+
+#define AS_HTTP_SERVER(v) ((HttpServer*)AS_ABSTRACT(v)->data)
+
+static double monotonicMs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+}
+
+static bool setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+static bool watchConnection(HttpServer *server, int fd, bool writable, bool added) {
+#ifdef __linux__
+    struct epoll_event event;
+    event.events = writable ? EPOLLOUT : EPOLLIN;
+    event.data.fd = fd;
+
+    return epoll_ctl(server->pollFd, added ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) != -1;
+#else
+    UNUSED(server);
+    UNUSED(fd);
+    UNUSED(writable);
+    UNUSED(added);
+
+    // Rebuilt from the connections on every wait
+    return true;
+#endif
+}
+
+static void closeConnection(DictuVM *vm, HttpServer *server, HttpConnection *connection) {
+#ifdef __linux__
+    epoll_ctl(server->pollFd, EPOLL_CTL_DEL, connection->fd, NULL);
+#endif
+    close(connection->fd);
+
+    server->connections[connection->fd] = NULL;
+    server->connectionCount--;
+
+    FREE_ARRAY(vm, char, connection->input, connection->inputCapacity);
+    FREE_ARRAY(vm, char, connection->output, connection->outputCapacity);
+    FREE(vm, HttpConnection, connection);
+}
+
+static void closeServer(DictuVM *vm, HttpServer *server) {
+    for (int fd = 0; fd < server->connectionCapacity; ++fd) {
+        if (server->connections[fd] != NULL) {
+            closeConnection(vm, server, server->connections[fd]);
+        }
+    }
+
+    if (server->listenFd != -1) {
+        close(server->listenFd);
+        server->listenFd = -1;
+    }
+
+#ifdef __linux__
+    if (server->pollFd != -1) {
+        close(server->pollFd);
+        server->pollFd = -1;
+    }
+#endif
+}
+
+static HttpConnection *newConnection(DictuVM *vm, HttpServer *server, int fd) {
+    if (fd >= server->connectionCapacity) {
+        int oldCapacity = server->connectionCapacity;
+        int capacity = oldCapacity < 8 ? 8 : oldCapacity;
+
+        while (capacity <= fd) {
+            capacity *= 2;
+        }
+
+        server->connections = GROW_ARRAY(vm, server->connections, HttpConnection *, oldCapacity, capacity);
+        server->connectionCapacity = capacity;
+
+        for (int i = oldCapacity; i < capacity; ++i) {
+            server->connections[i] = NULL;
+        }
+    }
+
+    HttpConnection *connection = ALLOCATE(vm, HttpConnection, 1);
+    connection->fd = fd;
+    connection->input = NULL;
+    connection->inputStart = 0;
+    connection->inputLength = 0;
+    connection->inputCapacity = 0;
+    connection->scanned = 0;
+    connection->headParsed = false;
+    connection->continueSent = false;
+    connection->output = NULL;
+    connection->outputLength = 0;
+    connection->outputCapacity = 0;
+    connection->outputSent = 0;
+    connection->closing = false;
+    connection->lastActive = monotonicMs();
+
+    server->connections[fd] = connection;
+    server->connectionCount++;
+
+    return connection;
+}
+
+static void acceptConnections(DictuVM *vm, HttpServer *server) {
+    while (true) {
+        int fd = accept(server->listenFd, NULL, NULL);
+
+        // Nothing left to accept, or out of descriptors until some close
+        if (fd == -1) {
+            return;
+        }
+
+        if (!setNonBlocking(fd)) {
+            close(fd);
+            continue;
+        }
+
+        // Responses are written whole, so there is nothing to gain from delaying them
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+#ifdef SO_NOSIGPIPE
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+
+        if (!watchConnection(server, fd, false, false)) {
+            close(fd);
+            continue;
+        }
+
+        newConnection(vm, server, fd);
+    }
+}
+
+static void appendOutput(DictuVM *vm, HttpConnection *connection, const char *chars, size_t length) {
+    if (connection->outputLength + length > connection->outputCapacity) {
+        size_t capacity = connection->outputCapacity < 1024 ? 1024 : connection->outputCapacity;
+
+        while (capacity < connection->outputLength + length) {
+            capacity *= 2;
+        }
+
+        connection->output = GROW_ARRAY(vm, connection->output, char, connection->outputCapacity, capacity);
+        connection->outputCapacity = capacity;
+    }
+
+    memcpy(connection->output + connection->outputLength, chars, length);
+    connection->outputLength += length;
+}
+
+static const char *statusReason(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 410: return "Gone";
+        case 411: return "Length Required";
+        case 413: return "Content Too Large";
+        case 415: return "Unsupported Media Type";
+        case 422: return "Unprocessable Content";
+        case 429: return "Too Many Requests";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        case 505: return "HTTP Version Not Supported";
+        default: return "";
+    }
+}
+
+// The Date header only changes once a second, so is formatted once a second
+static const char *currentDate(HttpServer *server) {
+    time_t now = time(NULL);
+
+    if (now != server->dateSecond) {
+        struct tm utc;
+        gmtime_r(&now, &utc);
+        strftime(server->date, sizeof(server->date), "%a, %d %b %Y %H:%M:%S GMT", &utc);
+        server->dateSecond = now;
+    }
+
+    return server->date;
+}
+
+static void appendStatusLine(DictuVM *vm, HttpServer *server, HttpConnection *connection, int status) {
+    char line[128];
+    int length = snprintf(line, sizeof(line), "HTTP/1.1 %d %s\r\nDate: %s\r\n", status, statusReason(status), currentDate(server));
+
+    appendOutput(vm, connection, line, length);
+}
+
+// Answers a request that can't be handled and closes the connection, as
+// there is no telling where the next request would start
+static void rejectRequest(DictuVM *vm, HttpServer *server, HttpConnection *connection, int status) {
+    appendStatusLine(vm, server, connection, status);
+    appendOutput(vm, connection, "Content-Length: 0\r\nConnection: close\r\n\r\n", 40);
+
+    connection->closing = true;
+    connection->inputStart = connection->inputLength;
+}
+
+static void setField(DictuVM *vm, ObjDict *dict, ObjString *key, Value value) {
+    push(vm, value);
+    dictSet(vm, dict, OBJ_VAL(key), value);
+    pop(vm);
+}
+
+// Header names are lower cased where they were read, then interned, so the
+// same few names are looked up rather than allocated on every request
+static ObjDict *newHeadersDict(DictuVM *vm, char *data, HttpRequestHead *head) {
+    ObjDict *headers = newDict(vm);
+    push(vm, OBJ_VAL(headers));
+
+    for (int i = 0; i < head->headerCount; ++i) {
+        HttpSlice name = head->headerNames[i];
+        HttpSlice value = head->headerValues[i];
+
+        for (int c = name.start; c < name.start + name.length; ++c) {
+            if (data[c] >= 'A' && data[c] <= 'Z') {
+                data[c] += 'a' - 'A';
+            }
+        }
+
+        Value key = OBJ_VAL(copyString(vm, data + name.start, name.length));
+        push(vm, key);
+
+        Value existing;
+        ObjString *string;
+
+        // A repeated header is the same as one holding both values
+        if (dictGet(vm, headers, key, &existing)) {
+            ObjString *previous = AS_STRING(existing);
+            int length = previous->length + 2 + value.length;
+            char *chars = ALLOCATE(vm, char, length + 1);
+
+            memcpy(chars, previous->chars, previous->length);
+            memcpy(chars + previous->length, ", ", 2);
+            memcpy(chars + previous->length + 2, data + value.start, value.length);
+            chars[length] = '\0';
+
+            string = takeString(vm, chars, length);
+        } else {
+            string = copyString(vm, data + value.start, value.length);
+        }
+
+        push(vm, OBJ_VAL(string));
+        dictSet(vm, headers, key, OBJ_VAL(string));
+        pop(vm);
+        pop(vm);
+    }
+
+    pop(vm);
+
+    return headers;
+}
+
+static ObjDict *newRequestDict(DictuVM *vm, HttpServer *server, char *data, HttpRequestHead *head, size_t bodyLength) {
+    ObjDict *request = newDict(vm);
+    push(vm, OBJ_VAL(request));
+
+    setField(vm, request, server->keys[KEY_METHOD], OBJ_VAL(copyString(vm, data + head->method.start, head->method.length)));
+
+    const char *target = data + head->target.start;
+    const char *query = memchr(target, '?', head->target.length);
+    int pathLength = query == NULL ? head->target.length : query - target;
+
+    setField(vm, request, server->keys[KEY_PATH], OBJ_VAL(copyString(vm, target, pathLength)));
+
+    if (query != NULL) {
+        setField(vm, request, server->keys[KEY_QUERY], OBJ_VAL(copyString(vm, query + 1, head->target.length - pathLength - 1)));
+    } else {
+        setField(vm, request, server->keys[KEY_QUERY], OBJ_VAL(copyString(vm, "", 0)));
+    }
+
+    setField(vm, request, server->keys[KEY_VERSION], OBJ_VAL(copyString(vm, head->minorVersion == 0 ? "HTTP/1.0" : "HTTP/1.1", 8)));
+    setField(vm, request, server->keys[KEY_HEADERS], OBJ_VAL(newHeadersDict(vm, data, head)));
+    setField(vm, request, server->keys[KEY_BODY], OBJ_VAL(copyString(vm, data + head->length, bodyLength)));
+
+    pop(vm);
+
+    return request;
+}
+
+static bool equalsIgnoreCase(ObjString *string, const char *lower) {
+    if (string->length != (int) strlen(lower)) {
+        return false;
+    }
+
+    for (int i = 0; i < string->length; ++i) {
+        char c = string->chars[i];
+
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+
+        if (c != lower[i]) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool appendResponseHeaders(DictuVM *vm, HttpConnection *connection, ObjDict *headers) {
+    for (int i = 0; i <= headers->capacityMask; ++i) {
+        DictItem *entry = &headers->entries[i];
+
+        if (IS_EMPTY(entry->key)) {
+            continue;
+        }
+
+        if (!IS_STRING(entry->key) || !IS_STRING(entry->value)) {
+            runtimeError(vm, "Response headers must be a dict of strings");
+            return false;
+        }
+
+        ObjString *name = AS_STRING(entry->key);
+        ObjString *value = AS_STRING(entry->value);
+
+        if (memchr(name->chars, '\n', name->length) || memchr(name->chars, '\r', name->length) ||
+            memchr(value->chars, '\n', value->length) || memchr(value->chars, '\r', value->length)) {
+            runtimeError(vm, "Response header '%s' must not contain a line break", name->chars);
+            return false;
+        }
+
+        // The body is always framed by the server
+        if (equalsIgnoreCase(name, "content-length") || equalsIgnoreCase(name, "transfer-encoding")) {
+            continue;
+        }
+
+        if (equalsIgnoreCase(name, "connection")) {
+            if (equalsIgnoreCase(value, "close")) {
+                connection->closing = true;
+            }
+
+            continue;
+        }
+
+        appendOutput(vm, connection, name->chars, name->length);
+        appendOutput(vm, connection, ": ", 2);
+        appendOutput(vm, connection, value->chars, value->length);
+        appendOutput(vm, connection, "\r\n", 2);
+    }
+
+    return true;
+}
+
+static bool writeResponse(DictuVM *vm, HttpServer *server, HttpConnection *connection, Value response, bool isHead) {
+    int status = 200;
+    ObjDict *headers = NULL;
+    ObjString *body = NULL;
+
+    if (IS_STRING(response)) {
+        body = AS_STRING(response);
+    } else if (IS_DICT(response)) {
+        ObjDict *dict = AS_DICT(response);
+        Value value;
+
+        if (dictGet(vm, dict, OBJ_VAL(server->keys[KEY_STATUS]), &value)) {
+            if (!IS_NUMBER(value) || AS_NUMBER(value) < 100 || AS_NUMBER(value) > 999) {
+                runtimeError(vm, "Response status must be a number between 100 and 999");
+                return false;
+            }
+
+            status = AS_NUMBER(value);
+        }
+
+        if (dictGet(vm, dict, OBJ_VAL(server->keys[KEY_HEADERS]), &value)) {
+            if (!IS_DICT(value)) {
+                runtimeError(vm, "Response headers must be a dict of strings");
+                return false;
+            }
+
+            headers = AS_DICT(value);
+        }
+
+        if (dictGet(vm, dict, OBJ_VAL(server->keys[KEY_BODY]), &value) && !IS_NIL(value)) {
+            if (!IS_STRING(value)) {
+                runtimeError(vm, "Response body must be a string");
+                return false;
+            }
+
+            body = AS_STRING(value);
+        }
+    } else {
+        runtimeError(vm, "Handler passed to create() must return a string or a dict");
+        return false;
+    }
+
+    appendStatusLine(vm, server, connection, status);
+
+    if (headers != NULL) {
+        if (!appendResponseHeaders(vm, connection, headers)) {
+            return false;
+        }
+    } else if (IS_STRING(response)) {
+        appendOutput(vm, connection, "Content-Type: text/plain; charset=utf-8\r\n", 41);
+    }
+
+    // Informational, No Content and Not Modified responses never have a body
+    bool hasBody = status >= 200 && status != 204 && status != 304;
+    int bodyLength = body == NULL ? 0 : body->length;
+
+    if (hasBody) {
+        char line[48];
+        int length = snprintf(line, sizeof(line), "Content-Length: %d\r\n", bodyLength);
+        appendOutput(vm, connection, line, length);
+    }
+
+    if (connection->closing) {
+        appendOutput(vm, connection, "Connection: close\r\n\r\n", 21);
+    } else if (connection->head.minorVersion == 0) {
+        appendOutput(vm, connection, "Connection: keep-alive\r\n\r\n", 26);
+    } else {
+        appendOutput(vm, connection, "\r\n", 2);
+    }
+
+    // A response to HEAD describes the body it would have sent
+    if (hasBody && !isHead && bodyLength > 0) {
+        appendOutput(vm, connection, body->chars, bodyLength);
+    }
+
+    return true;
+}
+
+static bool dispatchRequest(DictuVM *vm, HttpServer *server, HttpConnection *connection, size_t bodyLength) {
+    char *data = connection->input + connection->inputStart;
+    HttpRequestHead *head = &connection->head;
+
+    if (!head->keepAlive) {
+        connection->closing = true;
+    }
+
+    bool isHead = head->method.length == 4 && memcmp(data + head->method.start, "HEAD", 4) == 0;
+
+    Value request = OBJ_VAL(newRequestDict(vm, server, data, head, bodyLength));
+    push(vm, request);
+
+    int frameCount = vm->frameCount;
+    Value response;
+
+    if (tryCallFunction(vm, server->handler, 1, &request, &response) != INTERPRET_OK) {
+        // An error that ended the coroutine serve() ran in leaves nothing to carry on from
+        if (vm->frameCount != frameCount) {
+            return false;
+        }
+
+        // The error has been reported, the client gets a 500 and the server keeps going
+        pop(vm);
+        appendStatusLine(vm, server, connection, 500);
+        appendOutput(vm, connection, "Content-Length: 0\r\nConnection: close\r\n\r\n", 40);
+        connection->closing = true;
+        return true;
+    }
+
+    push(vm, response);
+
+    bool written = !IS_EMPTY(response) && writeResponse(vm, server, connection, response, isHead);
+
+    pop(vm);
+    pop(vm);
+
+    return written;
+}
+
+// Handles every complete request that has been read, returning false if a
+// handler raised a runtime error
+static bool processRequests(DictuVM *vm, HttpServer *server, HttpConnection *connection) {
+    while (!connection->closing) {
+        char *data = connection->input + connection->inputStart;
+        size_t available = connection->inputLength - connection->inputStart;
+        HttpRequestHead *head = &connection->head;
+
+        if (!connection->headParsed) {
+            // Some clients send a line break after a request body
+            while (available > 0 && connection->scanned == 0 && (data[0] == '\r' || data[0] == '\n')) {
+                connection->inputStart++;
+                data++;
+                available--;
+            }
+
+            int headLength = httpFindHeadEnd(data, available, &connection->scanned);
+
+            if (headLength == -1) {
+                if (available > server->maxHeadSize) {
+                    rejectRequest(vm, server, connection, 431);
+                }
+
+                return true;
+            }
+
+            if ((size_t) headLength > server->maxHeadSize) {
+                rejectRequest(vm, server, connection, 431);
+                return true;
+            }
+
+            switch (httpParseHead(data, headLength, head)) {
+                case HTTP_PARSE_OK:
+                    break;
+
+                case HTTP_PARSE_INVALID:
+                    rejectRequest(vm, server, connection, 400);
+                    return true;
+
+                case HTTP_PARSE_TOO_MANY_HEADERS:
+                    rejectRequest(vm, server, connection, 431);
+                    return true;
+
+                case HTTP_PARSE_UNSUPPORTED:
+                    rejectRequest(vm, server, connection, 501);
+                    return true;
+            }
+
+            if (head->contentLength > (int64_t) server->maxBodySize) {
+                rejectRequest(vm, server, connection, 413);
+                return true;
+            }
+
+            connection->headParsed = true;
+            connection->continueSent = false;
+            initHttpChunkedDecoder(&connection->chunked);
+        }
+
+        size_t bodyLength;
+        size_t rawLength;
+        bool complete;
+
+        if (head->chunked) {
+            HttpChunkedDecoder *decoder = &connection->chunked;
+
+            if (!httpDecodeChunked(decoder, data + head->length, available - head->length, server->maxBodySize)) {
+                bool tooLarge = decoder->decoded + decoder->remaining > server->maxBodySize;
+                rejectRequest(vm, server, connection, tooLarge ? 413 : 400);
+                return true;
+            }
+
+            complete = decoder->done;
+            bodyLength = decoder->decoded;
+            rawLength = decoder->consumed;
+        } else {
+            bodyLength = head->contentLength == -1 ? 0 : head->contentLength;
+            rawLength = bodyLength;
+            complete = available - head->length >= rawLength;
+        }
+
+        if (!complete) {
+            // The client is waiting to hear the body is wanted before sending it
+            if (head->expectContinue && head->minorVersion >= 1 && !connection->continueSent) {
+                appendOutput(vm, connection, "HTTP/1.1 100 Continue\r\n\r\n", 25);
+                connection->continueSent = true;
+            }
+
+            return true;
+        }
+
+        if (!dispatchRequest(vm, server, connection, bodyLength)) {
+            return false;
+        }
+
+        connection->inputStart += head->length + rawLength;
+        connection->scanned = 0;
+        connection->headParsed = false;
+    }
+
+    return true;
+}
+
+// Returns false if the connection should be dropped
+static bool readConnection(DictuVM *vm, HttpConnection *connection) {
+    // Everything before inputStart has been handled
+    if (connection->inputStart > 0) {
+        memmove(connection->input, connection->input + connection->inputStart, connection->inputLength - connection->inputStart);
+        connection->inputLength -= connection->inputStart;
+        connection->inputStart = 0;
+    }
+
+    if (connection->inputCapacity - connection->inputLength < HTTP_SERVER_READ_SIZE) {
+        size_t capacity = connection->inputCapacity == 0 ? HTTP_SERVER_READ_SIZE : connection->inputCapacity * 2;
+
+        connection->input = GROW_ARRAY(vm, connection->input, char, connection->inputCapacity, capacity);
+        connection->inputCapacity = capacity;
+    }
+
+    ssize_t count = recv(connection->fd, connection->input + connection->inputLength, connection->inputCapacity - connection->inputLength, 0);
+
+    if (count == -1) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+
+    // The peer has gone, and won't read anything more
+    if (count == 0) {
+        return false;
+    }
+
+    connection->inputLength += count;
+
+    return true;
+}
+
+// Returns false if the connection should be dropped
+static bool flushConnection(HttpConnection *connection) {
+    while (connection->outputSent < connection->outputLength) {
+        ssize_t sent = send(connection->fd, connection->output + connection->outputSent, connection->outputLength - connection->outputSent, SEND_FLAGS);
+
+        if (sent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        connection->outputSent += sent;
+    }
+
+    connection->outputLength = 0;
+    connection->outputSent = 0;
+
+    return true;
+}
+
+// Returns false if a handler raised a runtime error
+static bool handleConnection(DictuVM *vm, HttpServer *server, HttpConnection *connection) {
+    bool wasWriting = connection->outputLength > 0;
+
+    if (wasWriting) {
+        if (!flushConnection(connection)) {
+            closeConnection(vm, server, connection);
+            return true;
+        }
+
+        if (connection->outputLength > 0) {
+            return true;
+        }
+    } else if (!readConnection(vm, connection)) {
+        closeConnection(vm, server, connection);
+        return true;
+    }
+
+    connection->lastActive = monotonicMs();
+
+    if (!processRequests(vm, server, connection)) {
+        return false;
+    }
+
+    if (!flushConnection(connection)) {
+        closeConnection(vm, server, connection);
+        return true;
+    }
+
+    bool writing = connection->outputLength > 0;
+
+    if (connection->closing && !writing) {
+        closeConnection(vm, server, connection);
+        return true;
+    }
+
+    // Nothing more is read until everything written so far has been sent
+    if (writing != wasWriting && !watchConnection(server, connection->fd, writing, true)) {
+        closeConnection(vm, server, connection);
+    }
+
+    return true;
+}
+
+static void closeIdleConnections(DictuVM *vm, HttpServer *server) {
+    double now = monotonicMs();
+
+    if (server->idleTimeout <= 0 || now - server->lastSweep < 1000) {
+        return;
+    }
+
+    server->lastSweep = now;
+
+    for (int fd = 0; fd < server->connectionCapacity; ++fd) {
+        HttpConnection *connection = server->connections[fd];
+
+        if (connection != NULL && now - connection->lastActive >= server->idleTimeout) {
+            closeConnection(vm, server, connection);
+        }
+    }
+}
+
+// Returns the number of sockets handled, -1 with errno set if waiting
+// failed, or -2 if a handler raised a runtime error
+static int runOnce(DictuVM *vm, HttpServer *server, int timeout) {
+    // Wake at least once a second to close idle connections
+    if (server->idleTimeout > 0 && server->connectionCount > 0 && (timeout < 0 || timeout > 1000)) {
+        timeout = 1000;
+    }
+
+    int handled = 0;
+
+#ifdef __linux__
+    struct epoll_event events[HTTP_SERVER_MAX_EVENTS];
+    int count = epoll_wait(server->pollFd, events, HTTP_SERVER_MAX_EVENTS, timeout);
+
+    if (count == -1) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int fd = events[i].data.fd;
+
+        if (fd == server->listenFd) {
+            acceptConnections(vm, server);
+        } else if (fd < server->connectionCapacity && server->connections[fd] != NULL) {
+            if (!handleConnection(vm, server, server->connections[fd])) {
+                return -2;
+            }
+        }
+
+        handled++;
+    }
+#else
+    int fdCount = server->connectionCount + 1;
+    struct pollfd *fds = ALLOCATE(vm, struct pollfd, fdCount);
+
+    fds[0].fd = server->listenFd;
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+
+    for (int fd = 0, i = 1; fd < server->connectionCapacity; ++fd) {
+        HttpConnection *connection = server->connections[fd];
+
+        if (connection == NULL) {
+            continue;
+        }
+
+        fds[i].fd = fd;
+        fds[i].events = connection->outputLength > 0 ? POLLOUT : POLLIN;
+        fds[i].revents = 0;
+        i++;
+    }
+
+    int count = poll(fds, fdCount, timeout);
+
+    if (count == -1) {
+        FREE_ARRAY(vm, struct pollfd, fds, fdCount);
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < fdCount && count > 0; ++i) {
+        if (fds[i].revents == 0) {
+            continue;
+        }
+
+        count--;
+        handled++;
+
+        if (i == 0) {
+            acceptConnections(vm, server);
+        } else if (server->connections[fds[i].fd] != NULL) {
+            if (!handleConnection(vm, server, server->connections[fds[i].fd])) {
+                FREE_ARRAY(vm, struct pollfd, fds, fdCount);
+                return -2;
+            }
+        }
+    }
+
+    FREE_ARRAY(vm, struct pollfd, fds, fdCount);
+#endif
+
+    closeIdleConnections(vm, server);
+
+    return handled;
+}
+
+static Value httpServerRunOnce(DictuVM *vm, int argCount, Value *args) {
+    if (argCount > 1) {
+        runtimeError(vm, "runOnce() takes 0 or 1 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    int timeout = -1;
+
+    if (argCount == 1) {
+        if (!IS_NUMBER(args[1])) {
+            runtimeError(vm, "runOnce() argument must be a number");
+            return EMPTY_VAL;
+        }
+
+        timeout = AS_NUMBER(args[1]);
+    }
+
+    HttpServer *server = AS_HTTP_SERVER(args[0]);
+
+    if (server->running) {
+        runtimeError(vm, "runOnce() can not be called while the server is running");
+        return EMPTY_VAL;
+    }
+
+    if (server->listenFd == -1) {
+        runtimeError(vm, "runOnce() can not be called on a closed server");
+        return EMPTY_VAL;
+    }
+
+    server->running = true;
+    int handled = runOnce(vm, server, timeout);
+    server->running = false;
+
+    if (server->closePending) {
+        closeServer(vm, server);
+    }
+
+    if (handled == -2) {
+        return EMPTY_VAL;
+    }
+
+    if (handled == -1) {
+        ERROR_RESULT;
+    }
+
+    return newResultSuccess(vm, NUMBER_VAL(handled));
+}
+
+static Value httpServerRun(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "run() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    HttpServer *server = AS_HTTP_SERVER(args[0]);
+
+    if (server->running) {
+        runtimeError(vm, "run() can not be called while the server is running");
+        return EMPTY_VAL;
+    }
+
+    if (server->listenFd == -1) {
+        runtimeError(vm, "run() can not be called on a closed server");
+        return EMPTY_VAL;
+    }
+
+    server->running = true;
+    server->stopped = false;
+
+    int handled = 0;
+
+    while (!server->stopped && handled >= 0) {
+        handled = runOnce(vm, server, -1);
+    }
+
+    server->running = false;
+
+    if (server->closePending) {
+        closeServer(vm, server);
+    }
+
+    if (handled == -2) {
+        return EMPTY_VAL;
+    }
+
+    if (handled == -1) {
+        ERROR_RESULT;
+    }
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
+static Value httpServerStop(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "stop() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    AS_HTTP_SERVER(args[0])->stopped = true;
+
+    return NIL_VAL;
+}
+
+static Value httpServerClose(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "close() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    HttpServer *server = AS_HTTP_SERVER(args[0]);
+    server->stopped = true;
+
+    // The connection being handled is still in use
+    if (server->running) {
+        server->closePending = true;
+    } else {
+        closeServer(vm, server);
+    }
+
+    return NIL_VAL;
+}
+
+static Value httpServerLen(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "len() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(AS_HTTP_SERVER(args[0])->connectionCount);
+}
+
+void freeHttpServer(DictuVM *vm, ObjAbstract *abstract) {
+    HttpServer *server = (HttpServer *)abstract->data;
+
+    closeServer(vm, server);
+    FREE_ARRAY(vm, HttpConnection *, server->connections, server->connectionCapacity);
+    FREE(vm, HttpServer, abstract->data);
+}
+
+void grayHttpServer(DictuVM *vm, ObjAbstract *abstract) {
+    HttpServer *server = (HttpServer *)abstract->data;
+
+    if (server == NULL) return;
+
+    grayValue(vm, server->handler);
+
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        if (server->keys[i] != NULL) {
+            grayObject(vm, (Obj *) server->keys[i]);
+        }
+    }
+}
+
+char *httpServerToString(ObjAbstract *abstract) {
+    UNUSED(abstract);
+
+    char *httpServerString = malloc(sizeof(char) * 13);
+    snprintf(httpServerString, 13, "<HTTPServer>");
+    return httpServerString;
+}
+
+static bool readOptions(DictuVM *vm, HttpServer *server, ObjDict *options) {
+    for (int i = 0; i <= options->capacityMask; ++i) {
+        DictItem *entry = &options->entries[i];
+
+        if (IS_EMPTY(entry->key)) {
+            continue;
+        }
+
+        if (!IS_STRING(entry->key)) {
+            runtimeError(vm, "HTTPServer options key must be a string");
+            return false;
+        }
+
+        char *key = AS_CSTRING(entry->key);
+
+        if (!IS_NUMBER(entry->value) || AS_NUMBER(entry->value) < 0) {
+            runtimeError(vm, "HTTPServer option \"%s\" value must be a positive number", key);
+            return false;
+        }
+
+        double value = AS_NUMBER(entry->value);
+
+        if (strcmp(key, "maxHeadSize") == 0) {
+            server->maxHeadSize = value;
+        } else if (strcmp(key, "maxBodySize") == 0) {
+            server->maxBodySize = value;
+        } else if (strcmp(key, "idleTimeout") == 0) {
+            server->idleTimeout = value;
+        } else {
+            runtimeError(vm, "Unknown HTTPServer option \"%s\"", key);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Returns a listening, non-blocking socket, or -1 with errno set
+static int listenOn(const char *host, const char *port, const char **error) {
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+
+    struct addrinfo *addresses;
+    int status = getaddrinfo(host, port, &hints, &addresses);
+
+    if (status != 0) {
+        *error = gai_strerror(status);
+        return -1;
+    }
+
+    int fd = socket(addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+
+    if (fd == -1) {
+        freeaddrinfo(addresses);
+        return -1;
+    }
+
+    int enable = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    if (bind(fd, addresses->ai_addr, addresses->ai_addrlen) == -1 || listen(fd, SOMAXCONN) == -1 || !setNonBlocking(fd)) {
+        int savedErrno = errno;
+        close(fd);
+        freeaddrinfo(addresses);
+        errno = savedErrno;
+        return -1;
+    }
+
+    freeaddrinfo(addresses);
+
+    return fd;
+}
+
+static int boundPort(int fd) {
+    struct sockaddr_storage address;
+    socklen_t length = sizeof(address);
+
+    if (getsockname(fd, (struct sockaddr *) &address, &length) == -1) {
+        return -1;
+    }
+
+    if (address.ss_family == AF_INET6) {
+        return ntohs(((struct sockaddr_in6 *) &address)->sin6_port);
+    }
+
+    return ntohs(((struct sockaddr_in *) &address)->sin_port);
+}
+
+static Value createServer(DictuVM *vm, int argCount, Value *args) {
+    if (argCount < 3 || argCount > 4) {
+        runtimeError(vm, "create() takes 3 or 4 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[0])) {
+        runtimeError(vm, "Host passed to create() must be a string");
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[1]) || AS_NUMBER(args[1]) < 0 || AS_NUMBER(args[1]) > 65535) {
+        runtimeError(vm, "Port passed to create() must be a number between 0 and 65535");
+        return EMPTY_VAL;
+    }
+
+    if (!IS_CLOSURE(args[2]) && !IS_FUNCTION(args[2]) && !IS_BOUND_METHOD(args[2]) && !IS_NATIVE(args[2])) {
+        runtimeError(vm, "Handler passed to create() must be a function");
+        return EMPTY_VAL;
+    }
+
+    if (argCount == 4 && !IS_DICT(args[3])) {
+        runtimeError(vm, "Options passed to create() must be a dict");
+        return EMPTY_VAL;
+    }
+
+    ObjAbstract *abstract = newAbstract(vm, freeHttpServer, httpServerToString);
+    push(vm, OBJ_VAL(abstract));
+
+    HttpServer *server = ALLOCATE(vm, HttpServer, 1);
+    server->listenFd = -1;
+    server->pollFd = -1;
+    server->handler = args[2];
+    server->connections = NULL;
+    server->connectionCapacity = 0;
+    server->connectionCount = 0;
+    server->maxHeadSize = DEFAULT_MAX_HEAD_SIZE;
+    server->maxBodySize = DEFAULT_MAX_BODY_SIZE;
+    server->idleTimeout = DEFAULT_IDLE_TIMEOUT;
+    server->lastSweep = monotonicMs();
+    server->running = false;
+    server->stopped = false;
+    server->closePending = false;
+    server->dateSecond = 0;
+
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        server->keys[i] = NULL;
+    }
+
+    abstract->data = server;
+    abstract->grayFunc = grayHttpServer;
+
+    if (argCount == 4 && !readOptions(vm, server, AS_DICT(args[3]))) {
+        pop(vm);
+        return EMPTY_VAL;
+    }
+
+    for (int i = 0; i < KEY_COUNT; ++i) {
+        server->keys[i] = copyString(vm, keyNames[i], strlen(keyNames[i]));
+    }
+
+    char port[8];
+    snprintf(port, sizeof(port), "%d", (int) AS_NUMBER(args[1]));
+
+    const char *error = NULL;
+    server->listenFd = listenOn(AS_CSTRING(args[0]), port, &error);
+
+    if (server->listenFd == -1) {
+        pop(vm);
+
+        if (error != NULL) {
+            return newResultError(vm, (char *) error);
+        }
+
+        ERROR_RESULT;
+    }
+
+#ifdef __linux__
+    server->pollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = server->listenFd;
+
+    if (server->pollFd == -1 || epoll_ctl(server->pollFd, EPOLL_CTL_ADD, server->listenFd, &event) == -1) {
+        int savedErrno = errno;
+        closeServer(vm, server);
+        pop(vm);
+        errno = savedErrno;
+
+        ERROR_RESULT;
+    }
+#endif
+
+    /**
+     * Setup HTTPServer object methods
+     */
+    defineNative(vm, &abstract->values, "run", httpServerRun);
+    defineNative(vm, &abstract->values, "runOnce", httpServerRunOnce);
+    defineNative(vm, &abstract->values, "stop", httpServerStop);
+    defineNative(vm, &abstract->values, "close", httpServerClose);
+    defineNative(vm, &abstract->values, "len", httpServerLen);
+    defineNativeProperty(vm, &abstract->values, "port", NUMBER_VAL(boundPort(server->listenFd)));
+
+    pop(vm);
+
+    return newResultSuccess(vm, OBJ_VAL(abstract));
+}
+
+Value createHTTPServerModule(DictuVM *vm) {
+    ObjString *name = copyString(vm, "HTTPServer", 10);
+    push(vm, OBJ_VAL(name));
+    ObjModule *module = newModule(vm, name);
+    push(vm, OBJ_VAL(module));
+
+    /**
+     * Define HTTPServer methods
+     */
+    defineNative(vm, &module->values, "create", createServer);
+
+    pop(vm);
+    pop(vm);
+
+    return OBJ_VAL(module);
+}
@@ -0,0 +1,9 @@
+#ifndef dictu_http_server_h
+#define dictu_http_server_h
+
+#include "optionals.h"
+#include "../vm/vm.h"
+
+Value createHTTPServerModule(DictuVM *vm);
+
+#endif //dictu_http_server_h
@@ -0,0 +1,448 @@
+#include <string.h>
+
+#include "httpParser.h"
+
+// Characters allowed in methods and header names (RFC 9110 tchar)
+static const bool tokenChars[256] = {
+    ['!'] = true, ['#'] = true, ['$'] = true, ['%'] = true, ['&'] = true, ['\''] = true,
+    ['*'] = true, ['+'] = true, ['-'] = true, ['.'] = true, ['^'] = true, ['_'] = true,
+    ['`'] = true, ['|'] = true, ['~'] = true,
+    ['0'] = true, ['1'] = true, ['2'] = true, ['3'] = true, ['4'] = true,
+    ['5'] = true, ['6'] = true, ['7'] = true, ['8'] = true, ['9'] = true,
+    ['A'] = true, ['B'] = true, ['C'] = true, ['D'] = true, ['E'] = true, ['F'] = true,
+    ['G'] = true, ['H'] = true, ['I'] = true, ['J'] = true, ['K'] = true, ['L'] = true,
+    ['M'] = true, ['N'] = true, ['O'] = true, ['P'] = true, ['Q'] = true, ['R'] = true,
+    ['S'] = true, ['T'] = true, ['U'] = true, ['V'] = true, ['W'] = true, ['X'] = true,
+    ['Y'] = true, ['Z'] = true,
+    ['a'] = true, ['b'] = true, ['c'] = true, ['d'] = true, ['e'] = true, ['f'] = true,
+    ['g'] = true, ['h'] = true, ['i'] = true, ['j'] = true, ['k'] = true, ['l'] = true,
+    ['m'] = true, ['n'] = true, ['o'] = true, ['p'] = true, ['q'] = true, ['r'] = true,
+    ['s'] = true, ['t'] = true, ['u'] = true, ['v'] = true, ['w'] = true, ['x'] = true,
+    ['y'] = true, ['z'] = true
+};
+
+int httpFindHeadEnd(const char *buffer, size_t length, size_t *scanned) {
+    size_t i = *scanned;
+
+    while (i < length) {
+        const char *newline = memchr(buffer + i, '\n', length - i);
+
+        if (newline == NULL) {
+            break;
+        }
+
+        i = newline - buffer;
+
+        // An empty line, ended by either CRLF or a bare LF
+        if ((i >= 1 && buffer[i - 1] == '\n') || (i >= 2 && buffer[i - 1] == '\r' && buffer[i - 2] == '\n')) {
+            return i + 1;
+        }
+
+        i++;
+    }
+
+    *scanned = length;
+
+    return -1;
+}
+
+static bool equalsIgnoreCase(const char *chars, int length, const char *lower) {
+    int i = 0;
+
+    for (; i < length && lower[i] != '\0'; ++i) {
+        char c = chars[i];
+
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+
+        if (c != lower[i]) {
+            return false;
+        }
+    }
+
+    return i == length && lower[i] == '\0';
+}
+
+static bool isLineEnd(const char *buffer, int position, int length) {
+    return position < length && (buffer[position] == '\n' || (buffer[position] == '\r' && position + 1 < length && buffer[position + 1] == '\n'));
+}
+
+static int skipLineEnd(const char *buffer, int position) {
+    return buffer[position] == '\r' ? position + 2 : position + 1;
+}
+
+// Connection holds a comma separated list of options
+static void parseConnection(const char *value, int length, HttpRequestHead *head) {
+    int start = 0;
+
+    while (start < length) {
+        int end = start;
+
+        while (end < length && value[end] != ',') {
+            end++;
+        }
+
+        int tokenEnd = end;
+
+        while (start < tokenEnd && (value[start] == ' ' || value[start] == '\t')) start++;
+        while (tokenEnd > start && (value[tokenEnd - 1] == ' ' || value[tokenEnd - 1] == '\t')) tokenEnd--;
+
+        if (equalsIgnoreCase(value + start, tokenEnd - start, "close")) {
+            head->keepAlive = false;
+        } else if (equalsIgnoreCase(value + start, tokenEnd - start, "keep-alive")) {
+            head->keepAlive = true;
+        }
+
+        start = end + 1;
+    }
+}
+
+static HttpParseStatus parseFramingHeader(const char *buffer, HttpSlice name, HttpSlice value, HttpRequestHead *head) {
+    const char *nameChars = buffer + name.start;
+    const char *valueChars = buffer + value.start;
+
+    switch (name.length) {
+        case 6: {
+            if (equalsIgnoreCase(nameChars, name.length, "expect")) {
+                head->expectContinue = equalsIgnoreCase(valueChars, value.length, "100-continue");
+            }
+
+            break;
+        }
+
+        case 10: {
+            if (equalsIgnoreCase(nameChars, name.length, "connection")) {
+                parseConnection(valueChars, value.length, head);
+            }
+
+            break;
+        }
+
+        case 14: {
+            if (!equalsIgnoreCase(nameChars, name.length, "content-length")) {
+                break;
+            }
+
+            if (value.length == 0 || value.length > 18) {
+                return HTTP_PARSE_INVALID;
+            }
+
+            int64_t contentLength = 0;
+
+            for (int i = 0; i < value.length; ++i) {
+                if (valueChars[i] < '0' || valueChars[i] > '9') {
+                    return HTTP_PARSE_INVALID;
+                }
+
+                contentLength = contentLength * 10 + (valueChars[i] - '0');
+            }
+
+            // Repeating the header is allowed, disagreeing with it is not
+            if (head->contentLength != -1 && head->contentLength != contentLength) {
+                return HTTP_PARSE_INVALID;
+            }
+
+            head->contentLength = contentLength;
+            break;
+        }
+
+        case 17: {
+            if (!equalsIgnoreCase(nameChars, name.length, "transfer-encoding")) {
+                break;
+            }
+
+            // Chunked is the only coding a request body may arrive in here
+            if (!equalsIgnoreCase(valueChars, value.length, "chunked")) {
+                return HTTP_PARSE_UNSUPPORTED;
+            }
+
+            head->chunked = true;
+            break;
+        }
+    }
+
+    return HTTP_PARSE_OK;
+}
+
+HttpParseStatus httpParseHead(const char *buffer, int length, HttpRequestHead *head) {
+    int position = 0;
+
+    head->headerCount = 0;
+    head->length = length;
+    head->contentLength = -1;
+    head->chunked = false;
+    head->expectContinue = false;
+
+    // Request line: method SP target SP HTTP/1.x
+    head->method.start = position;
+    while (position < length && tokenChars[(unsigned char) buffer[position]]) {
+        position++;
+    }
+
+    head->method.length = position - head->method.start;
+
+    if (head->method.length == 0 || position >= length || buffer[position] != ' ') {
+        return HTTP_PARSE_INVALID;
+    }
+
+    head->target.start = ++position;
+    while (position < length && (unsigned char) buffer[position] > ' ' && buffer[position] != 0x7f) {
+        position++;
+    }
+
+    head->target.length = position - head->target.start;
+
+    if (head->target.length == 0 || position >= length || buffer[position] != ' ') {
+        return HTTP_PARSE_INVALID;
+    }
+
+    position++;
+
+    if (length - position < 8 || memcmp(buffer + position, "HTTP/", 5) != 0) {
+        return HTTP_PARSE_INVALID;
+    }
+
+    char major = buffer[position + 5];
+    char minor = buffer[position + 7];
+
+    if (major < '0' || major > '9' || buffer[position + 6] != '.' || minor < '0' || minor > '9') {
+        return HTTP_PARSE_INVALID;
+    }
+
+    if (major != '1') {
+        return HTTP_PARSE_UNSUPPORTED;
+    }
+
+    head->minorVersion = minor - '0';
+    head->keepAlive = head->minorVersion >= 1;
+    position += 8;
+
+    if (!isLineEnd(buffer, position, length)) {
+        return HTTP_PARSE_INVALID;
+    }
+
+    position = skipLineEnd(buffer, position);
+
+    while (!isLineEnd(buffer, position, length)) {
+        if (head->headerCount == HTTP_MAX_HEADERS) {
+            return HTTP_PARSE_TOO_MANY_HEADERS;
+        }
+
+        HttpSlice name = {position, 0};
+
+        while (position < length && tokenChars[(unsigned char) buffer[position]]) {
+            position++;
+        }
+
+        name.length = position - name.start;
+
+        // Also rejects folded lines, which start with whitespace
+        if (name.length == 0 || position >= length || buffer[position] != ':') {
+            return HTTP_PARSE_INVALID;
+        }
+
+        position++;
+
+        while (position < length && (buffer[position] == ' ' || buffer[position] == '\t')) {
+            position++;
+        }
+
+        HttpSlice value = {position, 0};
+
+        while (position < length && buffer[position] != '\r' && buffer[position] != '\n') {
+            unsigned char c = buffer[position];
+
+            if ((c < ' ' && c != '\t') || c == 0x7f) {
+                return HTTP_PARSE_INVALID;
+            }
+
+            position++;
+        }
+
+        if (!isLineEnd(buffer, position, length)) {
+            return HTTP_PARSE_INVALID;
+        }
+
+        int valueEnd = position;
+
+        while (valueEnd > value.start && (buffer[valueEnd - 1] == ' ' || buffer[valueEnd - 1] == '\t')) {
+            valueEnd--;
+        }
+
+        value.length = valueEnd - value.start;
+
+        HttpParseStatus status = parseFramingHeader(buffer, name, value, head);
+
+        if (status != HTTP_PARSE_OK) {
+            return status;
+        }
+
+        head->headerNames[head->headerCount] = name;
+        head->headerValues[head->headerCount] = value;
+        head->headerCount++;
+
+        position = skipLineEnd(buffer, position);
+    }
+
+    // A body framed both ways is how requests get smuggled past proxies
+    if (head->chunked && head->contentLength != -1) {
+        return HTTP_PARSE_INVALID;
+    }
+
+    return HTTP_PARSE_OK;
+}
+
+typedef enum {
+    CHUNK_SIZE_START,
+    CHUNK_SIZE,
+    CHUNK_EXTENSION,
+    CHUNK_SIZE_LF,
+    CHUNK_DATA,
+    CHUNK_DATA_END,
+    CHUNK_DATA_LF,
+    CHUNK_TRAILER_START,
+    CHUNK_TRAILER,
+    CHUNK_FINAL_LF
+} ChunkState;
+
+void initHttpChunkedDecoder(HttpChunkedDecoder *decoder) {
+    decoder->state = CHUNK_SIZE_START;
+    decoder->remaining = 0;
+    decoder->consumed = 0;
+    decoder->decoded = 0;
+    decoder->done = false;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+    return -1;
+}
+
+static void endSizeLine(HttpChunkedDecoder *decoder) {
+    decoder->state = decoder->remaining == 0 ? CHUNK_TRAILER_START : CHUNK_DATA;
+}
+
+bool httpDecodeChunked(HttpChunkedDecoder *decoder, char *body, size_t length, size_t limit) {
+    while (!decoder->done && decoder->consumed < length) {
+        if (decoder->state == CHUNK_DATA) {
+            size_t available = length - decoder->consumed;
+            size_t count = (int64_t) available < decoder->remaining ? available : (size_t) decoder->remaining;
+
+            // Always moves down, the framing before this data has been skipped
+            memmove(body + decoder->decoded, body + decoder->consumed, count);
+            decoder->decoded += count;
+            decoder->consumed += count;
+            decoder->remaining -= count;
+
+            if (decoder->remaining == 0) {
+                decoder->state = CHUNK_DATA_END;
+            }
+
+            continue;
+        }
+
+        char c = body[decoder->consumed++];
+
+        switch (decoder->state) {
+            case CHUNK_SIZE_START:
+            case CHUNK_SIZE: {
+                int digit = hexValue(c);
+
+                if (digit != -1) {
+                    decoder->remaining = decoder->remaining * 16 + digit;
+                    decoder->state = CHUNK_SIZE;
+
+                    if (decoder->decoded + decoder->remaining > limit) {
+                        return false;
+                    }
+                } else if (decoder->state == CHUNK_SIZE_START) {
+                    return false;
+                } else if (c == ';' || c == ' ' || c == '\t') {
+                    decoder->state = CHUNK_EXTENSION;
+                } else if (c == '\r') {
+                    decoder->state = CHUNK_SIZE_LF;
+                } else if (c == '\n') {
+                    endSizeLine(decoder);
+                } else {
+                    return false;
+                }
+
+                break;
+            }
+
+            case CHUNK_EXTENSION: {
+                if (c == '\n') {
+                    endSizeLine(decoder);
+                }
+
+                break;
+            }
+
+            case CHUNK_SIZE_LF: {
+                if (c != '\n') {
+                    return false;
+                }
+
+                endSizeLine(decoder);
+                break;
+            }
+
+            case CHUNK_DATA_END: {
+                if (c == '\r') {
+                    decoder->state = CHUNK_DATA_LF;
+                } else if (c == '\n') {
+                    decoder->state = CHUNK_SIZE_START;
+                } else {
+                    return false;
+                }
+
+                break;
+            }
+
+            case CHUNK_DATA_LF: {
+                if (c != '\n') {
+                    return false;
+                }
+
+                decoder->state = CHUNK_SIZE_START;
+                break;
+            }
+
+            // Trailer fields are read past and dropped
+            case CHUNK_TRAILER_START: {
+                if (c == '\r') {
+                    decoder->state = CHUNK_FINAL_LF;
+                } else if (c == '\n') {
+                    decoder->done = true;
+                } else {
+                    decoder->state = CHUNK_TRAILER;
+                }
+
+                break;
+            }
+
+            case CHUNK_TRAILER: {
+                if (c == '\n') {
+                    decoder->state = CHUNK_TRAILER_START;
+                }
+
+                break;
+            }
+
+            case CHUNK_FINAL_LF: {
+                if (c != '\n') {
+                    return false;
+                }
+
+                decoder->done = true;
+                break;
+            }
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef dictu_http_parser_h
+#define dictu_http_parser_h
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Parses HTTP/1.x request heads where they sit in the connection's read
+ * buffer. Nothing is copied: the method, target and every header name and
+ * value are recorded as an offset and length into the buffer, so they stay
+ * valid however the buffer is grown or moved until the request is consumed.
+ */
+#define HTTP_MAX_HEADERS 64
+
+typedef struct {
+    int start;
+    int length;
+} HttpSlice;
+
+typedef struct {
+    HttpSlice method;
+    HttpSlice target;
+    // The x of HTTP/1.x
+    int minorVersion;
+    HttpSlice headerNames[HTTP_MAX_HEADERS];
+    HttpSlice headerValues[HTTP_MAX_HEADERS];
+    int headerCount;
+    // Bytes up to and including the blank line ending the head
+    int length;
+    // -1 if there is no Content-Length header
+    int64_t contentLength;
+    bool chunked;
+    bool keepAlive;
+    bool expectContinue;
+} HttpRequestHead;
+
+typedef enum {
+    HTTP_PARSE_OK,
+    HTTP_PARSE_INVALID,
+    HTTP_PARSE_TOO_MANY_HEADERS,
+    // A transfer coding or HTTP version this parser does not implement
+    HTTP_PARSE_UNSUPPORTED
+} HttpParseStatus;
+
+// Returns the length of the head if the buffer holds all of it, or -1 with
+// scanned updated so the next call carries on where this one stopped
+int httpFindHeadEnd(const char *buffer, size_t length, size_t *scanned);
+
+HttpParseStatus httpParseHead(const char *buffer, int length, HttpRequestHead *head);
+
+/**
+ * Decodes a chunked body in place, moving the data of each chunk down over
+ * the framing so the decoded body ends up contiguous at the start of the
+ * body. Bytes may arrive split anywhere, each call picks up from the last.
+ */
+typedef struct {
+    int state;
+    // Bytes left in the current chunk, or its size while the size is read
+    int64_t remaining;
+    // Raw bytes consumed from the start of the body
+    size_t consumed;
+    // Decoded bytes at the start of the body
+    size_t decoded;
+    bool done;
+} HttpChunkedDecoder;
+
+void initHttpChunkedDecoder(HttpChunkedDecoder *decoder);
+
+// Returns false if the body is not validly chunked, or would decode to more than limit bytes
+bool httpDecodeChunked(HttpChunkedDecoder *decoder, char *body, size_t length, size_t limit);
+
+#endif //dictu_http_parser_h
@@ -6,6 +6,7 @@
 #include <copyfile.h>
 #elif defined(__linux__)
 #include <sys/sendfile.h>
+#include <sys/syscall.h>
 #endif
 
 #include "io.h"
@@ -66,6 +67,8 @@ static Value printErrlnIO(DictuVM *vm, int argCount, Value *args) {
     return NIL_VAL;
 }
 
+#define COPY_BUFFER_SIZE 65536
+
 #ifdef _WIN32
 static Value copyFileIO(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 2) {
@@ -81,31 +84,139 @@ static Value copyFileIO(DictuVM *vm, int argCount, Value *args) {
     char *srcFile = AS_CSTRING(args[0]);
     char *dstFile = AS_CSTRING(args[1]);
 
-    FILE *sf = fopen(srcFile, "r");
+    FILE *sf = fopen(srcFile, "rb");
     if (sf == NULL) {
         return newResultError(vm, "cannot open src file");
     }
 
-    FILE *df = fopen(dstFile, "w");
+    FILE *df = fopen(dstFile, "wb");
     if (df == NULL) {
         fclose(sf);
         return newResultError(vm, "cannot open dst file");
     }
 
-    int buffer = fgetc(sf);
-    while (buffer != EOF) {
-        fputc(buffer, df);
-        buffer = fgetc(sf);
+    char buffer[COPY_BUFFER_SIZE];
+    size_t bytes;
+    bool failed = false;
+
+    while ((bytes = fread(buffer, 1, sizeof(buffer), sf)) > 0) {
+        if (fwrite(buffer, 1, bytes, df) != bytes) {
+            failed = true;
+            break;
+        }
     }
 
+    failed = failed || ferror(sf);
+
     fclose(sf);
-    fclose(df);
+    if (fclose(df) != 0) {
+        failed = true;
+    }
+
+    if (failed) {
+        return newResultError(vm, "failed to copy file");
+    }
 
     return newResultSuccess(vm, NIL_VAL);
 }
 #endif
 
 #ifndef _WIN32
+// Copies what is left of in through a buffer, for when the kernel can not do
+// the copy itself
+static bool copyFileBuffered(int in, int out) {
+    char buffer[COPY_BUFFER_SIZE];
+    ssize_t bytes;
+
+    while ((bytes = read(in, buffer, sizeof(buffer))) != 0) {
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        for (ssize_t written = 0; written < bytes;) {
+            ssize_t wrote = write(out, buffer + written, bytes - written);
+
+            if (wrote == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+
+                return false;
+            }
+
+            written += wrote;
+        }
+    }
+
+    return true;
+}
+
+#ifdef __linux__
+// copy_file_range() and sendfile() both move the data inside the kernel, and
+// copy_file_range() can share extents or copy server side where the file
+// system supports it. Each falls back to the next when the files are on
+// different file systems, or the file system or kernel can not do the copy.
+// All three go through the file offsets, so a copy can pick up where the
+// previous one stopped.
+static bool copyFileContents(int in, int out, off_t size) {
+    off_t copied = 0;
+
+#ifdef SYS_copy_file_range
+    while (copied < size) {
+        ssize_t bytes = syscall(SYS_copy_file_range, in, NULL, out, NULL, (size_t) (size - copied), 0);
+
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP || errno == EBADF) {
+                break;
+            }
+
+            return false;
+        }
+
+        // The file was shorter than it was when it was opened
+        if (bytes == 0) {
+            return true;
+        }
+
+        copied += bytes;
+    }
+#endif
+
+    while (copied < size) {
+        ssize_t bytes = sendfile(out, in, NULL, size - copied);
+
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EINVAL || errno == ENOSYS) {
+                break;
+            }
+
+            return false;
+        }
+
+        if (bytes == 0) {
+            return true;
+        }
+
+        copied += bytes;
+    }
+
+    // Files that report no size, such as those under /proc, are read to the end
+    return copyFileBuffered(in, out);
+}
+#endif
+
 static Value copyFileIO(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 2) {
         runtimeError(vm, "copyFile() takes 2 arguments (%d given)", argCount);
@@ -132,15 +243,25 @@ static Value copyFileIO(DictuVM *vm, int argCount, Value *args) {
     }
 
 #if defined(__APPLE__) || defined(__FreeBSD__)
-    fcopyfile(in, out, 0, COPYFILE_ALL);
+    bool copied = fcopyfile(in, out, 0, COPYFILE_ALL) == 0;
 #elif defined(__linux__)
-    off_t bytes = 0;
     struct stat fileinfo = {0};
-    fstat(in, &fileinfo);
-    sendfile(out, in, &bytes, fileinfo.st_size);
+    bool copied = fstat(in, &fileinfo) == 0 && copyFileContents(in, out, fileinfo.st_size);
+#else
+    bool copied = copyFileBuffered(in, out);
 #endif
+    int error = errno;
+
     close(in);
-    close(out);
+    if (close(out) == -1 && copied) {
+        copied = false;
+        error = errno;
+    }
+
+    if (!copied) {
+        errno = error;
+        ERROR_RESULT;
+    }
 
     return newResultSuccess(vm, NIL_VAL);
 }
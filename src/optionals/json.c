@@ -1,174 +1,168 @@
 #include "json.h"
 
-static Value parseJson(DictuVM *vm, json_value *json) {
-    switch (json->type) {
-        case json_none:
-        case json_null: {
-            return NIL_VAL;
-        }
+static Value parse(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "parse() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
 
-        case json_object: {
-            ObjDict *dict = newDict(vm);
-            // Push value to stack to avoid GC
-            push(vm, OBJ_VAL(dict));
+    if (!IS_STRING(args[0])) {
+        runtimeError(vm, "parse() argument must be a string.");
+        return EMPTY_VAL;
+    }
 
-            for (unsigned int i = 0; i < json->u.object.length; i++) {
-                Value val = parseJson(vm, json->u.object.values[i].value);
-                push(vm, val);
-                Value key = OBJ_VAL(copyString(vm, json->u.object.values[i].name, json->u.object.values[i].name_length));
-                push(vm, key);
-                dictSet(vm, dict, key, val);
-                pop(vm);
-                pop(vm);
-            }
+    ObjString *json = AS_STRING(args[0]);
+    char error[JSON_ERROR_SIZE];
+    Value value = jsonDecode(vm, json->chars, json->length, error);
 
-            pop(vm);
+    if (value == EMPTY_VAL) {
+        return newResultError(vm, error);
+    }
 
-            return OBJ_VAL(dict);
-        }
+    push(vm, value);
+    Value result = newResultSuccess(vm, value);
+    pop(vm);
 
-        case json_array: {
-            ObjList *list = newList(vm);
-            // Push value to stack to avoid GC
-            push(vm, OBJ_VAL(list));
+    return result;
+}
 
-            for (unsigned int i = 0; i < json->u.array.length; i++) {
-                Value val = parseJson(vm, json->u.array.values[i]);
-                push(vm, val);
-                writeValueArray(vm, &list->values, val);
-                pop(vm);
-            }
+#define AS_JSON_STREAM(v) ((JsonStream*)AS_ABSTRACT(v)->data)
 
-            // Pop list
-            pop(vm);
+static Value decoderFeed(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "feed() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
 
-            return OBJ_VAL(list);
-        }
+    if (!IS_STRING(args[1])) {
+        runtimeError(vm, "feed() argument must be a string.");
+        return EMPTY_VAL;
+    }
 
-        case json_integer: {
-            return NUMBER_VAL(json->u.integer);
-        }
+    JsonStream *stream = AS_JSON_STREAM(args[0]);
 
-        case json_double: {
-            return NUMBER_VAL(json->u.dbl);
-        }
+    if (stream->finished) {
+        runtimeError(vm, "feed() called after finish().");
+        return EMPTY_VAL;
+    }
+
+    ObjString *chunk = AS_STRING(args[1]);
+    jsonStreamAppend(vm, stream, chunk->chars, chunk->length);
+
+    return NIL_VAL;
+}
+
+static Value decoderNext(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "next() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    JsonStream *stream = AS_JSON_STREAM(args[0]);
+    const char *start;
+    int length;
 
-        case json_string: {
-            return OBJ_VAL(copyString(vm, json->u.string.ptr, json->u.string.length));
+    switch (jsonStreamNext(stream, &start, &length)) {
+        case JSON_STREAM_PENDING: {
+            return NIL_VAL;
         }
 
-        case json_boolean: {
-            return BOOL_VAL(json->u.boolean);
+        case JSON_STREAM_TRUNCATED: {
+            return newResultError(vm, "Invalid JSON object: unexpected end of input");
         }
 
-        default: {
-            return EMPTY_VAL;
+        case JSON_STREAM_RECORD: {
+            break;
         }
     }
-}
 
-static Value parse(DictuVM *vm, int argCount, Value *args) {
-    if (argCount != 1) {
-        runtimeError(vm, "parse() takes 1 argument (%d given)", argCount);
-        return EMPTY_VAL;
+    char error[JSON_ERROR_SIZE];
+    Value value = jsonDecode(vm, start, length, error);
+
+    if (value == EMPTY_VAL) {
+        return newResultError(vm, error);
     }
 
-    if (!IS_STRING(args[0])) {
-        runtimeError(vm, "parse() argument must be a string.");
+    push(vm, value);
+    Value result = newResultSuccess(vm, value);
+    pop(vm);
+
+    return result;
+}
+
+static Value decoderFinish(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "finish() takes no arguments (%d given)", argCount);
         return EMPTY_VAL;
     }
 
-    ObjString *json = AS_STRING(args[0]);
-    json_value *json_obj = json_parse(json->chars, json->length);
+    AS_JSON_STREAM(args[0])->finished = true;
 
-    if (json_obj == NULL) {
-        return newResultError(vm, "Invalid JSON object");
-    }
+    return NIL_VAL;
+}
+
+void freeJsonDecoder(DictuVM *vm, ObjAbstract *abstract) {
+    JsonStream *stream = abstract->data;
+
+    freeJsonStream(vm, stream);
+    FREE(vm, JsonStream, stream);
+}
 
-    Value val = parseJson(vm, json_obj);
+char *jsonDecoderToString(ObjAbstract *abstract) {
+    UNUSED(abstract);
 
-    if (val == EMPTY_VAL) {
-        return newResultError(vm, "Invalid JSON object");
+    char *decoderString = malloc(sizeof(char) * 14);
+    snprintf(decoderString, 14, "<JSONDecoder>");
+    return decoderString;
+}
+
+static Value newDecoder(DictuVM *vm, int argCount, Value *args) {
+    UNUSED(args);
+
+    if (argCount != 0) {
+        runtimeError(vm, "decoder() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
     }
 
-    json_value_free(json_obj);
+    ObjAbstract *abstract = newAbstract(vm, freeJsonDecoder, jsonDecoderToString);
+    push(vm, OBJ_VAL(abstract));
+
+    JsonStream *stream = ALLOCATE(vm, JsonStream, 1);
+    initJsonStream(stream);
+
+    /**
+     * Setup JSONDecoder object methods
+     */
+    defineNative(vm, &abstract->values, "feed", decoderFeed);
+    defineNative(vm, &abstract->values, "next", decoderNext);
+    defineNative(vm, &abstract->values, "finish", decoderFinish);
+
+    abstract->data = stream;
+    pop(vm);
 
-    return newResultSuccess(vm, val);
+    return OBJ_VAL(abstract);
 }
 
-json_value* stringifyJson(DictuVM *vm, Value value) {
-    if (IS_NIL(value)) {
-        return json_null_new();
-    } else if (IS_BOOL(value)) {
-        return json_boolean_new(AS_BOOL(value));
-    } else if (IS_NUMBER(value)) {
-        double num = AS_NUMBER(value);
+// Reads the optional indent argument, -1 meaning a single line
+static bool getIndent(DictuVM *vm, const char *name, int argCount, Value *args, int position, int *indent) {
+    *indent = -1;
 
-        if ((int) num == num) {
-            return json_integer_new((int) num);
-        }
+    if (argCount <= position) {
+        return true;
+    }
 
-        return json_double_new(num);
-    } else if (IS_OBJ(value)) {
-        switch (AS_OBJ(value)->type) {
-            case OBJ_STRING: {
-                return json_string_new(AS_CSTRING(value));
-            }
-
-            case OBJ_LIST: {
-                ObjList *list = AS_LIST(value);
-                json_value *json = json_array_new(list->values.count);
-
-                for (int i = 0; i < list->values.count; i++) {
-                    json_array_push(json, stringifyJson(vm, list->values.values[i]));
-                }
-
-                return json;
-            }
-
-            case OBJ_DICT: {
-                ObjDict *dict = AS_DICT(value);
-                json_value *json = json_object_new(dict->count);
-
-                for (int i = 0; i <= dict->capacityMask; i++) {
-                    DictItem *entry = &dict->entries[i];
-                    if (IS_EMPTY(entry->key)) {
-                        continue;
-                    }
-
-                    char *key;
-
-                    if (IS_STRING(entry->key)) {
-                        ObjString *s = AS_STRING(entry->key);
-                        key = s->chars;
-                    } else if (IS_NIL(entry->key)) {
-                        key = malloc(5);
-                        memcpy(key, "null", 4);
-                        key[4] = '\0';
-                    } else {
-                        key = valueToString(entry->key);
-                    }
-
-                    json_object_push(
-                        json,
-                        key,
-                        stringifyJson(vm, entry->value)
-                    );
-
-                    if (!IS_STRING(entry->key)) {
-                        free(key);
-                    }
-                }
-
-                return json;
-            }
-
-            // Pass through and return NULL
-            default: {}
-        }
+    if (!IS_NUMBER(args[position])) {
+        runtimeError(vm, "%s() %s argument must be a number.", name, position == 1 ? "second" : "third");
+        return false;
+    }
+
+    *indent = AS_NUMBER(args[position]);
+
+    if (*indent < 0) {
+        *indent = 0;
     }
 
-    return NULL;
+    return true;
 }
 
 Value stringify(DictuVM *vm, int argCount, Value *args) {
@@ -177,48 +171,84 @@ Value stringify(DictuVM *vm, int argCount, Value *args) {
         return EMPTY_VAL;
     }
 
-    int indent = 4;
-    int lineType = json_serialize_mode_single_line;
+    int indent;
 
-    if (argCount == 2) {
-        if (!IS_NUMBER(args[1])) {
-            runtimeError(vm, "stringify() second argument must be a number.");
-            return EMPTY_VAL;
-        }
+    if (!getIndent(vm, "stringify", argCount, args, 1, &indent)) {
+        return EMPTY_VAL;
+    }
+
+    JsonEncoder encoder;
+    initJsonEncoder(vm, &encoder, indent);
 
-        lineType = json_serialize_mode_multiline;
-        indent = AS_NUMBER(args[1]);
+    if (!jsonEncode(&encoder, args[0])) {
+        freeJsonEncoder(&encoder);
+        return newResultError(vm, (char *) encoder.error);
     }
 
-    json_value *json = stringifyJson(vm, args[0]);
+    ObjString *string = jsonEncoderTakeString(&encoder);
+    push(vm, OBJ_VAL(string));
+    Value result = newResultSuccess(vm, OBJ_VAL(string));
+    pop(vm);
+
+    return result;
+}
+
+static bool writeToFile(JsonEncoder *encoder) {
+    FILE *file = encoder->sinkData;
+
+    return fwrite(encoder->buffer, 1, encoder->length, file) == encoder->length;
+}
+
+static bool writeToSocket(JsonEncoder *encoder) {
+    return socketSendAll(encoder->sinkData, encoder->buffer, encoder->length);
+}
 
-    if (json == NULL) {
-        return newResultError(vm, "Object is not serializable");
+static Value dump(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 2 && argCount != 3) {
+        runtimeError(vm, "dump() takes 2 or 3 arguments (%d given).", argCount);
+        return EMPTY_VAL;
     }
 
-    json_serialize_opts default_opts =
-    {
-        lineType,
-        json_serialize_opt_pack_brackets,
-        indent
-    };
+    int indent;
 
+    if (!getIndent(vm, "dump", argCount, args, 2, &indent)) {
+        return EMPTY_VAL;
+    }
+
+    JsonEncoder encoder;
+    initJsonEncoder(vm, &encoder, indent);
 
-    int length = json_measure_ex(json, default_opts);
-    char *buf = ALLOCATE(vm, char, length);
-    json_serialize_ex(buf, json, default_opts);
-    int actualLength = strlen(buf);
+    if (IS_FILE(args[1])) {
+        ObjFile *file = AS_FILE(args[1]);
+
+        if (strcmp(file->openType, "r") == 0 || strcmp(file->openType, "rb") == 0) {
+            runtimeError(vm, "File is not writable!");
+            return EMPTY_VAL;
+        }
 
-    // json_measure_ex can produce a length larger than the actual string returned
-    // so we need to cater for this case
-    if (actualLength != length) {
-        buf = SHRINK_ARRAY(vm, buf, char, length, actualLength + 1);
+        file->used = true;
+        encoder.sink = writeToFile;
+        encoder.sinkData = file->file;
+    } else if (IS_SOCKET(args[1])) {
+        encoder.sink = writeToSocket;
+        encoder.sinkData = AS_SOCKET(args[1]);
+    } else {
+        runtimeError(vm, "dump() second argument must be a file or a socket.");
+        return EMPTY_VAL;
     }
 
-    ObjString *string = takeString(vm, buf, actualLength);
-    json_builder_free(json);
+    bool encoded = jsonEncode(&encoder, args[0]) && jsonEncoderFlush(&encoder);
+    freeJsonEncoder(&encoder);
+
+    if (IS_FILE(args[1])) {
+        fflush(AS_FILE(args[1])->file);
+    }
+
+    if (!encoded) {
+        return newResultError(vm, (char *) encoder.error);
+    }
 
-    return newResultSuccess(vm, OBJ_VAL(string));
+    return newResultSuccess(vm, NUMBER_VAL(encoder.written));
 }
 
 Value createJSONModule(DictuVM *vm) {
@@ -232,6 +262,8 @@ Value createJSONModule(DictuVM *vm) {
      */
     defineNative(vm, &module->values, "parse", parse);
     defineNative(vm, &module->values, "stringify", stringify);
+    defineNative(vm, &module->values, "dump", dump);
+    defineNative(vm, &module->values, "decoder", newDecoder);
 
     pop(vm);
     pop(vm);
@@ -1,8 +1,9 @@
 #ifndef dictu_json_h
 #define dictu_json_h
 
-#include "json/jsonParseLib.h"
-#include "json/jsonBuilderLib.h"
+#include "json/jsonDecoder.h"
+#include "json/jsonEncoder.h"
+#include "socket.h"
 #include "optionals.h"
 #include "../vm/vm.h"
 
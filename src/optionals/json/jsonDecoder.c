@@ -0,0 +1,647 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsonDecoder.h"
+#include "../../vm/memory.h"
+
+typedef struct {
+    DictuVM *vm;
+    const char *start;
+    const char *current;
+    const char *end;
+    int depth;
+    char *error;
+    // Strings with escapes are decoded into here before being interned
+    char *scratch;
+    int scratchCapacity;
+} JsonParser;
+
+static bool fail(JsonParser *parser, const char *reason) {
+    snprintf(parser->error, JSON_ERROR_SIZE, "Invalid JSON object: %s at offset %d",
+             reason, (int) (parser->current - parser->start));
+
+    return false;
+}
+
+static void skipWhitespace(JsonParser *parser) {
+    while (parser->current < parser->end) {
+        char c = *parser->current;
+
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+            return;
+        }
+
+        parser->current++;
+    }
+}
+
+static bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool matchLiteral(JsonParser *parser, const char *literal, int length) {
+    if (parser->end - parser->current < length || memcmp(parser->current, literal, length) != 0) {
+        return fail(parser, "unexpected character");
+    }
+
+    parser->current += length;
+    return true;
+}
+
+static bool parseNumber(JsonParser *parser, Value *value) {
+    const char *start = parser->current;
+    const char *current = start;
+    bool integer = true;
+
+    if (current < parser->end && *current == '-') {
+        current++;
+    }
+
+    if (current >= parser->end || !isDigit(*current)) {
+        return fail(parser, "unexpected character");
+    }
+
+    // No leading zeros
+    if (*current == '0') {
+        current++;
+    } else {
+        while (current < parser->end && isDigit(*current)) {
+            current++;
+        }
+    }
+
+    if (current < parser->end && *current == '.') {
+        integer = false;
+        current++;
+
+        if (current >= parser->end || !isDigit(*current)) {
+            parser->current = current;
+            return fail(parser, "expected a digit");
+        }
+
+        while (current < parser->end && isDigit(*current)) {
+            current++;
+        }
+    }
+
+    if (current < parser->end && (*current == 'e' || *current == 'E')) {
+        integer = false;
+        current++;
+
+        if (current < parser->end && (*current == '+' || *current == '-')) {
+            current++;
+        }
+
+        if (current >= parser->end || !isDigit(*current)) {
+            parser->current = current;
+            return fail(parser, "expected a digit");
+        }
+
+        while (current < parser->end && isDigit(*current)) {
+            current++;
+        }
+    }
+
+    parser->current = current;
+
+    // Short integers are exact when summed up as doubles, which is much
+    // cheaper than going through strtod
+    int digits = (int) (current - start) - (*start == '-');
+    if (integer && digits <= 15) {
+        double number = 0;
+
+        for (const char *c = start + (*start == '-'); c < current; c++) {
+            number = number * 10 + (*c - '0');
+        }
+
+        *value = NUMBER_VAL(*start == '-' ? -number : number);
+        return true;
+    }
+
+    // strtod needs the number terminated, which the end of a record may not be
+    char buffer[64];
+    int length = (int) (current - start);
+
+    if (length < (int) sizeof(buffer)) {
+        memcpy(buffer, start, length);
+        buffer[length] = '\0';
+        *value = NUMBER_VAL(strtod(buffer, NULL));
+        return true;
+    }
+
+    char *copy = malloc(length + 1);
+    memcpy(copy, start, length);
+    copy[length] = '\0';
+    *value = NUMBER_VAL(strtod(copy, NULL));
+    free(copy);
+
+    return true;
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+
+    return -1;
+}
+
+static bool readHex4(JsonParser *parser, const char *at, int *codepoint) {
+    if (parser->end - at < 4) {
+        return false;
+    }
+
+    *codepoint = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        int digit = hexDigit(at[i]);
+
+        if (digit == -1) {
+            return false;
+        }
+
+        *codepoint = *codepoint * 16 + digit;
+    }
+
+    return true;
+}
+
+static int encodeUtf8(char *out, int codepoint) {
+    if (codepoint < 0x80) {
+        out[0] = (char) codepoint;
+        return 1;
+    }
+
+    if (codepoint < 0x800) {
+        out[0] = (char) (0xC0 | (codepoint >> 6));
+        out[1] = (char) (0x80 | (codepoint & 0x3F));
+        return 2;
+    }
+
+    if (codepoint < 0x10000) {
+        out[0] = (char) (0xE0 | (codepoint >> 12));
+        out[1] = (char) (0x80 | ((codepoint >> 6) & 0x3F));
+        out[2] = (char) (0x80 | (codepoint & 0x3F));
+        return 3;
+    }
+
+    out[0] = (char) (0xF0 | (codepoint >> 18));
+    out[1] = (char) (0x80 | ((codepoint >> 12) & 0x3F));
+    out[2] = (char) (0x80 | ((codepoint >> 6) & 0x3F));
+    out[3] = (char) (0x80 | (codepoint & 0x3F));
+    return 4;
+}
+
+// Decodes the escapes of a string whose closing quote is at end
+static bool unescapeString(JsonParser *parser, const char *end, int *length) {
+    // Escapes only ever shrink, so the raw length is always enough
+    int needed = (int) (end - parser->current);
+    if (needed > parser->scratchCapacity) {
+        parser->scratchCapacity = needed < 64 ? 64 : needed;
+        parser->scratch = realloc(parser->scratch, parser->scratchCapacity);
+    }
+
+    char *out = parser->scratch;
+
+    while (parser->current < end) {
+        char c = *parser->current;
+
+        if (c != '\\') {
+            *out++ = c;
+            parser->current++;
+            continue;
+        }
+
+        char escape = parser->current[1];
+        parser->current += 2;
+
+        switch (escape) {
+            case '"': *out++ = '"'; break;
+            case '\\': *out++ = '\\'; break;
+            case '/': *out++ = '/'; break;
+            case 'b': *out++ = '\b'; break;
+            case 'f': *out++ = '\f'; break;
+            case 'n': *out++ = '\n'; break;
+            case 'r': *out++ = '\r'; break;
+            case 't': *out++ = '\t'; break;
+            case 'u': {
+                int codepoint;
+
+                if (!readHex4(parser, parser->current, &codepoint)) {
+                    return fail(parser, "invalid unicode escape");
+                }
+
+                parser->current += 4;
+
+                if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                    int low;
+
+                    if (end - parser->current >= 6 && parser->current[0] == '\\' && parser->current[1] == 'u' &&
+                        readHex4(parser, parser->current + 2, &low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                        parser->current += 6;
+                    } else {
+                        codepoint = 0xFFFD;
+                    }
+                } else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+                    // A low surrogate on its own can't be encoded
+                    codepoint = 0xFFFD;
+                }
+
+                out += encodeUtf8(out, codepoint);
+                break;
+            }
+
+            default: {
+                parser->current -= 1;
+                return fail(parser, "invalid escape");
+            }
+        }
+    }
+
+    *length = (int) (out - parser->scratch);
+    return true;
+}
+
+static bool parseString(JsonParser *parser, Value *value) {
+    // Skip the opening quote
+    parser->current++;
+
+    const char *start = parser->current;
+    const char *current = start;
+    bool escaped = false;
+
+    while (current < parser->end && *current != '"') {
+        if (*current == '\\') {
+            escaped = true;
+
+            // Never step past the end on a trailing backslash
+            if (current + 1 >= parser->end) {
+                break;
+            }
+
+            current += 2;
+            continue;
+        }
+
+        if ((unsigned char) *current < 0x20) {
+            parser->current = current;
+            return fail(parser, "control character in string");
+        }
+
+        current++;
+    }
+
+    if (current >= parser->end) {
+        parser->current = current;
+        return fail(parser, "unterminated string");
+    }
+
+    if (!escaped) {
+        *value = OBJ_VAL(copyString(parser->vm, start, (int) (current - start)));
+        parser->current = current + 1;
+        return true;
+    }
+
+    int length;
+    if (!unescapeString(parser, current, &length)) {
+        return false;
+    }
+
+    *value = OBJ_VAL(copyString(parser->vm, parser->scratch, length));
+    parser->current = current + 1;
+
+    return true;
+}
+
+/**
+ * Parses a value, but only creates lists and dicts rather than filling
+ * them. The caller links a container into its parent first, so everything
+ * being built stays reachable, and then fills it with fillContainer().
+ */
+static bool parseValue(JsonParser *parser, Value *value) {
+    skipWhitespace(parser);
+
+    if (parser->current >= parser->end) {
+        return fail(parser, "unexpected end of input");
+    }
+
+    switch (*parser->current) {
+        case '{': {
+            *value = OBJ_VAL(newDict(parser->vm));
+            return true;
+        }
+
+        case '[': {
+            *value = OBJ_VAL(newList(parser->vm));
+            return true;
+        }
+
+        case '"': {
+            return parseString(parser, value);
+        }
+
+        case 't': {
+            *value = TRUE_VAL;
+            return matchLiteral(parser, "true", 4);
+        }
+
+        case 'f': {
+            *value = FALSE_VAL;
+            return matchLiteral(parser, "false", 5);
+        }
+
+        case 'n': {
+            *value = NIL_VAL;
+            return matchLiteral(parser, "null", 4);
+        }
+
+        default: {
+            return parseNumber(parser, value);
+        }
+    }
+}
+
+static bool fillContainer(JsonParser *parser, Value container);
+
+static bool fillList(JsonParser *parser, ObjList *list) {
+    // Skip the opening bracket
+    parser->current++;
+    skipWhitespace(parser);
+
+    if (parser->current < parser->end && *parser->current == ']') {
+        parser->current++;
+        return true;
+    }
+
+    for (;;) {
+        Value value;
+
+        if (!parseValue(parser, &value)) {
+            return false;
+        }
+
+        push(parser->vm, value);
+        writeValueArray(parser->vm, &list->values, value);
+        pop(parser->vm);
+
+        if (!fillContainer(parser, value)) {
+            return false;
+        }
+
+        skipWhitespace(parser);
+
+        if (parser->current >= parser->end) {
+            return fail(parser, "unexpected end of input");
+        }
+
+        if (*parser->current == ']') {
+            parser->current++;
+            return true;
+        }
+
+        if (*parser->current != ',') {
+            return fail(parser, "expected ',' or ']'");
+        }
+
+        parser->current++;
+    }
+}
+
+static bool fillDict(JsonParser *parser, ObjDict *dict) {
+    // Skip the opening brace
+    parser->current++;
+    skipWhitespace(parser);
+
+    if (parser->current < parser->end && *parser->current == '}') {
+        parser->current++;
+        return true;
+    }
+
+    for (;;) {
+        skipWhitespace(parser);
+
+        if (parser->current >= parser->end || *parser->current != '"') {
+            return fail(parser, "expected a string key");
+        }
+
+        Value key;
+        if (!parseString(parser, &key)) {
+            return false;
+        }
+
+        push(parser->vm, key);
+        skipWhitespace(parser);
+
+        if (parser->current >= parser->end || *parser->current != ':') {
+            pop(parser->vm);
+            return fail(parser, "expected ':'");
+        }
+
+        parser->current++;
+
+        Value value;
+        if (!parseValue(parser, &value)) {
+            pop(parser->vm);
+            return false;
+        }
+
+        push(parser->vm, value);
+        dictSet(parser->vm, dict, key, value);
+        pop(parser->vm);
+        pop(parser->vm);
+
+        if (!fillContainer(parser, value)) {
+            return false;
+        }
+
+        skipWhitespace(parser);
+
+        if (parser->current >= parser->end) {
+            return fail(parser, "unexpected end of input");
+        }
+
+        if (*parser->current == '}') {
+            parser->current++;
+            return true;
+        }
+
+        if (*parser->current != ',') {
+            return fail(parser, "expected ',' or '}'");
+        }
+
+        parser->current++;
+    }
+}
+
+static bool fillContainer(JsonParser *parser, Value container) {
+    if (!IS_LIST(container) && !IS_DICT(container)) {
+        return true;
+    }
+
+    if (++parser->depth > JSON_MAX_DEPTH) {
+        return fail(parser, "nested too deeply");
+    }
+
+    bool filled = IS_LIST(container) ? fillList(parser, AS_LIST(container)) : fillDict(parser, AS_DICT(container));
+    parser->depth--;
+
+    return filled;
+}
+
+Value jsonDecode(DictuVM *vm, const char *chars, int length, char *error) {
+    JsonParser parser = {vm, chars, chars, chars + length, 0, error, NULL, 0};
+    Value value;
+
+    if (!parseValue(&parser, &value)) {
+        free(parser.scratch);
+        return EMPTY_VAL;
+    }
+
+    push(vm, value);
+    bool valid = fillContainer(&parser, value);
+
+    if (valid) {
+        skipWhitespace(&parser);
+
+        if (parser.current != parser.end) {
+            valid = fail(&parser, "unexpected data after the value");
+        }
+    }
+
+    pop(vm);
+    free(parser.scratch);
+
+    return valid ? value : EMPTY_VAL;
+}
+
+void initJsonStream(JsonStream *stream) {
+    stream->buffer = NULL;
+    stream->length = 0;
+    stream->capacity = 0;
+    stream->consumed = 0;
+    stream->scanned = 0;
+    stream->recordStart = -1;
+    stream->depth = 0;
+    stream->inString = false;
+    stream->escaped = false;
+    stream->scalar = false;
+    stream->finished = false;
+}
+
+void freeJsonStream(DictuVM *vm, JsonStream *stream) {
+    FREE_ARRAY(vm, char, stream->buffer, stream->capacity);
+}
+
+void jsonStreamAppend(DictuVM *vm, JsonStream *stream, const char *chars, int length) {
+    // Drop the records that have been handed out before growing
+    if (stream->consumed > 0) {
+        memmove(stream->buffer, stream->buffer + stream->consumed, stream->length - stream->consumed);
+        stream->length -= stream->consumed;
+        stream->scanned -= stream->consumed;
+
+        if (stream->recordStart != -1) {
+            stream->recordStart -= stream->consumed;
+        }
+
+        stream->consumed = 0;
+    }
+
+    if (stream->length + length + 1 > stream->capacity) {
+        int oldCapacity = stream->capacity;
+        int capacity = GROW_CAPACITY(oldCapacity);
+
+        while (capacity < stream->length + length + 1) {
+            capacity *= 2;
+        }
+
+        stream->buffer = GROW_ARRAY(vm, stream->buffer, char, oldCapacity, capacity);
+        stream->capacity = capacity;
+    }
+
+    memcpy(stream->buffer + stream->length, chars, length);
+    stream->length += length;
+    stream->buffer[stream->length] = '\0';
+}
+
+static JsonStreamStatus takeRecord(JsonStream *stream, int end, const char **start, int *length) {
+    *start = stream->buffer + stream->recordStart;
+    *length = end - stream->recordStart;
+    stream->consumed = end;
+    stream->scanned = end;
+    stream->recordStart = -1;
+
+    return JSON_STREAM_RECORD;
+}
+
+JsonStreamStatus jsonStreamNext(JsonStream *stream, const char **start, int *length) {
+    for (int i = stream->scanned; i < stream->length; ++i) {
+        char c = stream->buffer[i];
+        bool whitespace = c == ' ' || c == '\n' || c == '\r' || c == '\t';
+
+        if (stream->recordStart == -1) {
+            if (whitespace) {
+                stream->consumed = i + 1;
+                continue;
+            }
+
+            stream->recordStart = i;
+            stream->depth = c == '{' || c == '[';
+            stream->inString = c == '"';
+            stream->escaped = false;
+            stream->scalar = !stream->depth && !stream->inString;
+            continue;
+        }
+
+        if (stream->inString) {
+            if (stream->escaped) {
+                stream->escaped = false;
+            } else if (c == '\\') {
+                stream->escaped = true;
+            } else if (c == '"') {
+                stream->inString = false;
+
+                if (stream->depth == 0) {
+                    return takeRecord(stream, i + 1, start, length);
+                }
+            }
+
+            continue;
+        }
+
+        if (stream->scalar) {
+            // The next value can start straight after a number or literal
+            if (whitespace || c == '{' || c == '[' || c == '"') {
+                return takeRecord(stream, i, start, length);
+            }
+
+            continue;
+        }
+
+        if (c == '"') {
+            stream->inString = true;
+        } else if (c == '{' || c == '[') {
+            stream->depth++;
+        } else if (c == '}' || c == ']') {
+            if (--stream->depth == 0) {
+                return takeRecord(stream, i + 1, start, length);
+            }
+        }
+    }
+
+    stream->scanned = stream->length;
+
+    if (!stream->finished || stream->recordStart == -1) {
+        return JSON_STREAM_PENDING;
+    }
+
+    if (stream->scalar) {
+        return takeRecord(stream, stream->length, start, length);
+    }
+
+    // Hand the partial record to the caller so it can report it
+    takeRecord(stream, stream->length, start, length);
+
+    return JSON_STREAM_TRUNCATED;
+}
@@ -0,0 +1,59 @@
+#ifndef dictu_json_decoder_h
+#define dictu_json_decoder_h
+
+#include "../../vm/vm.h"
+
+/**
+ * Parses JSON straight into Dictu values in a single pass, rather than
+ * building a tree of the whole document first and then walking it again.
+ * Containers are linked into their parent before they are filled, so only
+ * the outermost value is ever on the VM stack however deeply it nests.
+ */
+#define JSON_MAX_DEPTH 2048
+
+#define JSON_ERROR_SIZE 96
+
+// Parses exactly one value, surrounded by nothing but whitespace. Returns
+// EMPTY_VAL with the reason written to error if the JSON is invalid.
+Value jsonDecode(DictuVM *vm, const char *chars, int length, char *error);
+
+/**
+ * Finds where each value in a stream of JSON values begins and ends, so
+ * newline delimited JSON (or values simply following one another) can be
+ * decoded one record at a time as chunks of it arrive. Bytes are only
+ * scanned once however the records are split across chunks.
+ */
+typedef struct {
+    char *buffer;
+    int length;
+    int capacity;
+    // Bytes already handed out as records, dropped on the next append
+    int consumed;
+    int scanned;
+    // Offset of the record being scanned, -1 between records
+    int recordStart;
+    int depth;
+    bool inString;
+    bool escaped;
+    // The record is a number or a literal, which only ends at whitespace
+    bool scalar;
+    // No more input is coming, so a trailing scalar is complete
+    bool finished;
+} JsonStream;
+
+void initJsonStream(JsonStream *stream);
+void freeJsonStream(DictuVM *vm, JsonStream *stream);
+void jsonStreamAppend(DictuVM *vm, JsonStream *stream, const char *chars, int length);
+
+typedef enum {
+    JSON_STREAM_RECORD,
+    // Nothing complete is buffered yet
+    JSON_STREAM_PENDING,
+    // The input finished part way through a record
+    JSON_STREAM_TRUNCATED
+} JsonStreamStatus;
+
+// Finds the next complete record, which is consumed whether or not it parses
+JsonStreamStatus jsonStreamNext(JsonStream *stream, const char **start, int *length);
+
+#endif //dictu_json_decoder_h
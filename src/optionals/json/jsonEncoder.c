@@ -0,0 +1,432 @@
+#include <errno.h>
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "jsonEncoder.h"
+#include "jsonDecoder.h"
+#include "../../vm/memory.h"
+
+void initJsonEncoder(DictuVM *vm, JsonEncoder *encoder, int indent) {
+    encoder->vm = vm;
+    encoder->buffer = NULL;
+    encoder->length = 0;
+    encoder->capacity = 0;
+    encoder->indent = indent;
+    encoder->sink = NULL;
+    encoder->sinkData = NULL;
+    encoder->written = 0;
+    encoder->error = NULL;
+}
+
+void freeJsonEncoder(JsonEncoder *encoder) {
+    FREE_ARRAY(encoder->vm, char, encoder->buffer, encoder->capacity);
+    encoder->buffer = NULL;
+    encoder->length = 0;
+    encoder->capacity = 0;
+}
+
+bool jsonEncoderFlush(JsonEncoder *encoder) {
+    if (encoder->sink == NULL || encoder->length == 0) {
+        return true;
+    }
+
+    if (!encoder->sink(encoder)) {
+        encoder->error = strerror(errno);
+        return false;
+    }
+
+    encoder->written += encoder->length;
+    encoder->length = 0;
+
+    return true;
+}
+
+static bool reserve(JsonEncoder *encoder, size_t needed) {
+    if (encoder->length + needed <= encoder->capacity) {
+        return true;
+    }
+
+    // With somewhere to write to the buffer never grows past one chunk,
+    // unless a single string needs more room than that
+    if (encoder->sink != NULL) {
+        if (!jsonEncoderFlush(encoder)) {
+            return false;
+        }
+
+        if (needed <= encoder->capacity) {
+            return true;
+        }
+    }
+
+    size_t capacity = encoder->capacity;
+
+    if (capacity == 0) {
+        capacity = encoder->sink != NULL ? JSON_ENCODER_CHUNK : 512;
+    }
+
+    while (capacity < encoder->length + needed) {
+        capacity *= 2;
+    }
+
+    encoder->buffer = GROW_ARRAY(encoder->vm, encoder->buffer, char, encoder->capacity, capacity);
+    encoder->capacity = capacity;
+
+    return true;
+}
+
+static bool writeBytes(JsonEncoder *encoder, const char *chars, size_t length) {
+    if (!reserve(encoder, length)) {
+        return false;
+    }
+
+    memcpy(encoder->buffer + encoder->length, chars, length);
+    encoder->length += length;
+
+    return true;
+}
+
+static bool writeChar(JsonEncoder *encoder, char c) {
+    if (!reserve(encoder, 1)) {
+        return false;
+    }
+
+    encoder->buffer[encoder->length++] = c;
+
+    return true;
+}
+
+static bool writeNewline(JsonEncoder *encoder, int depth) {
+    size_t spaces = (size_t) encoder->indent * depth;
+
+    if (!reserve(encoder, spaces + 1)) {
+        return false;
+    }
+
+    encoder->buffer[encoder->length++] = '\n';
+    memset(encoder->buffer + encoder->length, ' ', spaces);
+    encoder->length += spaces;
+
+    return true;
+}
+
+#define MAX_EXACT_INTEGER 9007199254740992.0
+
+static const double powersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15
+};
+
+// Writes integer / 10^decimals, integer being a whole number below 2^53
+static bool writeDecimal(JsonEncoder *encoder, double integer, int decimals) {
+    char digits[32];
+    int start = sizeof(digits);
+    uint64_t magnitude = (uint64_t) fabs(integer);
+
+    for (int i = 0; i < decimals; i++) {
+        digits[--start] = '0' + magnitude % 10;
+        magnitude /= 10;
+    }
+
+    if (decimals > 0) {
+        digits[--start] = '.';
+    }
+
+    do {
+        digits[--start] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude != 0);
+
+    if (integer < 0) {
+        digits[--start] = '-';
+    }
+
+    return writeBytes(encoder, digits + start, sizeof(digits) - start);
+}
+
+static bool writeNumber(JsonEncoder *encoder, double number) {
+    // JSON has no way to write these, so do what JavaScript does
+    if (isnan(number) || isinf(number)) {
+        return writeBytes(encoder, "null", 4);
+    }
+
+    // -0 reads back as 0 unless the sign is written
+    if (number == 0 && signbit(number)) {
+        return writeBytes(encoder, "-0", 2);
+    }
+
+    double magnitude = fabs(number);
+
+    // Every whole number a double holds exactly is written without an exponent
+    if (magnitude < MAX_EXACT_INTEGER && number == trunc(number)) {
+        return writeDecimal(encoder, number, 0);
+    }
+
+    // Most fractions people write have only a few decimal places. If some
+    // whole number over 10^decimals divides out to exactly this double then
+    // that is also what reading the decimal back gives, as both are exact and
+    // division rounds correctly, so there is no need to format and reparse it
+    if (magnitude >= 1e-4 && magnitude < 1e15) {
+        for (int decimals = 1; decimals < 16; decimals++) {
+            double scaled = round(number * powersOfTen[decimals]);
+
+            if (fabs(scaled) >= MAX_EXACT_INTEGER) {
+                break;
+            }
+
+            if (scaled / powersOfTen[decimals] == number) {
+                return writeDecimal(encoder, scaled, decimals);
+            }
+        }
+    }
+
+    char digits[32];
+    int length;
+
+    // The fewest significant digits that read back as the same double.
+    // 17 always do, and any normal double that fits in fewer is already
+    // written that way by %.15g, as %g drops trailing zeros. Subnormals hold
+    // fewer digits, so those start from one (5e-324 rather than
+    // 4.94065645841247e-324)
+    for (int precision = magnitude < DBL_MIN ? 1 : 15; ; precision++) {
+        length = snprintf(digits, sizeof(digits), "%.*g", precision, number);
+
+        if (precision == 17 || strtod(digits, NULL) == number) {
+            break;
+        }
+    }
+
+    return writeBytes(encoder, digits, length);
+}
+
+// The character after the backslash for each byte that must be escaped
+static const char escapes[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+};
+
+#define ONES 0x0101010101010101ULL
+#define HIGH_BITS 0x8080808080808080ULL
+
+// True if any of the eight bytes is a control character, a quote or a
+// backslash. Bytes of multibyte UTF-8 sequences never match
+static inline bool wordNeedsEscape(uint64_t word) {
+    uint64_t control = (word - ONES * 0x20) & ~word;
+    uint64_t quote = word ^ (ONES * '"');
+    uint64_t backslash = word ^ (ONES * '\\');
+
+    quote = (quote - ONES) & ~quote;
+    backslash = (backslash - ONES) & ~backslash;
+
+    return ((control | quote | backslash) & HIGH_BITS) != 0;
+}
+
+#undef ONES
+#undef HIGH_BITS
+
+static bool writeString(JsonEncoder *encoder, const char *chars, size_t length) {
+    if (!writeChar(encoder, '"')) {
+        return false;
+    }
+
+    size_t start = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        // Skip over eight bytes at a time until one of them needs escaping
+        while (i + 8 <= length) {
+            uint64_t word;
+            memcpy(&word, chars + i, 8);
+
+            if (wordNeedsEscape(word)) {
+                break;
+            }
+
+            i += 8;
+        }
+
+        size_t end = i + 8 < length ? i + 8 : length;
+
+        while (i < end && escapes[(unsigned char) chars[i]] == 0) {
+            i++;
+        }
+
+        if (i == end) {
+            continue;
+        }
+
+        if (!writeBytes(encoder, chars + start, i - start)) {
+            return false;
+        }
+
+        char escape[7] = {'\\', escapes[(unsigned char) chars[i]]};
+        int escapeLength = 2;
+
+        if (escape[1] == 'u') {
+            escapeLength = snprintf(escape, sizeof(escape), "\\u%04x", (unsigned char) chars[i]);
+        }
+
+        if (!writeBytes(encoder, escape, escapeLength)) {
+            return false;
+        }
+
+        start = ++i;
+    }
+
+    if (!writeBytes(encoder, chars + start, length - start)) {
+        return false;
+    }
+
+    return writeChar(encoder, '"');
+}
+
+static bool writeKey(JsonEncoder *encoder, Value key) {
+    if (IS_STRING(key)) {
+        ObjString *string = AS_STRING(key);
+        return writeString(encoder, string->chars, string->length);
+    }
+
+    if (IS_NIL(key)) {
+        return writeString(encoder, "null", 4);
+    }
+
+    char *chars = valueToString(key);
+    bool written = writeString(encoder, chars, strlen(chars));
+    free(chars);
+
+    return written;
+}
+
+static bool encodeValue(JsonEncoder *encoder, Value value, int depth);
+
+static bool encodeList(JsonEncoder *encoder, ObjList *list, int depth) {
+    if (list->values.count == 0) {
+        return writeBytes(encoder, "[]", 2);
+    }
+
+    if (!writeChar(encoder, '[')) {
+        return false;
+    }
+
+    for (int i = 0; i < list->values.count; i++) {
+        if (i > 0 && !writeBytes(encoder, ", ", encoder->indent < 0 ? 2 : 1)) {
+            return false;
+        }
+
+        if (encoder->indent >= 0 && !writeNewline(encoder, depth + 1)) {
+            return false;
+        }
+
+        if (!encodeValue(encoder, list->values.values[i], depth + 1)) {
+            return false;
+        }
+    }
+
+    if (encoder->indent >= 0 && !writeNewline(encoder, depth)) {
+        return false;
+    }
+
+    return writeChar(encoder, ']');
+}
+
+static bool encodeDict(JsonEncoder *encoder, ObjDict *dict, int depth) {
+    if (dict->count == 0) {
+        return writeBytes(encoder, "{}", 2);
+    }
+
+    if (!writeChar(encoder, '{')) {
+        return false;
+    }
+
+    bool first = true;
+
+    for (int i = 0; i <= dict->capacityMask; i++) {
+        DictItem *entry = &dict->entries[i];
+
+        if (IS_EMPTY(entry->key)) {
+            continue;
+        }
+
+        if (!first && !writeBytes(encoder, ", ", encoder->indent < 0 ? 2 : 1)) {
+            return false;
+        }
+
+        first = false;
+
+        if (encoder->indent >= 0 && !writeNewline(encoder, depth + 1)) {
+            return false;
+        }
+
+        if (!writeKey(encoder, entry->key) || !writeBytes(encoder, ": ", 2)) {
+            return false;
+        }
+
+        if (!encodeValue(encoder, entry->value, depth + 1)) {
+            return false;
+        }
+    }
+
+    if (encoder->indent >= 0 && !writeNewline(encoder, depth)) {
+        return false;
+    }
+
+    return writeChar(encoder, '}');
+}
+
+static bool encodeValue(JsonEncoder *encoder, Value value, int depth) {
+    if (IS_NIL(value)) {
+        return writeBytes(encoder, "null", 4);
+    }
+
+    if (IS_BOOL(value)) {
+        return AS_BOOL(value) ? writeBytes(encoder, "true", 4) : writeBytes(encoder, "false", 5);
+    }
+
+    if (IS_NUMBER(value)) {
+        return writeNumber(encoder, AS_NUMBER(value));
+    }
+
+    if (IS_STRING(value)) {
+        ObjString *string = AS_STRING(value);
+        return writeString(encoder, string->chars, string->length);
+    }
+
+    if (IS_LIST(value) || IS_DICT(value)) {
+        // A container that holds itself would otherwise never finish
+        if (depth >= JSON_MAX_DEPTH) {
+            encoder->error = "Object is nested too deeply to serialize";
+            return false;
+        }
+
+        if (IS_LIST(value)) {
+            return encodeList(encoder, AS_LIST(value), depth);
+        }
+
+        return encodeDict(encoder, AS_DICT(value), depth);
+    }
+
+    encoder->error = "Object is not serializable";
+    return false;
+}
+
+bool jsonEncode(JsonEncoder *encoder, Value value) {
+    return encodeValue(encoder, value, 0);
+}
+
+ObjString *jsonEncoderTakeString(JsonEncoder *encoder) {
+    int length = encoder->length;
+    char *chars = SHRINK_ARRAY(encoder->vm, encoder->buffer, char, encoder->capacity, length + 1);
+    chars[length] = '\0';
+
+    encoder->buffer = NULL;
+    encoder->length = 0;
+    encoder->capacity = 0;
+
+    return takeString(encoder->vm, chars, length);
+}
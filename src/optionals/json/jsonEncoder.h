@@ -0,0 +1,46 @@
+#ifndef dictu_json_encoder_h
+#define dictu_json_encoder_h
+
+#include "../../vm/vm.h"
+
+/**
+ * Serializes Dictu values straight into a growable byte buffer, rather than
+ * building a json-parser tree of the whole value, measuring it and then
+ * walking it a second time to write it out. When the encoder has a sink the
+ * buffer is handed to it whenever it fills, so a value of any size can be
+ * written to a file or socket in fixed size pieces.
+ */
+#define JSON_ENCODER_CHUNK 65536
+
+typedef struct JsonEncoder JsonEncoder;
+
+// Writes out the buffered bytes, returning false with errno set on failure
+typedef bool (*JsonSinkFn)(JsonEncoder *encoder);
+
+struct JsonEncoder {
+    DictuVM *vm;
+    char *buffer;
+    size_t length;
+    size_t capacity;
+    // Spaces per level, or -1 to write everything on a single line
+    int indent;
+    JsonSinkFn sink;
+    void *sinkData;
+    // Total bytes handed to the sink so far
+    size_t written;
+    const char *error;
+};
+
+void initJsonEncoder(DictuVM *vm, JsonEncoder *encoder, int indent);
+void freeJsonEncoder(JsonEncoder *encoder);
+
+// Returns false with encoder->error set if the value can not be serialized
+bool jsonEncode(JsonEncoder *encoder, Value value);
+
+// Hands anything still buffered to the sink
+bool jsonEncoderFlush(JsonEncoder *encoder);
+
+// Takes the buffered output as a string, leaving the encoder empty
+ObjString *jsonEncoderTakeString(JsonEncoder *encoder);
+
+#endif //dictu_json_encoder_h
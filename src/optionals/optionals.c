@@ -31,7 +31,12 @@ BuiltinModules modules[] = {
 #endif
     {"BigInt", &createBigIntModule, false},
     {"Buffer", &createBufferModule, false},
+    {"TypedArray", &createTypedArrayModule, false},
     {"FFI", &createFFIModule, false},
+#ifndef _WIN32
+    {"Thread", &createThreadModule, false},
+    {"HTTPServer", &createHTTPServerModule, false},
+#endif
     {NULL, NULL, false}
 };
 
@@ -28,8 +28,11 @@
 #include "bigint.h"
 #include "object/object.h"
 #include "buffer.h"
+#include "typedArray.h"
 #include "unittest/unittest.h"
 #include "ffi.h"
+#include "thread/thread.h"
+#include "httpServer.h"
 
 typedef Value (*BuiltinModule)(DictuVM *vm);
 
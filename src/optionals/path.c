@@ -1,4 +1,7 @@
 #include "path.h"
+#ifndef _WIN32
+#include "path/walk.h"
+#endif
 
 #if defined(_WIN32) && !defined(S_ISDIR)
 #define S_ISDIR(M) (((M) & _S_IFDIR) == _S_IFDIR)
@@ -363,6 +366,9 @@ Value createPathModule(DictuVM *vm) {
     defineNative(vm, &module->values, "isSymbolicLink", isSymlinkNative);
 #endif
     defineNative(vm, &module->values, "listDir", listDirNative);
+#ifndef _WIN32
+    defineNative(vm, &module->values, "walk", walkNative);
+#endif
     defineNative(vm, &module->values, "join", joinNative);
 
     /**
@@ -0,0 +1,716 @@
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#include "walk.h"
+
+#define WALK_READ_SIZE 32768
+#define WALK_BATCH_SIZE 256
+#define WALK_QUEUE_SIZE 64
+#define WALK_MAX_THREADS 64
+
+typedef enum {
+    WALK_ALL,
+    WALK_FILES,
+    WALK_DIRS
+} WalkType;
+
+typedef struct {
+    char **match;
+    int matchCount;
+    char **exclude;
+    int excludeCount;
+    WalkType type;
+    // 0 walks the whole tree
+    int maxDepth;
+    int threads;
+    // Where an entry's path relative to the root starts
+    size_t relativeStart;
+} WalkOptions;
+
+#ifdef __linux__
+// The record getdents64() fills its buffer with, glibc only declares it
+// with _GNU_SOURCE
+typedef struct {
+    uint64_t ino;
+    int64_t off;
+    unsigned short length;
+    unsigned char type;
+    char name[];
+} LinuxDirent;
+#endif
+
+typedef struct {
+    int fd;
+#ifdef __linux__
+    char *buffer;
+    long position;
+    long length;
+#else
+    DIR *dir;
+#endif
+} DirReader;
+
+typedef struct {
+    char *path;
+    size_t length;
+    int depth;
+    // fd is -1 for a directory that has not been opened yet
+    DirReader reader;
+} WalkFrame;
+
+typedef struct {
+    char **paths;
+    int count;
+} WalkBatch;
+
+typedef struct {
+    WalkOptions options;
+
+    // One thread: the directories open from the root down to where the walk
+    // has got to, the last is the one being read
+    WalkFrame *frames;
+    int frameCount;
+    int frameCapacity;
+
+    // More threads: directories waiting to be read, and batches of paths
+    // waiting for the VM
+    pthread_t *threads;
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t jobAdded;
+    pthread_cond_t batchAdded;
+    pthread_cond_t batchTaken;
+    WalkFrame *jobs;
+    int jobCount;
+    int jobCapacity;
+    // Threads reading a directory
+    int busy;
+    WalkBatch queue[WALK_QUEUE_SIZE];
+    int queueHead;
+    int queueCount;
+    WalkBatch current;
+    int currentIndex;
+    bool finished;
+    bool cancelled;
+} Walker;
+
+static bool openReader(DirReader *reader, int parent, const char *name, int flags) {
+    reader->fd = openat(parent, name, O_RDONLY | O_DIRECTORY | O_CLOEXEC | flags);
+
+    if (reader->fd == -1) {
+        return false;
+    }
+
+#ifdef __linux__
+    reader->buffer = malloc(WALK_READ_SIZE);
+    reader->position = 0;
+    reader->length = 0;
+#else
+    reader->dir = fdopendir(reader->fd);
+
+    if (reader->dir == NULL) {
+        int error = errno;
+        close(reader->fd);
+        reader->fd = -1;
+        errno = error;
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+static bool isDots(const char *name) {
+    return name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'));
+}
+
+// name stays valid until the next entry is read
+static bool readEntry(DirReader *reader, const char **name, unsigned char *type) {
+#ifdef __linux__
+    while (true) {
+        if (reader->position >= reader->length) {
+            long bytes = syscall(SYS_getdents64, reader->fd, reader->buffer, WALK_READ_SIZE);
+
+            // The end of the directory, or it can not be read any further
+            if (bytes <= 0) {
+                return false;
+            }
+
+            reader->position = 0;
+            reader->length = bytes;
+        }
+
+        LinuxDirent *entry = (LinuxDirent *) (reader->buffer + reader->position);
+        reader->position += entry->length;
+
+        if (!isDots(entry->name)) {
+            *name = entry->name;
+            *type = entry->type;
+            return true;
+        }
+    }
+#else
+    struct dirent *entry;
+
+    while ((entry = readdir(reader->dir)) != NULL) {
+        if (!isDots(entry->d_name)) {
+            *name = entry->d_name;
+            *type = entry->d_type;
+            return true;
+        }
+    }
+
+    return false;
+#endif
+}
+
+static void closeReader(DirReader *reader) {
+    if (reader->fd == -1) {
+        return;
+    }
+
+#ifdef __linux__
+    close(reader->fd);
+    free(reader->buffer);
+#else
+    closedir(reader->dir);
+#endif
+    reader->fd = -1;
+}
+
+// Symbolic links are never followed, only a file system that leaves d_type
+// out costs an fstatat()
+static bool isDirectory(int parent, const char *name, unsigned char type) {
+    if (type != DT_UNKNOWN) {
+        return type == DT_DIR;
+    }
+
+    struct stat info;
+    return fstatat(parent, name, &info, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(info.st_mode);
+}
+
+static char *joinPath(const char *directory, size_t length, const char *name, size_t *joinedLength) {
+    size_t nameLength = strlen(name);
+    size_t separator = length > 0 && directory[length - 1] != '/';
+    char *path = malloc(length + separator + nameLength + 1);
+
+    memcpy(path, directory, length);
+    path[length] = '/';
+    memcpy(path + length + separator, name, nameLength + 1);
+
+    *joinedLength = length + separator + nameLength;
+    return path;
+}
+
+// Patterns with a '/' are matched against the path from the root, the rest
+// against the entry's name
+static bool matchesAny(char **patterns, int count, const char *relative, const char *name) {
+    for (int i = 0; i < count; ++i) {
+        bool matched = strchr(patterns[i], '/') != NULL
+                       ? fnmatch(patterns[i], relative, FNM_PATHNAME) == 0
+                       : fnmatch(patterns[i], name, 0) == 0;
+
+        if (matched) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void visitEntry(WalkOptions *options, const char *path, const char *name, bool directory, int depth,
+                       bool *yield, bool *descend) {
+    const char *relative = path + options->relativeStart;
+
+    if (matchesAny(options->exclude, options->excludeCount, relative, name)) {
+        *yield = false;
+        *descend = false;
+        return;
+    }
+
+    *descend = directory && (options->maxDepth == 0 || depth < options->maxDepth);
+    *yield = (options->type == WALK_ALL || (options->type == WALK_DIRS) == directory) &&
+             (options->matchCount == 0 || matchesAny(options->match, options->matchCount, relative, name));
+}
+
+static void pushFrame(WalkFrame **frames, int *count, int *capacity, WalkFrame frame) {
+    if (*count == *capacity) {
+        *capacity = *capacity < 8 ? 8 : *capacity * 2;
+        *frames = realloc(*frames, sizeof(WalkFrame) * *capacity);
+    }
+
+    (*frames)[(*count)++] = frame;
+}
+
+static bool nextEntry(DictuVM *vm, Walker *walker, Value *next) {
+    while (walker->frameCount > 0) {
+        WalkFrame *frame = &walker->frames[walker->frameCount - 1];
+        const char *name;
+        unsigned char type;
+
+        if (!readEntry(&frame->reader, &name, &type)) {
+            closeReader(&frame->reader);
+            free(frame->path);
+            walker->frameCount--;
+            continue;
+        }
+
+        size_t length;
+        char *path = joinPath(frame->path, frame->length, name, &length);
+        int depth = frame->depth + 1;
+        bool yield, descend;
+
+        visitEntry(&walker->options, path, name, isDirectory(frame->reader.fd, name, type), depth, &yield, &descend);
+
+        // The directory is read next, so its entries follow it
+        WalkFrame child = {.path = path, .length = length, .depth = depth, .reader = {.fd = -1}};
+        bool opened = descend && openReader(&child.reader, frame->reader.fd, name, O_NOFOLLOW);
+
+        if (yield) {
+            *next = OBJ_VAL(copyString(vm, path, length));
+        }
+
+        if (opened) {
+            pushFrame(&walker->frames, &walker->frameCount, &walker->frameCapacity, child);
+        } else {
+            free(path);
+        }
+
+        if (yield) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void freeBatch(WalkBatch *batch, int from) {
+    for (int i = from; i < batch->count; ++i) {
+        free(batch->paths[i]);
+    }
+
+    free(batch->paths);
+    batch->paths = NULL;
+    batch->count = 0;
+}
+
+static bool queueBatch(Walker *walker, WalkBatch *batch) {
+    pthread_mutex_lock(&walker->lock);
+
+    while (walker->queueCount == WALK_QUEUE_SIZE && !walker->cancelled) {
+        pthread_cond_wait(&walker->batchTaken, &walker->lock);
+    }
+
+    if (walker->cancelled) {
+        pthread_mutex_unlock(&walker->lock);
+        freeBatch(batch, 0);
+        return false;
+    }
+
+    walker->queue[(walker->queueHead + walker->queueCount) % WALK_QUEUE_SIZE] = *batch;
+    walker->queueCount++;
+    pthread_cond_signal(&walker->batchAdded);
+    pthread_mutex_unlock(&walker->lock);
+
+    batch->paths = NULL;
+    batch->count = 0;
+    return true;
+}
+
+static void readDirectory(Walker *walker, WalkFrame *job) {
+    // Only the root is opened before it reaches a thread, the rest are
+    // opened by path so that waiting directories do not hold descriptors
+    if (job->reader.fd == -1 && !openReader(&job->reader, AT_FDCWD, job->path, O_NOFOLLOW)) {
+        free(job->path);
+        return;
+    }
+
+    WalkBatch batch = {NULL, 0};
+    const char *name;
+    unsigned char type;
+
+    while (readEntry(&job->reader, &name, &type)) {
+        size_t length;
+        char *path = joinPath(job->path, job->length, name, &length);
+        bool yield, descend;
+
+        visitEntry(&walker->options, path, name, isDirectory(job->reader.fd, name, type), job->depth + 1,
+                   &yield, &descend);
+
+        if (yield) {
+            if (batch.paths == NULL) {
+                batch.paths = malloc(sizeof(char *) * WALK_BATCH_SIZE);
+            }
+
+            batch.paths[batch.count++] = descend ? strdup(path) : path;
+
+            // The walk was cancelled and the batch freed, path with it unless
+            // it was copied
+            if (batch.count == WALK_BATCH_SIZE && !queueBatch(walker, &batch)) {
+                if (descend) {
+                    free(path);
+                }
+
+                break;
+            }
+        }
+
+        if (descend) {
+            WalkFrame child = {.path = path, .length = length, .depth = job->depth + 1, .reader = {.fd = -1}};
+
+            pthread_mutex_lock(&walker->lock);
+            pushFrame(&walker->jobs, &walker->jobCount, &walker->jobCapacity, child);
+            pthread_cond_signal(&walker->jobAdded);
+            pthread_mutex_unlock(&walker->lock);
+        } else if (!yield) {
+            free(path);
+        }
+    }
+
+    if (batch.count > 0) {
+        queueBatch(walker, &batch);
+    } else {
+        freeBatch(&batch, 0);
+    }
+
+    closeReader(&job->reader);
+    free(job->path);
+}
+
+static void *walkThread(void *data) {
+    Walker *walker = data;
+
+    pthread_mutex_lock(&walker->lock);
+
+    while (true) {
+        while (walker->jobCount == 0 && walker->busy > 0 && !walker->cancelled) {
+            pthread_cond_wait(&walker->jobAdded, &walker->lock);
+        }
+
+        if (walker->cancelled || walker->jobCount == 0) {
+            break;
+        }
+
+        WalkFrame job = walker->jobs[--walker->jobCount];
+        walker->busy++;
+        pthread_mutex_unlock(&walker->lock);
+
+        readDirectory(walker, &job);
+
+        pthread_mutex_lock(&walker->lock);
+        walker->busy--;
+
+        if (walker->jobCount == 0 && walker->busy == 0) {
+            walker->finished = true;
+            pthread_cond_broadcast(&walker->jobAdded);
+            pthread_cond_broadcast(&walker->batchAdded);
+        }
+    }
+
+    pthread_mutex_unlock(&walker->lock);
+
+    return NULL;
+}
+
+static bool nextQueued(DictuVM *vm, Walker *walker, Value *next) {
+    if (walker->currentIndex == walker->current.count) {
+        freeBatch(&walker->current, walker->currentIndex);
+
+        pthread_mutex_lock(&walker->lock);
+
+        while (walker->queueCount == 0 && !walker->finished) {
+            pthread_cond_wait(&walker->batchAdded, &walker->lock);
+        }
+
+        if (walker->queueCount == 0) {
+            pthread_mutex_unlock(&walker->lock);
+            walker->currentIndex = 0;
+            return false;
+        }
+
+        walker->current = walker->queue[walker->queueHead];
+        walker->queueHead = (walker->queueHead + 1) % WALK_QUEUE_SIZE;
+        walker->queueCount--;
+        pthread_cond_signal(&walker->batchTaken);
+        pthread_mutex_unlock(&walker->lock);
+
+        walker->currentIndex = 0;
+    }
+
+    char *path = walker->current.paths[walker->currentIndex++];
+    *next = OBJ_VAL(copyString(vm, path, strlen(path)));
+    free(path);
+
+    return true;
+}
+
+static bool iterateWalker(DictuVM *vm, ObjAbstract *abstract, Value *next) {
+    Walker *walker = abstract->data;
+
+    if (walker->threadCount > 0) {
+        return nextQueued(vm, walker, next);
+    }
+
+    return nextEntry(vm, walker, next);
+}
+
+static Value nextWalker(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "next() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Value next;
+
+    if (!iterateWalker(vm, AS_ABSTRACT(args[0]), &next)) {
+        return NIL_VAL;
+    }
+
+    return next;
+}
+
+static void freePatterns(char **patterns, int count) {
+    for (int i = 0; i < count; ++i) {
+        free(patterns[i]);
+    }
+
+    free(patterns);
+}
+
+static void freeWalker(DictuVM *vm, ObjAbstract *abstract) {
+    Walker *walker = abstract->data;
+
+    if (walker->threadCount > 0) {
+        pthread_mutex_lock(&walker->lock);
+        walker->cancelled = true;
+        pthread_cond_broadcast(&walker->jobAdded);
+        pthread_cond_broadcast(&walker->batchTaken);
+        pthread_mutex_unlock(&walker->lock);
+
+        for (int i = 0; i < walker->threadCount; ++i) {
+            pthread_join(walker->threads[i], NULL);
+        }
+
+        pthread_mutex_destroy(&walker->lock);
+        pthread_cond_destroy(&walker->jobAdded);
+        pthread_cond_destroy(&walker->batchAdded);
+        pthread_cond_destroy(&walker->batchTaken);
+    }
+
+    for (int i = 0; i < walker->queueCount; ++i) {
+        freeBatch(&walker->queue[(walker->queueHead + i) % WALK_QUEUE_SIZE], 0);
+    }
+
+    freeBatch(&walker->current, walker->currentIndex);
+
+    for (int i = 0; i < walker->jobCount; ++i) {
+        closeReader(&walker->jobs[i].reader);
+        free(walker->jobs[i].path);
+    }
+
+    for (int i = 0; i < walker->frameCount; ++i) {
+        closeReader(&walker->frames[i].reader);
+        free(walker->frames[i].path);
+    }
+
+    free(walker->threads);
+    free(walker->jobs);
+    free(walker->frames);
+    freePatterns(walker->options.match, walker->options.matchCount);
+    freePatterns(walker->options.exclude, walker->options.excludeCount);
+    FREE(vm, Walker, walker);
+}
+
+static char *walkerToString(ObjAbstract *abstract) {
+    UNUSED(abstract);
+
+    char *walkerString = malloc(sizeof(char) * 9);
+    snprintf(walkerString, 9, "<Walker>");
+    return walkerString;
+}
+
+static bool readPatterns(DictuVM *vm, const char *key, Value value, char ***patterns, int *count) {
+    Value *values = &value;
+    int valueCount = 1;
+
+    if (IS_LIST(value)) {
+        values = AS_LIST(value)->values.values;
+        valueCount = AS_LIST(value)->values.count;
+    }
+
+    for (int i = 0; i < valueCount; ++i) {
+        if (!IS_STRING(values[i])) {
+            runtimeError(vm, "walk() option \"%s\" must be a string or a list of strings", key);
+            return false;
+        }
+    }
+
+    freePatterns(*patterns, *count);
+    *patterns = malloc(sizeof(char *) * valueCount);
+    *count = valueCount;
+
+    for (int i = 0; i < valueCount; ++i) {
+        (*patterns)[i] = strdup(AS_CSTRING(values[i]));
+    }
+
+    return true;
+}
+
+static bool readOptions(DictuVM *vm, WalkOptions *options, ObjDict *dict) {
+    for (int i = 0; i <= dict->capacityMask; ++i) {
+        DictItem *entry = &dict->entries[i];
+
+        if (IS_EMPTY(entry->key)) {
+            continue;
+        }
+
+        if (!IS_STRING(entry->key)) {
+            runtimeError(vm, "walk() options key must be a string");
+            return false;
+        }
+
+        char *key = AS_CSTRING(entry->key);
+
+        if (strcmp(key, "match") == 0) {
+            if (!readPatterns(vm, key, entry->value, &options->match, &options->matchCount)) {
+                return false;
+            }
+        } else if (strcmp(key, "exclude") == 0) {
+            if (!readPatterns(vm, key, entry->value, &options->exclude, &options->excludeCount)) {
+                return false;
+            }
+        } else if (strcmp(key, "type") == 0) {
+            if (IS_STRING(entry->value) && strcmp(AS_CSTRING(entry->value), "file") == 0) {
+                options->type = WALK_FILES;
+            } else if (IS_STRING(entry->value) && strcmp(AS_CSTRING(entry->value), "dir") == 0) {
+                options->type = WALK_DIRS;
+            } else {
+                runtimeError(vm, "walk() option \"type\" must be \"file\" or \"dir\"");
+                return false;
+            }
+        } else if (strcmp(key, "maxDepth") == 0 || strcmp(key, "threads") == 0) {
+            if (!IS_NUMBER(entry->value) || AS_NUMBER(entry->value) < 1) {
+                runtimeError(vm, "walk() option \"%s\" must be a number greater than 0", key);
+                return false;
+            }
+
+            if (key[0] == 'm') {
+                options->maxDepth = AS_NUMBER(entry->value);
+            } else {
+                double threads = AS_NUMBER(entry->value);
+                options->threads = threads > WALK_MAX_THREADS ? WALK_MAX_THREADS : threads;
+            }
+        } else {
+            runtimeError(vm, "Unknown walk() option \"%s\"", key);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool startThreads(Walker *walker, WalkFrame root) {
+    pthread_mutex_init(&walker->lock, NULL);
+    pthread_cond_init(&walker->jobAdded, NULL);
+    pthread_cond_init(&walker->batchAdded, NULL);
+    pthread_cond_init(&walker->batchTaken, NULL);
+
+    pushFrame(&walker->jobs, &walker->jobCount, &walker->jobCapacity, root);
+    walker->threads = malloc(sizeof(pthread_t) * walker->options.threads);
+
+    for (int i = 0; i < walker->options.threads; ++i) {
+        if (pthread_create(&walker->threads[walker->threadCount], NULL, walkThread, walker) == 0) {
+            walker->threadCount++;
+        }
+    }
+
+    if (walker->threadCount == 0) {
+        pthread_mutex_destroy(&walker->lock);
+        pthread_cond_destroy(&walker->jobAdded);
+        pthread_cond_destroy(&walker->batchAdded);
+        pthread_cond_destroy(&walker->batchTaken);
+        return false;
+    }
+
+    return true;
+}
+
+Value walkNative(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "walk() takes 1 or 2 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[0])) {
+        runtimeError(vm, "walk() first argument must be a string");
+        return EMPTY_VAL;
+    }
+
+    if (argCount == 2 && !IS_DICT(args[1])) {
+        runtimeError(vm, "walk() second argument must be a dict");
+        return EMPTY_VAL;
+    }
+
+    ObjString *root = AS_STRING(args[0]);
+    WalkOptions options;
+    memset(&options, 0, sizeof(options));
+    options.type = WALK_ALL;
+    options.threads = 1;
+    options.relativeStart = root->length + (root->length > 0 && root->chars[root->length - 1] != '/');
+
+    if (argCount == 2 && !readOptions(vm, &options, AS_DICT(args[1]))) {
+        freePatterns(options.match, options.matchCount);
+        freePatterns(options.exclude, options.excludeCount);
+        return EMPTY_VAL;
+    }
+
+    // The root may be a symbolic link to a directory
+    WalkFrame frame = {.length = root->length, .reader = {.fd = -1}};
+
+    if (!openReader(&frame.reader, AT_FDCWD, root->chars, 0)) {
+        int error = errno;
+        freePatterns(options.match, options.matchCount);
+        freePatterns(options.exclude, options.excludeCount);
+        errno = error;
+        ERROR_RESULT;
+    }
+
+    frame.path = strdup(root->chars);
+
+    ObjAbstract *abstract = newAbstract(vm, freeWalker, walkerToString);
+    push(vm, OBJ_VAL(abstract));
+
+    Walker *walker = ALLOCATE(vm, Walker, 1);
+    memset(walker, 0, sizeof(Walker));
+    walker->options = options;
+    abstract->data = walker;
+    abstract->iterate = iterateWalker;
+
+    if (options.threads > 1) {
+        if (!startThreads(walker, frame)) {
+            pop(vm);
+            return newResultError(vm, "Unable to start walk() threads");
+        }
+    } else {
+        pushFrame(&walker->frames, &walker->frameCount, &walker->frameCapacity, frame);
+    }
+
+    /**
+     * Setup Walker object methods
+     */
+    defineNative(vm, &abstract->values, "next", nextWalker);
+
+    Value result = newResultSuccess(vm, OBJ_VAL(abstract));
+    pop(vm);
+
+    return result;
+}
@@ -0,0 +1,21 @@
+#ifndef dictu_path_walk_h
+#define dictu_path_walk_h
+
+#include "../optionals.h"
+#include "../../vm/vm.h"
+
+/**
+ * Path.walk() reads directories with getdents64() on Linux, and readdir()
+ * elsewhere. Whether an entry is a directory comes from d_type, so nothing
+ * is stat()ed unless the file system leaves d_type out.
+ *
+ * With one thread the walk is depth first and only reads as far as the
+ * walker has been iterated, keeping each directory from the root down open
+ * and opening the next relative to it with openat(). With more, each thread
+ * takes whole directories off a shared stack and queues the paths it finds
+ * in batches for the VM, which waits on the queue as it iterates. The queue
+ * is bounded, so threads that get too far ahead wait for the VM to catch up.
+ */
+Value walkNative(DictuVM *vm, int argCount, Value *args);
+
+#endif //dictu_path_walk_h
@@ -231,6 +231,158 @@ static Value executeReturnOutput(DictuVM* vm, ObjList* argList) {
 
     return newResultSuccess(vm, OBJ_VAL(takeString(vm, output, total)));
 }
+
+typedef struct {
+    char **arguments;
+    int count;
+    bool capture;
+    char *output;
+    int length;
+    int error;
+} RunRequest;
+
+static void freeRunRequest(void *data) {
+    RunRequest *request = data;
+
+    for (int i = 0; i < request->count; ++i) {
+        free(request->arguments[i]);
+    }
+
+    free(request->arguments);
+    free(request->output);
+    free(request);
+}
+
+static void runWork(void *data) {
+    RunRequest *request = data;
+    int fd[2];
+
+    if (request->capture && pipe(fd) != 0) {
+        request->error = errno;
+        return;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        if (request->capture) {
+            close(fd[0]);
+            dup2(fd[1], 1);
+            dup2(fd[1], 2);
+            close(fd[1]);
+        }
+
+        // Only async-signal-safe calls are allowed in a child forked from a
+        // threaded process
+        execvp(request->arguments[0], request->arguments);
+        _exit(errno);
+    }
+
+    if (pid == -1) {
+        request->error = errno;
+
+        if (request->capture) {
+            close(fd[0]);
+            close(fd[1]);
+        }
+
+        return;
+    }
+
+    if (request->capture) {
+        close(fd[1]);
+
+        int size = 1024;
+        request->output = malloc(size);
+        int numRead;
+
+        while ((numRead = read(fd[0], request->output + request->length, size - request->length - 1)) > 0) {
+            request->length += numRead;
+
+            if (request->length + 1 >= size) {
+                size *= 3;
+                request->output = realloc(request->output, size);
+            }
+        }
+
+        request->output[request->length] = '\0';
+        close(fd[0]);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+        request->error = WEXITSTATUS(status);
+    }
+}
+
+static Value runComplete(DictuVM *vm, void *data) {
+    RunRequest *request = data;
+
+    if (request->error != 0) {
+        char buf[MAX_ERROR_LEN];
+        getStrerror(buf, request->error);
+        freeRunRequest(request);
+
+        return newResultError(vm, buf);
+    }
+
+    Value output = NIL_VAL;
+
+    if (request->capture) {
+        output = OBJ_VAL(copyString(vm, request->output, request->length));
+    }
+
+    freeRunRequest(request);
+
+    return newResultSuccess(vm, output);
+}
+
+static Value runAsyncProcess(DictuVM* vm, int argCount, Value* args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "runAsync() takes 1 or 2 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_LIST(args[0])) {
+        runtimeError(vm, "Argument passed to runAsync() must be a list");
+        return EMPTY_VAL;
+    }
+
+    bool getOutput = false;
+
+    if (argCount == 2) {
+        if (!IS_BOOL(args[1])) {
+            runtimeError(vm, "Optional argument passed to runAsync() must be a boolean");
+            return EMPTY_VAL;
+        }
+
+        getOutput = AS_BOOL(args[1]);
+    }
+
+    ObjList* argList = AS_LIST(args[0]);
+
+    for (int i = 0; i < argList->values.count; ++i) {
+        if (!IS_STRING(argList->values.values[i])) {
+            return newResultError(vm, "Arguments passed must all be strings");
+        }
+    }
+
+    // The pool thread can not touch the list, so it works on a copy
+    RunRequest *request = malloc(sizeof(RunRequest));
+    memset(request, 0, sizeof(RunRequest));
+    request->capture = getOutput;
+    request->count = argList->values.count;
+    request->arguments = malloc(sizeof(char*) * (argList->values.count + 1));
+
+    for (int i = 0; i < argList->values.count; ++i) {
+        request->arguments[i] = strdup(AS_CSTRING(argList->values.values[i]));
+    }
+
+    request->arguments[argList->values.count] = NULL;
+
+    return newFuture(vm, NIL_VAL, request, runWork, runComplete, freeRunRequest);
+}
 #endif
 
 static Value execProcess(DictuVM* vm, int argCount, Value* args) {
@@ -345,6 +497,9 @@ Value createProcessModule(DictuVM* vm) {
     defineNative(vm, &module->values, "exec", execProcess);
     defineNative(vm, &module->values, "run", runProcess);
     defineNative(vm, &module->values, "kill", killProcess);
+#ifndef _WIN32
+    defineNative(vm, &module->values, "runAsync", runAsyncProcess);
+#endif
 
     /**
      * Define process properties
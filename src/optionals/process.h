@@ -6,6 +6,7 @@
 #endif // !_WIN32
 
 #include "optionals.h"
+#include "../vm/future.h"
 
 Value createProcessModule(DictuVM *vm);
 
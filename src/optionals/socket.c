@@ -19,21 +19,34 @@ unsigned long inet_addr_new(const char* cp) {
 
 #define write(fd, buffer, count) _write(fd, buffer, count)
 #define close(fd) closesocket(fd)
+#define poll(fds, count, timeout) WSAPoll(fds, count, timeout)
 #else
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <poll.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 #endif
 
-typedef struct {
-    int socket;
-    int socketFamily;    /* Address family, e.g., AF_INET */
-    int socketType;      /* Socket type, e.g., SOCK_STREAM */
-    int socketProtocol;  /* Protocol type, usually 0 */
-} SocketData;
+// Writing to a socket the peer has closed shouldn't kill the process with SIGPIPE
+#ifdef MSG_NOSIGNAL
+#define SEND_FLAGS MSG_NOSIGNAL
+#else
+#define SEND_FLAGS 0
+#endif
 
-#define AS_SOCKET(v) ((SocketData*)AS_ABSTRACT(v)->data)
+#define EVENT_READ 1
+#define EVENT_WRITE 2
+#define EVENT_TIMEOUT 4
 
 ObjAbstract *newSocket(DictuVM *vm, int sock, int socketFamily, int socketType, int socketProtocol);
+static void unwatchClosedSocket(SocketData *sock);
 
 static Value createSocket(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 2) {
@@ -169,7 +182,7 @@ static Value writeSocket(DictuVM *vm, int argCount, Value *args) {
     SocketData *sock = AS_SOCKET(args[0]);
     ObjString *message = AS_STRING(args[1]);
 
-    int writeRet = write(sock->socket , message->chars, message->length);
+    int writeRet = send(sock->socket, message->chars, message->length, SEND_FLAGS);
 
     if (writeRet == -1) {
         ERROR_RESULT;
@@ -178,6 +191,37 @@ static Value writeSocket(DictuVM *vm, int argCount, Value *args) {
     return newResultSuccess(vm, NUMBER_VAL(writeRet));
 }
 
+bool socketSendAll(SocketData *sock, const char *chars, size_t length) {
+    while (length > 0) {
+        int sent = send(sock->socket, chars, length, SEND_FLAGS);
+
+        if (sent == -1) {
+#ifndef _WIN32
+            if (errno == EINTR) {
+                continue;
+            }
+
+            // A non-blocking socket is full, wait until the peer has read some of it
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                struct pollfd pollFd = {sock->socket, POLLOUT, 0};
+
+                if (poll(&pollFd, 1, -1) == -1 && errno != EINTR) {
+                    return false;
+                }
+
+                continue;
+            }
+#endif
+            return false;
+        }
+
+        chars += sent;
+        length -= sent;
+    }
+
+    return true;
+}
+
 static Value recvSocket(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 1) {
         runtimeError(vm, "recv() takes 1 argument (%d given)", argCount);
@@ -241,6 +285,15 @@ static Value connectSocket(DictuVM *vm, int argCount, Value *args) {
     server.sin_port = htons(AS_NUMBER(args[2]));
 
     if (connect(sock->socket, (struct sockaddr *)&server, sizeof(server)) < 0) {
+#ifdef _WIN32
+        if (WSAGetLastError() == WSAEWOULDBLOCK) {
+#else
+        if (errno == EINPROGRESS) {
+#endif
+            // A non-blocking connect completes once the socket is writable
+            return newResultSuccess(vm, NIL_VAL);
+        }
+
         ERROR_RESULT;
     }
 
@@ -254,6 +307,7 @@ static Value closeSocket(DictuVM *vm, int argCount, Value *args) {
     }
 
     SocketData *sock = AS_SOCKET(args[0]);
+    unwatchClosedSocket(sock);
     close(sock->socket);
 
     return NIL_VAL;
@@ -281,10 +335,52 @@ static Value setSocketOpt(DictuVM *vm, int argCount, Value *args) {
     return newResultSuccess(vm, NIL_VAL);
 }
 
+static Value setBlockingSocket(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "setBlocking() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_BOOL(args[1])) {
+        runtimeError(vm, "setBlocking() argument must be a boolean");
+        return EMPTY_VAL;
+    }
+
+    SocketData *sock = AS_SOCKET(args[0]);
+    bool blocking = AS_BOOL(args[1]);
+
+#ifdef _WIN32
+    u_long mode = blocking ? 0 : 1;
+    if (ioctlsocket(sock->socket, FIONBIO, &mode) != 0) {
+        ERROR_RESULT;
+    }
+#else
+    int flags = fcntl(sock->socket, F_GETFL, 0);
+    if (flags == -1) {
+        ERROR_RESULT;
+    }
+
+    flags = blocking ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+    if (fcntl(sock->socket, F_SETFL, flags) == -1) {
+        ERROR_RESULT;
+    }
+#endif
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
 void freeSocket(DictuVM *vm, ObjAbstract *abstract) {
     FREE(vm, SocketData, abstract->data);
 }
 
+void graySocket(DictuVM *vm, ObjAbstract *abstract) {
+    SocketData *sock = (SocketData *)abstract->data;
+
+    if (sock != NULL && sock->loop != NULL) {
+        grayObject(vm, (Obj *) sock->loop);
+    }
+}
+
 char *socketToString(ObjAbstract *abstract) {
     UNUSED(abstract);
 
@@ -302,8 +398,10 @@ ObjAbstract *newSocket(DictuVM *vm, int sock, int socketFamily, int socketType,
     socket->socketFamily = socketFamily;
     socket->socketType = socketType;
     socket->socketProtocol = socketProtocol;
+    socket->loop = NULL;
 
     abstract->data = socket;
+    abstract->grayFunc = graySocket;
 
     /**
      * Setup Socket object methods
@@ -316,11 +414,598 @@ ObjAbstract *newSocket(DictuVM *vm, int sock, int socketFamily, int socketType,
     defineNative(vm, &abstract->values, "connect", connectSocket);
     defineNative(vm, &abstract->values, "close", closeSocket);
     defineNative(vm, &abstract->values, "setsockopt", setSocketOpt);
+    defineNative(vm, &abstract->values, "setBlocking", setBlockingSocket);
     pop(vm);
 
     return abstract;
 }
 
+/**
+ * EventLoop
+ *
+ * Multiplexes readiness notifications for any number of sockets, along
+ * with one-shot and repeating timers, onto a single VM. Linux uses epoll,
+ * other platforms fall back to poll().
+ */
+typedef struct {
+    bool active;
+    int events;
+    Value socket;
+    Value callback;
+    // Timer that fires after timeout milliseconds without any events, -1 if
+    // the watcher has no deadline
+    double deadline;
+    double timeout;
+} Watcher;
+
+typedef struct {
+    int pollFd;
+    // Indexed by file descriptor
+    Watcher *watchers;
+    int watcherCapacity;
+    int watcherCount;
+    // Timers and watcher deadlines, ticking once a millisecond
+    TimerWheel wheel;
+    bool stopped;
+} EventLoop;
+
+#define AS_EVENT_LOOP(v) ((EventLoop*)AS_ABSTRACT(v)->data)
+
+#ifdef __linux__
+#define EVENT_LOOP_MAX_EVENTS 256
+#endif
+
+static double monotonicMs(void) {
+#ifdef _WIN32
+    return (double) GetTickCount64();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#endif
+}
+
+static bool isCallable(Value value) {
+    return IS_CLOSURE(value) || IS_FUNCTION(value) || IS_BOUND_METHOD(value) || IS_NATIVE(value);
+}
+
+static uint64_t currentTick(void) {
+    return (uint64_t) monotonicMs();
+}
+
+static uint64_t millisecondsToTicks(double milliseconds) {
+    uint64_t ticks = (uint64_t) milliseconds;
+    return ticks < milliseconds ? ticks + 1 : ticks;
+}
+
+static double addTimer(DictuVM *vm, EventLoop *loop, double milliseconds, bool repeat, Value callback, int watcher) {
+    uint64_t now = currentTick();
+    timerWheelCatchUp(&loop->wheel, now);
+
+    return timerWheelAdd(vm, &loop->wheel, now + millisecondsToTicks(milliseconds),
+                         repeat ? milliseconds : -1, callback, watcher);
+}
+
+static Value scheduleTimer(DictuVM *vm, int argCount, Value *args, const char *name, bool repeat) {
+    if (argCount != 2) {
+        runtimeError(vm, "%s() takes 2 arguments (%d given)", name, argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!isCallable(args[1])) {
+        runtimeError(vm, "%s() first argument must be a function", name);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[2]) || AS_NUMBER(args[2]) < 0) {
+        runtimeError(vm, "%s() second argument must be a positive number", name);
+        return EMPTY_VAL;
+    }
+
+    double id = addTimer(vm, AS_EVENT_LOOP(args[0]), AS_NUMBER(args[2]), repeat, args[1], -1);
+
+    if (id < 0) {
+        runtimeError(vm, "%s() too many timers scheduled", name);
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(id);
+}
+
+static Value eventLoopSetTimeout(DictuVM *vm, int argCount, Value *args) {
+    return scheduleTimer(vm, argCount, args, "setTimeout", false);
+}
+
+static Value eventLoopSetInterval(DictuVM *vm, int argCount, Value *args) {
+    return scheduleTimer(vm, argCount, args, "setInterval", true);
+}
+
+static Value eventLoopClearTimer(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "clearTimer() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[1])) {
+        runtimeError(vm, "clearTimer() argument must be a number");
+        return EMPTY_VAL;
+    }
+
+    return BOOL_VAL(timerWheelRemove(&AS_EVENT_LOOP(args[0])->wheel, AS_NUMBER(args[1])));
+}
+
+#ifdef __linux__
+static bool updatePoller(EventLoop *loop, int fd, int events, int op) {
+    struct epoll_event event = {0};
+    event.data.fd = fd;
+
+    if (events & EVENT_READ) event.events |= EPOLLIN;
+    if (events & EVENT_WRITE) event.events |= EPOLLOUT;
+
+    return epoll_ctl(loop->pollFd, op, fd, &event) == 0;
+}
+#endif
+
+static Value eventLoopWatch(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 3 && argCount != 4) {
+        runtimeError(vm, "watch() takes 3 or 4 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_SOCKET(args[1])) {
+        runtimeError(vm, "watch() first argument must be a socket");
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[2])) {
+        runtimeError(vm, "watch() second argument must be a number");
+        return EMPTY_VAL;
+    }
+
+    if (!isCallable(args[3])) {
+        runtimeError(vm, "watch() third argument must be a function");
+        return EMPTY_VAL;
+    }
+
+    double timeout = -1;
+
+    if (argCount == 4) {
+        if (!IS_NUMBER(args[4]) || AS_NUMBER(args[4]) < 0) {
+            runtimeError(vm, "watch() fourth argument must be a positive number");
+            return EMPTY_VAL;
+        }
+
+        timeout = AS_NUMBER(args[4]);
+    }
+
+    EventLoop *loop = AS_EVENT_LOOP(args[0]);
+    SocketData *sock = AS_SOCKET(args[1]);
+    int fd = sock->socket;
+    int events = (int) AS_NUMBER(args[2]) & (EVENT_READ | EVENT_WRITE);
+
+    if (fd < 0) {
+        return newResultError(vm, "Invalid socket");
+    }
+
+    // close() only knows of one loop to unwatch the socket from
+    if (sock->loop != NULL && sock->loop != AS_ABSTRACT(args[0])) {
+        return newResultError(vm, "Socket is already watched by another event loop");
+    }
+
+    if (fd >= loop->watcherCapacity) {
+        int oldCapacity = loop->watcherCapacity;
+        int capacity = oldCapacity < 8 ? 8 : oldCapacity;
+        while (capacity <= fd) capacity *= 2;
+
+        loop->watchers = GROW_ARRAY(vm, loop->watchers, Watcher, oldCapacity, capacity);
+        memset(loop->watchers + oldCapacity, 0, sizeof(Watcher) * (capacity - oldCapacity));
+        loop->watcherCapacity = capacity;
+    }
+
+    Watcher *watcher = &loop->watchers[fd];
+
+#ifdef __linux__
+    bool registered = updatePoller(loop, fd, events, watcher->active ? EPOLL_CTL_MOD : EPOLL_CTL_ADD);
+
+    // A watched socket that was closed without being unwatched has been
+    // dropped by epoll, and its descriptor may since have been reused
+    if (!registered && watcher->active && errno == ENOENT) {
+        registered = updatePoller(loop, fd, events, EPOLL_CTL_ADD);
+    }
+
+    if (!registered) {
+        ERROR_RESULT;
+    }
+#endif
+
+    if (!watcher->active) {
+        loop->watcherCount++;
+        watcher->deadline = -1;
+    }
+
+    watcher->active = true;
+    watcher->events = events;
+    watcher->socket = args[1];
+    sock->loop = AS_ABSTRACT(args[0]);
+    watcher->callback = args[3];
+    watcher->timeout = timeout;
+
+    if (watcher->deadline >= 0) {
+        timerWheelRemove(&loop->wheel, watcher->deadline);
+        watcher->deadline = -1;
+    }
+
+    if (timeout >= 0) {
+        // The timer has no callback of its own, the watcher's is used
+        watcher->deadline = addTimer(vm, loop, timeout, true, NIL_VAL, fd);
+    }
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
+static bool removeWatcher(EventLoop *loop, SocketData *sock) {
+    int fd = sock->socket;
+
+    if (fd < 0 || fd >= loop->watcherCapacity || !loop->watchers[fd].active) {
+        return false;
+    }
+
+    // The descriptor may belong to another socket by now
+    if (AS_SOCKET(loop->watchers[fd].socket) != sock) {
+        return false;
+    }
+
+#ifdef __linux__
+    // The descriptor may already have been closed, which removes it from epoll
+    updatePoller(loop, fd, 0, EPOLL_CTL_DEL);
+#endif
+
+    if (loop->watchers[fd].deadline >= 0) {
+        timerWheelRemove(&loop->wheel, loop->watchers[fd].deadline);
+    }
+
+    loop->watchers[fd].active = false;
+    loop->watchers[fd].socket = NIL_VAL;
+    loop->watchers[fd].callback = NIL_VAL;
+    loop->watcherCount--;
+
+    if (sock->loop != NULL && (EventLoop *) sock->loop->data == loop) {
+        sock->loop = NULL;
+    }
+
+    return true;
+}
+
+static Value eventLoopUnwatch(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "unwatch() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_SOCKET(args[1])) {
+        runtimeError(vm, "unwatch() argument must be a socket");
+        return EMPTY_VAL;
+    }
+
+    return BOOL_VAL(removeWatcher(AS_EVENT_LOOP(args[0]), AS_SOCKET(args[1])));
+}
+
+static void unwatchClosedSocket(SocketData *sock) {
+    if (sock->loop != NULL) {
+        removeWatcher((EventLoop *) sock->loop->data, sock);
+    }
+}
+
+static void dispatchSocketEvent(DictuVM *vm, EventLoop *loop, int fd, int events) {
+    // An earlier callback in this batch may have unwatched the descriptor
+    if (fd >= loop->watcherCapacity || !loop->watchers[fd].active) {
+        return;
+    }
+
+    Watcher *watcher = &loop->watchers[fd];
+    Value callback = watcher->callback;
+    Value callbackArgs[2] = {watcher->socket, NUMBER_VAL(events)};
+
+    // Any activity pushes the deadline back
+    if (events != EVENT_TIMEOUT && watcher->deadline >= 0) {
+        timerWheelReschedule(&loop->wheel, watcher->deadline, currentTick() + millisecondsToTicks(watcher->timeout));
+    }
+
+    push(vm, callback);
+    push(vm, callbackArgs[0]);
+    callFunction(vm, callback, 2, callbackArgs);
+    pop(vm);
+    pop(vm);
+}
+
+static int waitForEvents(DictuVM *vm, EventLoop *loop, int timeout) {
+    int dispatched = 0;
+
+#ifdef __linux__
+    struct epoll_event events[EVENT_LOOP_MAX_EVENTS];
+    int count = epoll_wait(loop->pollFd, events, EVENT_LOOP_MAX_EVENTS, timeout);
+
+    if (count == -1) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        int ready = 0;
+
+        // Errors and hang ups are reported as readable and writable so the
+        // callback finds out through recv() or write()
+        if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP)) ready |= EVENT_READ;
+        if (events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP)) ready |= EVENT_WRITE;
+
+        dispatchSocketEvent(vm, loop, events[i].data.fd, ready);
+        dispatched++;
+    }
+#else
+    struct pollfd *fds = ALLOCATE(vm, struct pollfd, loop->watcherCount);
+    int fdCount = 0;
+
+    for (int fd = 0; fd < loop->watcherCapacity; ++fd) {
+        Watcher *watcher = &loop->watchers[fd];
+        if (!watcher->active) continue;
+
+        fds[fdCount].fd = fd;
+        fds[fdCount].events = 0;
+        fds[fdCount].revents = 0;
+        if (watcher->events & EVENT_READ) fds[fdCount].events |= POLLIN;
+        if (watcher->events & EVENT_WRITE) fds[fdCount].events |= POLLOUT;
+        fdCount++;
+    }
+
+    int count = poll(fds, fdCount, timeout);
+
+    if (count == -1) {
+        FREE_ARRAY(vm, struct pollfd, fds, loop->watcherCount);
+        return errno == EINTR ? 0 : -1;
+    }
+
+    // Callbacks may change the watchers so work from a copy of the results
+    int allocated = fdCount;
+    for (int i = 0; i < fdCount && count > 0; ++i) {
+        if (fds[i].revents == 0) continue;
+
+        // The socket was closed without going through close(), so it will
+        // never see another event
+        if (fds[i].revents & POLLNVAL) {
+            Watcher *watcher = &loop->watchers[fds[i].fd];
+
+            if (watcher->active) {
+                removeWatcher(loop, AS_SOCKET(watcher->socket));
+            }
+
+            count--;
+            continue;
+        }
+
+        int ready = 0;
+        if (fds[i].revents & (POLLIN | POLLERR | POLLHUP)) ready |= EVENT_READ;
+        if (fds[i].revents & (POLLOUT | POLLERR | POLLHUP)) ready |= EVENT_WRITE;
+
+        dispatchSocketEvent(vm, loop, fds[i].fd, ready);
+        dispatched++;
+        count--;
+    }
+
+    FREE_ARRAY(vm, struct pollfd, fds, allocated);
+#endif
+
+    return dispatched;
+}
+
+static int runTimers(DictuVM *vm, EventLoop *loop) {
+    uint64_t now = currentTick();
+    int fired = 0;
+    int index;
+
+    while ((index = timerWheelExpire(&loop->wheel, now)) != -1) {
+        WheelTimer *timer = &loop->wheel.timers[index];
+        Value callback = timer->callback;
+        int watcher = timer->watcher;
+
+        // Rescheduled past the current tick, so it waits for the next pass
+        if (timer->interval >= 0) {
+            timerWheelSchedule(&loop->wheel, index, now + millisecondsToTicks(timer->interval));
+        } else {
+            timerWheelRelease(&loop->wheel, index);
+        }
+
+        if (watcher != -1) {
+            dispatchSocketEvent(vm, loop, watcher, EVENT_TIMEOUT);
+        } else {
+            push(vm, callback);
+            callFunction(vm, callback, 0, NULL);
+            pop(vm);
+        }
+
+        fired++;
+    }
+
+    return fired;
+}
+
+static int nextTimeout(EventLoop *loop, int timeout) {
+    int64_t ticks = timerWheelNextExpiry(&loop->wheel);
+
+    if (ticks < 0) {
+        return timeout;
+    }
+
+    // Counted from the last tick the wheel turned to, which may be behind
+    double untilTimer = (double) (loop->wheel.now + ticks) - monotonicMs();
+    int timerTimeout = untilTimer <= 0 ? 0 : (int) untilTimer + 1;
+
+    return (timeout < 0 || timerTimeout < timeout) ? timerTimeout : timeout;
+}
+
+static int runOnce(DictuVM *vm, EventLoop *loop, int timeout) {
+    int dispatched = waitForEvents(vm, loop, nextTimeout(loop, timeout));
+
+    if (dispatched == -1) {
+        return -1;
+    }
+
+    return dispatched + runTimers(vm, loop);
+}
+
+static Value eventLoopRunOnce(DictuVM *vm, int argCount, Value *args) {
+    if (argCount > 1) {
+        runtimeError(vm, "runOnce() takes 0 or 1 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    int timeout = -1;
+
+    if (argCount == 1) {
+        if (!IS_NUMBER(args[1])) {
+            runtimeError(vm, "runOnce() argument must be a number");
+            return EMPTY_VAL;
+        }
+
+        timeout = AS_NUMBER(args[1]);
+    }
+
+    EventLoop *loop = AS_EVENT_LOOP(args[0]);
+
+    if (loop->watcherCount == 0 && loop->wheel.count == 0) {
+        return newResultSuccess(vm, NUMBER_VAL(0));
+    }
+
+    int dispatched = runOnce(vm, loop, timeout);
+
+    if (dispatched == -1) {
+        ERROR_RESULT;
+    }
+
+    return newResultSuccess(vm, NUMBER_VAL(dispatched));
+}
+
+static Value eventLoopRun(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "run() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    EventLoop *loop = AS_EVENT_LOOP(args[0]);
+    loop->stopped = false;
+
+    while (!loop->stopped && (loop->watcherCount > 0 || loop->wheel.count > 0)) {
+        if (runOnce(vm, loop, -1) == -1) {
+            ERROR_RESULT;
+        }
+    }
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
+static Value eventLoopStop(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "stop() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    AS_EVENT_LOOP(args[0])->stopped = true;
+
+    return NIL_VAL;
+}
+
+static Value eventLoopLen(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "len() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(AS_EVENT_LOOP(args[0])->watcherCount);
+}
+
+void freeEventLoop(DictuVM *vm, ObjAbstract *abstract) {
+    EventLoop *loop = (EventLoop *)abstract->data;
+
+#ifdef __linux__
+    if (loop->pollFd != -1) {
+        close(loop->pollFd);
+    }
+#endif
+
+    FREE_ARRAY(vm, Watcher, loop->watchers, loop->watcherCapacity);
+    freeTimerWheel(vm, &loop->wheel);
+    FREE(vm, EventLoop, abstract->data);
+}
+
+void grayEventLoop(DictuVM *vm, ObjAbstract *abstract) {
+    EventLoop *loop = (EventLoop *)abstract->data;
+
+    if (loop == NULL) return;
+
+    for (int i = 0; i < loop->watcherCapacity; ++i) {
+        if (!loop->watchers[i].active) continue;
+
+        grayValue(vm, loop->watchers[i].socket);
+        grayValue(vm, loop->watchers[i].callback);
+    }
+
+    grayTimerWheel(vm, &loop->wheel);
+}
+
+char *eventLoopToString(ObjAbstract *abstract) {
+    UNUSED(abstract);
+
+    char *eventLoopString = malloc(sizeof(char) * 12);
+    snprintf(eventLoopString, 12, "<EventLoop>");
+    return eventLoopString;
+}
+
+static Value newEventLoop(DictuVM *vm, int argCount, Value *args) {
+    UNUSED(args);
+
+    if (argCount != 0) {
+        runtimeError(vm, "eventLoop() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    int pollFd = -1;
+
+#ifdef __linux__
+    pollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (pollFd == -1) {
+        ERROR_RESULT;
+    }
+#endif
+
+    ObjAbstract *abstract = newAbstract(vm, freeEventLoop, eventLoopToString);
+    push(vm, OBJ_VAL(abstract));
+
+    EventLoop *loop = ALLOCATE(vm, EventLoop, 1);
+    loop->pollFd = pollFd;
+    loop->watchers = NULL;
+    loop->watcherCapacity = 0;
+    loop->watcherCount = 0;
+    initTimerWheel(&loop->wheel, currentTick());
+    loop->stopped = false;
+
+    /**
+     * Setup EventLoop object methods
+     */
+    defineNative(vm, &abstract->values, "watch", eventLoopWatch);
+    defineNative(vm, &abstract->values, "unwatch", eventLoopUnwatch);
+    defineNative(vm, &abstract->values, "setTimeout", eventLoopSetTimeout);
+    defineNative(vm, &abstract->values, "setInterval", eventLoopSetInterval);
+    defineNative(vm, &abstract->values, "clearTimer", eventLoopClearTimer);
+    defineNative(vm, &abstract->values, "runOnce", eventLoopRunOnce);
+    defineNative(vm, &abstract->values, "run", eventLoopRun);
+    defineNative(vm, &abstract->values, "stop", eventLoopStop);
+    defineNative(vm, &abstract->values, "len", eventLoopLen);
+
+    abstract->data = loop;
+    abstract->grayFunc = grayEventLoop;
+    pop(vm);
+
+    return newResultSuccess(vm, OBJ_VAL(abstract));
+}
+
 #ifdef _WIN32
 void cleanupSockets(void) {
     // Calls WSACleanup until an error occurs.
@@ -348,6 +1033,7 @@ Value createSocketModule(DictuVM *vm) {
      * Define Socket methods
      */
     defineNative(vm, &module->values, "create", createSocket);
+    defineNative(vm, &module->values, "eventLoop", newEventLoop);
 
     /**
      * Define Socket properties
@@ -360,6 +1046,9 @@ Value createSocketModule(DictuVM *vm) {
     defineNativeProperty(vm, &module->values, "SOL_SOCKET", NUMBER_VAL(SOL_SOCKET));
     defineNativeProperty(vm, &module->values, "SO_REUSEADDR", NUMBER_VAL(SO_REUSEADDR));
     defineNativeProperty(vm, &module->values, "SO_BROADCAST", NUMBER_VAL(SO_BROADCAST));
+    defineNativeProperty(vm, &module->values, "EVENT_READ", NUMBER_VAL(EVENT_READ));
+    defineNativeProperty(vm, &module->values, "EVENT_WRITE", NUMBER_VAL(EVENT_WRITE));
+    defineNativeProperty(vm, &module->values, "EVENT_TIMEOUT", NUMBER_VAL(EVENT_TIMEOUT));
 
     pop(vm);
     pop(vm);
@@ -5,11 +5,29 @@
 #include "../vm/vm.h"
 #include "../vm/memory.h"
 #include "../vm/object.h"
+#include "socket/timerWheel.h"
 
 #ifdef __FreeBSD__
 #include <netinet/in.h>
 #endif
 
+typedef struct {
+    int socket;
+    int socketFamily;    /* Address family, e.g., AF_INET */
+    int socketType;      /* Socket type, e.g., SOCK_STREAM */
+    int socketProtocol;  /* Protocol type, usually 0 */
+    // The event loop watching the socket, which close() unwatches it from
+    ObjAbstract *loop;
+} SocketData;
+
+#define AS_SOCKET(v) ((SocketData*)AS_ABSTRACT(v)->data)
+#define IS_SOCKET(v) (IS_ABSTRACT(v) && AS_ABSTRACT(v)->type == socketToString)
+
+char *socketToString(ObjAbstract *abstract);
+
+// Sends every byte, retrying partial writes, returning false with errno set on failure
+bool socketSendAll(SocketData *sock, const char *chars, size_t length);
+
 Value createSocketModule(DictuVM *vm);
 
 #endif //dictu_socket_h
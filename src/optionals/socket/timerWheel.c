@@ -0,0 +1,316 @@
+#include "timerWheel.h"
+
+// Ids pack the generation above the index of the entry
+#define WHEEL_ID_LIMIT (1 << 24)
+
+#define LEVEL_SHIFT(level) (WHEEL_BITS * (level))
+#define LEVEL_SPAN(level) ((uint64_t) 1 << LEVEL_SHIFT(level))
+
+void initTimerWheel(TimerWheel *wheel, uint64_t now) {
+    wheel->now = now;
+    wheel->nextSequence = 0;
+    wheel->timers = NULL;
+    wheel->capacity = 0;
+    wheel->count = 0;
+    wheel->freeList = -1;
+
+    for (int i = 0; i < WHEEL_LISTS; ++i) {
+        wheel->heads[i] = -1;
+        wheel->tails[i] = -1;
+    }
+
+    for (int i = 0; i < WHEEL_LEVELS; ++i) {
+        wheel->levelCounts[i] = 0;
+    }
+}
+
+void freeTimerWheel(DictuVM *vm, TimerWheel *wheel) {
+    FREE_ARRAY(vm, WheelTimer, wheel->timers, wheel->capacity);
+}
+
+void grayTimerWheel(DictuVM *vm, TimerWheel *wheel) {
+    for (int i = 0; i < wheel->capacity; ++i) {
+        if (wheel->timers[i].active) {
+            grayValue(vm, wheel->timers[i].callback);
+        }
+    }
+}
+
+static void wheelUnlink(TimerWheel *wheel, int index) {
+    WheelTimer *timer = &wheel->timers[index];
+
+    if (timer->list == -1) {
+        return;
+    }
+
+    if (timer->prev == -1) {
+        wheel->heads[timer->list] = timer->next;
+    } else {
+        wheel->timers[timer->prev].next = timer->next;
+    }
+
+    if (timer->next == -1) {
+        wheel->tails[timer->list] = timer->prev;
+    } else {
+        wheel->timers[timer->next].prev = timer->prev;
+    }
+
+    if (timer->list != WHEEL_EXPIRED) {
+        wheel->levelCounts[timer->list / WHEEL_SLOTS]--;
+    }
+
+    timer->list = -1;
+}
+
+static void wheelLink(TimerWheel *wheel, int index, int list) {
+    WheelTimer *timer = &wheel->timers[index];
+    int after = wheel->tails[list];
+
+    // Almost always appends, timers only arrive out of order when they are
+    // cascaded down from a higher level
+    while (after != -1 && wheel->timers[after].sequence > timer->sequence) {
+        after = wheel->timers[after].prev;
+    }
+
+    timer->list = list;
+    timer->prev = after;
+    timer->next = after == -1 ? wheel->heads[list] : wheel->timers[after].next;
+
+    if (after == -1) {
+        wheel->heads[list] = index;
+    } else {
+        wheel->timers[after].next = index;
+    }
+
+    if (timer->next == -1) {
+        wheel->tails[list] = index;
+    } else {
+        wheel->timers[timer->next].prev = index;
+    }
+
+    if (list != WHEEL_EXPIRED) {
+        wheel->levelCounts[list / WHEEL_SLOTS]++;
+    }
+}
+
+static void place(TimerWheel *wheel, int index) {
+    uint64_t expires = wheel->timers[index].expires;
+    uint64_t delta = expires > wheel->now ? expires - wheel->now : 0;
+    int level = 0;
+
+    while (level < WHEEL_LEVELS - 1 && delta >= LEVEL_SPAN(level + 1)) {
+        level++;
+    }
+
+    // Too far out for the wheel, it is placed again when the top level turns
+    if (delta >= LEVEL_SPAN(WHEEL_LEVELS)) {
+        expires = wheel->now + LEVEL_SPAN(WHEEL_LEVELS) - 1;
+    }
+
+    int slot = (expires >> LEVEL_SHIFT(level)) & (WHEEL_SLOTS - 1);
+    wheelLink(wheel, index, level * WHEEL_SLOTS + slot);
+}
+
+static void cascade(TimerWheel *wheel, int level) {
+    int list = level * WHEEL_SLOTS + ((wheel->now >> LEVEL_SHIFT(level)) & (WHEEL_SLOTS - 1));
+
+    while (wheel->heads[list] != -1) {
+        int index = wheel->heads[list];
+        wheelUnlink(wheel, index);
+        place(wheel, index);
+    }
+}
+
+void timerWheelSchedule(TimerWheel *wheel, int index, uint64_t expires) {
+    WheelTimer *timer = &wheel->timers[index];
+
+    wheelUnlink(wheel, index);
+
+    // The current tick has already been handed out
+    timer->expires = expires > wheel->now ? expires : wheel->now + 1;
+    timer->sequence = wheel->nextSequence++;
+    place(wheel, index);
+}
+
+double timerWheelAdd(DictuVM *vm, TimerWheel *wheel, uint64_t expires, double interval, Value callback, int watcher) {
+    if (wheel->freeList == -1) {
+        if (wheel->capacity >= WHEEL_ID_LIMIT) {
+            return -1;
+        }
+
+        int oldCapacity = wheel->capacity;
+        int capacity = GROW_CAPACITY(oldCapacity);
+        // Growing can collect, which grays every entry up to the capacity
+        wheel->timers = GROW_ARRAY(vm, wheel->timers, WheelTimer, oldCapacity, capacity);
+        wheel->capacity = capacity;
+
+        for (int i = capacity - 1; i >= oldCapacity; --i) {
+            wheel->timers[i].active = false;
+            wheel->timers[i].generation = 0;
+            wheel->timers[i].next = wheel->freeList;
+            wheel->freeList = i;
+        }
+    }
+
+    int index = wheel->freeList;
+    WheelTimer *timer = &wheel->timers[index];
+    wheel->freeList = timer->next;
+    wheel->count++;
+
+    timer->active = true;
+    timer->interval = interval;
+    timer->callback = callback;
+    timer->watcher = watcher;
+    timer->list = -1;
+    timerWheelSchedule(wheel, index, expires);
+
+    return timerWheelId(wheel, index);
+}
+
+void timerWheelCatchUp(TimerWheel *wheel, uint64_t now) {
+    // Nothing is pending, so there is no need to turn through the idle
+    // ticks. now itself has not been processed yet.
+    if (wheel->count == 0 && now > wheel->now + 1) {
+        wheel->now = now - 1;
+    }
+}
+
+double timerWheelId(TimerWheel *wheel, int index) {
+    return (double) wheel->timers[index].generation * WHEEL_ID_LIMIT + index;
+}
+
+static int findTimer(TimerWheel *wheel, double id) {
+    if (id < 0) {
+        return -1;
+    }
+
+    int index = (int) ((uint64_t) id % WHEEL_ID_LIMIT);
+
+    if (index >= wheel->capacity || !wheel->timers[index].active || timerWheelId(wheel, index) != id) {
+        return -1;
+    }
+
+    return index;
+}
+
+void timerWheelRelease(TimerWheel *wheel, int index) {
+    WheelTimer *timer = &wheel->timers[index];
+
+    wheelUnlink(wheel, index);
+    timer->active = false;
+    timer->callback = NIL_VAL;
+    timer->generation++;
+    timer->next = wheel->freeList;
+    wheel->freeList = index;
+    wheel->count--;
+}
+
+bool timerWheelRemove(TimerWheel *wheel, double id) {
+    int index = findTimer(wheel, id);
+
+    if (index == -1) {
+        return false;
+    }
+
+    timerWheelRelease(wheel, index);
+
+    return true;
+}
+
+bool timerWheelReschedule(TimerWheel *wheel, double id, uint64_t expires) {
+    int index = findTimer(wheel, id);
+
+    if (index == -1) {
+        return false;
+    }
+
+    timerWheelSchedule(wheel, index, expires);
+
+    return true;
+}
+
+int timerWheelExpire(TimerWheel *wheel, uint64_t until) {
+    for (;;) {
+        int index = wheel->heads[WHEEL_EXPIRED];
+
+        if (index != -1) {
+            wheelUnlink(wheel, index);
+            return index;
+        }
+
+        if (wheel->now >= until) {
+            return -1;
+        }
+
+        if (wheel->count == 0) {
+            wheel->now = until;
+            return -1;
+        }
+
+        // Nothing can fire before the next cascade, skip straight to it
+        if (wheel->levelCounts[0] == 0) {
+            uint64_t blockEnd = wheel->now | (WHEEL_SLOTS - 1);
+
+            if (blockEnd >= until) {
+                wheel->now = until;
+                return -1;
+            }
+
+            wheel->now = blockEnd;
+        }
+
+        wheel->now++;
+
+        for (int level = WHEEL_LEVELS - 1; level > 0; --level) {
+            if ((wheel->now & (LEVEL_SPAN(level) - 1)) == 0) {
+                cascade(wheel, level);
+            }
+        }
+
+        int list = wheel->now & (WHEEL_SLOTS - 1);
+
+        while (wheel->heads[list] != -1) {
+            index = wheel->heads[list];
+            wheelUnlink(wheel, index);
+            wheelLink(wheel, index, WHEEL_EXPIRED);
+        }
+    }
+}
+
+int64_t timerWheelNextExpiry(TimerWheel *wheel) {
+    if (wheel->heads[WHEEL_EXPIRED] != -1) {
+        return 0;
+    }
+
+    if (wheel->count == 0) {
+        return -1;
+    }
+
+    int64_t next = -1;
+
+    for (int level = 0; level < WHEEL_LEVELS; ++level) {
+        if (wheel->levelCounts[level] == 0) {
+            continue;
+        }
+
+        uint64_t current = wheel->now >> LEVEL_SHIFT(level);
+
+        // The current slot comes last, it holds timers a whole turn away
+        for (int i = 1; i <= WHEEL_SLOTS; ++i) {
+            int list = level * WHEEL_SLOTS + ((current + i) & (WHEEL_SLOTS - 1));
+
+            if (wheel->heads[list] != -1) {
+                // For the higher levels this is when the slot cascades
+                int64_t ticks = (int64_t) (((current + i) << LEVEL_SHIFT(level)) - wheel->now);
+
+                if (next == -1 || ticks < next) {
+                    next = ticks;
+                }
+
+                break;
+            }
+        }
+    }
+
+    return next;
+}
@@ -0,0 +1,81 @@
+#ifndef dictu_timer_wheel_h
+#define dictu_timer_wheel_h
+
+#include <stdint.h>
+
+#include "../../vm/vm.h"
+#include "../../vm/memory.h"
+
+/**
+ * A hierarchical timer wheel with a resolution of one tick (a millisecond
+ * for the EventLoop). Each level has 64 slots, a slot in level n covering
+ * 64^n ticks, so four levels cover a little over four and a half hours and
+ * anything further out is parked in the top level until it comes into
+ * range. Scheduling, rescheduling and cancelling are all O(1), timers
+ * only move down a level when the wheel turns past the slot they are in.
+ */
+#define WHEEL_BITS 6
+#define WHEEL_SLOTS (1 << WHEEL_BITS)
+#define WHEEL_LEVELS 4
+// Every slot, plus the timers that have expired but not yet been handed out
+#define WHEEL_LISTS (WHEEL_LEVELS * WHEEL_SLOTS + 1)
+#define WHEEL_EXPIRED (WHEEL_LISTS - 1)
+
+typedef struct {
+    bool active;
+    uint64_t expires;
+    // Orders timers expiring on the same tick by when they were scheduled
+    uint64_t sequence;
+    // Negative for timers that only fire once
+    double interval;
+    Value callback;
+    // Descriptor of the watcher this is the deadline for, -1 for plain timers
+    int watcher;
+    // Bumped every time the entry is reused so stale ids are rejected
+    int generation;
+    // The list the timer is linked into, -1 while it is being fired
+    int list;
+    int prev;
+    int next;
+} WheelTimer;
+
+typedef struct {
+    // The last tick that has been processed
+    uint64_t now;
+    uint64_t nextSequence;
+    WheelTimer *timers;
+    int capacity;
+    int count;
+    int freeList;
+    int heads[WHEEL_LISTS];
+    int tails[WHEEL_LISTS];
+    int levelCounts[WHEEL_LEVELS];
+} TimerWheel;
+
+void initTimerWheel(TimerWheel *wheel, uint64_t now);
+void freeTimerWheel(DictuVM *vm, TimerWheel *wheel);
+void grayTimerWheel(DictuVM *vm, TimerWheel *wheel);
+
+// Moves an empty wheel straight to now
+void timerWheelCatchUp(TimerWheel *wheel, uint64_t now);
+
+// Returns the id of the new timer, or -1 if the wheel is full
+double timerWheelAdd(DictuVM *vm, TimerWheel *wheel, uint64_t expires, double interval, Value callback, int watcher);
+bool timerWheelRemove(TimerWheel *wheel, double id);
+bool timerWheelReschedule(TimerWheel *wheel, double id, uint64_t expires);
+
+/**
+ * Turns the wheel up to and including tick until, returning the index of
+ * the next timer that has expired or -1 once there are none left. The
+ * caller must either schedule the timer again or release it before the
+ * wheel is used for anything else.
+ */
+int timerWheelExpire(TimerWheel *wheel, uint64_t until);
+void timerWheelSchedule(TimerWheel *wheel, int index, uint64_t expires);
+void timerWheelRelease(TimerWheel *wheel, int index);
+double timerWheelId(TimerWheel *wheel, int index);
+
+// Ticks from now until the wheel next needs turning, -1 if it is empty
+int64_t timerWheelNextExpiry(TimerWheel *wheel);
+
+#endif //dictu_timer_wheel_h
@@ -3,6 +3,14 @@
 typedef struct {
     sqlite3 *db;
     bool open;
+    // The connection object and every executeAsync() still to run each hold
+    // a reference, the last one to let go frees it
+    int references;
+#ifndef _WIN32
+    // Held while a statement runs so an executeAsync() on a pool thread
+    // never overlaps other use of the connection
+    pthread_mutex_t lock;
+#endif
 } Database;
 
 typedef struct {
@@ -10,9 +18,53 @@ typedef struct {
     sqlite3_stmt *stmt;
 } Result;
 
+typedef struct {
+    // Holds a reference so the connection outlives the statement
+    Database *db;
+    // NULL once the statement has been finalized
+    sqlite3_stmt *stmt;
+    // Set once every row has been read, until the statement is reset
+    bool done;
+    // Column names, created the first time rows are read into dicts
+    ObjList *columns;
+} Statement;
+
 #define AS_SQLITE_DATABASE(v) ((Database*)AS_ABSTRACT(v)->data)
+#define AS_SQLITE_STATEMENT(v) ((Statement*)AS_ABSTRACT(v)->data)
+
+// Every integer up to 2^53 can be held in a double
+#define MAX_EXACT_INTEGER 9007199254740992.0
+
+#ifndef _WIN32
+#define LOCK_DATABASE(db) pthread_mutex_lock(&(db)->lock)
+#define UNLOCK_DATABASE(db) pthread_mutex_unlock(&(db)->lock)
+#else
+#define LOCK_DATABASE(db)
+#define UNLOCK_DATABASE(db)
+#endif
 
 ObjAbstract *newSqlite(DictuVM *vm);
+ObjAbstract *newStatement(DictuVM *vm, Database *db, sqlite3_stmt *stmt);
+
+static void releaseDatabase(Database *db) {
+    LOCK_DATABASE(db);
+    bool last = --db->references == 0;
+    UNLOCK_DATABASE(db);
+
+    if (!last) {
+        return;
+    }
+
+    if (db->open) {
+        sqlite3_close_v2(db->db);
+        db->open = false;
+    }
+
+#ifndef _WIN32
+    pthread_mutex_destroy(&db->lock);
+#endif
+    free(db);
+}
 
 static int countParameters(char *query) {
     int length = strlen(query);
@@ -27,7 +79,26 @@ static int countParameters(char *query) {
 
 void bindValue(sqlite3_stmt *stmt, int index, Value value) {
     if (IS_NUMBER(value)) {
-        sqlite3_bind_double(stmt, index, AS_NUMBER(value));
+        double number = AS_NUMBER(value);
+
+        // Whole numbers are bound as integers, so a TEXT column stores 1 rather than 1.0
+        if (fabs(number) <= MAX_EXACT_INTEGER && number == (sqlite3_int64) number) {
+            sqlite3_bind_int64(stmt, index, (sqlite3_int64) number);
+        } else {
+            sqlite3_bind_double(stmt, index, number);
+        }
+
+        return;
+    }
+
+    if (IS_BOOL(value)) {
+        sqlite3_bind_int(stmt, index, AS_BOOL(value));
+        return;
+    }
+
+    if (IS_BUFFER(value)) {
+        Buffer *buffer = AS_BUFFER(value);
+        sqlite3_bind_blob(stmt, index, buffer->bytes, buffer->size, SQLITE_TRANSIENT);
         return;
     }
 
@@ -39,7 +110,68 @@ void bindValue(sqlite3_stmt *stmt, int index, Value value) {
     if (IS_STRING(value)) {
         ObjString *string = AS_STRING(value);
         sqlite3_bind_text(stmt, index, string->chars, string->length, SQLITE_TRANSIENT);
+        return;
     }
+
+    // Statements are reused, so nothing may be left over from the last bind
+    sqlite3_bind_null(stmt, index);
+}
+
+static Value newBlob(DictuVM *vm, const void *bytes, int length) {
+    ObjAbstract *buffer = newBufferObj(vm, length);
+
+    if (length > 0) {
+        memcpy(((Buffer *) buffer->data)->bytes, bytes, length);
+    }
+
+    return OBJ_VAL(buffer);
+}
+
+// The caller must root the value before allocating again
+static Value readColumn(DictuVM *vm, sqlite3_stmt *stmt, int column) {
+    switch (sqlite3_column_type(stmt, column)) {
+        case SQLITE_INTEGER: {
+            // Exact up to 2^53, the same as any other Dictu number
+            return NUMBER_VAL((double) sqlite3_column_int64(stmt, column));
+        }
+
+        case SQLITE_FLOAT: {
+            return NUMBER_VAL(sqlite3_column_double(stmt, column));
+        }
+
+        case SQLITE_TEXT: {
+            char *text = (char *)sqlite3_column_text(stmt, column);
+            return OBJ_VAL(copyString(vm, text, sqlite3_column_bytes(stmt, column)));
+        }
+
+        case SQLITE_BLOB: {
+            const void *bytes = sqlite3_column_blob(stmt, column);
+            return newBlob(vm, bytes, sqlite3_column_bytes(stmt, column));
+        }
+
+        default: {
+            return NIL_VAL;
+        }
+    }
+}
+
+// Returns the current row of the statement as a list, the caller must root it
+static ObjList *readRow(DictuVM *vm, sqlite3_stmt *stmt) {
+    ObjList *rowList = newList(vm);
+    push(vm, OBJ_VAL(rowList));
+
+    int columnCount = sqlite3_column_count(stmt);
+
+    for (int i = 0; i < columnCount; i++) {
+        Value value = readColumn(vm, stmt, i);
+        push(vm, value);
+        writeValueArray(vm, &rowList->values, value);
+        pop(vm);
+    }
+
+    pop(vm);
+
+    return rowList;
 }
 
 static Value execute(DictuVM *vm, int argCount, Value *args) {
@@ -80,11 +212,13 @@ static Value execute(DictuVM *vm, int argCount, Value *args) {
     }
 
     Result result;
+    LOCK_DATABASE(db);
 
     int err = sqlite3_prepare_v2(db->db, sql, -1, &result.stmt, NULL);
     if (err != SQLITE_OK) {
-        char *error = (char *)sqlite3_errmsg(db->db);
-        return newResultError(vm, error);
+        Value error = newResultError(vm, (char *)sqlite3_errmsg(db->db));
+        UNLOCK_DATABASE(db);
+        return error;
     }
 
     if (parameterCount != 0 && list != NULL) {
@@ -110,54 +244,890 @@ static Value execute(DictuVM *vm, int argCount, Value *args) {
             }
 
             sqlite3_finalize(result.stmt);
-            char *error = (char *)sqlite3_errmsg(db->db);
+            Value error = newResultError(vm, (char *)sqlite3_errmsg(db->db));
+            UNLOCK_DATABASE(db);
             pop(vm);
-            return newResultError(vm, error);
+            return error;
         }
 
         returnValue = true;
 
-        ObjList *rowList = newList(vm);
+        ObjList *rowList = readRow(vm, result.stmt);
         push(vm, OBJ_VAL(rowList));
+        writeValueArray(vm, &finalList->values, OBJ_VAL(rowList));
+        pop(vm);
+    }
 
-        for (int i = 0; i < sqlite3_column_count(result.stmt); i++) {
-            switch (sqlite3_column_type(result.stmt, i)) {
-                case SQLITE_NULL: {
-                    writeValueArray(vm, &rowList->values, NIL_VAL);
-                    break;
-                }
+    sqlite3_finalize(result.stmt);
+    UNLOCK_DATABASE(db);
+    pop(vm);
 
-                case SQLITE_INTEGER:
-                case SQLITE_FLOAT: {
-                    writeValueArray(vm, &rowList->values, NUMBER_VAL(sqlite3_column_double(result.stmt, i)));
-                    break;
-                }
+    if (returnValue) {
+        return newResultSuccess(vm, OBJ_VAL(finalList));
+    }
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
+typedef struct {
+    int type;
+    double number;
+    // The bytes of a text or blob cell
+    char *text;
+    int length;
+} Cell;
+
+static char *copyBytes(const void *bytes, int length) {
+    char *copy = malloc(length + 1);
+    memcpy(copy, bytes, length);
+    copy[length] = '\0';
+
+    return copy;
+}
 
-                case SQLITE_TEXT: {
-                    char *s = (char *)sqlite3_column_text(result.stmt, i);
-                    ObjString *string = copyString(vm, s, strlen(s));
-                    push(vm, OBJ_VAL(string));
-                    writeValueArray(vm, &rowList->values, OBJ_VAL(string));
-                    pop(vm);
-                    break;
+typedef struct {
+    Database *db;
+    char *sql;
+    Cell *parameters;
+    int parameterCount;
+    Cell *cells;
+    int cellCount;
+    int cellCapacity;
+    int columnCount;
+    bool returnValue;
+    char *error;
+} ExecuteRequest;
+
+static void copyCell(Cell *cell, Value value) {
+    cell->type = SQLITE_NULL;
+    cell->text = NULL;
+
+    if (IS_NUMBER(value)) {
+        cell->type = SQLITE_FLOAT;
+        cell->number = AS_NUMBER(value);
+    } else if (IS_BOOL(value)) {
+        cell->type = SQLITE_INTEGER;
+        cell->number = AS_BOOL(value);
+    } else if (IS_STRING(value)) {
+        cell->type = SQLITE_TEXT;
+        cell->length = AS_STRING(value)->length;
+        cell->text = copyBytes(AS_CSTRING(value), cell->length);
+    } else if (IS_BUFFER(value)) {
+        cell->type = SQLITE_BLOB;
+        cell->length = AS_BUFFER(value)->size;
+        cell->text = copyBytes(AS_BUFFER(value)->bytes, cell->length);
+    }
+}
+
+static void freeExecuteRequest(void *data) {
+    ExecuteRequest *request = data;
+
+    for (int i = 0; i < request->parameterCount; ++i) {
+        free(request->parameters[i].text);
+    }
+
+    for (int i = 0; i < request->cellCount; ++i) {
+        free(request->cells[i].text);
+    }
+
+    free(request->sql);
+    free(request->parameters);
+    free(request->cells);
+    free(request->error);
+    free(request);
+}
+
+static void executeWork(void *data) {
+    ExecuteRequest *request = data;
+    Database *db = request->db;
+    sqlite3_stmt *stmt;
+
+    LOCK_DATABASE(db);
+
+    if (!db->open) {
+        request->error = strdup("Database connection is closed");
+        UNLOCK_DATABASE(db);
+        releaseDatabase(db);
+        return;
+    }
+
+    int err = sqlite3_prepare_v2(db->db, request->sql, -1, &stmt, NULL);
+    if (err != SQLITE_OK) {
+        request->error = strdup(sqlite3_errmsg(db->db));
+        UNLOCK_DATABASE(db);
+        releaseDatabase(db);
+        return;
+    }
+
+    for (int i = 0; i < request->parameterCount; ++i) {
+        Cell *parameter = &request->parameters[i];
+
+        if (parameter->type == SQLITE_FLOAT) {
+            bindValue(stmt, i + 1, NUMBER_VAL(parameter->number));
+        } else if (parameter->type == SQLITE_INTEGER) {
+            sqlite3_bind_int(stmt, i + 1, (int) parameter->number);
+        } else if (parameter->type == SQLITE_TEXT) {
+            sqlite3_bind_text(stmt, i + 1, parameter->text, parameter->length, SQLITE_TRANSIENT);
+        } else if (parameter->type == SQLITE_BLOB) {
+            sqlite3_bind_blob(stmt, i + 1, parameter->text, parameter->length, SQLITE_TRANSIENT);
+        } else {
+            sqlite3_bind_null(stmt, i + 1);
+        }
+    }
+
+    request->columnCount = sqlite3_column_count(stmt);
+
+    for (;;) {
+        err = sqlite3_step(stmt);
+        if (err != SQLITE_ROW) {
+            if (err == SQLITE_DONE) {
+                if (request->sql[0] == 'S' || request->sql[0] == 's') {
+                    // If a select statement returns no results SQLITE_ROW is not used.
+                    request->returnValue = true;
                 }
+
+                break;
             }
+
+            sqlite3_finalize(stmt);
+            request->error = strdup(sqlite3_errmsg(db->db));
+            UNLOCK_DATABASE(db);
+            releaseDatabase(db);
+            return;
+        }
+
+        request->returnValue = true;
+
+        if (request->cellCount + request->columnCount > request->cellCapacity) {
+            request->cellCapacity = request->cellCapacity < 8 ? 8 : request->cellCapacity * 2;
+
+            while (request->cellCapacity < request->cellCount + request->columnCount) {
+                request->cellCapacity *= 2;
+            }
+
+            request->cells = realloc(request->cells, sizeof(Cell) * request->cellCapacity);
+        }
+
+        for (int i = 0; i < request->columnCount; i++) {
+            Cell *cell = &request->cells[request->cellCount++];
+            cell->type = sqlite3_column_type(stmt, i);
+            cell->text = NULL;
+
+            if (cell->type == SQLITE_INTEGER) {
+                cell->number = (double) sqlite3_column_int64(stmt, i);
+            } else if (cell->type == SQLITE_FLOAT) {
+                cell->number = sqlite3_column_double(stmt, i);
+            } else if (cell->type == SQLITE_TEXT) {
+                cell->length = sqlite3_column_bytes(stmt, i);
+                cell->text = copyBytes(sqlite3_column_text(stmt, i), cell->length);
+            } else if (cell->type == SQLITE_BLOB) {
+                // Read the blob before its length, the other way around is only safe for text
+                const void *bytes = sqlite3_column_blob(stmt, i);
+                cell->length = sqlite3_column_bytes(stmt, i);
+                cell->text = copyBytes(bytes, cell->length);
+            }
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    UNLOCK_DATABASE(db);
+    releaseDatabase(db);
+}
+
+static Value executeComplete(DictuVM *vm, void *data) {
+    ExecuteRequest *request = data;
+
+    if (request->error != NULL) {
+        Value error = newResultError(vm, request->error);
+        freeExecuteRequest(request);
+        return error;
+    }
+
+    if (!request->returnValue) {
+        freeExecuteRequest(request);
+        return newResultSuccess(vm, NIL_VAL);
+    }
+
+    ObjList *finalList = newList(vm);
+    push(vm, OBJ_VAL(finalList));
+
+    for (int row = 0; row < request->cellCount; row += request->columnCount) {
+        ObjList *rowList = newList(vm);
+        push(vm, OBJ_VAL(rowList));
+
+        for (int i = row; i < row + request->columnCount; i++) {
+            Cell *cell = &request->cells[i];
+            Value value = NIL_VAL;
+
+            if (cell->type == SQLITE_INTEGER || cell->type == SQLITE_FLOAT) {
+                value = NUMBER_VAL(cell->number);
+            } else if (cell->type == SQLITE_TEXT) {
+                value = OBJ_VAL(copyString(vm, cell->text, cell->length));
+            } else if (cell->type == SQLITE_BLOB) {
+                value = newBlob(vm, cell->text, cell->length);
+            }
+
+            push(vm, value);
+            writeValueArray(vm, &rowList->values, value);
+            pop(vm);
         }
 
         writeValueArray(vm, &finalList->values, OBJ_VAL(rowList));
         pop(vm);
     }
 
-    sqlite3_finalize(result.stmt);
+    freeExecuteRequest(request);
+    Value result = newResultSuccess(vm, OBJ_VAL(finalList));
     pop(vm);
 
-    if (returnValue) {
-        return newResultSuccess(vm, OBJ_VAL(finalList));
+    return result;
+}
+
+static Value executeAsync(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1 && argCount != 2) {
+        runtimeError(vm, "executeAsync() takes 1 or 2 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[1])) {
+        runtimeError(vm, "executeAsync() first argument must be a string.");
+        return EMPTY_VAL;
+    }
+
+    Database *db = AS_SQLITE_DATABASE(args[0]);
+    char *sql = AS_CSTRING(args[1]);
+    ObjList *list = NULL;
+    int parameterCount = countParameters(sql);
+    int argumentCount = 0;
+
+    if (argCount == 2) {
+        if (!IS_LIST(args[2])) {
+            runtimeError(vm, "executeAsync() second argument must be a list.");
+            return EMPTY_VAL;
+        }
+
+        list = AS_LIST(args[2]);
+        argumentCount = list->values.count;
+    }
+
+    if (parameterCount != argumentCount) {
+        runtimeError(vm, "executeAsync() has %d parameters but %d were given", parameterCount, argumentCount);
+        return EMPTY_VAL;
+    }
+
+    // The pool thread only sees C copies of the query and its parameters
+    ExecuteRequest *request = malloc(sizeof(ExecuteRequest));
+    memset(request, 0, sizeof(ExecuteRequest));
+    request->db = db;
+    LOCK_DATABASE(db);
+    db->references++;
+    UNLOCK_DATABASE(db);
+    request->sql = strdup(sql);
+    request->parameterCount = parameterCount;
+    request->parameters = malloc(sizeof(Cell) * (parameterCount + 1));
+
+    for (int i = 0; i < parameterCount; ++i) {
+        copyCell(&request->parameters[i], list->values.values[i]);
+    }
+
+    return newFuture(vm, NIL_VAL, request, executeWork, executeComplete, freeExecuteRequest);
+}
+
+// Must be called with the connection locked
+static char *statementUnusable(Statement *statement) {
+    if (statement->stmt == NULL) {
+        return "Statement has been finalized";
+    }
+
+    if (!statement->db->open) {
+        return "Database connection is closed";
+    }
+
+    return NULL;
+}
+
+static bool checkBindings(DictuVM *vm, sqlite3_stmt *stmt, Value value, const char *method) {
+    if (!IS_LIST(value)) {
+        runtimeError(vm, "%s() argument must be a list.", method);
+        return false;
     }
 
+    int parameterCount = sqlite3_bind_parameter_count(stmt);
+    int argumentCount = AS_LIST(value)->values.count;
+
+    if (parameterCount != argumentCount) {
+        runtimeError(vm, "%s() has %d parameters but %d were given", method, parameterCount, argumentCount);
+        return false;
+    }
+
+    return true;
+}
+
+static void bindList(sqlite3_stmt *stmt, ObjList *list) {
+    for (int i = 0; i < list->values.count; ++i) {
+        bindValue(stmt, i + 1, list->values.values[i]);
+    }
+}
+
+static Value bindStatement(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "bind() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Statement *statement = AS_SQLITE_STATEMENT(args[0]);
+    LOCK_DATABASE(statement->db);
+
+    char *error = statementUnusable(statement);
+    if (error != NULL) {
+        UNLOCK_DATABASE(statement->db);
+        return newResultError(vm, error);
+    }
+
+    if (!checkBindings(vm, statement->stmt, args[1], "bind")) {
+        UNLOCK_DATABASE(statement->db);
+        return EMPTY_VAL;
+    }
+
+    sqlite3_reset(statement->stmt);
+    statement->done = false;
+    bindList(statement->stmt, AS_LIST(args[1]));
+    UNLOCK_DATABASE(statement->db);
+
     return newResultSuccess(vm, NIL_VAL);
 }
 
+typedef enum {
+    ROWS_LISTS,
+    ROWS_DICTS,
+    // One list per column rather than one per row
+    ROWS_COLUMNS
+} RowFormat;
+
+// Column names are interned once per statement rather than once per row
+static ObjList *statementColumns(DictuVM *vm, Statement *statement) {
+    if (statement->columns != NULL) {
+        return statement->columns;
+    }
+
+    ObjList *columns = newList(vm);
+    push(vm, OBJ_VAL(columns));
+
+    int columnCount = sqlite3_column_count(statement->stmt);
+
+    for (int i = 0; i < columnCount; ++i) {
+        const char *name = sqlite3_column_name(statement->stmt, i);
+        Value column = OBJ_VAL(copyString(vm, name, strlen(name)));
+        push(vm, column);
+        writeValueArray(vm, &columns->values, column);
+        pop(vm);
+    }
+
+    statement->columns = columns;
+    pop(vm);
+
+    return columns;
+}
+
+// Returns the current row of the statement as a dict, the caller must root it
+static ObjDict *readDict(DictuVM *vm, Statement *statement) {
+    ObjList *columns = statementColumns(vm, statement);
+    ObjDict *row = newDict(vm);
+    push(vm, OBJ_VAL(row));
+
+    for (int i = 0; i < columns->values.count; ++i) {
+        Value value = readColumn(vm, statement->stmt, i);
+        push(vm, value);
+        dictSet(vm, row, columns->values.values[i], value);
+        pop(vm);
+    }
+
+    pop(vm);
+
+    return row;
+}
+
+static Value stepWith(DictuVM *vm, int argCount, Value *args, const char *method, RowFormat format) {
+    if (argCount != 0) {
+        runtimeError(vm, "%s() takes no arguments (%d given)", method, argCount);
+        return EMPTY_VAL;
+    }
+
+    Statement *statement = AS_SQLITE_STATEMENT(args[0]);
+    LOCK_DATABASE(statement->db);
+
+    char *error = statementUnusable(statement);
+    if (error != NULL) {
+        UNLOCK_DATABASE(statement->db);
+        return newResultError(vm, error);
+    }
+
+    // SQLite would start the statement again, only reset() or bind() does that here
+    if (statement->done) {
+        UNLOCK_DATABASE(statement->db);
+        return newResultSuccess(vm, NIL_VAL);
+    }
+
+    int err = sqlite3_step(statement->stmt);
+
+    if (err == SQLITE_ROW) {
+        Value row = format == ROWS_DICTS ? OBJ_VAL(readDict(vm, statement)) : OBJ_VAL(readRow(vm, statement->stmt));
+        push(vm, row);
+        UNLOCK_DATABASE(statement->db);
+        Value result = newResultSuccess(vm, row);
+        pop(vm);
+
+        return result;
+    }
+
+    if (err == SQLITE_DONE) {
+        statement->done = true;
+        UNLOCK_DATABASE(statement->db);
+        return newResultSuccess(vm, NIL_VAL);
+    }
+
+    Value result = newResultError(vm, (char *)sqlite3_errmsg(statement->db->db));
+    sqlite3_reset(statement->stmt);
+    UNLOCK_DATABASE(statement->db);
+
+    return result;
+}
+
+static Value stepStatement(DictuVM *vm, int argCount, Value *args) {
+    return stepWith(vm, argCount, args, "step", ROWS_LISTS);
+}
+
+static Value stepDictStatement(DictuVM *vm, int argCount, Value *args) {
+    return stepWith(vm, argCount, args, "stepDict", ROWS_DICTS);
+}
+
+static Value executeWith(DictuVM *vm, int argCount, Value *args, const char *method, RowFormat format) {
+    if (argCount != 0 && argCount != 1) {
+        runtimeError(vm, "%s() takes 0 or 1 arguments (%d given)", method, argCount);
+        return EMPTY_VAL;
+    }
+
+    Statement *statement = AS_SQLITE_STATEMENT(args[0]);
+    LOCK_DATABASE(statement->db);
+
+    char *error = statementUnusable(statement);
+    if (error != NULL) {
+        UNLOCK_DATABASE(statement->db);
+        return newResultError(vm, error);
+    }
+
+    sqlite3_reset(statement->stmt);
+    statement->done = false;
+
+    if (argCount == 1) {
+        if (!checkBindings(vm, statement->stmt, args[1], method)) {
+            UNLOCK_DATABASE(statement->db);
+            return EMPTY_VAL;
+        }
+
+        bindList(statement->stmt, AS_LIST(args[1]));
+    }
+
+    Value rows;
+    // Only used for ROWS_COLUMNS, the list each column is read into
+    ObjList *columnLists = NULL;
+
+    if (format == ROWS_COLUMNS) {
+        ObjList *columns = statementColumns(vm, statement);
+        ObjDict *dict = newDict(vm);
+        rows = OBJ_VAL(dict);
+        push(vm, rows);
+
+        // A duplicated column name only keeps the last column in the dict
+        columnLists = newList(vm);
+        push(vm, OBJ_VAL(columnLists));
+
+        for (int i = 0; i < columns->values.count; ++i) {
+            Value list = OBJ_VAL(newList(vm));
+            push(vm, list);
+            writeValueArray(vm, &columnLists->values, list);
+            dictSet(vm, dict, columns->values.values[i], list);
+            pop(vm);
+        }
+    } else {
+        rows = OBJ_VAL(newList(vm));
+        push(vm, rows);
+    }
+
+    int err;
+    while ((err = sqlite3_step(statement->stmt)) == SQLITE_ROW) {
+        if (format == ROWS_COLUMNS) {
+            for (int i = 0; i < columnLists->values.count; ++i) {
+                Value value = readColumn(vm, statement->stmt, i);
+                push(vm, value);
+                writeValueArray(vm, &AS_LIST(columnLists->values.values[i])->values, value);
+                pop(vm);
+            }
+
+            continue;
+        }
+
+        Value row = format == ROWS_DICTS ? OBJ_VAL(readDict(vm, statement)) : OBJ_VAL(readRow(vm, statement->stmt));
+        push(vm, row);
+        writeValueArray(vm, &AS_LIST(rows)->values, row);
+        pop(vm);
+    }
+
+    Value result;
+
+    if (err != SQLITE_DONE) {
+        result = newResultError(vm, (char *)sqlite3_errmsg(statement->db->db));
+    } else if (sqlite3_column_count(statement->stmt) > 0) {
+        result = newResultSuccess(vm, rows);
+    } else {
+        result = newResultSuccess(vm, NIL_VAL);
+    }
+
+    sqlite3_reset(statement->stmt);
+    UNLOCK_DATABASE(statement->db);
+
+    if (columnLists != NULL) {
+        pop(vm);
+    }
+
+    pop(vm);
+
+    return result;
+}
+
+static Value executeStatement(DictuVM *vm, int argCount, Value *args) {
+    return executeWith(vm, argCount, args, "execute", ROWS_LISTS);
+}
+
+static Value executeDictsStatement(DictuVM *vm, int argCount, Value *args) {
+    return executeWith(vm, argCount, args, "executeDicts", ROWS_DICTS);
+}
+
+static Value executeColumnsStatement(DictuVM *vm, int argCount, Value *args) {
+    return executeWith(vm, argCount, args, "executeColumns", ROWS_COLUMNS);
+}
+
+static Value resetStatement(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "reset() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Statement *statement = AS_SQLITE_STATEMENT(args[0]);
+    LOCK_DATABASE(statement->db);
+
+    if (statement->stmt != NULL) {
+        sqlite3_reset(statement->stmt);
+    }
+
+    statement->done = false;
+    UNLOCK_DATABASE(statement->db);
+
+    return NIL_VAL;
+}
+
+static Value columnsStatement(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "columns() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Statement *statement = AS_SQLITE_STATEMENT(args[0]);
+    LOCK_DATABASE(statement->db);
+
+    if (statement->stmt == NULL && statement->columns == NULL) {
+        UNLOCK_DATABASE(statement->db);
+        return OBJ_VAL(newList(vm));
+    }
+
+    ObjList *columns = statementColumns(vm, statement);
+    UNLOCK_DATABASE(statement->db);
+
+    // A copy, so the cached names can't be changed underneath the statement
+    ObjList *list = newList(vm);
+    push(vm, OBJ_VAL(list));
+
+    for (int i = 0; i < columns->values.count; ++i) {
+        writeValueArray(vm, &list->values, columns->values.values[i]);
+    }
+
+    pop(vm);
+
+    return OBJ_VAL(list);
+}
+
+static void finalizeStatement(Statement *statement) {
+    LOCK_DATABASE(statement->db);
+
+    if (statement->stmt != NULL) {
+        sqlite3_finalize(statement->stmt);
+        statement->stmt = NULL;
+    }
+
+    UNLOCK_DATABASE(statement->db);
+}
+
+static Value finalizeStatementNative(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "finalize() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    finalizeStatement(AS_SQLITE_STATEMENT(args[0]));
+
+    return NIL_VAL;
+}
+
+static Value prepare(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "prepare() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[1])) {
+        runtimeError(vm, "prepare() argument must be a string.");
+        return EMPTY_VAL;
+    }
+
+    Database *db = AS_SQLITE_DATABASE(args[0]);
+    ObjString *sql = AS_STRING(args[1]);
+    sqlite3_stmt *stmt;
+    const char *tail;
+
+    LOCK_DATABASE(db);
+
+    if (!db->open) {
+        UNLOCK_DATABASE(db);
+        return newResultError(vm, "Database connection is closed");
+    }
+
+    int err = sqlite3_prepare_v3(db->db, sql->chars, sql->length, SQLITE_PREPARE_PERSISTENT, &stmt, &tail);
+    if (err != SQLITE_OK) {
+        Value error = newResultError(vm, (char *)sqlite3_errmsg(db->db));
+        UNLOCK_DATABASE(db);
+        return error;
+    }
+
+    // Only the first statement would ever run, so anything after it is refused
+    while (*tail != '\0' && (isspace((unsigned char) *tail) || *tail == ';')) {
+        tail++;
+    }
+
+    if (stmt == NULL || *tail != '\0') {
+        sqlite3_finalize(stmt);
+        UNLOCK_DATABASE(db);
+        return newResultError(vm, "prepare() takes exactly one statement");
+    }
+
+    db->references++;
+    UNLOCK_DATABASE(db);
+
+    return newResultSuccess(vm, OBJ_VAL(newStatement(vm, db, stmt)));
+}
+
+// Rolling back to a savepoint leaves it open, so it is released afterwards
+static void rollbackExecuteMany(Database *db) {
+    sqlite3_exec(db->db, "ROLLBACK TO executeMany", NULL, NULL, NULL);
+    sqlite3_exec(db->db, "RELEASE executeMany", NULL, NULL, NULL);
+}
+
+static Value executeMany(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 2) {
+        runtimeError(vm, "executeMany() takes 2 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[1])) {
+        runtimeError(vm, "executeMany() first argument must be a string.");
+        return EMPTY_VAL;
+    }
+
+    if (!IS_LIST(args[2])) {
+        runtimeError(vm, "executeMany() second argument must be a list.");
+        return EMPTY_VAL;
+    }
+
+    Database *db = AS_SQLITE_DATABASE(args[0]);
+    ObjString *sql = AS_STRING(args[1]);
+    ObjList *rows = AS_LIST(args[2]);
+    sqlite3_stmt *stmt;
+
+    LOCK_DATABASE(db);
+
+    if (!db->open) {
+        UNLOCK_DATABASE(db);
+        return newResultError(vm, "Database connection is closed");
+    }
+
+    int err = sqlite3_prepare_v2(db->db, sql->chars, sql->length, &stmt, NULL);
+    if (err != SQLITE_OK) {
+        Value error = newResultError(vm, (char *)sqlite3_errmsg(db->db));
+        UNLOCK_DATABASE(db);
+        return error;
+    }
+
+    // Every row is checked up front so a bad one never leaves half the batch applied
+    for (int i = 0; i < rows->values.count; ++i) {
+        if (!checkBindings(vm, stmt, rows->values.values[i], "executeMany")) {
+            sqlite3_finalize(stmt);
+            UNLOCK_DATABASE(db);
+            return EMPTY_VAL;
+        }
+    }
+
+    // A savepoint starts a transaction of its own outside of one, and nests
+    // inside a transaction the caller opened, so either way a failing row
+    // undoes every row of the batch and nothing else
+    if (sqlite3_exec(db->db, "SAVEPOINT executeMany", NULL, NULL, NULL) != SQLITE_OK) {
+        Value error = newResultError(vm, (char *)sqlite3_errmsg(db->db));
+        sqlite3_finalize(stmt);
+        UNLOCK_DATABASE(db);
+        return error;
+    }
+
+    for (int i = 0; i < rows->values.count; ++i) {
+        bindList(stmt, AS_LIST(rows->values.values[i]));
+
+        while ((err = sqlite3_step(stmt)) == SQLITE_ROW);
+
+        if (err != SQLITE_DONE) {
+            Value error = newResultError(vm, (char *)sqlite3_errmsg(db->db));
+            sqlite3_finalize(stmt);
+            rollbackExecuteMany(db);
+            UNLOCK_DATABASE(db);
+            return error;
+        }
+
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_exec(db->db, "RELEASE executeMany", NULL, NULL, NULL) != SQLITE_OK) {
+        Value error = newResultError(vm, (char *)sqlite3_errmsg(db->db));
+        rollbackExecuteMany(db);
+        UNLOCK_DATABASE(db);
+        return error;
+    }
+
+    UNLOCK_DATABASE(db);
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
+static Value runSql(DictuVM *vm, Database *db, const char *sql) {
+    LOCK_DATABASE(db);
+
+    if (!db->open) {
+        UNLOCK_DATABASE(db);
+        return newResultError(vm, "Database connection is closed");
+    }
+
+    if (sqlite3_exec(db->db, sql, NULL, NULL, NULL) != SQLITE_OK) {
+        Value error = newResultError(vm, (char *)sqlite3_errmsg(db->db));
+        UNLOCK_DATABASE(db);
+        return error;
+    }
+
+    UNLOCK_DATABASE(db);
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
+static Value begin(DictuVM *vm, int argCount, Value *args) {
+    if (argCount > 1) {
+        runtimeError(vm, "begin() takes 0 or 1 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    char *sql = "BEGIN";
+
+    if (argCount == 1) {
+        if (!IS_STRING(args[1])) {
+            runtimeError(vm, "begin() argument must be a string.");
+            return EMPTY_VAL;
+        }
+
+        char *mode = AS_CSTRING(args[1]);
+
+        if (strcmp(mode, "deferred") == 0) {
+            sql = "BEGIN DEFERRED";
+        } else if (strcmp(mode, "immediate") == 0) {
+            sql = "BEGIN IMMEDIATE";
+        } else if (strcmp(mode, "exclusive") == 0) {
+            sql = "BEGIN EXCLUSIVE";
+        } else {
+            runtimeError(vm, "begin() argument must be one of 'deferred', 'immediate' or 'exclusive'.");
+            return EMPTY_VAL;
+        }
+    }
+
+    return runSql(vm, AS_SQLITE_DATABASE(args[0]), sql);
+}
+
+static Value commit(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "commit() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    return runSql(vm, AS_SQLITE_DATABASE(args[0]), "COMMIT");
+}
+
+static Value rollback(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "rollback() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    return runSql(vm, AS_SQLITE_DATABASE(args[0]), "ROLLBACK");
+}
+
+static Value runSavepointSql(DictuVM *vm, int argCount, Value *args, const char *method, const char *format) {
+    if (argCount != 1) {
+        runtimeError(vm, "%s() takes 1 argument (%d given)", method, argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[1])) {
+        runtimeError(vm, "%s() argument must be a string.", method);
+        return EMPTY_VAL;
+    }
+
+    // %w quotes the name as an identifier
+    char *sql = sqlite3_mprintf(format, AS_CSTRING(args[1]));
+    Value result = runSql(vm, AS_SQLITE_DATABASE(args[0]), sql);
+    sqlite3_free(sql);
+
+    return result;
+}
+
+static Value savepoint(DictuVM *vm, int argCount, Value *args) {
+    return runSavepointSql(vm, argCount, args, "savepoint", "SAVEPOINT \"%w\"");
+}
+
+static Value release(DictuVM *vm, int argCount, Value *args) {
+    return runSavepointSql(vm, argCount, args, "release", "RELEASE \"%w\"");
+}
+
+static Value rollbackTo(DictuVM *vm, int argCount, Value *args) {
+    return runSavepointSql(vm, argCount, args, "rollbackTo", "ROLLBACK TO \"%w\"");
+}
+
+static Value inTransaction(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "inTransaction() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Database *db = AS_SQLITE_DATABASE(args[0]);
+    LOCK_DATABASE(db);
+    bool active = db->open && !sqlite3_get_autocommit(db->db);
+    UNLOCK_DATABASE(db);
+
+    return BOOL_VAL(active);
+}
+
 static Value closeConnection(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 0) {
         runtimeError(vm, "close() takes no arguments (%d given)", argCount);
@@ -165,12 +1135,17 @@ static Value closeConnection(DictuVM *vm, int argCount, Value *args) {
     }
 
     Database *db = AS_SQLITE_DATABASE(args[0]);
+    LOCK_DATABASE(db);
 
+    // Statements that are still alive turn the connection into a zombie
+    // that is closed once the last of them is finalized
     if (db->open) {
-        sqlite3_close(db->db);
+        sqlite3_close_v2(db->db);
         db->open = false;
     }
 
+    UNLOCK_DATABASE(db);
+
     return NIL_VAL;
 }
 
@@ -223,12 +1198,9 @@ static Value connectSqlite(DictuVM *vm, int argCount, Value *args) {
 }
 
 void freeSqlite(DictuVM *vm, ObjAbstract *abstract) {
-    Database *db = (Database*)abstract->data;
-    if (db->open) {
-        sqlite3_close(db->db);
-        db->open = false;
-    }
-    FREE(vm, Database, abstract->data);
+    UNUSED(vm);
+
+    releaseDatabase((Database*)abstract->data);
 }
 
 char *sqliteToString(ObjAbstract *abstract) {
@@ -239,17 +1211,93 @@ char *sqliteToString(ObjAbstract *abstract) {
     return sqliteString;
 }
 
+void grayStatement(DictuVM *vm, ObjAbstract *abstract) {
+    Statement *statement = abstract->data;
+
+    if (statement != NULL && statement->columns != NULL) {
+        grayObject(vm, (Obj *) statement->columns);
+    }
+}
+
+void freeStatement(DictuVM *vm, ObjAbstract *abstract) {
+    UNUSED(vm);
+
+    Statement *statement = abstract->data;
+    finalizeStatement(statement);
+    releaseDatabase(statement->db);
+    free(statement);
+}
+
+char *statementToString(ObjAbstract *abstract) {
+    UNUSED(abstract);
+
+    char *statementString = malloc(sizeof(char) * 18);
+    snprintf(statementString, 18, "<SqliteStatement>");
+    return statementString;
+}
+
+ObjAbstract *newStatement(DictuVM *vm, Database *db, sqlite3_stmt *stmt) {
+    ObjAbstract *abstract = newAbstract(vm, freeStatement, statementToString);
+    push(vm, OBJ_VAL(abstract));
+
+    Statement *statement = malloc(sizeof(Statement));
+    statement->db = db;
+    statement->stmt = stmt;
+    statement->done = false;
+    statement->columns = NULL;
+
+    /**
+     * Setup Statement object methods
+     */
+    defineNative(vm, &abstract->values, "bind", bindStatement);
+    defineNative(vm, &abstract->values, "step", stepStatement);
+    defineNative(vm, &abstract->values, "stepDict", stepDictStatement);
+    defineNative(vm, &abstract->values, "execute", executeStatement);
+    defineNative(vm, &abstract->values, "executeDicts", executeDictsStatement);
+    defineNative(vm, &abstract->values, "executeColumns", executeColumnsStatement);
+    defineNative(vm, &abstract->values, "reset", resetStatement);
+    defineNative(vm, &abstract->values, "columns", columnsStatement);
+    defineNative(vm, &abstract->values, "finalize", finalizeStatementNative);
+
+    abstract->data = statement;
+    abstract->grayFunc = grayStatement;
+    pop(vm);
+
+    return abstract;
+}
+
 ObjAbstract *newSqlite(DictuVM *vm) {
     ObjAbstract *abstract = newAbstract(vm, freeSqlite, sqliteToString);
     push(vm, OBJ_VAL(abstract));
 
-    Database *db = ALLOCATE(vm, Database, 1);
+    // Shared with the native thread pool so it lives outside the VM's heap
+    Database *db = malloc(sizeof(Database));
     db->open = true;
+    db->references = 1;
+#ifndef _WIN32
+    // Allocating while a statement runs can collect a statement on the same
+    // connection, which takes the lock again to finalize it
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&db->lock, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+#endif
 
     /**
      * Setup Sqlite object methods
      */
     defineNative(vm, &abstract->values, "execute", execute);
+    defineNative(vm, &abstract->values, "executeAsync", executeAsync);
+    defineNative(vm, &abstract->values, "executeMany", executeMany);
+    defineNative(vm, &abstract->values, "prepare", prepare);
+    defineNative(vm, &abstract->values, "begin", begin);
+    defineNative(vm, &abstract->values, "commit", commit);
+    defineNative(vm, &abstract->values, "rollback", rollback);
+    defineNative(vm, &abstract->values, "savepoint", savepoint);
+    defineNative(vm, &abstract->values, "release", release);
+    defineNative(vm, &abstract->values, "rollbackTo", rollbackTo);
+    defineNative(vm, &abstract->values, "inTransaction", inTransaction);
     defineNative(vm, &abstract->values, "close", closeConnection);
 
     abstract->data = db;
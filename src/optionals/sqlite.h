@@ -8,8 +8,16 @@
 #endif
 
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include <ctype.h>
+
 #include "optionals.h"
 #include "../vm/vm.h"
+#include "../vm/future.h"
+#include "buffer.h"
 
 Value createSqliteModule(DictuVM *vm);
 
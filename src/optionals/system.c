@@ -411,6 +411,19 @@ static Value clockNative(DictuVM *vm, int argCount, Value *args) {
     return NUMBER_VAL((double) clock() / CLOCKS_PER_SEC);
 }
 
+static Value monotonicNative(DictuVM *vm, int argCount, Value *args) {
+    UNUSED(vm); UNUSED(argCount); UNUSED(args);
+
+#ifdef _WIN32
+    return NUMBER_VAL((double) GetTickCount64() / 1000);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return NUMBER_VAL(now.tv_sec + now.tv_nsec / 1e9);
+#endif
+}
+
 static Value collectNative(DictuVM *vm, int argCount, Value *args) {
     UNUSED(argCount); UNUSED(args);
 
@@ -540,6 +553,36 @@ void initPlatform(DictuVM *vm, Table *table) {
 #endif
 }
 
+void initExecutable(DictuVM *vm, Table *table) {
+#if defined(_WIN32)
+    char path[MAX_PATH];
+    DWORD length = GetModuleFileNameA(NULL, path, MAX_PATH);
+
+    if (length > 0 && length < MAX_PATH) {
+        defineNativeProperty(vm, table, "executable", OBJ_VAL(copyString(vm, path, length)));
+        return;
+    }
+#elif defined(__APPLE__)
+    char path[PATH_MAX];
+    uint32_t size = PATH_MAX;
+
+    if (_NSGetExecutablePath(path, &size) == 0) {
+        defineNativeProperty(vm, table, "executable", OBJ_VAL(copyString(vm, path, strlen(path))));
+        return;
+    }
+#elif defined(__linux__)
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, PATH_MAX);
+
+    if (length > 0 && length < PATH_MAX) {
+        defineNativeProperty(vm, table, "executable", OBJ_VAL(copyString(vm, path, length)));
+        return;
+    }
+#endif
+
+    defineNativeProperty(vm, table, "executable", NIL_VAL);
+}
+
 void setVersion(DictuVM *vm, Table *table) {
     ObjDict *versionDict = newDict(vm);
     push(vm, OBJ_VAL(versionDict));
@@ -604,6 +647,7 @@ Value createSystemModule(DictuVM *vm) {
     defineNative(vm, &module->values, "getCWD", getCWDNative);
     defineNative(vm, &module->values, "time", timeNative);
     defineNative(vm, &module->values, "clock", clockNative);
+    defineNative(vm, &module->values, "monotonic", monotonicNative);
     defineNative(vm, &module->values, "collect", collectNative);
     defineNative(vm, &module->values, "sleep", sleepNative);
     defineNative(vm, &module->values, "exit", exitNative);
@@ -619,6 +663,7 @@ Value createSystemModule(DictuVM *vm) {
     }
 
     initPlatform(vm, &module->values);
+    initExecutable(vm, &module->values);
     setVersion(vm, &module->values);
 
     defineNativeProperty(vm, &module->values, "arch", OBJ_VAL(copyString(vm, SYSTEM_ARCH, strlen(SYSTEM_ARCH))));
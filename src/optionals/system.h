@@ -15,6 +15,9 @@
 #else
 #include <unistd.h>
 #include <sys/utsname.h>
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
 #define HAS_ACCESS
 #define REMOVE unlink
 #define MKDIR(d, m) mkdir(d, m)
@@ -0,0 +1,797 @@
+#include "message.h"
+
+// Deep enough for any reasonable structure while staying well within
+// the stack of a worker thread
+#define MESSAGE_MAX_DEPTH 4096
+#define IDENTITY_MAX_LOAD 0.75
+
+typedef enum {
+    MESSAGE_NIL,
+    MESSAGE_TRUE,
+    MESSAGE_FALSE,
+    MESSAGE_NUMBER,
+    MESSAGE_STRING,
+    MESSAGE_LIST,
+    MESSAGE_TUPLE,
+    MESSAGE_DICT,
+    MESSAGE_SET,
+    MESSAGE_RANGE,
+    MESSAGE_CHANNEL,
+    MESSAGE_FUNCTION,
+    MESSAGE_CLOSURE,
+    MESSAGE_UPVALUE,
+    MESSAGE_MODULE,
+    MESSAGE_BUILTIN_MODULE,
+    MESSAGE_REFERENCE
+} MessageTag;
+
+typedef struct {
+    Obj *object;
+    uint32_t index;
+} IdentityEntry;
+
+typedef struct {
+    DictuVM *vm;
+    Message *message;
+    // Identity map from each object written so far to its number
+    IdentityEntry *entries;
+    int capacity;
+    int count;
+    // Functions whose module variables are yet to be written, they follow
+    // the value so that every object they may refer to already exists
+    ObjFunction **functions;
+    int functionCount;
+    int functionCapacity;
+    char *error;
+} Encoder;
+
+typedef struct {
+    DictuVM *vm;
+    Message *message;
+    size_t position;
+    // Every object decoded so far, in the order they were numbered. This
+    // resolves references and keeps the partially built value reachable.
+    ObjList *objects;
+} Decoder;
+
+static void writeBytes(Message *message, const void *bytes, size_t length) {
+    if (message->length + length > message->capacity) {
+        size_t capacity = message->capacity < 64 ? 64 : message->capacity;
+
+        while (capacity < message->length + length) {
+            capacity *= 2;
+        }
+
+        message->bytes = realloc(message->bytes, capacity);
+        message->capacity = capacity;
+    }
+
+    memcpy(message->bytes + message->length, bytes, length);
+    message->length += length;
+}
+
+static void writeByte(Message *message, uint8_t byte) {
+    writeBytes(message, &byte, 1);
+}
+
+static void writeTag(Message *message, MessageTag tag) {
+    writeByte(message, tag);
+}
+
+static void writeUint32(Message *message, uint32_t value) {
+    writeBytes(message, &value, sizeof(value));
+}
+
+// Strings written this way are not numbered and can not be referenced
+static void writeString(Message *message, ObjString *string) {
+    writeUint32(message, string->length);
+    writeBytes(message, string->chars, string->length);
+}
+
+static void writeDouble(Message *message, double value) {
+    writeBytes(message, &value, sizeof(value));
+}
+
+static uint32_t hashPointer(Obj *object) {
+    return (uint32_t) ((uintptr_t) object >> 4);
+}
+
+static IdentityEntry *findIdentityEntry(IdentityEntry *entries, int capacity, Obj *object) {
+    uint32_t index = hashPointer(object) & (capacity - 1);
+
+    for (;;) {
+        IdentityEntry *entry = &entries[index];
+
+        if (entry->object == NULL || entry->object == object) {
+            return entry;
+        }
+
+        index = (index + 1) & (capacity - 1);
+    }
+}
+
+static void growIdentityMap(Encoder *encoder) {
+    int capacity = GROW_CAPACITY(encoder->capacity);
+    IdentityEntry *entries = calloc(capacity, sizeof(IdentityEntry));
+
+    for (int i = 0; i < encoder->capacity; ++i) {
+        IdentityEntry *entry = &encoder->entries[i];
+        if (entry->object == NULL) continue;
+
+        *findIdentityEntry(entries, capacity, entry->object) = *entry;
+    }
+
+    free(encoder->entries);
+    encoder->entries = entries;
+    encoder->capacity = capacity;
+}
+
+// Writes a reference if the object has been written before, otherwise
+// gives it the next number and returns false so its contents get written
+static bool writeReference(Encoder *encoder, Obj *object) {
+    if (encoder->count + 1 > encoder->capacity * IDENTITY_MAX_LOAD) {
+        growIdentityMap(encoder);
+    }
+
+    IdentityEntry *entry = findIdentityEntry(encoder->entries, encoder->capacity, object);
+
+    if (entry->object != NULL) {
+        writeTag(encoder->message, MESSAGE_REFERENCE);
+        writeUint32(encoder->message, entry->index);
+        return true;
+    }
+
+    entry->object = object;
+    entry->index = encoder->message->objectCount++;
+    encoder->count++;
+
+    return false;
+}
+
+static void writeChannel(Message *message, Channel *channel) {
+    if (message->channelCount == message->channelCapacity) {
+        message->channelCapacity = GROW_CAPACITY(message->channelCapacity);
+        message->channels = realloc(message->channels, sizeof(Channel *) * message->channelCapacity);
+    }
+
+    retainChannel(channel);
+    message->channels[message->channelCount] = channel;
+
+    writeTag(message, MESSAGE_CHANNEL);
+    writeUint32(message, message->channelCount++);
+}
+
+// Only plain functions can be rebuilt elsewhere, methods need their class
+static bool isSendableFunction(ObjFunction *function) {
+    return function->type == TYPE_FUNCTION || function->type == TYPE_ARROW_FUNCTION;
+}
+
+// A builtin module written in C can be imported afresh by the receiver
+static bool isBuiltinModule(ObjModule *module) {
+    if (module->path != NULL) {
+        return false;
+    }
+
+    bool dictuSource;
+    int index = findBuiltinModule(module->name->chars, module->name->length, &dictuSource);
+
+    return index != -1 && !dictuSource;
+}
+
+static void encodeModule(Encoder *encoder, ObjModule *module) {
+    Message *message = encoder->message;
+
+    if (writeReference(encoder, (Obj *) module)) return;
+
+    if (isBuiltinModule(module)) {
+        writeTag(message, MESSAGE_BUILTIN_MODULE);
+        writeString(message, module->name);
+        return;
+    }
+
+    writeTag(message, MESSAGE_MODULE);
+    writeString(message, module->name);
+    writeByte(message, module->path != NULL);
+
+    if (module->path != NULL) {
+        writeString(message, module->path);
+    }
+}
+
+static void deferModuleVariables(Encoder *encoder, ObjFunction *function) {
+    if (encoder->functionCount == encoder->functionCapacity) {
+        encoder->functionCapacity = GROW_CAPACITY(encoder->functionCapacity);
+        encoder->functions = realloc(encoder->functions, sizeof(ObjFunction *) * encoder->functionCapacity);
+    }
+
+    encoder->functions[encoder->functionCount++] = function;
+}
+
+static bool encodeValue(Encoder *encoder, Value value, int depth);
+
+static bool encodeFunction(Encoder *encoder, ObjFunction *function, int depth) {
+    Message *message = encoder->message;
+    Chunk *chunk = &function->chunk;
+
+    writeTag(message, MESSAGE_FUNCTION);
+    encodeModule(encoder, function->module);
+    writeByte(message, function->name != NULL);
+
+    if (function->name != NULL) {
+        writeString(message, function->name);
+    }
+
+    writeByte(message, function->type);
+    writeByte(message, function->isCoroutine);
+    writeUint32(message, function->arity);
+    writeUint32(message, function->arityOptional);
+    writeUint32(message, function->isVariadic);
+    writeUint32(message, function->upvalueCount);
+
+    writeUint32(message, chunk->count);
+    writeBytes(message, chunk->code, chunk->count);
+    writeBytes(message, chunk->lines, sizeof(int) * chunk->count);
+
+    writeUint32(message, chunk->constants.count);
+
+    for (int i = 0; i < chunk->constants.count; ++i) {
+        if (!encodeValue(encoder, chunk->constants.values[i], depth + 1)) return false;
+    }
+
+    deferModuleVariables(encoder, function);
+    return true;
+}
+
+static bool encodeValue(Encoder *encoder, Value value, int depth) {
+    Message *message = encoder->message;
+
+    if (depth > MESSAGE_MAX_DEPTH) {
+        snprintf(encoder->error, MESSAGE_ERROR_SIZE, "Value is nested too deeply to be sent");
+        return false;
+    }
+
+    if (IS_NIL(value)) {
+        writeTag(message, MESSAGE_NIL);
+        return true;
+    }
+
+    if (IS_BOOL(value)) {
+        writeTag(message, AS_BOOL(value) ? MESSAGE_TRUE : MESSAGE_FALSE);
+        return true;
+    }
+
+    if (IS_NUMBER(value)) {
+        writeTag(message, MESSAGE_NUMBER);
+        writeDouble(message, AS_NUMBER(value));
+        return true;
+    }
+
+    if (IS_OBJ(value)) {
+        if (isChannelValue(value)) {
+            if (!writeReference(encoder, AS_OBJ(value))) {
+                writeChannel(message, channelFromValue(value));
+            }
+
+            return true;
+        }
+
+        switch (OBJ_TYPE(value)) {
+            case OBJ_STRING: {
+                if (writeReference(encoder, AS_OBJ(value))) return true;
+
+                writeTag(message, MESSAGE_STRING);
+                writeString(message, AS_STRING(value));
+                return true;
+            }
+
+            case OBJ_LIST:
+            case OBJ_TUPLE: {
+                if (writeReference(encoder, AS_OBJ(value))) return true;
+
+                ValueArray *values = IS_LIST(value) ? &AS_LIST(value)->values : &AS_TUPLE(value)->values;
+                writeTag(message, IS_LIST(value) ? MESSAGE_LIST : MESSAGE_TUPLE);
+                writeUint32(message, values->count);
+
+                for (int i = 0; i < values->count; ++i) {
+                    if (!encodeValue(encoder, values->values[i], depth + 1)) return false;
+                }
+
+                return true;
+            }
+
+            case OBJ_DICT: {
+                if (writeReference(encoder, AS_OBJ(value))) return true;
+
+                ObjDict *dict = AS_DICT(value);
+                writeTag(message, MESSAGE_DICT);
+                writeUint32(message, dict->activeCount);
+
+                for (int i = 0; i <= dict->capacityMask; ++i) {
+                    DictItem *item = &dict->entries[i];
+                    if (IS_EMPTY(item->key)) continue;
+
+                    if (!encodeValue(encoder, item->key, depth + 1) ||
+                        !encodeValue(encoder, item->value, depth + 1)) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            case OBJ_SET: {
+                if (writeReference(encoder, AS_OBJ(value))) return true;
+
+                ObjSet *set = AS_SET(value);
+                writeTag(message, MESSAGE_SET);
+
+                // The count is patched in once the live entries are known
+                size_t countOffset = message->length;
+                uint32_t count = 0;
+                writeUint32(message, count);
+
+                for (int i = 0; i <= set->capacityMask; ++i) {
+                    SetItem *item = &set->entries[i];
+                    if (IS_EMPTY(item->value) || item->deleted) continue;
+
+                    if (!encodeValue(encoder, item->value, depth + 1)) return false;
+                    count++;
+                }
+
+                memcpy(message->bytes + countOffset, &count, sizeof(count));
+                return true;
+            }
+
+            case OBJ_RANGE: {
+                if (writeReference(encoder, AS_OBJ(value))) return true;
+
+                ObjRange *range = AS_RANGE(value);
+                writeTag(message, MESSAGE_RANGE);
+                writeDouble(message, range->start);
+                writeDouble(message, range->end);
+                writeDouble(message, range->step);
+                return true;
+            }
+
+            case OBJ_FUNCTION: {
+                if (!isSendableFunction(AS_FUNCTION(value))) break;
+                if (writeReference(encoder, AS_OBJ(value))) return true;
+
+                return encodeFunction(encoder, AS_FUNCTION(value), depth);
+            }
+
+            case OBJ_CLOSURE: {
+                ObjClosure *closure = AS_CLOSURE(value);
+
+                if (!isSendableFunction(closure->function)) break;
+                if (writeReference(encoder, AS_OBJ(value))) return true;
+
+                writeTag(message, MESSAGE_CLOSURE);
+                if (!encodeValue(encoder, OBJ_VAL(closure->function), depth + 1)) return false;
+
+                // Captured variables are copied too, closures that shared
+                // a variable still share the copy
+                for (int i = 0; i < closure->upvalueCount; ++i) {
+                    ObjUpvalue *upvalue = closure->upvalues[i];
+                    if (writeReference(encoder, (Obj *) upvalue)) continue;
+
+                    writeTag(message, MESSAGE_UPVALUE);
+                    if (!encodeValue(encoder, *upvalue->value, depth + 1)) return false;
+                }
+
+                return true;
+            }
+
+            case OBJ_MODULE: {
+                if (!isBuiltinModule(AS_MODULE(value))) break;
+
+                encodeModule(encoder, AS_MODULE(value));
+                return true;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    int length = 0;
+    char *type = valueTypeToString(encoder->vm, value, &length);
+    snprintf(encoder->error, MESSAGE_ERROR_SIZE, "'%s' values can not be sent between threads", type);
+    FREE_ARRAY(encoder->vm, char, type, length + 1);
+
+    return false;
+}
+
+// Module variables are only copied along with a function when they
+// could be sent themselves, anything else is left undefined
+static bool isSendableVariable(Value value) {
+    if (!IS_OBJ(value) || isChannelValue(value)) {
+        return true;
+    }
+
+    switch (OBJ_TYPE(value)) {
+        case OBJ_STRING:
+        case OBJ_LIST:
+        case OBJ_TUPLE:
+        case OBJ_DICT:
+        case OBJ_SET:
+        case OBJ_RANGE:
+            return true;
+
+        case OBJ_FUNCTION:
+            return isSendableFunction(AS_FUNCTION(value));
+
+        case OBJ_CLOSURE:
+            return isSendableFunction(AS_CLOSURE(value)->function);
+
+        case OBJ_MODULE:
+            return isBuiltinModule(AS_MODULE(value));
+
+        default:
+            return false;
+    }
+}
+
+// Writes the module variables each function names in its constants. A
+// function only refers to a module variable through a string constant
+// holding its name, so this copies everything it might use.
+static bool encodeModuleVariables(Encoder *encoder) {
+    Message *message = encoder->message;
+
+    // Encoding a variable may defer further functions
+    for (int i = 0; i < encoder->functionCount; ++i) {
+        ObjFunction *function = encoder->functions[i];
+        ValueArray *constants = &function->chunk.constants;
+
+        for (int j = 0; j < constants->count; ++j) {
+            Value variable;
+
+            if (!IS_STRING(constants->values[j]) ||
+                !tableGet(&function->module->values, AS_STRING(constants->values[j]), &variable) ||
+                !isSendableVariable(variable)) {
+                continue;
+            }
+
+            writeByte(message, true);
+            encodeModule(encoder, function->module);
+
+            if (!encodeValue(encoder, constants->values[j], 0) || !encodeValue(encoder, variable, 0)) {
+                return false;
+            }
+        }
+    }
+
+    writeByte(message, false);
+    return true;
+}
+
+static bool finishEncoding(Encoder *encoder, bool encoded) {
+    encoded = encoded && encodeModuleVariables(encoder);
+
+    free(encoder->entries);
+    free(encoder->functions);
+
+    if (!encoded) {
+        freeMessage(encoder->message);
+    }
+
+    return encoded;
+}
+
+bool encodeMessage(DictuVM *vm, Message *message, Value value, char *error) {
+    Encoder encoder = {vm, message, NULL, 0, 0, NULL, 0, 0, error};
+
+    return finishEncoding(&encoder, encodeValue(&encoder, value, 0));
+}
+
+bool encodeMessageList(DictuVM *vm, Message *message, Value *values, int count, char *error) {
+    Encoder encoder = {vm, message, NULL, 0, 0, NULL, 0, 0, error};
+
+    // Numbered like a list object so it decodes as one
+    message->objectCount++;
+    writeTag(message, MESSAGE_LIST);
+    writeUint32(message, count);
+
+    bool encoded = true;
+
+    for (int i = 0; i < count && encoded; ++i) {
+        encoded = encodeValue(&encoder, values[i], 1);
+    }
+
+    return finishEncoding(&encoder, encoded);
+}
+
+static uint8_t readByte(Decoder *decoder) {
+    return decoder->message->bytes[decoder->position++];
+}
+
+static uint32_t readUint32(Decoder *decoder) {
+    uint32_t value;
+    memcpy(&value, decoder->message->bytes + decoder->position, sizeof(value));
+    decoder->position += sizeof(value);
+    return value;
+}
+
+static double readDouble(Decoder *decoder) {
+    double value;
+    memcpy(&value, decoder->message->bytes + decoder->position, sizeof(value));
+    decoder->position += sizeof(value);
+    return value;
+}
+
+static ObjString *readString(Decoder *decoder) {
+    uint32_t length = readUint32(decoder);
+    char *chars = (char *) decoder->message->bytes + decoder->position;
+    decoder->position += length;
+
+    return copyString(decoder->vm, chars, length);
+}
+
+// Space for every object is reserved up front, so this never allocates
+static void keepObject(Decoder *decoder, Value value) {
+    ValueArray *objects = &decoder->objects->values;
+    objects->values[objects->count++] = value;
+}
+
+static Value decodeValue(Decoder *decoder) {
+    DictuVM *vm = decoder->vm;
+
+    switch (readByte(decoder)) {
+        case MESSAGE_NIL:
+            return NIL_VAL;
+
+        case MESSAGE_TRUE:
+            return TRUE_VAL;
+
+        case MESSAGE_FALSE:
+            return FALSE_VAL;
+
+        case MESSAGE_NUMBER:
+            return NUMBER_VAL(readDouble(decoder));
+
+        case MESSAGE_STRING: {
+            Value string = OBJ_VAL(readString(decoder));
+            keepObject(decoder, string);
+            return string;
+        }
+
+        case MESSAGE_LIST:
+        case MESSAGE_TUPLE: {
+            bool isList = decoder->message->bytes[decoder->position - 1] == MESSAGE_LIST;
+            uint32_t count = readUint32(decoder);
+
+            Value value;
+            ValueArray *values;
+
+            if (isList) {
+                ObjList *list = newList(vm);
+                value = OBJ_VAL(list);
+                values = &list->values;
+            } else {
+                ObjTuple *tuple = newTuple(vm);
+                value = OBJ_VAL(tuple);
+                values = &tuple->values;
+            }
+
+            keepObject(decoder, value);
+
+            if (count > 0) {
+                values->values = ALLOCATE(vm, Value, count);
+                values->capacity = count;
+
+                for (uint32_t i = 0; i < count; ++i) {
+                    Value item = decodeValue(decoder);
+                    values->values[values->count++] = item;
+                }
+            }
+
+            return value;
+        }
+
+        case MESSAGE_DICT: {
+            uint32_t count = readUint32(decoder);
+            ObjDict *dict = newDict(vm);
+            keepObject(decoder, OBJ_VAL(dict));
+
+            for (uint32_t i = 0; i < count; ++i) {
+                Value key = decodeValue(decoder);
+                Value value = decodeValue(decoder);
+                dictSet(vm, dict, key, value);
+            }
+
+            return OBJ_VAL(dict);
+        }
+
+        case MESSAGE_SET: {
+            uint32_t count = readUint32(decoder);
+            ObjSet *set = newSet(vm);
+            keepObject(decoder, OBJ_VAL(set));
+
+            for (uint32_t i = 0; i < count; ++i) {
+                setInsert(vm, set, decodeValue(decoder));
+            }
+
+            return OBJ_VAL(set);
+        }
+
+        case MESSAGE_RANGE: {
+            double start = readDouble(decoder);
+            double end = readDouble(decoder);
+            double step = readDouble(decoder);
+
+            Value range = OBJ_VAL(newRange(vm, start, end, step));
+            keepObject(decoder, range);
+            return range;
+        }
+
+        case MESSAGE_CHANNEL: {
+            Value channel = newChannelValue(vm, decoder->message->channels[readUint32(decoder)]);
+            keepObject(decoder, channel);
+            return channel;
+        }
+
+        case MESSAGE_FUNCTION: {
+            ObjFunction *function = newFunction(vm, NULL, TYPE_FUNCTION, ACCESS_PUBLIC);
+            keepObject(decoder, OBJ_VAL(function));
+
+            function->module = AS_MODULE(decodeValue(decoder));
+
+            if (readByte(decoder)) {
+                function->name = readString(decoder);
+            }
+
+            function->type = readByte(decoder);
+            function->isCoroutine = readByte(decoder);
+            function->arity = readUint32(decoder);
+            function->arityOptional = readUint32(decoder);
+            function->isVariadic = readUint32(decoder);
+            function->upvalueCount = readUint32(decoder);
+
+            Chunk *chunk = &function->chunk;
+            uint32_t count = readUint32(decoder);
+            uint8_t *code = ALLOCATE(vm, uint8_t, count);
+            int *lines = ALLOCATE(vm, int, count);
+
+            memcpy(code, decoder->message->bytes + decoder->position, count);
+            decoder->position += count;
+            memcpy(lines, decoder->message->bytes + decoder->position, sizeof(int) * count);
+            decoder->position += sizeof(int) * count;
+
+            chunk->code = code;
+            chunk->lines = lines;
+            chunk->count = count;
+            chunk->capacity = count;
+
+            uint32_t constantCount = readUint32(decoder);
+
+            if (constantCount > 0) {
+                chunk->constants.values = ALLOCATE(vm, Value, constantCount);
+                chunk->constants.capacity = constantCount;
+
+                for (uint32_t i = 0; i < constantCount; ++i) {
+                    Value constant = decodeValue(decoder);
+                    chunk->constants.values[chunk->constants.count++] = constant;
+                }
+            }
+
+            return OBJ_VAL(function);
+        }
+
+        case MESSAGE_CLOSURE: {
+            // The closure is numbered before its function, which can not
+            // refer back to it, so its slot is filled in afterwards
+            ValueArray *objects = &decoder->objects->values;
+            int index = objects->count;
+            keepObject(decoder, NIL_VAL);
+
+            ObjClosure *closure = newClosure(vm, AS_FUNCTION(decodeValue(decoder)));
+            objects->values[index] = OBJ_VAL(closure);
+
+            for (int i = 0; i < closure->upvalueCount; ++i) {
+                closure->upvalues[i] = (ObjUpvalue *) AS_OBJ(decodeValue(decoder));
+            }
+
+            return OBJ_VAL(closure);
+        }
+
+        case MESSAGE_UPVALUE: {
+            ObjUpvalue *upvalue = newUpvalue(vm, NULL);
+            upvalue->value = &upvalue->closed;
+            keepObject(decoder, OBJ_VAL(upvalue));
+
+            upvalue->closed = decodeValue(decoder);
+            return OBJ_VAL(upvalue);
+        }
+
+        case MESSAGE_MODULE: {
+            ObjString *name = readString(decoder);
+            push(vm, OBJ_VAL(name));
+
+            // A module of the same name in this VM is reused, so functions
+            // sent back to where they came from see the original variables
+            ObjModule *module = newModule(vm, name);
+            pop(vm);
+
+            keepObject(decoder, OBJ_VAL(module));
+
+            if (readByte(decoder)) {
+                ObjString *path = readString(decoder);
+
+                if (module->path == NULL) {
+                    module->path = path;
+                }
+            }
+
+            return OBJ_VAL(module);
+        }
+
+        case MESSAGE_BUILTIN_MODULE: {
+            ObjString *name = readString(decoder);
+            push(vm, OBJ_VAL(name));
+
+            Value module;
+
+            if (!tableGet(&vm->modules, name, &module)) {
+                bool dictuSource;
+                module = importBuiltinModule(vm, findBuiltinModule(name->chars, name->length, &dictuSource));
+            }
+
+            pop(vm);
+
+            keepObject(decoder, module);
+            return module;
+        }
+
+        case MESSAGE_REFERENCE:
+            return decoder->objects->values.values[readUint32(decoder)];
+    }
+
+    return NIL_VAL;
+}
+
+static Value decode(DictuVM *vm, Message *message, bool replaceVariables) {
+    Decoder decoder = {vm, message, 0, newList(vm)};
+    push(vm, OBJ_VAL(decoder.objects));
+
+    if (message->objectCount > 0) {
+        decoder.objects->values.values = ALLOCATE(vm, Value, message->objectCount);
+        decoder.objects->values.capacity = message->objectCount;
+    }
+
+    Value value = decodeValue(&decoder);
+
+    // Module variables used by the functions in the message, anything the
+    // receiving module already defines is left as it is unless asked otherwise
+    while (readByte(&decoder)) {
+        ObjModule *module = AS_MODULE(decodeValue(&decoder));
+        ObjString *name = AS_STRING(decodeValue(&decoder));
+        Value variable = decodeValue(&decoder);
+        Value existing;
+
+        if (replaceVariables || !tableGet(&module->values, name, &existing)) {
+            tableSet(vm, &module->values, name, variable);
+        }
+    }
+
+    pop(vm);
+
+    return value;
+}
+
+Value decodeMessage(DictuVM *vm, Message *message) {
+    return decode(vm, message, false);
+}
+
+Value decodeMessageReplacing(DictuVM *vm, Message *message) {
+    return decode(vm, message, true);
+}
+
+void freeMessage(Message *message) {
+    for (int i = 0; i < message->channelCount; ++i) {
+        releaseChannel(message->channels[i]);
+    }
+
+    free(message->channels);
+    free(message->bytes);
+    memset(message, 0, sizeof(Message));
+}
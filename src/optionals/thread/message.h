@@ -0,0 +1,60 @@
+#ifndef dictu_message_h
+#define dictu_message_h
+
+#include <stdint.h>
+
+#include "../optionals.h"
+
+typedef struct Channel Channel;
+
+/**
+ * A message is a value flattened into a buffer that belongs to no VM, so
+ * it can be handed from one heap to another. It is allocated with the
+ * system allocator rather than through a VM so that it can be freed by
+ * whichever thread ends up owning it.
+ *
+ * Objects are numbered in the order they are first written and any later
+ * occurrence is written as a reference to that number, which keeps shared
+ * and cyclic structures intact. Channels are not copied, the message holds
+ * a reference to each one it contains.
+ *
+ * Functions are sent as their bytecode along with the values they capture
+ * and the module variables they use, which are copied like any other value.
+ */
+typedef struct {
+    uint8_t *bytes;
+    size_t length;
+    size_t capacity;
+    uint32_t objectCount;
+    Channel **channels;
+    int channelCount;
+    int channelCapacity;
+} Message;
+
+#define MESSAGE_ERROR_SIZE 128
+
+// Flattens the value into the message. On failure the message is left empty
+// and the reason is written to error, which holds MESSAGE_ERROR_SIZE chars.
+bool encodeMessage(DictuVM *vm, Message *message, Value value, char *error);
+
+// As encodeMessage but for a list of the given values, without one
+// having to be created first
+bool encodeMessageList(DictuVM *vm, Message *message, Value *values, int count, char *error);
+
+// Rebuilds the value in the given VM, the message is left untouched
+Value decodeMessage(DictuVM *vm, Message *message);
+
+// As decodeMessage, but module variables sent with the message replace any
+// the VM already has, for VMs that are handed functions again and again
+Value decodeMessageReplacing(DictuVM *vm, Message *message);
+
+void freeMessage(Message *message);
+
+// Implemented by the Thread module
+void retainChannel(Channel *channel);
+void releaseChannel(Channel *channel);
+Value newChannelValue(DictuVM *vm, Channel *channel);
+bool isChannelValue(Value value);
+Channel *channelFromValue(Value value);
+
+#endif //dictu_message_h
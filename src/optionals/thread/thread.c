@@ -0,0 +1,795 @@
+#include "thread.h"
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include "message.h"
+
+#define DEFAULT_CHANNEL_CAPACITY 16
+
+/**
+ * A channel is shared by every VM holding a handle to it, so it lives
+ * outside of any one heap and is freed when the last handle, or message
+ * carrying it, is released.
+ */
+struct Channel {
+    pthread_mutex_t lock;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    // Ring buffer of pending messages
+    Message *messages;
+    int capacity;
+    int head;
+    int count;
+    bool closed;
+    int refCount;
+};
+
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    char *path;
+    char *source;
+    Message args;
+    DictuInterpretResult result;
+    bool finished;
+    bool joined;
+    // Set when the handle is collected before the worker has finished,
+    // the worker then cleans up after itself
+    bool detached;
+} Worker;
+
+#define AS_CHANNEL(v) ((Channel*)AS_ABSTRACT(v)->data)
+#define AS_WORKER(v) ((Worker*)AS_ABSTRACT(v)->data)
+
+// The arguments the worker running on this thread was spawned with
+static _Thread_local Message *workerArgs = NULL;
+
+void retainChannel(Channel *channel) {
+    pthread_mutex_lock(&channel->lock);
+    channel->refCount++;
+    pthread_mutex_unlock(&channel->lock);
+}
+
+void releaseChannel(Channel *channel) {
+    pthread_mutex_lock(&channel->lock);
+    bool last = --channel->refCount == 0;
+    pthread_mutex_unlock(&channel->lock);
+
+    if (!last) {
+        return;
+    }
+
+    for (int i = 0; i < channel->count; ++i) {
+        freeMessage(&channel->messages[(channel->head + i) % channel->capacity]);
+    }
+
+    pthread_mutex_destroy(&channel->lock);
+    pthread_cond_destroy(&channel->notEmpty);
+    pthread_cond_destroy(&channel->notFull);
+    free(channel->messages);
+    free(channel);
+}
+
+void freeChannel(DictuVM *vm, ObjAbstract *abstract) {
+    UNUSED(vm);
+
+    releaseChannel((Channel *) abstract->data);
+}
+
+char *channelToString(ObjAbstract *abstract) {
+    UNUSED(abstract);
+
+    char *channelString = malloc(sizeof(char) * 10);
+    snprintf(channelString, 10, "<Channel>");
+    return channelString;
+}
+
+bool isChannelValue(Value value) {
+    return IS_ABSTRACT(value) && AS_ABSTRACT(value)->type == channelToString;
+}
+
+Channel *channelFromValue(Value value) {
+    return AS_CHANNEL(value);
+}
+
+static Value channelSend(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "send() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Channel *channel = AS_CHANNEL(args[0]);
+
+    Message message = {0};
+    char error[MESSAGE_ERROR_SIZE];
+
+    if (!encodeMessage(vm, &message, args[1], error)) {
+        return newResultError(vm, error);
+    }
+
+    pthread_mutex_lock(&channel->lock);
+
+    while (channel->count == channel->capacity && !channel->closed) {
+        pthread_cond_wait(&channel->notFull, &channel->lock);
+    }
+
+    if (channel->closed) {
+        pthread_mutex_unlock(&channel->lock);
+        // Released outside of the lock as the message may hold this channel
+        freeMessage(&message);
+        return newResultError(vm, "Channel is closed");
+    }
+
+    channel->messages[(channel->head + channel->count) % channel->capacity] = message;
+    channel->count++;
+
+    pthread_cond_signal(&channel->notEmpty);
+    pthread_mutex_unlock(&channel->lock);
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
+static Value channelRecv(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "recv() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Channel *channel = AS_CHANNEL(args[0]);
+
+    pthread_mutex_lock(&channel->lock);
+
+    while (channel->count == 0 && !channel->closed) {
+        pthread_cond_wait(&channel->notEmpty, &channel->lock);
+    }
+
+    // A closed channel still hands out what was sent before it was closed
+    if (channel->count == 0) {
+        pthread_mutex_unlock(&channel->lock);
+        return newResultError(vm, "Channel is closed");
+    }
+
+    Message message = channel->messages[channel->head];
+    channel->head = (channel->head + 1) % channel->capacity;
+    channel->count--;
+
+    pthread_cond_signal(&channel->notFull);
+    pthread_mutex_unlock(&channel->lock);
+
+    Value value = decodeMessage(vm, &message);
+    freeMessage(&message);
+
+    return newResultSuccess(vm, value);
+}
+
+static Value channelClose(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "close() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Channel *channel = AS_CHANNEL(args[0]);
+
+    pthread_mutex_lock(&channel->lock);
+    channel->closed = true;
+    pthread_cond_broadcast(&channel->notEmpty);
+    pthread_cond_broadcast(&channel->notFull);
+    pthread_mutex_unlock(&channel->lock);
+
+    return NIL_VAL;
+}
+
+static Value channelLen(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "len() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Channel *channel = AS_CHANNEL(args[0]);
+
+    pthread_mutex_lock(&channel->lock);
+    int count = channel->count;
+    pthread_mutex_unlock(&channel->lock);
+
+    return NUMBER_VAL(count);
+}
+
+Value newChannelValue(DictuVM *vm, Channel *channel) {
+    retainChannel(channel);
+
+    ObjAbstract *abstract = newAbstract(vm, freeChannel, channelToString);
+    abstract->data = channel;
+    push(vm, OBJ_VAL(abstract));
+
+    /**
+     * Setup Channel object methods
+     */
+    defineNative(vm, &abstract->values, "send", channelSend);
+    defineNative(vm, &abstract->values, "recv", channelRecv);
+    defineNative(vm, &abstract->values, "close", channelClose);
+    defineNative(vm, &abstract->values, "len", channelLen);
+
+    pop(vm);
+
+    return OBJ_VAL(abstract);
+}
+
+static Value newChannel(DictuVM *vm, int argCount, Value *args) {
+    if (argCount > 1) {
+        runtimeError(vm, "channel() takes 0 or 1 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    int capacity = DEFAULT_CHANNEL_CAPACITY;
+
+    if (argCount == 1) {
+        if (!IS_NUMBER(args[0]) || AS_NUMBER(args[0]) < 1) {
+            runtimeError(vm, "channel() capacity must be a number greater than 0");
+            return EMPTY_VAL;
+        }
+
+        capacity = AS_NUMBER(args[0]);
+    }
+
+    Channel *channel = malloc(sizeof(Channel));
+    pthread_mutex_init(&channel->lock, NULL);
+    pthread_cond_init(&channel->notEmpty, NULL);
+    pthread_cond_init(&channel->notFull, NULL);
+    channel->messages = malloc(sizeof(Message) * capacity);
+    channel->capacity = capacity;
+    channel->head = 0;
+    channel->count = 0;
+    channel->closed = false;
+    channel->refCount = 0;
+
+    return newChannelValue(vm, channel);
+}
+
+static void freeWorkerData(Worker *worker) {
+    pthread_mutex_destroy(&worker->lock);
+    freeMessage(&worker->args);
+    free(worker->source);
+    free(worker->path);
+    free(worker);
+}
+
+static void *runWorker(void *data) {
+    Worker *worker = data;
+    workerArgs = &worker->args;
+
+    char *argv[] = {worker->path};
+    DictuVM *vm = dictuInitVM(false, 1, argv);
+    worker->result = dictuInterpret(vm, worker->path, worker->source);
+    dictuFreeVM(vm);
+
+    workerArgs = NULL;
+
+    pthread_mutex_lock(&worker->lock);
+    worker->finished = true;
+    bool detached = worker->detached;
+    pthread_mutex_unlock(&worker->lock);
+
+    if (detached) {
+        freeWorkerData(worker);
+    }
+
+    return NULL;
+}
+
+void freeWorker(DictuVM *vm, ObjAbstract *abstract) {
+    UNUSED(vm);
+
+    Worker *worker = abstract->data;
+
+    if (worker->joined) {
+        freeWorkerData(worker);
+        return;
+    }
+
+    pthread_mutex_lock(&worker->lock);
+
+    if (worker->finished) {
+        pthread_mutex_unlock(&worker->lock);
+        pthread_join(worker->thread, NULL);
+        freeWorkerData(worker);
+        return;
+    }
+
+    worker->detached = true;
+    pthread_detach(worker->thread);
+    pthread_mutex_unlock(&worker->lock);
+}
+
+char *workerToString(ObjAbstract *abstract) {
+    UNUSED(abstract);
+
+    char *workerString = malloc(sizeof(char) * 9);
+    snprintf(workerString, 9, "<Worker>");
+    return workerString;
+}
+
+static Value workerJoin(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "join() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Worker *worker = AS_WORKER(args[0]);
+
+    if (!worker->joined) {
+        pthread_join(worker->thread, NULL);
+        worker->joined = true;
+    }
+
+    if (worker->result == INTERPRET_COMPILE_ERROR) {
+        return newResultError(vm, "Worker failed to compile");
+    }
+
+    if (worker->result == INTERPRET_RUNTIME_ERROR) {
+        return newResultError(vm, "Worker exited with a runtime error");
+    }
+
+    return newResultSuccess(vm, NIL_VAL);
+}
+
+static Value spawnWorker(DictuVM *vm, int argCount, Value *args) {
+    if (argCount < 1) {
+        runtimeError(vm, "spawn() takes at least 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_STRING(args[0])) {
+        runtimeError(vm, "spawn() path must be a string");
+        return EMPTY_VAL;
+    }
+
+    ObjString *path = AS_STRING(args[0]);
+    char *source = readFile(vm, path->chars);
+
+    if (source == NULL) {
+        return newResultError(vm, "Unable to open worker file");
+    }
+
+    Worker *worker = malloc(sizeof(Worker));
+    memset(worker, 0, sizeof(Worker));
+    pthread_mutex_init(&worker->lock, NULL);
+
+    // The worker's copies are owned by the new thread rather than this VM
+    size_t sourceLength = strlen(source);
+    worker->source = malloc(sourceLength + 1);
+    memcpy(worker->source, source, sourceLength + 1);
+    FREE_ARRAY(vm, char, source, sourceLength + 1);
+
+    worker->path = malloc(path->length + 1);
+    memcpy(worker->path, path->chars, path->length + 1);
+
+    ObjList *workerArgList = newList(vm);
+    push(vm, OBJ_VAL(workerArgList));
+
+    for (int i = 1; i < argCount; ++i) {
+        writeValueArray(vm, &workerArgList->values, args[i]);
+    }
+
+    char error[MESSAGE_ERROR_SIZE];
+    bool encoded = encodeMessage(vm, &worker->args, OBJ_VAL(workerArgList), error);
+    pop(vm);
+
+    if (!encoded) {
+        freeWorkerData(worker);
+        return newResultError(vm, error);
+    }
+
+    int status = pthread_create(&worker->thread, NULL, runWorker, worker);
+
+    if (status != 0) {
+        freeWorkerData(worker);
+        return newResultError(vm, strerror(status));
+    }
+
+    ObjAbstract *abstract = newAbstract(vm, freeWorker, workerToString);
+    abstract->data = worker;
+    push(vm, OBJ_VAL(abstract));
+
+    /**
+     * Setup Worker object methods
+     */
+    defineNative(vm, &abstract->values, "join", workerJoin);
+
+    pop(vm);
+
+    return newResultSuccess(vm, OBJ_VAL(abstract));
+}
+
+static Value workerArguments(DictuVM *vm, int argCount, Value *args) {
+    UNUSED(args);
+
+    if (argCount != 0) {
+        runtimeError(vm, "args() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (workerArgs == NULL) {
+        return OBJ_VAL(newList(vm));
+    }
+
+    return decodeMessage(vm, workerArgs);
+}
+
+static Value cpuCount(DictuVM *vm, int argCount, Value *args) {
+    UNUSED(args);
+
+    if (argCount != 0) {
+        runtimeError(vm, "cpuCount() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return NUMBER_VAL(count > 0 ? count : 1);
+}
+
+/**
+ * Shared state of a parallelMap() call. The list is split into several
+ * chunks per worker and each worker takes the next one as soon as it has
+ * finished its last, so a slow chunk does not hold the others up.
+ */
+typedef struct ParallelMap {
+    // Tells workers apart from an earlier call that had the same address
+    uint64_t id;
+    Message function;
+    Message *chunks;
+    Message *results;
+    int chunkCount;
+    int nextChunk;
+    // The most workers allowed on this call at once, and those on it now
+    int maxWorkers;
+    int activeWorkers;
+    bool failed;
+    char error[MESSAGE_ERROR_SIZE];
+    pthread_cond_t finished;
+    struct ParallelMap *next;
+} ParallelMap;
+
+/**
+ * Worker VMs are started the first time parallelMap() needs them and then
+ * kept for the life of the process, waiting for calls with chunks left to
+ * take. Calls from any VM or thread share the one pool.
+ */
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t work;
+    // Calls which still have chunks to hand out, oldest first
+    ParallelMap *queue;
+    int workerCount;
+    uint64_t nextId;
+} WorkerPool;
+
+#define PARALLEL_CHUNKS_PER_WORKER 8
+#define PARALLEL_MAX_WORKERS 64
+
+static WorkerPool pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, 0, 0};
+
+// Set on the threads of the pool, which run any parallelMap() of their own inline
+static _Thread_local bool isPoolWorker = false;
+
+// The caller holds the pool lock
+static void dequeueParallelMap(ParallelMap *map) {
+    for (ParallelMap **current = &pool.queue; *current != NULL; current = &(*current)->next) {
+        if (*current == map) {
+            *current = map->next;
+            return;
+        }
+    }
+}
+
+// The caller holds the pool lock
+static void failParallelMap(ParallelMap *map, const char *error) {
+    if (!map->failed) {
+        map->failed = true;
+        snprintf(map->error, MESSAGE_ERROR_SIZE, "%s", error);
+        dequeueParallelMap(map);
+    }
+}
+
+// Waits for a chunk of any call that has room for another worker, the pool lock is held on return
+static ParallelMap *takeChunk(int *chunk) {
+    for (;;) {
+        for (ParallelMap *map = pool.queue; map != NULL; map = map->next) {
+            if (map->activeWorkers < map->maxWorkers) {
+                *chunk = map->nextChunk++;
+                map->activeWorkers++;
+
+                if (map->nextChunk == map->chunkCount) {
+                    dequeueParallelMap(map);
+                }
+
+                return map;
+            }
+        }
+
+        pthread_cond_wait(&pool.work, &pool.lock);
+    }
+}
+
+static bool mapChunk(DictuVM *vm, ParallelMap *map, Value function, int chunk, char *error) {
+    ObjList *items = AS_LIST(decodeMessage(vm, &map->chunks[chunk]));
+    push(vm, OBJ_VAL(items));
+    ObjList *results = newList(vm);
+    push(vm, OBJ_VAL(results));
+
+    bool mapped = true;
+
+    for (int i = 0; i < items->values.count && mapped; ++i) {
+        Value result;
+
+        // On an error the stack is put back as it was before the call
+        if (tryCallFunction(vm, function, 1, &items->values.values[i], &result) != INTERPRET_OK) {
+            snprintf(error, MESSAGE_ERROR_SIZE, "parallelMap() function raised a runtime error");
+            mapped = false;
+            break;
+        }
+
+        push(vm, result);
+        writeValueArray(vm, &results->values, result);
+        pop(vm);
+    }
+
+    if (mapped) {
+        mapped = encodeMessage(vm, &map->results[chunk], OBJ_VAL(results), error);
+    }
+
+    pop(vm);
+    pop(vm);
+
+    return mapped;
+}
+
+static void *runPoolWorker(void *data) {
+    UNUSED(data);
+
+    isPoolWorker = true;
+    DictuVM *vm = dictuInitVM(false, 0, NULL);
+
+    // The function of the call last worked on is kept on the stack, so it is
+    // only copied in once however many of its chunks this worker takes
+    uint64_t currentId = 0;
+    push(vm, NIL_VAL);
+
+    pthread_mutex_lock(&pool.lock);
+
+    for (;;) {
+        int chunk;
+        ParallelMap *map = takeChunk(&chunk);
+        bool failed = map->failed;
+        pthread_mutex_unlock(&pool.lock);
+
+        char error[MESSAGE_ERROR_SIZE];
+        bool mapped = true;
+
+        if (!failed) {
+            if (map->id != currentId) {
+                pop(vm);
+                push(vm, decodeMessageReplacing(vm, &map->function));
+                currentId = map->id;
+            }
+
+            mapped = mapChunk(vm, map, vm->stackTop[-1], chunk, error);
+        }
+
+        pthread_mutex_lock(&pool.lock);
+
+        if (!mapped) {
+            failParallelMap(map, error);
+        }
+
+        map->activeWorkers--;
+
+        if (map->activeWorkers == 0 && (map->failed || map->nextChunk == map->chunkCount)) {
+            pthread_cond_signal(&map->finished);
+        }
+    }
+
+    return NULL;
+}
+
+// Starts workers until the pool has the number asked for, the caller holds the pool lock
+static bool growPool(int workerCount, char *error) {
+    while (pool.workerCount < workerCount) {
+        pthread_t thread;
+        int status = pthread_create(&thread, NULL, runPoolWorker, NULL);
+
+        if (status != 0) {
+            // A smaller pool still gets through the work
+            if (pool.workerCount > 0) {
+                return true;
+            }
+
+            snprintf(error, MESSAGE_ERROR_SIZE, "%s", strerror(status));
+            return false;
+        }
+
+        pthread_detach(thread);
+        pool.workerCount++;
+    }
+
+    return true;
+}
+
+static void freeParallelMap(ParallelMap *map) {
+    for (int i = 0; i < map->chunkCount; ++i) {
+        freeMessage(&map->chunks[i]);
+        freeMessage(&map->results[i]);
+    }
+
+    free(map->chunks);
+    free(map->results);
+    freeMessage(&map->function);
+    pthread_cond_destroy(&map->finished);
+}
+
+// A worker of the pool waiting on calls of its own could leave none free to
+// run them, so from a worker the list is mapped in its own VM
+static Value parallelMapInline(DictuVM *vm, ObjList *list, Value function) {
+    ObjList *mapped = newList(vm);
+    push(vm, OBJ_VAL(mapped));
+
+    for (int i = 0; i < list->values.count; ++i) {
+        Value result;
+
+        if (tryCallFunction(vm, function, 1, &list->values.values[i], &result) != INTERPRET_OK) {
+            pop(vm);
+            return newResultError(vm, "parallelMap() function raised a runtime error");
+        }
+
+        push(vm, result);
+        writeValueArray(vm, &mapped->values, result);
+        pop(vm);
+    }
+
+    pop(vm);
+
+    return newResultSuccess(vm, OBJ_VAL(mapped));
+}
+
+static Value parallelMap(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 2 && argCount != 3) {
+        runtimeError(vm, "parallelMap() takes 2 or 3 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_LIST(args[0])) {
+        runtimeError(vm, "parallelMap() first argument must be a list");
+        return EMPTY_VAL;
+    }
+
+    if (!IS_FUNCTION(args[1]) && !IS_CLOSURE(args[1])) {
+        runtimeError(vm, "parallelMap() second argument must be a function");
+        return EMPTY_VAL;
+    }
+
+    long workerCount = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (argCount == 3) {
+        if (!IS_NUMBER(args[2]) || AS_NUMBER(args[2]) < 1) {
+            runtimeError(vm, "parallelMap() worker count must be a number greater than 0");
+            return EMPTY_VAL;
+        }
+
+        workerCount = AS_NUMBER(args[2]);
+    }
+
+    ObjList *list = AS_LIST(args[0]);
+    int count = list->values.count;
+
+    if (count == 0) {
+        return newResultSuccess(vm, OBJ_VAL(newList(vm)));
+    }
+
+    if (isPoolWorker) {
+        return parallelMapInline(vm, list, args[1]);
+    }
+
+    if (workerCount < 1) {
+        workerCount = 1;
+    } else if (workerCount > count) {
+        workerCount = count;
+    }
+
+    if (workerCount > PARALLEL_MAX_WORKERS) {
+        workerCount = PARALLEL_MAX_WORKERS;
+    }
+
+    int chunkSize = (count + workerCount * PARALLEL_CHUNKS_PER_WORKER - 1) / (workerCount * PARALLEL_CHUNKS_PER_WORKER);
+
+    ParallelMap map;
+    memset(&map, 0, sizeof(ParallelMap));
+    pthread_cond_init(&map.finished, NULL);
+    map.maxWorkers = workerCount;
+    map.chunkCount = (count + chunkSize - 1) / chunkSize;
+    map.chunks = calloc(map.chunkCount, sizeof(Message));
+    map.results = calloc(map.chunkCount, sizeof(Message));
+
+    char error[MESSAGE_ERROR_SIZE];
+    bool encoded = encodeMessage(vm, &map.function, args[1], error);
+
+    for (int i = 0; i < map.chunkCount && encoded; ++i) {
+        int start = i * chunkSize;
+        int length = count - start < chunkSize ? count - start : chunkSize;
+
+        encoded = encodeMessageList(vm, &map.chunks[i], list->values.values + start, length, error);
+    }
+
+    if (!encoded) {
+        freeParallelMap(&map);
+        return newResultError(vm, error);
+    }
+
+    pthread_mutex_lock(&pool.lock);
+
+    if (!growPool(workerCount, error)) {
+        pthread_mutex_unlock(&pool.lock);
+        freeParallelMap(&map);
+        return newResultError(vm, error);
+    }
+
+    map.id = ++pool.nextId;
+
+    ParallelMap **last = &pool.queue;
+    while (*last != NULL) {
+        last = &(*last)->next;
+    }
+    *last = &map;
+
+    pthread_cond_broadcast(&pool.work);
+
+    while (map.activeWorkers > 0 || (!map.failed && map.nextChunk < map.chunkCount)) {
+        pthread_cond_wait(&map.finished, &pool.lock);
+    }
+
+    pthread_mutex_unlock(&pool.lock);
+
+    if (map.failed) {
+        Value result = newResultError(vm, map.error);
+        freeParallelMap(&map);
+        return result;
+    }
+
+    ObjList *mapped = newList(vm);
+    push(vm, OBJ_VAL(mapped));
+
+    mapped->values.values = ALLOCATE(vm, Value, count);
+    mapped->values.capacity = count;
+
+    for (int i = 0; i < map.chunkCount; ++i) {
+        ObjList *results = AS_LIST(decodeMessage(vm, &map.results[i]));
+
+        memcpy(mapped->values.values + mapped->values.count, results->values.values, sizeof(Value) * results->values.count);
+        mapped->values.count += results->values.count;
+    }
+
+    freeParallelMap(&map);
+    pop(vm);
+
+    return newResultSuccess(vm, OBJ_VAL(mapped));
+}
+
+Value createThreadModule(DictuVM *vm) {
+    ObjString *name = copyString(vm, "Thread", 6);
+    push(vm, OBJ_VAL(name));
+    ObjModule *module = newModule(vm, name);
+    push(vm, OBJ_VAL(module));
+
+    /**
+     * Define Thread methods
+     */
+    defineNative(vm, &module->values, "spawn", spawnWorker);
+    defineNative(vm, &module->values, "channel", newChannel);
+    defineNative(vm, &module->values, "args", workerArguments);
+    defineNative(vm, &module->values, "cpuCount", cpuCount);
+    defineNative(vm, &module->values, "parallelMap", parallelMap);
+
+    pop(vm);
+    pop(vm);
+
+    return OBJ_VAL(module);
+}
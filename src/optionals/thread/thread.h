@@ -0,0 +1,9 @@
+#ifndef dictu_thread_h
+#define dictu_thread_h
+
+#include "../optionals.h"
+#include "../../vm/vm.h"
+
+Value createThreadModule(DictuVM *vm);
+
+#endif //dictu_thread_h
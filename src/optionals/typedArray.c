@@ -0,0 +1,868 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "typedArray.h"
+#include "buffer.h"
+
+typedef enum {
+    TYPED_ARRAY_FLOAT64,
+    TYPED_ARRAY_INT64,
+    TYPED_ARRAY_INT32,
+    TYPED_ARRAY_UINT8
+} TypedArrayType;
+
+typedef struct {
+    TypedArrayType type;
+    int length;
+    void *data;
+} TypedArray;
+
+#define AS_TYPED_ARRAY(v) ((TypedArray *)AS_ABSTRACT(v)->data)
+#define IS_TYPED_ARRAY(v) (IS_ABSTRACT(v) && AS_ABSTRACT(v)->type == typedArrayToString)
+
+#define TYPED_ARRAY_TYPE_COUNT 4
+
+static const char *typeNames[TYPED_ARRAY_TYPE_COUNT] = {"float64", "int64", "int32", "uint8"};
+static const size_t elementSizes[TYPED_ARRAY_TYPE_COUNT] = {sizeof(double), sizeof(int64_t), sizeof(int32_t), sizeof(uint8_t)};
+
+typedef void (*Kernel)(void *out, const void *a, const void *b, int length);
+
+typedef enum {
+    ELEMENTWISE_ADD,
+    ELEMENTWISE_SUBTRACT,
+    ELEMENTWISE_MULTIPLY,
+    ELEMENTWISE_DIVIDE
+} ElementwiseOp;
+
+/**
+ * The kernels below work on plain contiguous C arrays with restrict
+ * qualified pointers, which lets the compiler vectorise them. Integer
+ * arithmetic is carried out on unsigned 64 bit values so that overflow
+ * wraps rather than being undefined.
+ */
+#define DEFINE_KERNEL(NAME, T, WIDE, OP)                                              \
+    static void NAME(void *out, const void *a, const void *b, int length) {          \
+        T *restrict o = out;                                                          \
+        const T *restrict x = a;                                                      \
+        const T *restrict y = b;                                                      \
+        for (int i = 0; i < length; ++i) {                                            \
+            o[i] = (T) ((WIDE) x[i] OP (WIDE) y[i]);                                  \
+        }                                                                             \
+    }                                                                                 \
+                                                                                      \
+    static void NAME##Scalar(void *out, const void *a, const void *b, int length) {  \
+        T *restrict o = out;                                                          \
+        const T *restrict x = a;                                                      \
+        const WIDE y = (WIDE) *(const T *) b;                                         \
+        for (int i = 0; i < length; ++i) {                                            \
+            o[i] = (T) ((WIDE) x[i] OP y);                                            \
+        }                                                                             \
+    }
+
+#define DEFINE_KERNELS(SUFFIX, T, WIDE)                 \
+    DEFINE_KERNEL(add##SUFFIX, T, WIDE, +)              \
+    DEFINE_KERNEL(subtract##SUFFIX, T, WIDE, -)         \
+    DEFINE_KERNEL(multiply##SUFFIX, T, WIDE, *)
+
+DEFINE_KERNELS(Float64, double, double)
+DEFINE_KERNELS(Int64, int64_t, uint64_t)
+DEFINE_KERNELS(Int32, int32_t, uint64_t)
+DEFINE_KERNELS(UInt8, uint8_t, uint64_t)
+
+DEFINE_KERNEL(divideFloat64, double, double, /)
+
+#undef DEFINE_KERNELS
+#undef DEFINE_KERNEL
+
+static const Kernel arrayKernels[TYPED_ARRAY_TYPE_COUNT][3] = {
+    {addFloat64, subtractFloat64, multiplyFloat64},
+    {addInt64, subtractInt64, multiplyInt64},
+    {addInt32, subtractInt32, multiplyInt32},
+    {addUInt8, subtractUInt8, multiplyUInt8},
+};
+
+static const Kernel scalarKernels[TYPED_ARRAY_TYPE_COUNT][3] = {
+    {addFloat64Scalar, subtractFloat64Scalar, multiplyFloat64Scalar},
+    {addInt64Scalar, subtractInt64Scalar, multiplyInt64Scalar},
+    {addInt32Scalar, subtractInt32Scalar, multiplyInt32Scalar},
+    {addUInt8Scalar, subtractUInt8Scalar, multiplyUInt8Scalar},
+};
+
+// Expands the body once per element type with T bound to the C element type
+#define TYPED_ARRAY_SWITCH(arrayType, ...)                                   \
+    switch (arrayType) {                                                     \
+        case TYPED_ARRAY_FLOAT64: { typedef double T; __VA_ARGS__; break; }  \
+        case TYPED_ARRAY_INT64: { typedef int64_t T; __VA_ARGS__; break; }   \
+        case TYPED_ARRAY_INT32: { typedef int32_t T; __VA_ARGS__; break; }   \
+        case TYPED_ARRAY_UINT8: { typedef uint8_t T; __VA_ARGS__; break; }   \
+    }
+
+#define TYPED_ARRAY_INTEGER_SWITCH(arrayType, ...)                           \
+    switch (arrayType) {                                                     \
+        case TYPED_ARRAY_INT64: { typedef int64_t T; __VA_ARGS__; break; }   \
+        case TYPED_ARRAY_INT32: { typedef int32_t T; __VA_ARGS__; break; }   \
+        case TYPED_ARRAY_UINT8: { typedef uint8_t T; __VA_ARGS__; break; }   \
+        default: break;                                                      \
+    }
+
+void freeTypedArray(DictuVM *vm, ObjAbstract *abstract) {
+    TypedArray *array = (TypedArray *)abstract->data;
+    FREE_ARRAY(vm, uint8_t, array->data, array->length * elementSizes[array->type]);
+    FREE(vm, TypedArray, abstract->data);
+}
+
+char *typedArrayToString(ObjAbstract *abstract) {
+    TypedArray *array = (TypedArray *)abstract->data;
+    const char *typeName = typeNames[array->type];
+
+    int length = strlen(typeName) + 14;
+    char *arrayString = malloc(sizeof(char) * length);
+    snprintf(arrayString, length, "<TypedArray %s>", typeName);
+    return arrayString;
+}
+
+static int64_t toInteger(double value) {
+    if (value != value) {
+        return 0;
+    }
+
+    if (value >= 9223372036854775807.0) {
+        return INT64_MAX;
+    }
+
+    if (value <= -9223372036854775808.0) {
+        return INT64_MIN;
+    }
+
+    return (int64_t) value;
+}
+
+// Converts a Dictu number into an element, integer types wrap like C casts
+static void storeElement(TypedArray *array, int index, double value) {
+    switch (array->type) {
+        case TYPED_ARRAY_FLOAT64: {
+            ((double *) array->data)[index] = value;
+            break;
+        }
+
+        case TYPED_ARRAY_INT64: {
+            ((int64_t *) array->data)[index] = toInteger(value);
+            break;
+        }
+
+        case TYPED_ARRAY_INT32: {
+            ((int32_t *) array->data)[index] = (int32_t) (uint32_t) toInteger(value);
+            break;
+        }
+
+        case TYPED_ARRAY_UINT8: {
+            ((uint8_t *) array->data)[index] = (uint8_t) toInteger(value);
+            break;
+        }
+    }
+}
+
+static double loadElement(TypedArray *array, int index) {
+    TYPED_ARRAY_SWITCH(array->type, return (double) ((T *) array->data)[index])
+
+    return 0;
+}
+
+static bool typeFromString(DictuVM *vm, Value value, TypedArrayType *type) {
+    if (!IS_STRING(value)) {
+        runtimeError(vm, "TypedArray type must be a string");
+        return false;
+    }
+
+    char *name = AS_CSTRING(value);
+
+    for (int i = 0; i < TYPED_ARRAY_TYPE_COUNT; ++i) {
+        if (strcmp(typeNames[i], name) == 0) {
+            *type = (TypedArrayType) i;
+            return true;
+        }
+    }
+
+    runtimeError(vm, "Unknown TypedArray type '%s', expected float64, int64, int32 or uint8", name);
+    return false;
+}
+
+ObjAbstract *newTypedArrayObj(DictuVM *vm, TypedArrayType type, int length);
+
+static TypedArray *newResultArray(DictuVM *vm, TypedArray *source, int length, ObjAbstract **abstract) {
+    *abstract = newTypedArrayObj(vm, source->type, length);
+    return (TypedArray *) (*abstract)->data;
+}
+
+static Value typedArrayLen(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "len() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(AS_TYPED_ARRAY(args[0])->length);
+}
+
+static Value typedArrayElementType(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "elementType() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    const char *name = typeNames[AS_TYPED_ARRAY(args[0])->type];
+    return OBJ_VAL(copyString(vm, name, strlen(name)));
+}
+
+static bool checkIndex(DictuVM *vm, const char *name, TypedArray *array, Value value, int *index) {
+    if (!IS_NUMBER(value)) {
+        runtimeError(vm, "%s() index argument must be a number", name);
+        return false;
+    }
+
+    int i = AS_NUMBER(value);
+
+    // Allow negative indexes
+    if (i < 0) {
+        i = array->length + i;
+    }
+
+    if (i < 0 || i >= array->length) {
+        runtimeError(vm, "TypedArray index out of bounds.");
+        return false;
+    }
+
+    *index = i;
+    return true;
+}
+
+static Value typedArrayGet(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "get() takes 1 argument (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    int index;
+
+    if (!checkIndex(vm, "get", array, args[1], &index)) {
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(loadElement(array, index));
+}
+
+static Value typedArraySet(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 2) {
+        runtimeError(vm, "set() takes 2 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    int index;
+
+    if (!checkIndex(vm, "set", array, args[1], &index)) {
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[2])) {
+        runtimeError(vm, "set() value argument must be a number");
+        return EMPTY_VAL;
+    }
+
+    storeElement(array, index, AS_NUMBER(args[2]));
+    return NIL_VAL;
+}
+
+static Value typedArrayFill(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "fill() takes 1 argument (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[1])) {
+        runtimeError(vm, "fill() argument must be a number");
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+
+    if (array->length == 0) {
+        return NIL_VAL;
+    }
+
+    storeElement(array, 0, AS_NUMBER(args[1]));
+
+    TYPED_ARRAY_SWITCH(array->type,
+        T *data = array->data;
+        T value = data[0];
+        for (int i = 1; i < array->length; ++i) {
+            data[i] = value;
+        }
+    )
+
+    return NIL_VAL;
+}
+
+static Value typedArrayToList(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "toList() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    ObjList *list = newList(vm);
+    push(vm, OBJ_VAL(list));
+
+    for (int i = 0; i < array->length; ++i) {
+        writeValueArray(vm, &list->values, NUMBER_VAL(loadElement(array, i)));
+    }
+
+    pop(vm);
+    return OBJ_VAL(list);
+}
+
+static Value typedArrayToBuffer(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "toBuffer() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    size_t size = array->length * elementSizes[array->type];
+
+    if (size == 0 || size >= BUFFER_SIZE_MAX) {
+        return newResultError(vm, "TypedArray size must be greater than 0 and smaller than 2147483647 bytes");
+    }
+
+    ObjAbstract *buffer = newBufferObj(vm, size);
+    memcpy(((Buffer *) buffer->data)->bytes, array->data, size);
+
+    return newResultSuccess(vm, OBJ_VAL(buffer));
+}
+
+static Value typedArraySlice(DictuVM *vm, int argCount, Value *args) {
+    if (argCount > 2) {
+        runtimeError(vm, "slice() takes at most 2 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    int start = 0;
+    int end = array->length;
+
+    if (argCount > 0) {
+        if (!IS_NUMBER(args[1])) {
+            runtimeError(vm, "slice() start argument must be a number");
+            return EMPTY_VAL;
+        }
+
+        start = AS_NUMBER(args[1]);
+    }
+
+    if (argCount == 2) {
+        if (!IS_NUMBER(args[2])) {
+            runtimeError(vm, "slice() end argument must be a number");
+            return EMPTY_VAL;
+        }
+
+        end = AS_NUMBER(args[2]);
+    }
+
+    // Allow negative indexes
+    if (start < 0) start = array->length + start;
+    if (end < 0) end = array->length + end;
+    if (start < 0) start = 0;
+    if (end > array->length) end = array->length;
+    if (end < start) end = start;
+
+    ObjAbstract *abstract;
+    TypedArray *result = newResultArray(vm, array, end - start, &abstract);
+    size_t elementSize = elementSizes[array->type];
+
+    if (result->length > 0) {
+        memcpy(result->data, (uint8_t *) array->data + start * elementSize, result->length * elementSize);
+    }
+
+    return OBJ_VAL(abstract);
+}
+
+static bool divideIntegers(TypedArray *result, TypedArray *array, void *other, bool scalar) {
+    TYPED_ARRAY_INTEGER_SWITCH(array->type,
+        T *out = result->data;
+        const T *x = array->data;
+        const T *y = other;
+
+        for (int i = 0; i < array->length; ++i) {
+            T divisor = scalar ? y[0] : y[i];
+
+            if (divisor == 0) {
+                return false;
+            }
+
+            // Avoid the overflow of the most negative value divided by -1
+            if ((T) -1 < 0 && divisor == (T) -1) {
+                out[i] = (T) (0 - (uint64_t) x[i]);
+            } else {
+                out[i] = x[i] / divisor;
+            }
+        }
+    )
+
+    return true;
+}
+
+static Value elementwise(DictuVM *vm, int argCount, Value *args, const char *name, ElementwiseOp op) {
+    if (argCount != 1) {
+        runtimeError(vm, "%s() takes 1 argument (%d given).", name, argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    void *other;
+    bool scalar;
+    // Large enough to hold a single element of any type
+    uint64_t scalarStorage = 0;
+
+    if (IS_NUMBER(args[1])) {
+        TypedArray scalarArray = {array->type, 1, &scalarStorage};
+        storeElement(&scalarArray, 0, AS_NUMBER(args[1]));
+        other = &scalarStorage;
+        scalar = true;
+    } else if (IS_TYPED_ARRAY(args[1])) {
+        TypedArray *otherArray = AS_TYPED_ARRAY(args[1]);
+
+        if (otherArray->type != array->type) {
+            runtimeError(vm, "%s() TypedArray types must match (%s and %s)", name,
+                         typeNames[array->type], typeNames[otherArray->type]);
+            return EMPTY_VAL;
+        }
+
+        if (otherArray->length != array->length) {
+            runtimeError(vm, "%s() TypedArray lengths must match (%d and %d)", name,
+                         array->length, otherArray->length);
+            return EMPTY_VAL;
+        }
+
+        other = otherArray->data;
+        scalar = false;
+    } else {
+        runtimeError(vm, "%s() argument must be a number or a TypedArray", name);
+        return EMPTY_VAL;
+    }
+
+    ObjAbstract *abstract;
+    TypedArray *result = newResultArray(vm, array, array->length, &abstract);
+
+    if (op != ELEMENTWISE_DIVIDE) {
+        Kernel kernel = scalar ? scalarKernels[array->type][op] : arrayKernels[array->type][op];
+        kernel(result->data, array->data, other, array->length);
+    } else if (array->type == TYPED_ARRAY_FLOAT64) {
+        Kernel kernel = scalar ? divideFloat64Scalar : divideFloat64;
+        kernel(result->data, array->data, other, array->length);
+    } else if (!divideIntegers(result, array, other, scalar)) {
+        runtimeError(vm, "Integer division by zero in div()");
+        return EMPTY_VAL;
+    }
+
+    return OBJ_VAL(abstract);
+}
+
+static Value typedArrayAdd(DictuVM *vm, int argCount, Value *args) {
+    return elementwise(vm, argCount, args, "add", ELEMENTWISE_ADD);
+}
+
+static Value typedArraySubtract(DictuVM *vm, int argCount, Value *args) {
+    return elementwise(vm, argCount, args, "sub", ELEMENTWISE_SUBTRACT);
+}
+
+static Value typedArrayMultiply(DictuVM *vm, int argCount, Value *args) {
+    return elementwise(vm, argCount, args, "mul", ELEMENTWISE_MULTIPLY);
+}
+
+static Value typedArrayDivide(DictuVM *vm, int argCount, Value *args) {
+    return elementwise(vm, argCount, args, "div", ELEMENTWISE_DIVIDE);
+}
+
+static double sumFloat64(const double *data, int length) {
+    // Independent accumulators break the dependency chain between additions
+    double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    int i = 0;
+
+    for (; i + 4 <= length; i += 4) {
+        s0 += data[i];
+        s1 += data[i + 1];
+        s2 += data[i + 2];
+        s3 += data[i + 3];
+    }
+
+    for (; i < length; ++i) {
+        s0 += data[i];
+    }
+
+    return (s0 + s1) + (s2 + s3);
+}
+
+static double sumElements(TypedArray *array) {
+    if (array->type == TYPED_ARRAY_FLOAT64) {
+        return sumFloat64(array->data, array->length);
+    }
+
+    uint64_t sum = 0;
+
+    TYPED_ARRAY_INTEGER_SWITCH(array->type,
+        const T *data = array->data;
+        for (int i = 0; i < array->length; ++i) {
+            sum += (uint64_t) data[i];
+        }
+    )
+
+    return (double) (int64_t) sum;
+}
+
+static Value typedArraySum(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "sum() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(sumElements(AS_TYPED_ARRAY(args[0])));
+}
+
+static Value typedArrayMean(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "mean() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+
+    if (array->length == 0) {
+        runtimeError(vm, "mean() called on an empty TypedArray");
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(sumElements(array) / array->length);
+}
+
+static Value typedArrayMin(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "min() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+
+    if (array->length == 0) {
+        runtimeError(vm, "min() called on an empty TypedArray");
+        return EMPTY_VAL;
+    }
+
+    double minimum = 0;
+
+    TYPED_ARRAY_SWITCH(array->type,
+        const T *data = array->data;
+        T current = data[0];
+        for (int i = 1; i < array->length; ++i) {
+            current = data[i] < current ? data[i] : current;
+        }
+        minimum = (double) current;
+    )
+
+    return NUMBER_VAL(minimum);
+}
+
+static Value typedArrayMax(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "max() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+
+    if (array->length == 0) {
+        runtimeError(vm, "max() called on an empty TypedArray");
+        return EMPTY_VAL;
+    }
+
+    double maximum = 0;
+
+    TYPED_ARRAY_SWITCH(array->type,
+        const T *data = array->data;
+        T current = data[0];
+        for (int i = 1; i < array->length; ++i) {
+            current = data[i] > current ? data[i] : current;
+        }
+        maximum = (double) current;
+    )
+
+    return NUMBER_VAL(maximum);
+}
+
+static Value typedArrayDot(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "dot() takes 1 argument (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_TYPED_ARRAY(args[1])) {
+        runtimeError(vm, "dot() argument must be a TypedArray");
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+    TypedArray *other = AS_TYPED_ARRAY(args[1]);
+
+    if (array->type != other->type || array->length != other->length) {
+        runtimeError(vm, "dot() TypedArrays must have the same type and length");
+        return EMPTY_VAL;
+    }
+
+    if (array->type == TYPED_ARRAY_FLOAT64) {
+        const double *x = array->data;
+        const double *y = other->data;
+        double s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        int i = 0;
+
+        for (; i + 4 <= array->length; i += 4) {
+            s0 += x[i] * y[i];
+            s1 += x[i + 1] * y[i + 1];
+            s2 += x[i + 2] * y[i + 2];
+            s3 += x[i + 3] * y[i + 3];
+        }
+
+        for (; i < array->length; ++i) {
+            s0 += x[i] * y[i];
+        }
+
+        return NUMBER_VAL((s0 + s1) + (s2 + s3));
+    }
+
+    uint64_t sum = 0;
+
+    TYPED_ARRAY_INTEGER_SWITCH(array->type,
+        const T *x = array->data;
+        const T *y = other->data;
+        for (int i = 0; i < array->length; ++i) {
+            sum += (uint64_t) x[i] * (uint64_t) y[i];
+        }
+    )
+
+    return NUMBER_VAL((double) (int64_t) sum);
+}
+
+#define DEFINE_COMPARE(NAME, T)                          \
+    static int NAME(const void *a, const void *b) {      \
+        T x = *(const T *) a;                            \
+        T y = *(const T *) b;                            \
+        return (x > y) - (x < y);                        \
+    }
+
+DEFINE_COMPARE(compareFloat64, double)
+DEFINE_COMPARE(compareInt64, int64_t)
+DEFINE_COMPARE(compareInt32, int32_t)
+
+#undef DEFINE_COMPARE
+
+static Value typedArraySort(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "sort() takes no arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArray *array = AS_TYPED_ARRAY(args[0]);
+
+    switch (array->type) {
+        case TYPED_ARRAY_FLOAT64: {
+            qsort(array->data, array->length, sizeof(double), compareFloat64);
+            break;
+        }
+
+        case TYPED_ARRAY_INT64: {
+            qsort(array->data, array->length, sizeof(int64_t), compareInt64);
+            break;
+        }
+
+        case TYPED_ARRAY_INT32: {
+            qsort(array->data, array->length, sizeof(int32_t), compareInt32);
+            break;
+        }
+
+        case TYPED_ARRAY_UINT8: {
+            // Counting sort, there are only 256 possible values
+            int counts[256] = {0};
+            uint8_t *data = array->data;
+
+            for (int i = 0; i < array->length; ++i) {
+                counts[data[i]]++;
+            }
+
+            int index = 0;
+            for (int value = 0; value < 256; ++value) {
+                memset(data + index, value, counts[value]);
+                index += counts[value];
+            }
+
+            break;
+        }
+    }
+
+    return NIL_VAL;
+}
+
+ObjAbstract *newTypedArrayObj(DictuVM *vm, TypedArrayType type, int length) {
+    ObjAbstract *abstract = newAbstract(vm, freeTypedArray, typedArrayToString);
+    push(vm, OBJ_VAL(abstract));
+
+    TypedArray *array = ALLOCATE(vm, TypedArray, 1);
+    array->type = type;
+    array->length = 0;
+    array->data = NULL;
+    abstract->data = array;
+
+    array->data = ALLOCATE(vm, uint8_t, length * elementSizes[type]);
+    array->length = length;
+
+    if (length > 0) {
+        memset(array->data, 0, length * elementSizes[type]);
+    }
+
+    /**
+     * Setup TypedArray object methods
+     */
+    defineNative(vm, &abstract->values, "len", typedArrayLen);
+    defineNative(vm, &abstract->values, "elementType", typedArrayElementType);
+    defineNative(vm, &abstract->values, "get", typedArrayGet);
+    defineNative(vm, &abstract->values, "set", typedArraySet);
+    defineNative(vm, &abstract->values, "fill", typedArrayFill);
+    defineNative(vm, &abstract->values, "toList", typedArrayToList);
+    defineNative(vm, &abstract->values, "toBuffer", typedArrayToBuffer);
+    defineNative(vm, &abstract->values, "slice", typedArraySlice);
+    defineNative(vm, &abstract->values, "add", typedArrayAdd);
+    defineNative(vm, &abstract->values, "sub", typedArraySubtract);
+    defineNative(vm, &abstract->values, "mul", typedArrayMultiply);
+    defineNative(vm, &abstract->values, "div", typedArrayDivide);
+    defineNative(vm, &abstract->values, "sum", typedArraySum);
+    defineNative(vm, &abstract->values, "mean", typedArrayMean);
+    defineNative(vm, &abstract->values, "min", typedArrayMin);
+    defineNative(vm, &abstract->values, "max", typedArrayMax);
+    defineNative(vm, &abstract->values, "dot", typedArrayDot);
+    defineNative(vm, &abstract->values, "sort", typedArraySort);
+
+    pop(vm);
+
+    return abstract;
+}
+
+static Value newTypedArray(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 2) {
+        runtimeError(vm, "new() takes 2 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArrayType type;
+    if (!typeFromString(vm, args[0], &type)) {
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[1])) {
+        runtimeError(vm, "new() length argument must be a number");
+        return EMPTY_VAL;
+    }
+
+    // NaN fails every comparison, so reject anything that is not a whole number first
+    double length = AS_NUMBER(args[1]);
+    if (!isfinite(length) || length != floor(length)) {
+        return newResultError(vm, "length must be a whole number");
+    }
+
+    if (length < 0 || length * elementSizes[type] >= BUFFER_SIZE_MAX) {
+        return newResultError(vm, "length must be positive and the array smaller than 2147483647 bytes");
+    }
+
+    return newResultSuccess(vm, OBJ_VAL(newTypedArrayObj(vm, type, length)));
+}
+
+static Value newTypedArrayFromList(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 2) {
+        runtimeError(vm, "fromList() takes 2 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArrayType type;
+    if (!typeFromString(vm, args[0], &type)) {
+        return EMPTY_VAL;
+    }
+
+    if (!IS_LIST(args[1])) {
+        runtimeError(vm, "fromList() second argument must be a list");
+        return EMPTY_VAL;
+    }
+
+    ObjList *list = AS_LIST(args[1]);
+
+    for (int i = 0; i < list->values.count; ++i) {
+        if (!IS_NUMBER(list->values.values[i])) {
+            runtimeError(vm, "A non-number value passed to fromList()");
+            return EMPTY_VAL;
+        }
+    }
+
+    if ((double) list->values.count * elementSizes[type] >= BUFFER_SIZE_MAX) {
+        return newResultError(vm, "TypedArray must be smaller than 2147483647 bytes");
+    }
+
+    ObjAbstract *abstract = newTypedArrayObj(vm, type, list->values.count);
+    TypedArray *array = (TypedArray *) abstract->data;
+
+    for (int i = 0; i < list->values.count; ++i) {
+        storeElement(array, i, AS_NUMBER(list->values.values[i]));
+    }
+
+    return newResultSuccess(vm, OBJ_VAL(abstract));
+}
+
+static Value newTypedArrayFromBuffer(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 2) {
+        runtimeError(vm, "fromBuffer() takes 2 arguments (%d given).", argCount);
+        return EMPTY_VAL;
+    }
+
+    TypedArrayType type;
+    if (!typeFromString(vm, args[0], &type)) {
+        return EMPTY_VAL;
+    }
+
+    if (!IS_BUFFER(args[1])) {
+        runtimeError(vm, "fromBuffer() second argument must be a Buffer");
+        return EMPTY_VAL;
+    }
+
+    Buffer *buffer = AS_BUFFER(args[1]);
+    size_t elementSize = elementSizes[type];
+
+    if (buffer->size % elementSize != 0) {
+        return newResultError(vm, "Buffer size is not a multiple of the element size");
+    }
+
+    ObjAbstract *abstract = newTypedArrayObj(vm, type, buffer->size / elementSize);
+    memcpy(((TypedArray *) abstract->data)->data, buffer->bytes, buffer->size);
+
+    return newResultSuccess(vm, OBJ_VAL(abstract));
+}
+
+Value createTypedArrayModule(DictuVM *vm) {
+    ObjString *name = copyString(vm, "TypedArray", 10);
+    push(vm, OBJ_VAL(name));
+    ObjModule *module = newModule(vm, name);
+    push(vm, OBJ_VAL(module));
+
+    defineNative(vm, &module->values, "new", newTypedArray);
+    defineNative(vm, &module->values, "fromList", newTypedArrayFromList);
+    defineNative(vm, &module->values, "fromBuffer", newTypedArrayFromBuffer);
+
+    pop(vm);
+    pop(vm);
+
+    return OBJ_VAL(module);
+}
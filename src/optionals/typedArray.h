@@ -0,0 +1,9 @@
+#ifndef dictu_typed_array_h
+#define dictu_typed_array_h
+
+#include "optionals.h"
+#include "../vm/vm.h"
+
+Value createTypedArrayModule(DictuVM *vm);
+
+#endif //dictu_typed_array_h
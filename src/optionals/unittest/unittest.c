@@ -42,7 +42,7 @@ static Value mockNative(DictuVM *vm, int argCount, Value *args) {
         emptyFunc->name = klass->publicMethods.entries[i].key;
 
         Value val;
-        if (returnValues != NULL && dictGet(returnValues, OBJ_VAL(klass->publicMethods.entries[i].key), &val)) {
+        if (returnValues != NULL && dictGet(vm, returnValues, OBJ_VAL(klass->publicMethods.entries[i].key), &val)) {
             int constant = addConstant(vm, &emptyFunc->chunk, val);
             writeChunk(vm, &emptyFunc->chunk, constant, 1);
             writeChunk(vm, &emptyFunc->chunk, OP_CONSTANT, 1);
@@ -1402,6 +1402,51 @@ static void static_(Compiler *compiler, bool canAssign) {
     }
 }
 
+static void yield_(Compiler *compiler, bool canAssign) {
+    UNUSED(canAssign);
+
+    if (compiler->type == TYPE_TOP_LEVEL) {
+        error(compiler->parser, "Cannot yield from top-level code.");
+    } else if (compiler->type == TYPE_INITIALIZER) {
+        error(compiler->parser, "Cannot yield from an initializer.");
+    }
+
+    // Any function that yields runs as a coroutine
+    compiler->function->isCoroutine = true;
+
+    switch (compiler->parser->current.type) {
+        case TOKEN_SEMICOLON:
+        case TOKEN_COMMA:
+        case TOKEN_COLON:
+        case TOKEN_RIGHT_PAREN:
+        case TOKEN_RIGHT_BRACKET:
+        case TOKEN_RIGHT_BRACE:
+            emitByte(compiler, OP_NIL);
+            break;
+
+        default:
+            expression(compiler);
+    }
+
+    emitByte(compiler, OP_YIELD);
+}
+
+static void resume_(Compiler *compiler, bool canAssign) {
+    UNUSED(canAssign);
+
+    consume(compiler, TOKEN_LEFT_PAREN, "Expect '(' after 'resume'.");
+    expression(compiler);
+
+    if (match(compiler, TOKEN_COMMA)) {
+        expression(compiler);
+    } else {
+        emitByte(compiler, OP_NIL);
+    }
+
+    consume(compiler, TOKEN_RIGHT_PAREN, "Expect ')' after resume arguments.");
+    emitByte(compiler, OP_RESUME);
+}
+
 static void useStatement(Compiler *compiler) {
     if (compiler->class == NULL) {
         error(compiler->parser, "Cannot utilise 'use' outside of a class.");
@@ -1542,10 +1587,13 @@ ParseRule rules[] = {
         {literal,  NULL,      PREC_NONE},               // TOKEN_FALSE
         {literal,  NULL,      PREC_NONE},               // TOKEN_NIL
         {NULL,     NULL,      PREC_NONE},               // TOKEN_FOR
+        {NULL,     NULL,      PREC_NONE},               // TOKEN_IN
         {NULL,     NULL,      PREC_NONE},               // TOKEN_WHILE
         {NULL,     NULL,      PREC_NONE},               // TOKEN_BREAK
         {NULL,     NULL,      PREC_NONE},               // TOKEN_RETURN
         {NULL,     NULL,      PREC_NONE},               // TOKEN_CONTINUE
+        {yield_,   NULL,      PREC_NONE},               // TOKEN_YIELD
+        {resume_,  NULL,      PREC_NONE},               // TOKEN_RESUME
         {NULL,     NULL,      PREC_NONE},               // TOKEN_WITH
         {NULL,     NULL,      PREC_NONE},               // TOKEN_EOF
         {NULL,     NULL,      PREC_NONE},               // TOKEN_IMPORT
@@ -1647,7 +1695,7 @@ static void method(Compiler *compiler, bool private, LangToken *identifier, bool
         DictuVM *vm = compiler->parser->vm;
 
         Value existingDict;
-        dictGet(compiler->methodAnnotations, OBJ_VAL(vm->annotationString), &existingDict);
+        dictGet(vm, compiler->methodAnnotations, OBJ_VAL(vm->annotationString), &existingDict);
         ObjString *methodName = AS_STRING(currentChunk(compiler)->constants.values[constant]);
         dictSet(vm, compiler->methodAnnotations, OBJ_VAL(methodName), existingDict);
         dictDelete(vm, compiler->methodAnnotations, OBJ_VAL(vm->annotationString));
@@ -1942,7 +1990,7 @@ static void parseClassBody(Compiler *compiler) {
                 ObjString *varName = AS_STRING(currentChunk(compiler)->constants.values[name]);
 
                 Value existingDict;
-                dictGet(compiler->fieldAnnotations, OBJ_VAL(vm->annotationString), &existingDict);
+                dictGet(vm, compiler->fieldAnnotations, OBJ_VAL(vm->annotationString), &existingDict);
                 dictSet(vm, compiler->fieldAnnotations, OBJ_VAL(varName), existingDict);
                 dictDelete(vm, compiler->fieldAnnotations, OBJ_VAL(vm->annotationString));
 
@@ -1963,7 +2011,7 @@ static void parseClassBody(Compiler *compiler) {
                 ObjString *varName = AS_STRING(currentChunk(compiler)->constants.values[name]);
 
                 Value existingDict;
-                dictGet(compiler->fieldAnnotations, OBJ_VAL(vm->annotationString), &existingDict);
+                dictGet(vm, compiler->fieldAnnotations, OBJ_VAL(vm->annotationString), &existingDict);
                 dictSet(vm, compiler->fieldAnnotations, OBJ_VAL(varName), existingDict);
                 dictDelete(vm, compiler->fieldAnnotations, OBJ_VAL(vm->annotationString));
 
@@ -2295,6 +2343,7 @@ static int getArgCount(uint8_t *code, const ValueArray constants, int ip) {
         case OP_INVOKE:
         case OP_INVOKE_INTERNAL:
         case OP_SUPER:
+        case OP_FOR_ITER:
             return 3;
 
         case OP_IMPORT_BUILTIN_VARIABLE: {
@@ -2340,6 +2389,71 @@ static void endLoop(Compiler *compiler) {
     compiler->loop = compiler->loop->enclosing;
 }
 
+static void forInStatement(Compiler *compiler) {
+    // for (var x in iterable) print x;
+    //
+    //   var <iterator> = iterable;  (or iterable.__iter__())
+    //   var <cursor> = 0;
+    // start:                             <--.
+    //   x = next <iterator>, <cursor>       |
+    //       or goto exit;  ----------.      |
+    //   print x;                     |      |
+    //   goto start;  ----------------+------'
+    // exit:                       <--'
+
+    consume(compiler, TOKEN_IDENTIFIER, "Expect loop variable name.");
+    LangToken name = compiler->parser->previous;
+    consume(compiler, TOKEN_IN, "Expect 'in' after loop variable.");
+
+    expression(compiler);
+    consume(compiler, TOKEN_RIGHT_PAREN, "Expect ')' after for clauses.");
+    emitByte(compiler, OP_GET_ITER);
+
+    // The iterator and its position live in hidden locals, the names
+    // can't clash with user variables as they aren't valid identifiers.
+    int iteratorSlot = compiler->localCount;
+    addLocal(compiler, syntheticToken(" iterator"));
+    defineVariable(compiler, 0, false);
+
+    emitConstant(compiler, NUMBER_VAL(0));
+    addLocal(compiler, syntheticToken(" cursor"));
+    defineVariable(compiler, 0, false);
+
+    Loop loop;
+    loop.start = currentChunk(compiler)->count;
+    loop.scopeDepth = compiler->scopeDepth;
+    loop.enclosing = compiler->loop;
+    loop.end = -1;
+    compiler->loop = &loop;
+
+    emitBytes(compiler, OP_FOR_ITER, iteratorSlot);
+    emitBytes(compiler, 0xff, 0xff);
+    int exitJump = currentChunk(compiler)->count - 2;
+
+    // Each iteration gets a fresh loop variable so closures capture
+    // the value of that iteration.
+    compiler->loop->body = compiler->function->chunk.count;
+    beginScope(compiler);
+    declareVariable(compiler, &name);
+    defineVariable(compiler, 0, false);
+    statement(compiler);
+    endScope(compiler);
+
+    emitLoop(compiler, compiler->loop->start);
+
+    patchJump(compiler, exitJump);
+    endLoop(compiler);
+}
+
+static bool isForIn(Compiler *compiler) {
+    if (!check(compiler, TOKEN_IDENTIFIER)) {
+        return false;
+    }
+
+    Scanner lookahead = compiler->parser->scanner;
+    return scanToken(&lookahead).type == TOKEN_IN;
+}
+
 static void forStatement(Compiler *compiler) {
     // for (var i = 0; i < 10; i = i + 1) print i;
     //
@@ -2361,6 +2475,12 @@ static void forStatement(Compiler *compiler) {
     // The initialization clause.
     consume(compiler, TOKEN_LEFT_PAREN, "Expect '(' after 'for'.");
     if (match(compiler, TOKEN_VAR)) {
+        if (isForIn(compiler)) {
+            forInStatement(compiler);
+            endScope(compiler); // Iterator.
+            return;
+        }
+
         varDeclaration(compiler, false);
     } else if (match(compiler, TOKEN_SEMICOLON)) {
         // No initializer.
@@ -1,118 +1,267 @@
 #include "copy.h"
 
-ObjList *copyList(DictuVM* vm, ObjList *oldList, bool shallow);
+/**
+ * Deep copies walk the object graph with an explicit worklist rather than
+ * recursing on the C stack, and keep an identity map from each original
+ * object to its copy. This means deeply nested structures can't overflow
+ * the stack, cyclic structures terminate and an object reachable through
+ * several paths is copied once, preserving the sharing in the copy.
+ */
+typedef struct {
+    Obj *original;
+    Obj *copy;
+} CopyEntry;
 
-ObjDict *copyDict(DictuVM* vm, ObjDict *oldDict, bool shallow) {
-    ObjDict *dict = newDict(vm);
-    // Push to stack to avoid GC
-    push(vm, OBJ_VAL(dict));
+/**
+ * The identity map and worklist are scratch space that holds no GC
+ * references of its own (every copy is rooted through the root copy), so
+ * they are allocated outside of the VM heap and never trigger a collection.
+ */
+typedef struct {
+    // Identity map, open addressing keyed on the original's address
+    CopyEntry *entries;
+    int capacity;
+    int count;
+    // Copies whose contents still point at the original objects
+    Obj **pending;
+    int pendingCapacity;
+    int pendingCount;
+} DeepCopy;
 
-    for (int i = 0; i <= oldDict->capacityMask; ++i) {
-        if (IS_EMPTY(oldDict->entries[i].key)) {
-            continue;
-        }
+#define COPY_MAP_MAX_LOAD 0.75
 
-        Value val = oldDict->entries[i].value;
+// Objects allocated close together land in nearby slots, which keeps the
+// probes cache friendly as a structure is walked in allocation order
+static uint32_t hashPointer(Obj *object) {
+    return (uint32_t) ((uintptr_t) object >> 4);
+}
 
-        if (!shallow) {
-            if (IS_DICT(val)) {
-                val = OBJ_VAL(copyDict(vm, AS_DICT(val), false));
-            } else if (IS_LIST(val)) {
-                val = OBJ_VAL(copyList(vm, AS_LIST(val), false));
-            } else if (IS_INSTANCE(val)) {
-                val = OBJ_VAL(copyInstance(vm, AS_INSTANCE(val), false));
-            }
+static CopyEntry *findCopyEntry(CopyEntry *entries, int capacity, Obj *original) {
+    uint32_t index = hashPointer(original) & (capacity - 1);
+
+    for (;;) {
+        CopyEntry *entry = &entries[index];
+
+        if (entry->original == NULL || entry->original == original) {
+            return entry;
         }
 
-        // Push to stack to avoid GC
-        push(vm, val);
-        dictSet(vm, dict, oldDict->entries[i].key, val);
+        index = (index + 1) & (capacity - 1);
+    }
+}
+
+static void growCopyMap(DeepCopy *state) {
+    int capacity = GROW_CAPACITY(state->capacity);
+    CopyEntry *entries = malloc(sizeof(CopyEntry) * capacity);
+    memset(entries, 0, sizeof(CopyEntry) * capacity);
+
+    for (int i = 0; i < state->capacity; ++i) {
+        CopyEntry *entry = &state->entries[i];
+        if (entry->original == NULL) continue;
+
+        *findCopyEntry(entries, capacity, entry->original) = *entry;
+    }
+
+    free(state->entries);
+    state->entries = entries;
+    state->capacity = capacity;
+}
+
+static void cloneTable(DictuVM *vm, Table *from, Table *to) {
+    freeTable(vm, to);
+
+    if (from->capacity == 0) {
+        return;
+    }
+
+    to->entries = ALLOCATE(vm, Entry, from->capacity);
+    memcpy(to->entries, from->entries, sizeof(Entry) * from->capacity);
+    to->capacity = from->capacity;
+    to->count = from->count;
+}
+
+/**
+ * Shallow copies are sized exactly from their source, the values
+ * are copied wholesale rather than re-inserted one by one.
+ */
+static ObjDict *cloneDict(DictuVM *vm, ObjDict *oldDict) {
+    ObjDict *dict = newDict(vm);
+
+    if (oldDict->count > 0) {
+        push(vm, OBJ_VAL(dict));
+        dict->entries = ALLOCATE(vm, DictItem, oldDict->capacityMask + 1);
+        memcpy(dict->entries, oldDict->entries, sizeof(DictItem) * (oldDict->capacityMask + 1));
+        dict->capacityMask = oldDict->capacityMask;
+        dict->count = oldDict->count;
+        dict->activeCount = oldDict->activeCount;
         pop(vm);
     }
 
-    pop(vm);
     return dict;
 }
 
-ObjList *copyList(DictuVM* vm, ObjList *oldList, bool shallow) {
+static ObjInstance *cloneInstance(DictuVM *vm, ObjInstance *oldInstance) {
+    ObjInstance *instance = newInstance(vm, oldInstance->klass);
+    push(vm, OBJ_VAL(instance));
+
+    cloneTable(vm, &oldInstance->publicAttributes, &instance->publicAttributes);
+    cloneTable(vm, &oldInstance->privateAttributes, &instance->privateAttributes);
+
+    pop(vm);
+    return instance;
+}
+
+static ObjList *cloneList(DictuVM *vm, ObjList *oldList) {
     ObjList *list = newList(vm);
-    // Push to stack to avoid GC
-    push(vm, OBJ_VAL(list));
-
-    for (int i = 0; i < oldList->values.count; ++i) {
-        Value val = oldList->values.values[i];
-
-        if (!shallow) {
-            if (IS_DICT(val)) {
-                val = OBJ_VAL(copyDict(vm, AS_DICT(val), false));
-            } else if (IS_LIST(val)) {
-                val = OBJ_VAL(copyList(vm, AS_LIST(val), false));
-            } else if (IS_INSTANCE(val)) {
-                val = OBJ_VAL(copyInstance(vm, AS_INSTANCE(val), false));
-            }
-        }
 
-        // Push to stack to avoid GC
-        push(vm, val);
-        writeValueArray(vm, &list->values, val);
+    if (oldList->values.count > 0) {
+        push(vm, OBJ_VAL(list));
+        list->values.values = ALLOCATE(vm, Value, oldList->values.count);
+        memcpy(list->values.values, oldList->values.values, sizeof(Value) * oldList->values.count);
+        list->values.count = oldList->values.count;
+        list->values.capacity = oldList->values.count;
         pop(vm);
     }
 
-    pop(vm);
     return list;
 }
 
-ObjInstance *copyInstance(DictuVM* vm, ObjInstance *oldInstance, bool shallow) {
-    ObjInstance *instance = newInstance(vm, oldInstance->klass);
-    // Push to stack to avoid GC
-    push(vm, OBJ_VAL(instance));
+static Value copyValue(DictuVM *vm, DeepCopy *state, Value value) {
+    if (!IS_LIST(value) && !IS_DICT(value) && !IS_INSTANCE(value)) {
+        return value;
+    }
 
-    if (shallow) {
-        tableAddAll(vm, &oldInstance->publicAttributes, &instance->publicAttributes);
-    } else {
-        for (int i = 0; i < oldInstance->publicAttributes.capacity; i++) {
-            Entry *entry = &oldInstance->publicAttributes.entries[i];
-            if (entry->key != NULL) {
-                Value val = entry->value;
-
-                if (IS_LIST(val)) {
-                    val = OBJ_VAL(copyList(vm, AS_LIST(val), false));
-                } else if (IS_DICT(val)) {
-                    val = OBJ_VAL(copyDict(vm, AS_DICT(val), false));
-                } else if (IS_INSTANCE(val)) {
-                    val = OBJ_VAL(copyInstance(vm, AS_INSTANCE(val), false));
+    if (state->count + 1 > state->capacity * COPY_MAP_MAX_LOAD) {
+        growCopyMap(state);
+    }
+
+    Obj *original = AS_OBJ(value);
+    CopyEntry *entry = findCopyEntry(state->entries, state->capacity, original);
+
+    if (entry->original != NULL) {
+        return OBJ_VAL(entry->copy);
+    }
+
+    // Start with a shallow copy, its contents are replaced when it is
+    // taken off the worklist. Nothing allocates on the VM heap between
+    // here and the copy being stored in its parent, which roots it.
+    switch (original->type) {
+        case OBJ_LIST: {
+            entry->copy = (Obj *) cloneList(vm, (ObjList *) original);
+            break;
+        }
+
+        case OBJ_DICT: {
+            entry->copy = (Obj *) cloneDict(vm, (ObjDict *) original);
+            break;
+        }
+
+        default: {
+            entry->copy = (Obj *) cloneInstance(vm, (ObjInstance *) original);
+            break;
+        }
+    }
+
+    entry->original = original;
+    state->count++;
+
+    if (state->pendingCount == state->pendingCapacity) {
+        state->pendingCapacity = GROW_CAPACITY(state->pendingCapacity);
+        state->pending = realloc(state->pending, sizeof(Obj *) * state->pendingCapacity);
+    }
+
+    state->pending[state->pendingCount++] = entry->copy;
+
+    return OBJ_VAL(entry->copy);
+}
+
+static void copyTableValues(DictuVM *vm, DeepCopy *state, Table *table) {
+    // Only values are replaced so the table never resizes underneath us
+    for (int i = 0; i < table->capacity; ++i) {
+        if (table->entries[i].key == NULL) continue;
+
+        Value value = copyValue(vm, state, table->entries[i].value);
+        table->entries[i].value = value;
+    }
+}
+
+static Obj *deepCopy(DictuVM *vm, Obj *root) {
+    DeepCopy state = {NULL, 0, 0, NULL, 0, 0};
+
+    // Every copy is reachable from the root copy, so a collection part way
+    // through would only mark the structure being copied and free nothing
+    vm->gcPaused++;
+
+    Value rootCopy = copyValue(vm, &state, OBJ_VAL(root));
+    push(vm, rootCopy);
+
+    while (state.pendingCount > 0) {
+        Obj *copy = state.pending[--state.pendingCount];
+
+        switch (copy->type) {
+            case OBJ_LIST: {
+                ObjList *list = (ObjList *) copy;
+
+                for (int i = 0; i < list->values.count; ++i) {
+                    Value value = copyValue(vm, &state, list->values.values[i]);
+                    list->values.values[i] = value;
                 }
 
-                // Push to stack to avoid GC
-                push(vm, val);
-                tableSet(vm, &instance->publicAttributes, entry->key, val);
-                pop(vm);
+                break;
             }
-        }
 
-        for (int i = 0; i < oldInstance->privateAttributes.capacity; i++) {
-            Entry *entry = &oldInstance->privateAttributes.entries[i];
-            if (entry->key != NULL) {
-                Value val = entry->value;
-
-                if (IS_LIST(val)) {
-                    val = OBJ_VAL(copyList(vm, AS_LIST(val), false));
-                } else if (IS_DICT(val)) {
-                    val = OBJ_VAL(copyDict(vm, AS_DICT(val), false));
-                } else if (IS_INSTANCE(val)) {
-                    val = OBJ_VAL(copyInstance(vm, AS_INSTANCE(val), false));
+            case OBJ_DICT: {
+                ObjDict *dict = (ObjDict *) copy;
+
+                for (int i = 0; i <= dict->capacityMask; ++i) {
+                    if (IS_EMPTY(dict->entries[i].key)) continue;
+
+                    Value value = copyValue(vm, &state, dict->entries[i].value);
+                    dict->entries[i].value = value;
                 }
 
-                // Push to stack to avoid GC
-                push(vm, val);
-                tableSet(vm, &instance->privateAttributes, entry->key, val);
-                pop(vm);
+                break;
+            }
+
+            default: {
+                ObjInstance *instance = (ObjInstance *) copy;
+                copyTableValues(vm, &state, &instance->publicAttributes);
+                copyTableValues(vm, &state, &instance->privateAttributes);
+                break;
             }
         }
     }
 
+    free(state.entries);
+    free(state.pending);
     pop(vm);
-    return instance;
+    vm->gcPaused--;
+
+    return AS_OBJ(rootCopy);
+}
+
+ObjDict *copyDict(DictuVM* vm, ObjDict *oldDict, bool shallow) {
+    if (shallow) {
+        return cloneDict(vm, oldDict);
+    }
+
+    return (ObjDict *) deepCopy(vm, (Obj *) oldDict);
+}
+
+ObjList *copyList(DictuVM* vm, ObjList *oldList, bool shallow) {
+    if (shallow) {
+        return shareList(vm, oldList, 0, oldList->values.count);
+    }
+
+    return (ObjList *) deepCopy(vm, (Obj *) oldList);
+}
+
+ObjInstance *copyInstance(DictuVM* vm, ObjInstance *oldInstance, bool shallow) {
+    if (shallow) {
+        return cloneInstance(vm, oldInstance);
+    }
+
+    return (ObjInstance *) deepCopy(vm, (Obj *) oldInstance);
 }
 
 // TODO: Set copy
@@ -0,0 +1,15 @@
+#include "coroutines.h"
+
+static Value doneCoroutine(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "done() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjCoroutine *coroutine = AS_COROUTINE(args[0]);
+    return BOOL_VAL(coroutine->state == COROUTINE_DONE);
+}
+
+void declareCoroutineMethods(DictuVM *vm) {
+    defineNative(vm, &vm->coroutineMethods, "done", doneCoroutine);
+}
@@ -0,0 +1,8 @@
+#ifndef dictu_coroutines_h
+#define dictu_coroutines_h
+
+#include "../util.h"
+
+void declareCoroutineMethods(DictuVM *vm);
+
+#endif //dictu_coroutines_h
@@ -68,15 +68,15 @@ static Value getDictItem(DictuVM *vm, int argCount, Value *args) {
         defaultValue = args[2];
     }
 
-    if (!isValidKey(args[1])) {
-        runtimeError(vm, "Dictionary key passed to get() must be an immutable type");
+    if (!isValidKey(vm, args[1])) {
+        runtimeError(vm, "Dictionary key passed to get() must be a hashable type");
         return EMPTY_VAL;
     }
 
     ObjDict *dict = AS_DICT(args[0]);
 
     Value ret;
-    if (dictGet(dict, args[1], &ret)) {
+    if (dictGet(vm, dict, args[1], &ret)) {
         return ret;
     }
 
@@ -89,8 +89,8 @@ static Value removeDictItem(DictuVM *vm, int argCount, Value *args) {
         return EMPTY_VAL;
     }
 
-    if (!isValidKey(args[1])) {
-        runtimeError(vm, "Dictionary key passed to remove() must be an immutable type");
+    if (!isValidKey(vm, args[1])) {
+        runtimeError(vm, "Dictionary key passed to remove() must be a hashable type");
         return EMPTY_VAL;
     }
 
@@ -113,8 +113,8 @@ static Value dictItemExists(DictuVM *vm, int argCount, Value *args) {
         return EMPTY_VAL;
     }
 
-    if (!isValidKey(args[1])) {
-        runtimeError(vm, "Dictionary key passed to exists() must be an immutable type");
+    if (!isValidKey(vm, args[1])) {
+        runtimeError(vm, "Dictionary key passed to exists() must be a hashable type");
         return EMPTY_VAL;
     }
 
@@ -125,7 +125,7 @@ static Value dictItemExists(DictuVM *vm, int argCount, Value *args) {
     }
 
     Value v;
-    if (dictGet(dict, args[1], &v)) {
+    if (dictGet(vm, dict, args[1], &v)) {
         return TRUE_VAL;
     }
 
@@ -1,5 +1,56 @@
 #include "files.h"
 #include "../memory.h"
+#include "../future.h"
+#include "../../optionals/c.h"
+
+#include <limits.h>
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+// A string needs a NUL after its last byte, so the mapping is one byte
+// longer than the file, rounded up to whole pages
+static size_t mappedSize(int length) {
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    return ((size_t) length + pageSize) / pageSize * pageSize;
+}
+
+// The file is mapped over an anonymous mapping of mappedSize(), so the byte
+// after it reads as zero even when the file ends exactly on a page boundary
+static char *mapFileChars(int fd, int length) {
+    size_t size = mappedSize(length);
+    char *chars = mmap(NULL, size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (chars == MAP_FAILED) {
+        return NULL;
+    }
+
+    if (mmap(chars, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        int error = errno;
+        munmap(chars, size);
+        errno = error;
+        return NULL;
+    }
+
+    return chars;
+}
+#endif
+
+void unmapFileChars(char *chars, int length) {
+#ifdef _WIN32
+    UNUSED(chars);
+    UNUSED(length);
+#else
+    munmap(chars, mappedSize(length));
+#endif
+}
 
 static Value writeFile(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 1) {
@@ -20,6 +71,7 @@ static Value writeFile(DictuVM *vm, int argCount, Value *args) {
         return EMPTY_VAL;
     }
 
+    file->used = true;
     int charsWrote = 0;
 
     if (strcmp(file->openType, "wb") == 0) {
@@ -27,7 +79,10 @@ static Value writeFile(DictuVM *vm, int argCount, Value *args) {
     } else {
         charsWrote = fprintf(file->file, "%s", string->chars);
     }
-    fflush(file->file);
+
+    if (file->bufferSize == 0) {
+        fflush(file->file);
+    }
 
     return NUMBER_VAL(charsWrote);
 }
@@ -51,12 +106,242 @@ static Value writeLineFile(DictuVM *vm, int argCount, Value *args) {
         return EMPTY_VAL;
     }
 
+    file->used = true;
     int charsWrote = fprintf(file->file, "%s\n", string->chars);
-    fflush(file->file);
+
+    if (file->bufferSize == 0) {
+        fflush(file->file);
+    }
 
     return NUMBER_VAL(charsWrote);
 }
 
+static size_t writeStringsBuffered(FILE *stream, ObjList *list) {
+    size_t written = 0;
+
+    for (int i = 0; i < list->values.count; ++i) {
+        ObjString *string = AS_STRING(list->values.values[i]);
+        written += fwrite(string->chars, 1, string->length, stream);
+    }
+
+    return written;
+}
+
+#ifndef _WIN32
+#ifdef IOV_MAX
+#define WRITE_BATCH IOV_MAX
+#else
+#define WRITE_BATCH 16
+#endif
+
+// Strings shorter than GATHER_LIMIT are copied together into a block of
+// GATHER_SIZE, as an iovec each would cost the kernel more than the copy
+#define GATHER_SIZE 65536
+#define GATHER_LIMIT 512
+
+// Writes the vectors out, following on from a partial write, which can stop
+// part way through one of them
+static bool writeVectors(int fd, struct iovec *pending, int count, size_t *written) {
+    while (count > 0) {
+        ssize_t bytes = writev(fd, pending, count);
+
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return false;
+        }
+
+        *written += bytes;
+
+        while (count > 0 && (size_t) bytes >= pending->iov_len) {
+            bytes -= pending->iov_len;
+            pending++;
+            count--;
+        }
+
+        if (count > 0) {
+            pending->iov_base = (char *) pending->iov_base + bytes;
+            pending->iov_len -= bytes;
+        }
+    }
+
+    return true;
+}
+
+// Hands the strings to writev() a block at a time, so a list costs a system
+// call per GATHER_SIZE bytes or WRITE_BATCH long strings rather than one per
+// string. Returns the number of bytes written, which is only short if a write
+// failed.
+static size_t writeStrings(int fd, ObjList *list) {
+    struct iovec vectors[WRITE_BATCH];
+    char *gather = malloc(GATHER_SIZE);
+    size_t gathered = 0;
+    size_t written = 0;
+    int count = 0;
+
+    for (int i = 0; i < list->values.count; ++i) {
+        ObjString *string = AS_STRING(list->values.values[i]);
+        bool small = string->length < GATHER_LIMIT;
+
+        if (count == WRITE_BATCH || (small && gathered + string->length > GATHER_SIZE)) {
+            if (!writeVectors(fd, vectors, count, &written)) {
+                free(gather);
+                return written;
+            }
+
+            count = 0;
+            gathered = 0;
+        }
+
+        if (!small) {
+            vectors[count].iov_base = string->chars;
+            vectors[count++].iov_len = string->length;
+            continue;
+        }
+
+        // Runs of short strings share one vector
+        char *next = gather + gathered;
+
+        if (count > 0 && (char *) vectors[count - 1].iov_base + vectors[count - 1].iov_len == next) {
+            vectors[count - 1].iov_len += string->length;
+        } else {
+            vectors[count].iov_base = next;
+            vectors[count++].iov_len = string->length;
+        }
+
+        memcpy(next, string->chars, string->length);
+        gathered += string->length;
+    }
+
+    writeVectors(fd, vectors, count, &written);
+    free(gather);
+
+    return written;
+}
+#endif
+
+static Value writeAllFile(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "writeAll() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_LIST(args[1])) {
+        runtimeError(vm, "writeAll() argument must be a list");
+        return EMPTY_VAL;
+    }
+
+    ObjFile *file = AS_FILE(args[0]);
+    ObjList *list = AS_LIST(args[1]);
+
+    if (strcmp(file->openType, "r") == 0 || strcmp(file->openType, "rb") == 0) {
+        runtimeError(vm, "File is not writable!");
+        return EMPTY_VAL;
+    }
+
+    size_t length = 0;
+
+    for (int i = 0; i < list->values.count; ++i) {
+        if (!IS_STRING(list->values.values[i])) {
+            runtimeError(vm, "writeAll() list must only contain strings");
+            return EMPTY_VAL;
+        }
+
+        length += AS_STRING(list->values.values[i])->length;
+    }
+
+    file->used = true;
+
+    // Anything that fits in the buffer set by setBufferSize() is left there
+    if (length < file->bufferSize) {
+        return NUMBER_VAL(writeStringsBuffered(file->file, list));
+    }
+
+#ifdef _WIN32
+    size_t written = writeStringsBuffered(file->file, list);
+
+    if (file->bufferSize == 0) {
+        fflush(file->file);
+    }
+#else
+    // The strings go straight to the descriptor, behind anything stdio holds
+    fflush(file->file);
+
+    int fd = fileno(file->file);
+    size_t written = writeStrings(fd, list);
+
+    // stdio keeps its own idea of the position, which has to catch up
+    off_t position = lseek(fd, 0, SEEK_CUR);
+
+    if (position != -1) {
+        fseek(file->file, position, SEEK_SET);
+    }
+#endif
+
+    return NUMBER_VAL(written);
+}
+
+static Value setBufferSizeFile(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "setBufferSize() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[1])) {
+        runtimeError(vm, "setBufferSize() argument must be a number");
+        return EMPTY_VAL;
+    }
+
+    double size = AS_NUMBER(args[1]);
+
+    if (size < 1) {
+        runtimeError(vm, "setBufferSize() argument must be greater than 0");
+        return EMPTY_VAL;
+    }
+
+    ObjFile *file = AS_FILE(args[0]);
+
+    // setvbuf() is only defined on a stream nothing has been done with yet
+    if (file->used) {
+        runtimeError(vm, "setBufferSize() must be called once, before \"%s\" is read from or written to", file->path);
+        return EMPTY_VAL;
+    }
+
+    char *buffer = malloc((size_t) size);
+
+    if (buffer == NULL) {
+        runtimeError(vm, "Not enough memory for a buffer of %g bytes", size);
+        return EMPTY_VAL;
+    }
+
+    if (setvbuf(file->file, buffer, _IOFBF, (size_t) size) != 0) {
+        free(buffer);
+        runtimeError(vm, "Unable to set the buffer size of \"%s\"", file->path);
+        return EMPTY_VAL;
+    }
+
+    file->used = true;
+    file->buffer = buffer;
+    file->bufferSize = (size_t) size;
+
+    return NIL_VAL;
+}
+
+static Value flushFile(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "flush() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjFile *file = AS_FILE(args[0]);
+    file->used = true;
+    fflush(file->file);
+
+    return NIL_VAL;
+}
+
 static Value readFullFile(DictuVM *vm, int argCount, Value *args) {
     if (argCount != 0) {
         runtimeError(vm, "read() takes no arguments (%d given)", argCount);
@@ -64,6 +349,7 @@ static Value readFullFile(DictuVM *vm, int argCount, Value *args) {
     }
 
     ObjFile *file = AS_FILE(args[0]);
+    file->used = true;
 
     size_t currentPosition = ftell(file->file);
     // Calculate file size
@@ -93,45 +379,263 @@ static Value readFullFile(DictuVM *vm, int argCount, Value *args) {
     return OBJ_VAL(takeString(vm, buffer, bytesRead));
 }
 
+static Value mapFile(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "map() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjFile *file = AS_FILE(args[0]);
+
+    if (!strchr(file->openType, 'r') && !strchr(file->openType, '+')) {
+        runtimeError(vm, "map() file must be opened for reading");
+        return EMPTY_VAL;
+    }
+
+    file->used = true;
+
+    // Anything still buffered has to reach the file before it is mapped
+    if (strchr(file->openType, '+')) {
+        fflush(file->file);
+    }
+
+#ifdef _WIN32
+    // Without mmap the whole file is read in instead
+    long position = ftell(file->file);
+    fseek(file->file, 0L, SEEK_SET);
+    Value contents = readFullFile(vm, 0, args);
+    fseek(file->file, position, SEEK_SET);
+
+    if (IS_EMPTY(contents)) {
+        return EMPTY_VAL;
+    }
+
+    return newResultSuccess(vm, contents);
+#else
+    int fd = fileno(file->file);
+    struct stat info;
+
+    if (fstat(fd, &info) == -1) {
+        ERROR_RESULT;
+    }
+
+    if (!S_ISREG(info.st_mode)) {
+        return newResultError(vm, "map() file must be a regular file");
+    }
+
+    if (info.st_size >= INT_MAX) {
+        return newResultError(vm, "File is too large to map");
+    }
+
+    if (info.st_size == 0) {
+        return newResultSuccess(vm, OBJ_VAL(copyString(vm, "", 0)));
+    }
+
+    char *chars = mapFileChars(fd, info.st_size);
+
+    if (chars == NULL) {
+        ERROR_RESULT;
+    }
+
+    return newResultSuccess(vm, OBJ_VAL(takeMappedString(vm, chars, info.st_size)));
+#endif
+}
+
+typedef struct {
+    ObjFile *file;
+    char *path;
+    const char *mode;
+    long offset;
+    char *buffer;
+    size_t length;
+    int error;
+} FileRead;
+
+// Reads through a handle of its own, so the file object is never used
+// off the VM's thread
+static void readFileWork(void *data) {
+    FileRead *request = data;
+    FILE *file = fopen(request->path, request->mode);
+
+    if (file == NULL) {
+        request->error = errno;
+        return;
+    }
+
+    fseek(file, 0L, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, request->offset, SEEK_SET);
+
+    size_t size = fileSize > request->offset ? fileSize - request->offset : 0;
+    request->buffer = malloc(size + 1);
+    request->length = fread(request->buffer, sizeof(char), size, file);
+
+    if (ferror(file)) {
+        request->error = EIO;
+    }
+
+    fclose(file);
+}
+
+static void freeFileRead(void *data) {
+    FileRead *request = data;
+
+    free(request->buffer);
+    free(request->path);
+    free(request);
+}
+
+static Value readFileComplete(DictuVM *vm, void *data) {
+    FileRead *request = data;
+    Value result;
+
+    if (request->error != 0) {
+        char buf[MAX_ERROR_LEN];
+        getStrerror(buf, request->error);
+        result = newResultError(vm, buf);
+    } else {
+        // Leave the file where read() would have
+        if (request->file->file != NULL) {
+            fseek(request->file->file, 0L, SEEK_END);
+        }
+
+        result = newResultSuccess(vm, OBJ_VAL(copyString(vm, request->buffer, request->length)));
+    }
+
+    freeFileRead(request);
+
+    return result;
+}
+
+static Value readFullFileAsync(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "readAsync() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjFile *file = AS_FILE(args[0]);
+
+    if (!strchr(file->openType, 'r') && !strchr(file->openType, '+')) {
+        runtimeError(vm, "readAsync() file must be opened for reading");
+        return EMPTY_VAL;
+    }
+
+    file->used = true;
+
+    FileRead *request = malloc(sizeof(FileRead));
+    memset(request, 0, sizeof(FileRead));
+    request->file = file;
+    request->offset = ftell(file->file);
+
+    // Anything still buffered has to reach the file before it is reopened
+    if (strchr(file->openType, '+')) {
+        fflush(file->file);
+    }
+
+    request->path = strdup(file->path);
+    request->mode = strchr(file->openType, 'b') ? "rb" : "r";
+
+    return newFuture(vm, args[0], request, readFileWork, readFileComplete, freeFileRead);
+}
+
+// Reads the next line, newline included, into the file's line buffer.
+// Returns its length, or -1 at the end of the file.
+static long readFileLine(ObjFile *file) {
+#ifdef _WIN32
+    size_t length = 0;
+
+    do {
+        if (file->lineCapacity - length < 2) {
+            file->lineCapacity = file->lineCapacity < 128 ? 128 : file->lineCapacity * 2;
+            file->lineBuffer = realloc(file->lineBuffer, file->lineCapacity);
+        }
+
+        if (fgets(file->lineBuffer + length, file->lineCapacity - length, file->file) == NULL) {
+            break;
+        }
+
+        length += strlen(file->lineBuffer + length);
+    } while (file->lineBuffer[length - 1] != '\n');
+
+    return length == 0 ? -1 : (long) length;
+#else
+    return getline(&file->lineBuffer, &file->lineCapacity, file->file);
+#endif
+}
+
+bool nextFileLine(DictuVM *vm, ObjFile *file, Value *line) {
+    file->used = true;
+    long length = readFileLine(file);
+
+    if (length == -1) {
+        return false;
+    }
+
+    if (length > 0 && file->lineBuffer[length - 1] == '\n') {
+        length--;
+    }
+
+    *line = OBJ_VAL(copyString(vm, file->lineBuffer, length));
+    return true;
+}
+
 static Value readLineFile(DictuVM *vm, int argCount, Value *args) {
     if (argCount > 1) {
         runtimeError(vm, "readLine() takes at most 1 argument (%d given)", argCount);
         return EMPTY_VAL;
     }
 
-    int readLineBufferSize = 4096;
+    ObjFile *file = AS_FILE(args[0]);
 
-    if (argCount == 1) {
-        if (!IS_NUMBER(args[1])) {
-            runtimeError(vm, "readLine() argument must be a number");
-            return EMPTY_VAL;
+    if (argCount == 0) {
+        Value line;
+
+        if (!nextFileLine(vm, file, &line)) {
+            return NIL_VAL;
         }
 
-        readLineBufferSize = AS_NUMBER(args[1]) + 1;
+        return line;
+    }
+
+    if (!IS_NUMBER(args[1])) {
+        runtimeError(vm, "readLine() argument must be a number");
+        return EMPTY_VAL;
+    }
+
+    int readLineBufferSize = AS_NUMBER(args[1]) + 1;
+
+    if (readLineBufferSize < 2) {
+        runtimeError(vm, "readLine() argument must be greater than 0");
+        return EMPTY_VAL;
     }
 
-#ifdef _WIN32
     char *line = ALLOCATE(vm, char, readLineBufferSize);
-#else 
-    char line[readLineBufferSize]; 
-#endif
+    Value result = NIL_VAL;
+    file->used = true;
 
-    ObjFile *file = AS_FILE(args[0]);
     if (fgets(line, readLineBufferSize, file->file) != NULL) {
         int lineLength = strlen(line);
         // Remove newline char
         if (line[lineLength - 1] == '\n') {
             lineLength--;
-            line[lineLength] = '\0';
         }
-        return OBJ_VAL(copyString(vm, line, lineLength));
+
+        result = OBJ_VAL(copyString(vm, line, lineLength));
     }
 
-#ifdef _WIN32
-    FREE(vm, char, line);
-#endif 
+    FREE_ARRAY(vm, char, line, readLineBufferSize);
 
-    return NIL_VAL;
+    return result;
+}
+
+// A file is iterated a line at a time, lines() makes that explicit
+static Value linesFile(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "lines() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    return args[0];
 }
 
 static Value seekFile(DictuVM *vm, int argCount, Value *args) {
@@ -179,6 +683,7 @@ static Value seekFile(DictuVM *vm, int argCount, Value *args) {
         return EMPTY_VAL;
     }
 
+    file->used = true;
     fseek(file->file, offset, seekType);
 
     return NIL_VAL;
@@ -187,7 +692,13 @@ static Value seekFile(DictuVM *vm, int argCount, Value *args) {
 void declareFileMethods(DictuVM *vm) {
     defineNative(vm, &vm->fileMethods, "write", writeFile);
     defineNative(vm, &vm->fileMethods, "writeLine", writeLineFile);
+    defineNative(vm, &vm->fileMethods, "writeAll", writeAllFile);
+    defineNative(vm, &vm->fileMethods, "setBufferSize", setBufferSizeFile);
+    defineNative(vm, &vm->fileMethods, "flush", flushFile);
     defineNative(vm, &vm->fileMethods, "read", readFullFile);
+    defineNative(vm, &vm->fileMethods, "readAsync", readFullFileAsync);
     defineNative(vm, &vm->fileMethods, "readLine", readLineFile);
+    defineNative(vm, &vm->fileMethods, "lines", linesFile);
+    defineNative(vm, &vm->fileMethods, "map", mapFile);
     defineNative(vm, &vm->fileMethods, "seek", seekFile);
 }
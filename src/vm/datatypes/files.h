@@ -5,10 +5,18 @@
 #include <stdbool.h>
 #include <string.h>
 #include <stdlib.h>
+#include <errno.h>
 
 #include "../common.h"
 #include "../util.h"
 
 void declareFileMethods(DictuVM *vm);
 
+// Reads the next line of the file, without its newline, however long it is.
+// Returns false at the end of the file.
+bool nextFileLine(DictuVM *vm, ObjFile *file, Value *line);
+
+// Releases the chars of a string made by file.map()
+void unmapFileChars(char *chars, int length);
+
 #endif //dictu_files_h
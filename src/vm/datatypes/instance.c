@@ -104,9 +104,9 @@ static Value getAttribute(DictuVM *vm, int argCount, Value *args) {
     return defaultValue;
 }
 
-static bool exists(ObjList *list, ObjString *search) {
+static bool exists(DictuVM *vm, ObjList *list, ObjString *search) {
     for (int i = 0; i < list->values.count; ++i) {
-        if (valuesEqual(list->values.values[i], OBJ_VAL(search))) {
+        if (valuesEqual(vm, list->values.values[i], OBJ_VAL(search))) {
             return true;
         }
     }
@@ -137,7 +137,7 @@ static Value getAttributes(DictuVM *vm, int argCount, Value *args) {
                 continue;
             }
 
-            if (exists(fields, klass->variables.entries[i].key)) {
+            if (exists(vm, fields, klass->variables.entries[i].key)) {
                 continue;
             }
 
@@ -149,7 +149,7 @@ static Value getAttributes(DictuVM *vm, int argCount, Value *args) {
                 continue;
             }
 
-            if (exists(fields, klass->constants.entries[i].key)) {
+            if (exists(vm, fields, klass->constants.entries[i].key)) {
                 continue;
             }
 
@@ -175,7 +175,7 @@ static Value getAttributes(DictuVM *vm, int argCount, Value *args) {
             continue;
         }
 
-        if (exists(attributes, instance->publicAttributes.entries[i].key)) {
+        if (exists(vm, attributes, instance->publicAttributes.entries[i].key)) {
             continue;
         }
 
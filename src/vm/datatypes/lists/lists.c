@@ -49,6 +49,7 @@ static Value extendList(DictuVM *vm, int argCount, Value *args) {
 
     ObjList *list = AS_LIST(args[0]);
     ObjList *listArgument = AS_LIST(args[1]);
+    makeListWritable(vm, list);
 
     for (int i = 0; i < listArgument->values.count; i++) {
         writeValueArray(vm, &list->values, listArgument->values.values[i]);
@@ -64,6 +65,7 @@ static Value pushListItem(DictuVM *vm, int argCount, Value *args) {
     }
 
     ObjList *list = AS_LIST(args[0]);
+    makeListWritable(vm, list);
     writeValueArray(vm, &list->values, args[1]);
 
     return NIL_VAL;
@@ -92,6 +94,8 @@ static Value insertListItem(DictuVM *vm, int argCount, Value *args) {
         return EMPTY_VAL;
     }
 
+    makeListWritable(vm, list);
+
     if (list->values.capacity < list->values.count + 1) {
         int oldCapacity = list->values.capacity;
         list->values.capacity = GROW_CAPACITY(oldCapacity);
@@ -141,11 +145,14 @@ static Value popListItem(DictuVM *vm, int argCount, Value *args) {
         }
 
         element = list->values.values[index];
+        makeListWritable(vm, list);
 
         for (int i = index; i < list->values.count - 1; ++i) {
             list->values.values[i] = list->values.values[i + 1];
         }
     } else {
+        // Dropping the last element only shrinks this list's view, so a
+        // shared backing store can be left untouched
         element = list->values.values[list->values.count - 1];
     }
 
@@ -162,40 +169,27 @@ static Value removeListItem(DictuVM *vm, int argCount, Value *args) {
 
     ObjList *list = AS_LIST(args[0]);
     Value remove = args[1];
-    bool found = false;
 
     if (list->values.count == 0) {
         runtimeError(vm, "Value passed to remove() does not exist within an empty list");
         return EMPTY_VAL;
     }
 
-    if (list->values.count > 1) {
-        for (int i = 0; i < list->values.count - 1; i++) {
-            if (!found && valuesEqual(remove, list->values.values[i])) {
-                found = true;
-            }
+    for (int i = 0; i < list->values.count; i++) {
+        if (valuesEqual(vm, remove, list->values.values[i])) {
+            // Search first, __eq__ hooks could slice the list while comparing
+            makeListWritable(vm, list);
 
-            // If we have found the value, shuffle the array
-            if (found) {
+            // Shuffle the array over the removed value
+            for (; i < list->values.count - 1; i++) {
                 list->values.values[i] = list->values.values[i + 1];
             }
-        }
 
-        // Check if it's the last element
-        if (!found && valuesEqual(remove, list->values.values[list->values.count - 1])) {
-            found = true;
-        }
-    } else {
-        if (valuesEqual(remove, list->values.values[0])) {
-            found = true;
+            list->values.count--;
+            return NIL_VAL;
         }
     }
 
-    if (found) {
-        list->values.count--;
-        return NIL_VAL;
-    }
-
     runtimeError(vm, "Value passed to remove() does not exist within the list");
     return EMPTY_VAL;
 }
@@ -210,7 +204,7 @@ static Value containsListItem(DictuVM *vm, int argCount, Value *args) {
     Value search = args[1];
 
     for (int i = 0; i < list->values.count; ++i) {
-        if (valuesEqual(list->values.values[i], search)) {
+        if (valuesEqual(vm, list->values.values[i], search)) {
             return TRUE_VAL;
         }
     }
@@ -348,6 +342,7 @@ static Value sortList(DictuVM *vm, int argCount, Value *args) {
     }
 
     ObjList *list = AS_LIST(args[0]);
+    makeListWritable(vm, list);
 
     if (isNumberList(list)) {
         qsort(list->values.values, list->values.count, sizeof(*list->values.values), compareNumbers);
@@ -372,6 +367,7 @@ static Value reverseList(DictuVM *vm, int argCount, Value *args) {
 
     ObjList *list = AS_LIST(args[0]);
     int listLength = list->values.count;
+    makeListWritable(vm, list);
 
     for (int i = 0; i < listLength / 2; i++) {
         Value temp = list->values.values[i];
@@ -382,6 +378,24 @@ static Value reverseList(DictuVM *vm, int argCount, Value *args) {
     return NIL_VAL;
 }
 
+static Value toTupleList(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "toTuple() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjList *list = AS_LIST(args[0]);
+    ObjTuple *tuple = newTuple(vm);
+    push(vm, OBJ_VAL(tuple));
+
+    for (int i = 0; i < list->values.count; ++i) {
+        writeValueArray(vm, &tuple->values, list->values.values[i]);
+    }
+
+    pop(vm);
+    return OBJ_VAL(tuple);
+}
+
 void declareListMethods(DictuVM *vm) {
     defineNative(vm, &vm->listMethods, "toString", toStringList);
     defineNative(vm, &vm->listMethods, "len", lenList);
@@ -395,6 +409,7 @@ void declareListMethods(DictuVM *vm) {
     defineNative(vm, &vm->listMethods, "copy", copyListShallow);
     defineNative(vm, &vm->listMethods, "deepCopy", copyListDeep);
     defineNative(vm, &vm->listMethods, "toBool", boolNative); // Defined in util
+    defineNative(vm, &vm->listMethods, "toTuple", toTupleList);
     defineNative(vm, &vm->listMethods, "sort", sortList);
     defineNative(vm, &vm->listMethods, "reverse", reverseList);
 
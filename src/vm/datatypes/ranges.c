@@ -0,0 +1,68 @@
+#include "ranges.h"
+
+static Value toStringRange(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "toString() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    char *valueString = rangeToString(args[0]);
+
+    ObjString *string = copyString(vm, valueString, strlen(valueString));
+    free(valueString);
+
+    return OBJ_VAL(string);
+}
+
+static Value lenRange(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "len() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(rangeLength(AS_RANGE(args[0])));
+}
+
+static Value toListRange(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "toList() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjRange *range = AS_RANGE(args[0]);
+    double length = rangeLength(range);
+
+    ObjList *list = newList(vm);
+    push(vm, OBJ_VAL(list));
+
+    for (double i = 0; i < length; ++i) {
+        writeValueArray(vm, &list->values, NUMBER_VAL(range->start + i * range->step));
+    }
+
+    pop(vm);
+    return OBJ_VAL(list);
+}
+
+static Value containsRange(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "contains() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!IS_NUMBER(args[1])) {
+        return FALSE_VAL;
+    }
+
+    ObjRange *range = AS_RANGE(args[0]);
+    double index = (AS_NUMBER(args[1]) - range->start) / range->step;
+
+    return BOOL_VAL(index >= 0 && index < rangeLength(range) && index == floor(index));
+}
+
+void declareRangeMethods(DictuVM *vm) {
+    defineNative(vm, &vm->rangeMethods, "toString", toStringRange);
+    defineNative(vm, &vm->rangeMethods, "len", lenRange);
+    defineNative(vm, &vm->rangeMethods, "toList", toListRange);
+    defineNative(vm, &vm->rangeMethods, "contains", containsRange);
+    defineNative(vm, &vm->rangeMethods, "toBool", boolNative); // Defined in util
+}
@@ -0,0 +1,18 @@
+#ifndef dictu_ranges_h
+#define dictu_ranges_h
+
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "../util.h"
+
+// Number of values the range produces, 0 if start is already past end
+static inline double rangeLength(ObjRange *range) {
+    double length = ceil((range->end - range->start) / range->step);
+    return length > 0 ? length : 0;
+}
+
+void declareRangeMethods(DictuVM *vm);
+
+#endif //dictu_ranges_h
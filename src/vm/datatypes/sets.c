@@ -49,8 +49,8 @@ static Value addSetItem(DictuVM *vm, int argCount, Value *args) {
         return EMPTY_VAL;
     }
 
-    if (!isValidKey(args[1])) {
-        runtimeError(vm, "Set value must be an immutable type");
+    if (!isValidKey(vm, args[1])) {
+        runtimeError(vm, "Set value must be a hashable type");
         return EMPTY_VAL;
     }
 
@@ -86,7 +86,7 @@ static Value containsSetItem(DictuVM *vm, int argCount, Value *args) {
 
     ObjSet *set = AS_SET(args[0]);
 
-    return setGet(set, args[1]) ? TRUE_VAL : FALSE_VAL;
+    return setGet(vm, set, args[1]) ? TRUE_VAL : FALSE_VAL;
 }
 
 static Value containsAllSet(DictuVM *vm, int argCount, Value *args) {
@@ -105,13 +105,310 @@ static Value containsAllSet(DictuVM *vm, int argCount, Value *args) {
 
     int listSize = list->values.count;
     for(int index=0;index<listSize;index++){
-        if(setGet(set, list->values.values[index])==false){
+        if(setGet(vm, set, list->values.values[index])==false){
             return FALSE_VAL;
         }
     }
     return TRUE_VAL;
 }
 
+static bool setArgument(DictuVM *vm, const char *name, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "%s() takes 1 argument (%d given)", name, argCount);
+        return false;
+    }
+
+    if (!IS_SET(args[1])) {
+        runtimeError(vm, "%s() argument must be a set", name);
+        return false;
+    }
+
+    return true;
+}
+
+// Moves the table of from into set, leaving from empty
+static void replaceSetEntries(DictuVM *vm, ObjSet *set, ObjSet *from) {
+    FREE_ARRAY(vm, SetItem, set->entries, set->capacityMask + 1);
+    set->entries = from->entries;
+    set->count = from->count;
+    set->capacityMask = from->capacityMask;
+
+    from->entries = NULL;
+    from->count = 0;
+    from->capacityMask = -1;
+}
+
+// Creates a new set sharing the table layout of source, avoiding a rehash of every value
+static ObjSet *cloneSet(DictuVM *vm, ObjSet *source) {
+    ObjSet *set = newSet(vm);
+    push(vm, OBJ_VAL(set));
+
+    if (source->count > 0) {
+        set->entries = ALLOCATE(vm, SetItem, source->capacityMask + 1);
+        memcpy(set->entries, source->entries, sizeof(SetItem) * (source->capacityMask + 1));
+        set->capacityMask = source->capacityMask;
+        set->count = source->count;
+    }
+
+    pop(vm);
+    return set;
+}
+
+static ObjSet *setUnion(DictuVM *vm, ObjSet *a, ObjSet *b) {
+    // Copy the larger set then insert the members of the smaller one
+    if (a->count < b->count) {
+        ObjSet *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    ObjSet *result = cloneSet(vm, a);
+    push(vm, OBJ_VAL(result));
+
+    for (int i = 0; i <= b->capacityMask; ++i) {
+        SetItem *item = &b->entries[i];
+        if (IS_EMPTY(item->value) || item->deleted) continue;
+
+        setInsert(vm, result, item->value);
+    }
+
+    pop(vm);
+    return result;
+}
+
+static ObjSet *setIntersection(DictuVM *vm, ObjSet *a, ObjSet *b) {
+    // Probe the larger set with the members of the smaller one
+    if (a->count > b->count) {
+        ObjSet *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    ObjSet *result = newSet(vm);
+    push(vm, OBJ_VAL(result));
+    setReserve(vm, result, a->count);
+
+    for (int i = 0; i <= a->capacityMask; ++i) {
+        SetItem *item = &a->entries[i];
+        if (IS_EMPTY(item->value) || item->deleted) continue;
+
+        if (setGet(vm, b, item->value)) {
+            setInsert(vm, result, item->value);
+        }
+    }
+
+    pop(vm);
+    return result;
+}
+
+static ObjSet *setDifference(DictuVM *vm, ObjSet *a, ObjSet *b) {
+    ObjSet *result;
+
+    if (b->count < a->count) {
+        // Copy a and remove the members of the smaller set
+        result = cloneSet(vm, a);
+        push(vm, OBJ_VAL(result));
+
+        for (int i = 0; i <= b->capacityMask; ++i) {
+            SetItem *item = &b->entries[i];
+            if (IS_EMPTY(item->value) || item->deleted) continue;
+
+            setDelete(vm, result, item->value);
+        }
+    } else {
+        result = newSet(vm);
+        push(vm, OBJ_VAL(result));
+        setReserve(vm, result, a->count);
+
+        for (int i = 0; i <= a->capacityMask; ++i) {
+            SetItem *item = &a->entries[i];
+            if (IS_EMPTY(item->value) || item->deleted) continue;
+
+            if (!setGet(vm, b, item->value)) {
+                setInsert(vm, result, item->value);
+            }
+        }
+    }
+
+    pop(vm);
+    return result;
+}
+
+static ObjSet *setSymmetricDifference(DictuVM *vm, ObjSet *a, ObjSet *b) {
+    if (a->count < b->count) {
+        ObjSet *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    // Copy the larger set then toggle each member of the smaller one
+    ObjSet *result = cloneSet(vm, a);
+    push(vm, OBJ_VAL(result));
+
+    for (int i = 0; i <= b->capacityMask; ++i) {
+        SetItem *item = &b->entries[i];
+        if (IS_EMPTY(item->value) || item->deleted) continue;
+
+        if (!setDelete(vm, result, item->value)) {
+            setInsert(vm, result, item->value);
+        }
+    }
+
+    pop(vm);
+    return result;
+}
+
+static Value unionSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "union", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    return OBJ_VAL(setUnion(vm, AS_SET(args[0]), AS_SET(args[1])));
+}
+
+static Value intersectionSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "intersection", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    return OBJ_VAL(setIntersection(vm, AS_SET(args[0]), AS_SET(args[1])));
+}
+
+static Value differenceSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "difference", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    return OBJ_VAL(setDifference(vm, AS_SET(args[0]), AS_SET(args[1])));
+}
+
+static Value symmetricDifferenceSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "symmetricDifference", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    return OBJ_VAL(setSymmetricDifference(vm, AS_SET(args[0]), AS_SET(args[1])));
+}
+
+static Value isSubsetSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "isSubset", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    ObjSet *set = AS_SET(args[0]);
+    ObjSet *other = AS_SET(args[1]);
+
+    if (set->count > other->count) {
+        return FALSE_VAL;
+    }
+
+    for (int i = 0; i <= set->capacityMask; ++i) {
+        SetItem *item = &set->entries[i];
+        if (IS_EMPTY(item->value) || item->deleted) continue;
+
+        if (!setGet(vm, other, item->value)) {
+            return FALSE_VAL;
+        }
+    }
+
+    return TRUE_VAL;
+}
+
+static Value unionInPlaceSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "unionInPlace", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    ObjSet *set = AS_SET(args[0]);
+    ObjSet *other = AS_SET(args[1]);
+
+    if (set == other) {
+        return NIL_VAL;
+    }
+
+    setReserve(vm, set, set->count + other->count);
+
+    for (int i = 0; i <= other->capacityMask; ++i) {
+        SetItem *item = &other->entries[i];
+        if (IS_EMPTY(item->value) || item->deleted) continue;
+
+        setInsert(vm, set, item->value);
+    }
+
+    return NIL_VAL;
+}
+
+static Value intersectionInPlaceSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "intersectionInPlace", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    ObjSet *set = AS_SET(args[0]);
+    ObjSet *other = AS_SET(args[1]);
+
+    if (set == other) {
+        return NIL_VAL;
+    }
+
+    ObjSet *result = setIntersection(vm, set, other);
+    replaceSetEntries(vm, set, result);
+
+    return NIL_VAL;
+}
+
+static Value differenceInPlaceSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "differenceInPlace", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    ObjSet *set = AS_SET(args[0]);
+    ObjSet *other = AS_SET(args[1]);
+
+    // Removing the members of a smaller set avoids touching the whole table
+    if (set != other && other->count < set->count) {
+        for (int i = 0; i <= other->capacityMask; ++i) {
+            SetItem *item = &other->entries[i];
+            if (IS_EMPTY(item->value) || item->deleted) continue;
+
+            setDelete(vm, set, item->value);
+        }
+
+        return NIL_VAL;
+    }
+
+    ObjSet *result = setDifference(vm, set, other);
+    replaceSetEntries(vm, set, result);
+
+    return NIL_VAL;
+}
+
+static Value symmetricDifferenceInPlaceSet(DictuVM *vm, int argCount, Value *args) {
+    if (!setArgument(vm, "symmetricDifferenceInPlace", argCount, args)) {
+        return EMPTY_VAL;
+    }
+
+    ObjSet *set = AS_SET(args[0]);
+    ObjSet *other = AS_SET(args[1]);
+
+    if (set != other && other->count <= set->count) {
+        for (int i = 0; i <= other->capacityMask; ++i) {
+            SetItem *item = &other->entries[i];
+            if (IS_EMPTY(item->value) || item->deleted) continue;
+
+            if (!setDelete(vm, set, item->value)) {
+                setInsert(vm, set, item->value);
+            }
+        }
+
+        return NIL_VAL;
+    }
+
+    ObjSet *result = setSymmetricDifference(vm, set, other);
+    replaceSetEntries(vm, set, result);
+
+    return NIL_VAL;
+}
+
 void declareSetMethods(DictuVM *vm) {
     defineNative(vm, &vm->setMethods, "toString", toStringSet);
     defineNative(vm, &vm->setMethods, "len", lenSet);
@@ -120,5 +417,14 @@ void declareSetMethods(DictuVM *vm) {
     defineNative(vm, &vm->setMethods, "remove", removeSetItem);
     defineNative(vm, &vm->setMethods, "contains", containsSetItem);
     defineNative(vm, &vm->setMethods, "containsAll", containsAllSet);
+    defineNative(vm, &vm->setMethods, "union", unionSet);
+    defineNative(vm, &vm->setMethods, "intersection", intersectionSet);
+    defineNative(vm, &vm->setMethods, "difference", differenceSet);
+    defineNative(vm, &vm->setMethods, "symmetricDifference", symmetricDifferenceSet);
+    defineNative(vm, &vm->setMethods, "isSubset", isSubsetSet);
+    defineNative(vm, &vm->setMethods, "unionInPlace", unionInPlaceSet);
+    defineNative(vm, &vm->setMethods, "intersectionInPlace", intersectionInPlaceSet);
+    defineNative(vm, &vm->setMethods, "differenceInPlace", differenceInPlaceSet);
+    defineNative(vm, &vm->setMethods, "symmetricDifferenceInPlace", symmetricDifferenceInPlaceSet);
     defineNative(vm, &vm->setMethods, "toBool", boolNative); // Defined in util
 }
@@ -0,0 +1,84 @@
+#include "tuples.h"
+
+static Value toStringTuple(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "toString() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    char *valueString = tupleToString(args[0]);
+
+    ObjString *string = copyString(vm, valueString, strlen(valueString));
+    free(valueString);
+
+    return OBJ_VAL(string);
+}
+
+static Value lenTuple(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "len() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjTuple *tuple = AS_TUPLE(args[0]);
+    return NUMBER_VAL(tuple->values.count);
+}
+
+static Value toListTuple(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "toList() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjTuple *tuple = AS_TUPLE(args[0]);
+    ObjList *list = newList(vm);
+    push(vm, OBJ_VAL(list));
+
+    for (int i = 0; i < tuple->values.count; ++i) {
+        writeValueArray(vm, &list->values, tuple->values.values[i]);
+    }
+
+    pop(vm);
+    return OBJ_VAL(list);
+}
+
+static Value containsTupleItem(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 1) {
+        runtimeError(vm, "contains() takes 1 argument (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    ObjTuple *tuple = AS_TUPLE(args[0]);
+    Value search = args[1];
+
+    for (int i = 0; i < tuple->values.count; ++i) {
+        if (valuesEqual(vm, tuple->values.values[i], search)) {
+            return TRUE_VAL;
+        }
+    }
+
+    return FALSE_VAL;
+}
+
+static Value hashTuple(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "hash() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    if (!isValidKey(vm, args[0])) {
+        runtimeError(vm, "Tuple passed to hash() must only contain hashable types");
+        return EMPTY_VAL;
+    }
+
+    return NUMBER_VAL(hashValue(vm, args[0]));
+}
+
+void declareTupleMethods(DictuVM *vm) {
+    defineNative(vm, &vm->tupleMethods, "toString", toStringTuple);
+    defineNative(vm, &vm->tupleMethods, "len", lenTuple);
+    defineNative(vm, &vm->tupleMethods, "toList", toListTuple);
+    defineNative(vm, &vm->tupleMethods, "contains", containsTupleItem);
+    defineNative(vm, &vm->tupleMethods, "hash", hashTuple);
+    defineNative(vm, &vm->tupleMethods, "toBool", boolNative); // Defined in util
+}
@@ -0,0 +1,12 @@
+#ifndef dictu_tuples_h
+#define dictu_tuples_h
+
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "../util.h"
+
+void declareTupleMethods(DictuVM *vm);
+
+#endif //dictu_tuples_h
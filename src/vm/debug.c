@@ -109,6 +109,14 @@ static int simpleInstruction(const char *name, int offset) {
     return offset + 1;
 }
 
+static int forIterInstruction(const char *name, Chunk *chunk, int offset) {
+    uint8_t slot = chunk->code[offset + 1];
+    uint16_t jump = (uint16_t)(chunk->code[offset + 2] << 8);
+    jump |= chunk->code[offset + 3];
+    printf("%-16s %4d %4d -> %d\n", name, slot, offset, offset + 4 + jump);
+    return offset + 4;
+}
+
 static int byteInstruction(const char *name, Chunk *chunk, int offset) {
     uint8_t slot = chunk->code[offset + 1];
     printf("%-16s %4d\n", name, slot);
@@ -280,6 +288,14 @@ int disassembleInstruction(Chunk *chunk, int offset) {
             return simpleInstruction("OP_CLOSE_UPVALUE", offset);
         case OP_RETURN:
             return simpleInstruction("OP_RETURN", offset);
+        case OP_YIELD:
+            return simpleInstruction("OP_YIELD", offset);
+        case OP_RESUME:
+            return simpleInstruction("OP_RESUME", offset);
+        case OP_GET_ITER:
+            return simpleInstruction("OP_GET_ITER", offset);
+        case OP_FOR_ITER:
+            return forIterInstruction("OP_FOR_ITER", chunk, offset);
         case OP_EMPTY:
             return simpleInstruction("OP_EMPTY", offset);
         case OP_CLASS:
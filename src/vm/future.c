@@ -0,0 +1,238 @@
+#include "future.h"
+#include "memory.h"
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+// Enough to overlap a handful of slow calls, the pool is shared by every VM
+#define FUTURE_POOL_SIZE 4
+
+typedef struct Task {
+    struct Task *next;
+    void *data;
+    FutureWorkFn work;
+    FutureCompleteFn complete;
+    FutureFreeFn freeData;
+    // Guarded by the pool lock
+    bool finished;
+    bool abandoned;
+    // Only used on the thread of the VM that created the future
+    bool completed;
+    Value value;
+    Value owner;
+} Task;
+
+#define AS_TASK(v) ((Task*)AS_ABSTRACT(v)->data)
+
+#ifndef _WIN32
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t taskQueued = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t taskFinished = PTHREAD_COND_INITIALIZER;
+static pthread_once_t poolOnce = PTHREAD_ONCE_INIT;
+static int poolSize = 0;
+static Task *queueHead = NULL;
+static Task *queueTail = NULL;
+
+static void *runPool(void *unused) {
+    UNUSED(unused);
+
+    pthread_mutex_lock(&poolLock);
+
+    for (;;) {
+        while (queueHead == NULL) {
+            pthread_cond_wait(&taskQueued, &poolLock);
+        }
+
+        Task *task = queueHead;
+        queueHead = task->next;
+
+        if (queueHead == NULL) {
+            queueTail = NULL;
+        }
+
+        pthread_mutex_unlock(&poolLock);
+
+        task->work(task->data);
+
+        pthread_mutex_lock(&poolLock);
+        task->finished = true;
+        bool abandoned = task->abandoned;
+        pthread_cond_broadcast(&taskFinished);
+
+        // The future was collected while the work ran, nobody is left to
+        // complete it
+        if (abandoned) {
+            pthread_mutex_unlock(&poolLock);
+            task->freeData(task->data);
+            free(task);
+            pthread_mutex_lock(&poolLock);
+        }
+    }
+
+    return NULL;
+}
+
+static void startPool(void) {
+    for (int i = 0; i < FUTURE_POOL_SIZE; ++i) {
+        pthread_t thread;
+
+        if (pthread_create(&thread, NULL, runPool, NULL) != 0) {
+            break;
+        }
+
+        pthread_detach(thread);
+        poolSize++;
+    }
+}
+#endif
+
+static void submitTask(Task *task) {
+#ifndef _WIN32
+    pthread_once(&poolOnce, startPool);
+
+    if (poolSize > 0) {
+        pthread_mutex_lock(&poolLock);
+
+        if (queueTail == NULL) {
+            queueHead = task;
+        } else {
+            queueTail->next = task;
+        }
+
+        queueTail = task;
+        pthread_cond_signal(&taskQueued);
+        pthread_mutex_unlock(&poolLock);
+
+        return;
+    }
+#endif
+
+    task->work(task->data);
+    task->finished = true;
+}
+
+static bool isFinished(Task *task) {
+#ifndef _WIN32
+    pthread_mutex_lock(&poolLock);
+    bool finished = task->finished;
+    pthread_mutex_unlock(&poolLock);
+
+    return finished;
+#else
+    return task->finished;
+#endif
+}
+
+static void waitForTask(Task *task) {
+#ifndef _WIN32
+    pthread_mutex_lock(&poolLock);
+
+    while (!task->finished) {
+        pthread_cond_wait(&taskFinished, &poolLock);
+    }
+
+    pthread_mutex_unlock(&poolLock);
+#else
+    UNUSED(task);
+#endif
+}
+
+static Value futureAwait(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "await() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Task *task = AS_TASK(args[0]);
+
+    if (!task->completed) {
+        waitForTask(task);
+
+        task->value = task->complete(vm, task->data);
+        task->data = NULL;
+        task->completed = true;
+    }
+
+    return task->value;
+}
+
+static Value futureDone(DictuVM *vm, int argCount, Value *args) {
+    if (argCount != 0) {
+        runtimeError(vm, "done() takes no arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    Task *task = AS_TASK(args[0]);
+
+    return BOOL_VAL(task->completed || isFinished(task));
+}
+
+static void freeFuture(DictuVM *vm, ObjAbstract *abstract) {
+    UNUSED(vm);
+
+    Task *task = abstract->data;
+
+#ifndef _WIN32
+    pthread_mutex_lock(&poolLock);
+
+    if (!task->finished) {
+        // The pool frees it once the work is done
+        task->abandoned = true;
+        pthread_mutex_unlock(&poolLock);
+        return;
+    }
+
+    pthread_mutex_unlock(&poolLock);
+#endif
+
+    if (!task->completed) {
+        task->freeData(task->data);
+    }
+
+    free(task);
+}
+
+static void grayFuture(DictuVM *vm, ObjAbstract *abstract) {
+    Task *task = abstract->data;
+
+    grayValue(vm, task->owner);
+    grayValue(vm, task->value);
+}
+
+static char *futureToString(ObjAbstract *abstract) {
+    UNUSED(abstract);
+
+    char *futureString = malloc(sizeof(char) * 9);
+    snprintf(futureString, 9, "<Future>");
+    return futureString;
+}
+
+Value newFuture(DictuVM *vm, Value owner, void *data, FutureWorkFn work,
+                FutureCompleteFn complete, FutureFreeFn freeData) {
+    Task *task = malloc(sizeof(Task));
+    memset(task, 0, sizeof(Task));
+    task->data = data;
+    task->work = work;
+    task->complete = complete;
+    task->freeData = freeData;
+    task->value = NIL_VAL;
+    task->owner = owner;
+
+    ObjAbstract *abstract = newAbstract(vm, freeFuture, futureToString);
+    abstract->data = task;
+    abstract->grayFunc = grayFuture;
+    push(vm, OBJ_VAL(abstract));
+
+    /**
+     * Setup Future object methods
+     */
+    defineNative(vm, &abstract->values, "await", futureAwait);
+    defineNative(vm, &abstract->values, "done", futureDone);
+
+    pop(vm);
+
+    submitTask(task);
+
+    return OBJ_VAL(abstract);
+}
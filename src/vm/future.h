@@ -0,0 +1,33 @@
+#ifndef dictu_future_h
+#define dictu_future_h
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "util.h"
+
+/**
+ * Futures let a native hand blocking work to a small pool of native
+ * threads shared by every VM in the process, so the VM that asked for it
+ * is free to carry on until it needs the result.
+ *
+ * The work function runs on a pool thread and must not touch any VM, it
+ * only sees the data it was given. Once it has finished the complete
+ * function runs on the VM's own thread, the first time the future is
+ * awaited, and turns the data into the value the future resolves to.
+ * complete is responsible for freeing the data, if the future is collected
+ * before that happens freeData is called instead.
+ *
+ * Platforms without pthreads run the work straight away.
+ */
+typedef void (*FutureWorkFn)(void *data);
+typedef Value (*FutureCompleteFn)(DictuVM *vm, void *data);
+typedef void (*FutureFreeFn)(void *data);
+
+// owner is kept alive for as long as the future is, pass NIL_VAL if the
+// work does not rely on any object
+Value newFuture(DictuVM *vm, Value owner, void *data, FutureWorkFn work,
+                FutureCompleteFn complete, FutureFreeFn freeData);
+
+#endif //dictu_future_h
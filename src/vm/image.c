@@ -0,0 +1,699 @@
+#ifdef __linux__
+// For dl_iterate_phdr()
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__APPLE__)
+#include <dlfcn.h>
+#include <mach-o/getsect.h>
+#include <mach-o/loader.h>
+#elif defined(__linux__)
+#include <link.h>
+#endif
+
+#include "image.h"
+#include "compiler.h"
+#include "future.h"
+#include "memory.h"
+#include "object.h"
+
+static void imageError(const char *action, const char *path, const char *reason) {
+    fprintf(stderr, "Could not %s image \"%s\": %s\n", action, path, reason);
+}
+
+#ifndef _WIN32
+#define IMAGE_MAGIC "DICTUIMG"
+#define IMAGE_VERSION 2
+
+// Relocations are 8 byte aligned offsets, the low bit says whether the
+// slot holds a native function rather than something in the image
+#define RELOCATE_CODE 1
+
+#define IMAGE_TABLES(TABLE) \
+    TABLE(strings) \
+    TABLE(globals) \
+    TABLE(modules) \
+    TABLE(numberMethods) \
+    TABLE(boolMethods) \
+    TABLE(nilMethods) \
+    TABLE(stringMethods) \
+    TABLE(listMethods) \
+    TABLE(dictMethods) \
+    TABLE(setMethods) \
+    TABLE(tupleMethods) \
+    TABLE(coroutineMethods) \
+    TABLE(rangeMethods) \
+    TABLE(fileMethods) \
+    TABLE(classMethods) \
+    TABLE(instanceMethods) \
+    TABLE(resultMethods) \
+    TABLE(enumMethods)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t relocationCount;
+    uint64_t buildId;
+    uint64_t checksum;
+    uint64_t size;
+    uint64_t relocations;
+#define TABLE(name) Table name;
+    IMAGE_TABLES(TABLE)
+#undef TABLE
+} ImageHeader;
+
+static uint64_t hashBytes(uint64_t hash, const void *bytes, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        hash ^= ((const uint8_t *) bytes)[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+// Hashes four words at a time in separate lanes, the code of a binary
+// without a build ID runs to hundreds of kilobytes
+static uint64_t hashWords(uint64_t hash, const char *bytes, size_t length) {
+    uint64_t lanes[4] = {hash, hash + 1, hash + 2, hash + 3};
+    size_t i = 0;
+
+    for (; i + sizeof(lanes) <= length; i += sizeof(lanes)) {
+        for (int lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            memcpy(&word, bytes + i + sizeof(uint64_t) * lane, sizeof(uint64_t));
+            lanes[lane] = (lanes[lane] ^ word) * 0x9E3779B97F4A7C15ULL;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+
+    hash = hashBytes(hash, lanes, sizeof(lanes));
+
+    return hashBytes(hash, bytes + i, length - i);
+}
+
+static uintptr_t codeAnchor(void) {
+    return (uintptr_t) &dictuInitVM;
+}
+
+typedef struct {
+    // The ID the linker stamped the binary holding the natives with
+    const char *id;
+    size_t idLength;
+    // Its code, hashed instead when the linker left no ID
+    const char *code;
+    size_t codeLength;
+} BinaryInfo;
+
+#if defined(__APPLE__)
+static bool findBinary(BinaryInfo *binary) {
+    Dl_info info;
+
+    if (dladdr((const void *) codeAnchor(), &info) == 0) {
+        return false;
+    }
+
+    const struct mach_header_64 *header = info.dli_fbase;
+    const struct load_command *command = (const struct load_command *) (header + 1);
+
+    for (uint32_t i = 0; i < header->ncmds; i++) {
+        if (command->cmd == LC_UUID) {
+            binary->id = (const char *) ((const struct uuid_command *) command)->uuid;
+            binary->idLength = sizeof(((const struct uuid_command *) command)->uuid);
+            return true;
+        }
+
+        command = (const struct load_command *) ((const char *) command + command->cmdsize);
+    }
+
+    unsigned long size;
+    binary->code = (const char *) getsectiondata(header, "__TEXT", "__text", &size);
+    binary->codeLength = size;
+
+    return binary->code != NULL;
+}
+#elif defined(__linux__)
+static bool findBuildIdNote(struct dl_phdr_info *info, BinaryInfo *binary) {
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *segment = &info->dlpi_phdr[i];
+
+        if (segment->p_type != PT_NOTE) {
+            continue;
+        }
+
+        const char *note = (const char *) (info->dlpi_addr + segment->p_vaddr);
+        const char *end = note + segment->p_filesz;
+
+        while (end - note >= (ptrdiff_t) sizeof(ElfW(Nhdr))) {
+            const ElfW(Nhdr) *header = (const ElfW(Nhdr) *) note;
+            const char *name = note + sizeof(ElfW(Nhdr));
+            const char *description = name + ((header->n_namesz + 3) & ~3u);
+
+            if (header->n_type == NT_GNU_BUILD_ID && header->n_namesz == 4 && memcmp(name, "GNU", 4) == 0) {
+                binary->id = description;
+                binary->idLength = header->n_descsz;
+                return true;
+            }
+
+            note = description + ((header->n_descsz + 3) & ~3u);
+        }
+    }
+
+    return false;
+}
+
+static int findObject(struct dl_phdr_info *info, size_t infoSize, void *data) {
+    UNUSED(infoSize);
+
+    BinaryInfo *binary = data;
+
+    for (int i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr) *segment = &info->dlpi_phdr[i];
+        uintptr_t start = info->dlpi_addr + segment->p_vaddr;
+
+        if (segment->p_type == PT_LOAD && codeAnchor() - start < segment->p_filesz) {
+            if (!findBuildIdNote(info, binary)) {
+                binary->code = (const char *) start;
+                binary->codeLength = segment->p_filesz;
+            }
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static bool findBinary(BinaryInfo *binary) {
+    return dl_iterate_phdr(findObject, binary) != 0;
+}
+#else
+static bool findBinary(BinaryInfo *binary) {
+    UNUSED(binary);
+
+    return false;
+}
+#endif
+
+/**
+ * Native functions are stored relative to codeAnchor(), so an image is only
+ * valid for a binary with exactly the same code. The build ID is the one the
+ * linker gave the binary holding the natives, or a hash of its code when it
+ * has none, along with the layout of the objects written to the image.
+ */
+static bool imageBuildId(uint64_t *buildId) {
+    BinaryInfo binary = {0};
+
+    if (!findBinary(&binary)) {
+        return false;
+    }
+
+    size_t sizes[] = {
+        sizeof(Value), sizeof(Table), sizeof(Entry), sizeof(ObjString), sizeof(ObjNative),
+        sizeof(ObjFunction), sizeof(ObjClosure), sizeof(ObjModule), sizeof(ImageHeader)
+    };
+    uint64_t hash = 14695981039346656037ULL;
+
+    if (binary.id != NULL) {
+        hash = hashBytes(hash, binary.id, binary.idLength);
+    } else {
+        hash = hashWords(hash, binary.code, binary.codeLength);
+    }
+
+    hash = hashBytes(hash, sizes, sizeof(sizes));
+    *buildId = hashBytes(hash, DICTU_STRING_VERSION, strlen(DICTU_STRING_VERSION));
+
+    return true;
+}
+
+// The checksum covers the whole image, with its own field left as 0
+static uint64_t imageChecksum(char *data, uint64_t size) {
+    ImageHeader *header = (ImageHeader *) data;
+    uint64_t checksum = header->checksum;
+
+    header->checksum = 0;
+    uint64_t hash = hashWords(14695981039346656037ULL, data, size);
+    header->checksum = checksum;
+
+    return hash;
+}
+
+typedef struct {
+    char *data;
+    uint64_t size;
+    uint64_t capacity;
+    uint64_t *relocations;
+    uint32_t relocationCount;
+    uint32_t relocationCapacity;
+    // Open addressed map from every object in the heap to its offset
+    Obj **objects;
+    uint64_t *offsets;
+    uint64_t objectMask;
+} ImageWriter;
+
+static uint64_t reserve(ImageWriter *writer, uint64_t size) {
+    uint64_t offset = writer->size;
+    uint64_t end = offset + ((size + 7) & ~(uint64_t) 7);
+
+    if (end > writer->capacity) {
+        uint64_t capacity = writer->capacity < 4096 ? 4096 : writer->capacity;
+
+        while (capacity < end) {
+            capacity *= 2;
+        }
+
+        writer->data = realloc(writer->data, capacity);
+        writer->capacity = capacity;
+    }
+
+    memset(writer->data + offset, 0, end - offset);
+    writer->size = end;
+
+    return offset;
+}
+
+static void addRelocation(ImageWriter *writer, uint64_t relocation) {
+    if (writer->relocationCount == writer->relocationCapacity) {
+        writer->relocationCapacity = writer->relocationCapacity < 256 ? 256 : writer->relocationCapacity * 2;
+        writer->relocations = realloc(writer->relocations, sizeof(uint64_t) * writer->relocationCapacity);
+    }
+
+    writer->relocations[writer->relocationCount++] = relocation;
+}
+
+static uint64_t *slotAt(ImageWriter *writer, uint64_t at) {
+    return (uint64_t *) (writer->data + at);
+}
+
+static uint64_t *findSlot(ImageWriter *writer, Obj *object) {
+    uint64_t index = ((uintptr_t) object >> 3) & writer->objectMask;
+
+    while (writer->objects[index] != NULL && writer->objects[index] != object) {
+        index = (index + 1) & writer->objectMask;
+    }
+
+    writer->objects[index] = object;
+
+    return &writer->offsets[index];
+}
+
+// Objects all sit past the header, so an offset of 0 means NULL
+static void writePointer(ImageWriter *writer, uint64_t at, void *pointer) {
+    if (pointer == NULL) {
+        *slotAt(writer, at) = 0;
+        return;
+    }
+
+    *slotAt(writer, at) = *findSlot(writer, pointer);
+    addRelocation(writer, at);
+}
+
+static void writeValue(ImageWriter *writer, uint64_t at, Value value) {
+    if (!IS_OBJ(value)) {
+        *slotAt(writer, at) = value;
+        return;
+    }
+
+    // Relocating adds the image's address, which leaves the tag bits alone
+    *slotAt(writer, at) = (value & (SIGN_BIT | QNAN)) | *findSlot(writer, AS_OBJ(value));
+    addRelocation(writer, at);
+}
+
+static void writeNative(ImageWriter *writer, uint64_t at, NativeFn function) {
+    *slotAt(writer, at) = (uint64_t) ((uintptr_t) function - codeAnchor());
+    addRelocation(writer, at | RELOCATE_CODE);
+}
+
+static uint64_t writeBytes(ImageWriter *writer, uint64_t at, const void *bytes, uint64_t size) {
+    if (size == 0) {
+        *slotAt(writer, at) = 0;
+        return 0;
+    }
+
+    uint64_t offset = reserve(writer, size);
+    memcpy(writer->data + offset, bytes, size);
+    *slotAt(writer, at) = offset;
+    addRelocation(writer, at);
+
+    return offset;
+}
+
+static void writeTable(ImageWriter *writer, uint64_t at, Table *table) {
+    uint64_t entries = writeBytes(writer, at + offsetof(Table, entries), table->entries,
+                                  sizeof(Entry) * table->capacity);
+
+    for (int i = 0; i < table->capacity; i++) {
+        uint64_t entry = entries + sizeof(Entry) * i;
+
+        writePointer(writer, entry + offsetof(Entry, key), table->entries[i].key);
+        writeValue(writer, entry + offsetof(Entry, value), table->entries[i].value);
+    }
+}
+
+static uint64_t objectSize(Obj *object) {
+    switch (object->type) {
+        case OBJ_STRING:
+            return sizeof(ObjString);
+        case OBJ_NATIVE:
+            return sizeof(ObjNative);
+        case OBJ_FUNCTION:
+            return sizeof(ObjFunction);
+        case OBJ_CLOSURE:
+            return ((ObjClosure *) object)->upvalueCount == 0 ? sizeof(ObjClosure) : 0;
+        case OBJ_MODULE:
+            return sizeof(ObjModule);
+        default:
+            return 0;
+    }
+}
+
+static void writeObject(ImageWriter *writer, Obj *object) {
+    uint64_t at = *findSlot(writer, object);
+    memcpy(writer->data + at, object, objectSize(object));
+
+    Obj *copy = (Obj *) (writer->data + at);
+    copy->next = NULL;
+    copy->isDark = true;
+
+    switch (object->type) {
+        case OBJ_STRING: {
+            ObjString *string = (ObjString *) object;
+            writeBytes(writer, at + offsetof(ObjString, chars), string->chars, string->length + 1);
+            break;
+        }
+
+        case OBJ_NATIVE: {
+            writeNative(writer, at + offsetof(ObjNative, function), ((ObjNative *) object)->function);
+            break;
+        }
+
+        case OBJ_FUNCTION: {
+            ObjFunction *function = (ObjFunction *) object;
+            Chunk *chunk = &function->chunk;
+            uint64_t chunkAt = at + offsetof(ObjFunction, chunk);
+
+            ((ObjFunction *) (writer->data + at))->chunk.capacity = chunk->count;
+            writeBytes(writer, chunkAt + offsetof(Chunk, code), chunk->code, chunk->count);
+            writeBytes(writer, chunkAt + offsetof(Chunk, lines), chunk->lines, sizeof(int) * chunk->count);
+
+            uint64_t constantsAt = chunkAt + offsetof(Chunk, constants);
+            ((ObjFunction *) (writer->data + at))->chunk.constants.capacity = chunk->constants.count;
+            uint64_t constants = writeBytes(writer, constantsAt + offsetof(ValueArray, values),
+                                            chunk->constants.values, sizeof(Value) * chunk->constants.count);
+
+            for (int i = 0; i < chunk->constants.count; i++) {
+                writeValue(writer, constants + sizeof(Value) * i, chunk->constants.values[i]);
+            }
+
+            writePointer(writer, at + offsetof(ObjFunction, name), function->name);
+            writePointer(writer, at + offsetof(ObjFunction, module), function->module);
+
+            // Only initializers have properties, the rest leave them unset
+            writeBytes(writer, at + offsetof(ObjFunction, propertyNames), function->propertyNames,
+                       sizeof(int) * function->propertyCount);
+            writeBytes(writer, at + offsetof(ObjFunction, propertyIndexes), function->propertyIndexes,
+                       sizeof(int) * function->propertyCount);
+            writeBytes(writer, at + offsetof(ObjFunction, privatePropertyNames), function->privatePropertyNames,
+                       sizeof(int) * function->privatePropertyCount);
+            writeBytes(writer, at + offsetof(ObjFunction, privatePropertyIndexes), function->privatePropertyIndexes,
+                       sizeof(int) * function->privatePropertyCount);
+            break;
+        }
+
+        case OBJ_CLOSURE: {
+            ObjClosure *closure = (ObjClosure *) object;
+            writePointer(writer, at + offsetof(ObjClosure, function), closure->function);
+            writePointer(writer, at + offsetof(ObjClosure, upvalues), NULL);
+            break;
+        }
+
+        case OBJ_MODULE: {
+            ObjModule *module = (ObjModule *) object;
+            writePointer(writer, at + offsetof(ObjModule, name), module->name);
+            writePointer(writer, at + offsetof(ObjModule, path), module->path);
+            writeTable(writer, at + offsetof(ObjModule, values), &module->values);
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+static bool saveImage(ImageWriter *writer, DictuVM *heap, const char *path) {
+    uint64_t objectCount = 0;
+
+    for (Obj *object = heap->objects; object != NULL; object = object->next) {
+        if (objectSize(object) == 0) {
+            imageError("write", path, "the heap holds values that can not be written to an image");
+            return false;
+        }
+
+        objectCount++;
+    }
+
+    uint64_t mapSize = 16;
+
+    while (mapSize < objectCount * 2) {
+        mapSize *= 2;
+    }
+
+    writer->objects = calloc(mapSize, sizeof(Obj *));
+    writer->offsets = calloc(mapSize, sizeof(uint64_t));
+    writer->objectMask = mapSize - 1;
+
+    reserve(writer, sizeof(ImageHeader));
+
+    for (Obj *object = heap->objects; object != NULL; object = object->next) {
+        uint64_t offset = reserve(writer, objectSize(object));
+        *findSlot(writer, object) = offset;
+    }
+
+    for (Obj *object = heap->objects; object != NULL; object = object->next) {
+        writeObject(writer, object);
+    }
+
+#define TABLE(name) \
+    memcpy(writer->data + offsetof(ImageHeader, name), &heap->name, sizeof(Table)); \
+    writeTable(writer, offsetof(ImageHeader, name), &heap->name);
+    IMAGE_TABLES(TABLE)
+#undef TABLE
+
+    uint64_t relocations = reserve(writer, sizeof(uint64_t) * writer->relocationCount);
+    memcpy(writer->data + relocations, writer->relocations, sizeof(uint64_t) * writer->relocationCount);
+
+    ImageHeader *header = (ImageHeader *) writer->data;
+    memcpy(header->magic, IMAGE_MAGIC, sizeof(header->magic));
+    header->version = IMAGE_VERSION;
+    header->relocationCount = writer->relocationCount;
+    header->size = writer->size;
+    header->relocations = relocations;
+
+    if (!imageBuildId(&header->buildId)) {
+        imageError("write", path, "could not find the code of this binary");
+        return false;
+    }
+
+    header->checksum = imageChecksum(writer->data, writer->size);
+
+    FILE *file = fopen(path, "wb");
+
+    if (file == NULL) {
+        imageError("write", path, strerror(errno));
+        return false;
+    }
+
+    bool written = fwrite(writer->data, 1, writer->size, file) == writer->size;
+
+    if (fclose(file) != 0) {
+        written = false;
+    }
+
+    if (!written) {
+        imageError("write", path, strerror(errno));
+    }
+
+    return written;
+}
+
+bool writeImage(DictuVM *heap, const char *path) {
+    ImageWriter writer;
+    memset(&writer, 0, sizeof(ImageWriter));
+
+    bool written = saveImage(&writer, heap, path);
+
+    free(writer.data);
+    free(writer.relocations);
+    free(writer.objects);
+    free(writer.offsets);
+
+    return written;
+}
+
+// There is only ever one image mapped, it backs the process wide heap
+static char *imageData = NULL;
+static uint64_t imageSize = 0;
+
+static bool tableInImage(Table *table, char *data, uint64_t size) {
+    if (table->capacity == 0) {
+        return true;
+    }
+
+    if (table->capacity < 0 || table->count > table->capacity || table->entries == NULL) {
+        return false;
+    }
+
+    uint64_t offset = (uint64_t) ((char *) table->entries - data);
+
+    return offset < size && (size - offset) / sizeof(Entry) >= (uint64_t) table->capacity;
+}
+
+static const char *relocateImage(char *data, uint64_t size) {
+    ImageHeader *header = (ImageHeader *) data;
+
+    if (size < sizeof(ImageHeader) || memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0) {
+        return "not an image";
+    }
+
+    uint64_t buildId;
+
+    if (!imageBuildId(&buildId)) {
+        return "could not find the code of this binary";
+    }
+
+    if (header->version != IMAGE_VERSION || header->buildId != buildId) {
+        return "written by a different build of Dictu";
+    }
+
+    if (header->size != size || header->relocations > size ||
+        (size - header->relocations) / sizeof(uint64_t) < header->relocationCount) {
+        return "the image is truncated";
+    }
+
+    if (header->checksum != imageChecksum(data, size)) {
+        return "the image is corrupt";
+    }
+
+    // Past the checksum only a bad writer could get these wrong, but a
+    // relocation outside the image, or into the header fields before its
+    // tables, would write over memory that is still to be read
+    if (header->relocations % sizeof(uint64_t) != 0) {
+        return "the image is corrupt";
+    }
+
+    uint64_t *relocations = (uint64_t *) (data + header->relocations);
+
+    for (uint32_t i = 0; i < header->relocationCount; i++) {
+        uint64_t at = relocations[i] & ~(uint64_t) RELOCATE_CODE;
+
+        if (at % sizeof(uint64_t) != 0 || at < offsetof(ImageHeader, strings) || at > size - sizeof(uint64_t)) {
+            return "the image is corrupt";
+        }
+
+        uint64_t *slot = (uint64_t *) (data + at);
+
+        if (relocations[i] & RELOCATE_CODE) {
+            *slot += codeAnchor();
+            continue;
+        }
+
+        // Values keep their tag bits, pointers have none
+        if ((*slot & ~(SIGN_BIT | QNAN)) >= size) {
+            return "the image is corrupt";
+        }
+
+        *slot += (uintptr_t) data;
+    }
+
+#define TABLE(name) \
+    if (!tableInImage(&header->name, data, size)) { \
+        return "the image is corrupt"; \
+    }
+    IMAGE_TABLES(TABLE)
+#undef TABLE
+
+    return NULL;
+}
+
+DictuVM *loadImage(const char *path) {
+    int fd = open(path, O_RDONLY);
+
+    if (fd == -1) {
+        imageError("load", path, strerror(errno));
+        return NULL;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) == -1 || st.st_size == 0) {
+        imageError("load", path, st.st_size == 0 ? "the image is empty" : strerror(errno));
+        close(fd);
+        return NULL;
+    }
+
+    // Private so the relocations only touch this process' copy of the pages
+    char *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        imageError("load", path, strerror(errno));
+        return NULL;
+    }
+
+    const char *error = relocateImage(data, st.st_size);
+
+    if (error != NULL) {
+        imageError("load", path, error);
+        munmap(data, st.st_size);
+        return NULL;
+    }
+
+    DictuVM *heap = malloc(sizeof(DictuVM));
+    memset(heap, 0, sizeof(DictuVM));
+
+    ImageHeader *header = (ImageHeader *) data;
+#define TABLE(name) heap->name = header->name;
+    IMAGE_TABLES(TABLE)
+#undef TABLE
+
+    imageData = data;
+    imageSize = st.st_size;
+
+    return heap;
+}
+
+void freeImage(DictuVM *heap) {
+    munmap(imageData, imageSize);
+    imageData = NULL;
+    imageSize = 0;
+    free(heap);
+}
+#else
+bool writeImage(DictuVM *heap, const char *path) {
+    UNUSED(heap);
+
+    imageError("write", path, "images are not supported on this platform");
+    return false;
+}
+
+DictuVM *loadImage(const char *path) {
+    imageError("load", path, "images are not supported on this platform");
+    return NULL;
+}
+
+void freeImage(DictuVM *heap) {
+    free(heap);
+}
+#endif
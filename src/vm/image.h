@@ -0,0 +1,26 @@
+#ifndef dictu_image_h
+#define dictu_image_h
+
+#include "common.h"
+#include "vm.h"
+
+/**
+ * An image is the frozen heap shared between VMs written out to a file,
+ * so later runs can map it back in rather than building the builtins
+ * again. Every pointer in it is stored as an offset into the image and
+ * fixed up when it is loaded, native functions are stored relative to the
+ * binary's own code so an image is only ever valid for the binary that
+ * wrote it.
+ *
+ * Only strings, natives, functions, closures and modules can be written,
+ * which is everything the builtins are made of.
+ */
+bool writeImage(DictuVM *heap, const char *path);
+
+// Returns a heap that reads its objects straight out of the mapped image,
+// or NULL with the reason written to stderr
+DictuVM *loadImage(const char *path);
+
+void freeImage(DictuVM *heap);
+
+#endif //dictu_image_h
@@ -4,6 +4,7 @@
 #include "compiler.h"
 #include "memory.h"
 #include "vm.h"
+#include "datatypes/files.h"
 
 #ifdef DEBUG_TRACE_GC
 #include <stdio.h>
@@ -19,7 +20,7 @@ void *reallocate(DictuVM *vm, void *previous, size_t oldSize, size_t newSize) {
     printf("Total bytes allocated: %zu\nNew allocation: %zu\nOld allocation: %zu\n\n", vm->bytesAllocated, newSize, oldSize);
 #endif
 
-    if (newSize > oldSize) {
+    if (newSize > oldSize && vm->gcPaused == 0) {
 #ifdef DEBUG_STRESS_GC
         collectGarbage(vm);
 #endif
@@ -74,6 +75,23 @@ static void grayArray(DictuVM *vm, ValueArray *array) {
     }
 }
 
+static void grayExecutionState(DictuVM *vm, Value *stack, Value *stackTop,
+                               CallFrame *frames, int frameCount, ObjUpvalue *openUpvalues) {
+    for (Value *slot = stack; slot < stackTop; slot++) {
+        grayValue(vm, *slot);
+    }
+
+    for (int i = 0; i < frameCount; i++) {
+        grayObject(vm, (Obj *) frames[i].closure);
+    }
+
+    for (ObjUpvalue *upvalue = openUpvalues;
+         upvalue != NULL;
+         upvalue = upvalue->next) {
+        grayObject(vm, (Obj *) upvalue);
+    }
+}
+
 static void blackenObject(DictuVM *vm, Obj *object) {
 #ifdef DEBUG_TRACE_GC
     printf("%p blacken ", (void *)object);
@@ -144,7 +162,9 @@ static void blackenObject(DictuVM *vm, Obj *object) {
         }
 
         case OBJ_UPVALUE:
-            grayValue(vm, ((ObjUpvalue *) object)->closed);
+            // An open upvalue may point into the stack of a coroutine
+            // that is no longer reachable, so the value is kept alive here
+            grayValue(vm, *((ObjUpvalue *) object)->value);
             break;
 
         case OBJ_LIST: {
@@ -153,6 +173,12 @@ static void blackenObject(DictuVM *vm, Obj *object) {
             break;
         }
 
+        case OBJ_TUPLE: {
+            ObjTuple *tuple = (ObjTuple *) object;
+            grayArray(vm, &tuple->values);
+            break;
+        }
+
         case OBJ_DICT: {
             ObjDict *dict = (ObjDict *) object;
             grayDict(vm, dict);
@@ -180,9 +206,27 @@ static void blackenObject(DictuVM *vm, Obj *object) {
             break;
         }
 
+        case OBJ_COROUTINE: {
+            ObjCoroutine *coroutine = (ObjCoroutine *) object;
+
+            // While running the coroutine holds its resumer's state, which
+            // lives on the resumer's stack rather than its own
+            Value *stack = coroutine->stack;
+
+            if (coroutine->state == COROUTINE_RUNNING) {
+                stack = coroutine->caller != NULL ? coroutine->caller->stack : vm->stack;
+                grayObject(vm, (Obj *) coroutine->caller);
+            }
+
+            grayExecutionState(vm, stack, coroutine->stackTop, coroutine->frames,
+                               coroutine->frameCount, coroutine->openUpvalues);
+            break;
+        }
+
         case OBJ_NATIVE:
         case OBJ_STRING:
         case OBJ_FILE:
+        case OBJ_RANGE:
             break;
     }
 }
@@ -262,18 +306,29 @@ void freeObject(DictuVM *vm, Obj *object) {
 
         case OBJ_STRING: {
             ObjString *string = (ObjString *) object;
-            FREE_ARRAY(vm, char, string->chars, string->length + 1);
+            if (string->mapped) {
+                unmapFileChars(string->chars, string->length);
+            } else {
+                FREE_ARRAY(vm, char, string->chars, string->length + 1);
+            }
             FREE(vm, ObjString, object);
             break;
         }
 
         case OBJ_LIST: {
             ObjList *list = (ObjList *) object;
-            freeValueArray(vm, &list->values);
+            freeList(vm, list);
             FREE(vm, ObjList, list);
             break;
         }
 
+        case OBJ_TUPLE: {
+            ObjTuple *tuple = (ObjTuple *) object;
+            freeValueArray(vm, &tuple->values);
+            FREE(vm, ObjTuple, tuple);
+            break;
+        }
+
         case OBJ_DICT: {
             ObjDict *dict = (ObjDict *) object;
             FREE_ARRAY(vm, DictItem, dict->entries, dict->capacityMask + 1);
@@ -289,6 +344,16 @@ void freeObject(DictuVM *vm, Obj *object) {
         }
 
         case OBJ_FILE: {
+            ObjFile *file = (ObjFile *) object;
+
+            // A file left open by a runtime error still points stdio at its
+            // buffer, so it is closed before the buffer goes
+            if (file->buffer != NULL && file->file != NULL) {
+                fclose(file->file);
+            }
+
+            free(file->buffer);
+            free(file->lineBuffer);
             FREE(vm, ObjFile, object);
             break;
         }
@@ -310,6 +375,48 @@ void freeObject(DictuVM *vm, Obj *object) {
             FREE(vm, ObjResult, object);
             break;
         }
+
+        case OBJ_COROUTINE: {
+            ObjCoroutine *coroutine = (ObjCoroutine *) object;
+            FREE_ARRAY(vm, Value, coroutine->stack, coroutine->stackCapacity);
+            FREE_ARRAY(vm, CallFrame, coroutine->frames, coroutine->frameCapacity);
+            FREE(vm, ObjCoroutine, object);
+            break;
+        }
+
+        case OBJ_RANGE: {
+            FREE(vm, ObjRange, object);
+            break;
+        }
+    }
+}
+
+// A suspended coroutine's stack is freed along with it, so any upvalues
+// still open on it are closed first. Runs between marking and sweeping,
+// while the unreached upvalues have not been freed yet.
+static void closeCoroutineUpvalues(DictuVM *vm) {
+    ObjCoroutine **coroutine = &vm->coroutines;
+
+    while (*coroutine != NULL) {
+        ObjCoroutine *current = *coroutine;
+
+        if (current->obj.isDark && current->state != COROUTINE_DONE) {
+            coroutine = &current->next;
+            continue;
+        }
+
+        if (!current->obj.isDark) {
+            for (ObjUpvalue *upvalue = current->openUpvalues;
+                 upvalue != NULL;
+                 upvalue = upvalue->next) {
+                upvalue->closed = *upvalue->value;
+                upvalue->value = &upvalue->closed;
+            }
+
+            current->openUpvalues = NULL;
+        }
+
+        *coroutine = current->next;
     }
 }
 
@@ -319,40 +426,45 @@ void collectGarbage(DictuVM *vm) {
     size_t before = vm->bytesAllocated;
 #endif
 
-    // Mark the stack roots.
-    for (Value *slot = vm->stack; slot < vm->stackTop; slot++) {
-        grayValue(vm, *slot);
-    }
+    // Mark the stack roots, the frames and the open upvalues. When inside
+    // a coroutine the stacks of its resumers are reached through it.
+    grayExecutionState(vm, stackBase(vm), vm->stackTop, vm->frames,
+                       vm->frameCount, vm->openUpvalues);
+    grayObject(vm, (Obj *) vm->coroutine);
+
+    // Mark the global roots.
+    grayTable(vm, &vm->modules);
 
-    for (int i = 0; i < vm->frameCount; i++) {
-        grayObject(vm, (Obj *) vm->frames[i].closure);
+    // Everything in the shared heap is permanently marked, there is no
+    // need to walk the tables borrowed from it
+    if (vm->shared == NULL || vm->repl) {
+        grayTable(vm, &vm->globals);
     }
 
-    // Mark the open upvalues.
-    for (ObjUpvalue *upvalue = vm->openUpvalues;
-         upvalue != NULL;
-         upvalue = upvalue->next) {
-        grayObject(vm, (Obj *) upvalue);
+    if (vm->shared == NULL) {
+        grayTable(vm, &vm->numberMethods);
+        grayTable(vm, &vm->boolMethods);
+        grayTable(vm, &vm->nilMethods);
+        grayTable(vm, &vm->stringMethods);
+        grayTable(vm, &vm->listMethods);
+        grayTable(vm, &vm->dictMethods);
+        grayTable(vm, &vm->setMethods);
+        grayTable(vm, &vm->tupleMethods);
+        grayTable(vm, &vm->coroutineMethods);
+        grayTable(vm, &vm->rangeMethods);
+        grayTable(vm, &vm->fileMethods);
+        grayTable(vm, &vm->classMethods);
+        grayTable(vm, &vm->instanceMethods);
+        grayTable(vm, &vm->resultMethods);
+        grayTable(vm, &vm->enumMethods);
     }
 
-    // Mark the global roots.
-    grayTable(vm, &vm->modules);
-    grayTable(vm, &vm->globals);
-    grayTable(vm, &vm->numberMethods);
-    grayTable(vm, &vm->boolMethods);
-    grayTable(vm, &vm->nilMethods);
-    grayTable(vm, &vm->stringMethods);
-    grayTable(vm, &vm->listMethods);
-    grayTable(vm, &vm->dictMethods);
-    grayTable(vm, &vm->setMethods);
-    grayTable(vm, &vm->fileMethods);
-    grayTable(vm, &vm->classMethods);
-    grayTable(vm, &vm->instanceMethods);
-    grayTable(vm, &vm->resultMethods);
-    grayTable(vm, &vm->enumMethods);
     grayCompilerRoots(vm);
     grayObject(vm, (Obj *) vm->initString);
     grayObject(vm, (Obj *) vm->annotationString);
+    grayObject(vm, (Obj *) vm->hashString);
+    grayObject(vm, (Obj *) vm->eqString);
+    grayObject(vm, (Obj *) vm->iterString);
     grayObject(vm, (Obj *) vm->replVar);
 
     // Traverse the references.
@@ -365,6 +477,8 @@ void collectGarbage(DictuVM *vm) {
     // Delete unused interned strings.
     tableRemoveWhite(vm, &vm->strings);
 
+    closeCoroutineUpvalues(vm);
+
     // Collect the white objects.
     Obj **object = &vm->objects;
     while (*object != NULL) {
@@ -24,6 +24,12 @@ static Value setNative(DictuVM *vm, int argCount, Value *args) {
     push(vm, OBJ_VAL(set));
 
     for (int i = 0; i < argCount; i++) {
+        if (!isValidKey(vm, args[i])) {
+            pop(vm);
+            runtimeError(vm, "Set value must be a hashable type");
+            return EMPTY_VAL;
+        }
+
         setInsert(vm, set, args[i]);
     }
     pop(vm);
@@ -31,6 +37,52 @@ static Value setNative(DictuVM *vm, int argCount, Value *args) {
     return OBJ_VAL(set);
 }
 
+static Value tupleNative(DictuVM *vm, int argCount, Value *args) {
+    ObjTuple *tuple = newTuple(vm);
+    push(vm, OBJ_VAL(tuple));
+
+    for (int i = 0; i < argCount; i++) {
+        writeValueArray(vm, &tuple->values, args[i]);
+    }
+    pop(vm);
+
+    return OBJ_VAL(tuple);
+}
+
+static Value rangeNative(DictuVM *vm, int argCount, Value *args) {
+    if (argCount < 1 || argCount > 3) {
+        runtimeError(vm, "range() takes 1, 2 or 3 arguments (%d given)", argCount);
+        return EMPTY_VAL;
+    }
+
+    for (int i = 0; i < argCount; i++) {
+        if (!IS_NUMBER(args[i])) {
+            runtimeError(vm, "range() arguments must be numbers");
+            return EMPTY_VAL;
+        }
+    }
+
+    double start = 0;
+    double end = AS_NUMBER(args[0]);
+    double step = 1;
+
+    if (argCount > 1) {
+        start = AS_NUMBER(args[0]);
+        end = AS_NUMBER(args[1]);
+    }
+
+    if (argCount == 3) {
+        step = AS_NUMBER(args[2]);
+
+        if (step == 0) {
+            runtimeError(vm, "range() step can not be 0");
+            return EMPTY_VAL;
+        }
+    }
+
+    return OBJ_VAL(newRange(vm, start, end, step));
+}
+
 static Value inputNative(DictuVM *vm, int argCount, Value *args) {
     if (argCount > 1) {
         runtimeError(vm, "input() takes either 0 or 1 arguments (%d given)", argCount);
@@ -187,6 +239,8 @@ void defineAllNatives(DictuVM *vm) {
             "input",
             "type",
             "set",
+            "tuple",
+            "range",
             "print",
             "printError",
             "assert",
@@ -199,6 +253,8 @@ void defineAllNatives(DictuVM *vm) {
             inputNative,
             typeNative,
             setNative,
+            tupleNative,
+            rangeNative,
             printNative,
             printErrorNative,
             assertNative,
@@ -8,6 +8,7 @@
 #include "value.h"
 #include "vm.h"
 #include "utf8.h"
+#include "datatypes/files.h"
 
 #define ALLOCATE_OBJ(vm, type, objectType) \
     (type*)allocateObject(vm, sizeof(type), objectType)
@@ -115,6 +116,7 @@ ObjFunction *newFunction(DictuVM *vm, ObjModule *module, FunctionType type, Acce
     function->propertyNames = NULL;
     function->privatePropertyCount = 0;
     function->privatePropertyIndexes = NULL;
+    function->isCoroutine = false;
     function->propertyNames = NULL;
     function->name = NULL;
     function->type = type;
@@ -154,6 +156,7 @@ static ObjString *allocateStringWithLen(DictuVM *vm, char *chars, int length,
     string->chars = chars;
     string->hash = hash;
     string->character_len = character_len;
+    string->mapped = false;
 
     push(vm, OBJ_VAL(string));
     tableSet(vm, &vm->strings, string, NIL_VAL);
@@ -170,9 +173,126 @@ static ObjString *allocateString(DictuVM *vm, char *chars, int length,
 ObjList *newList(DictuVM *vm) {
     ObjList *list = ALLOCATE_OBJ(vm, ObjList, OBJ_LIST);
     initValueArray(&list->values);
+    list->shared = NULL;
     return list;
 }
 
+/**
+ * Returns a new list viewing the elements [start, end) of the given list
+ * without copying them. The backing store is copied by whichever list
+ * is written to first, see unshareList.
+ */
+ObjList *shareList(DictuVM *vm, ObjList *list, int start, int end) {
+    ObjList *view = newList(vm);
+
+    if (end <= start) {
+        return view;
+    }
+
+    push(vm, OBJ_VAL(view));
+
+    if (list->shared == NULL) {
+        ListStorage *storage = ALLOCATE(vm, ListStorage, 1);
+        storage->refCount = 1;
+        storage->capacity = list->values.capacity;
+        storage->values = list->values.values;
+        list->shared = storage;
+    }
+
+    list->shared->refCount++;
+    view->shared = list->shared;
+    view->values.values = list->values.values + start;
+    view->values.count = end - start;
+    view->values.capacity = end - start;
+
+    pop(vm);
+    return view;
+}
+
+static void releaseListStorage(DictuVM *vm, ListStorage *storage) {
+    if (--storage->refCount == 0) {
+        FREE_ARRAY(vm, Value, storage->values, storage->capacity);
+        FREE(vm, ListStorage, storage);
+    }
+}
+
+void unshareList(DictuVM *vm, ObjList *list) {
+    ListStorage *storage = list->shared;
+
+    if (storage->refCount == 1) {
+        // Every other view has been collected, take ownership of the store
+        if (list->values.values != storage->values) {
+            memmove(storage->values, list->values.values, sizeof(Value) * list->values.count);
+        }
+
+        list->values.values = storage->values;
+        list->values.capacity = storage->capacity;
+        list->shared = NULL;
+        FREE(vm, ListStorage, storage);
+        return;
+    }
+
+    Value *values = ALLOCATE(vm, Value, list->values.count);
+    memcpy(values, list->values.values, sizeof(Value) * list->values.count);
+
+    // The allocation may have collected the other views, so release
+    // the store rather than just dropping the count
+    releaseListStorage(vm, storage);
+    list->values.values = values;
+    list->values.capacity = list->values.count;
+    list->shared = NULL;
+}
+
+void freeList(DictuVM *vm, ObjList *list) {
+    if (list->shared == NULL) {
+        freeValueArray(vm, &list->values);
+        return;
+    }
+
+    releaseListStorage(vm, list->shared);
+}
+
+ObjTuple *newTuple(DictuVM *vm) {
+    ObjTuple *tuple = ALLOCATE_OBJ(vm, ObjTuple, OBJ_TUPLE);
+    initValueArray(&tuple->values);
+    tuple->isHashed = false;
+    tuple->hash = 0;
+    return tuple;
+}
+
+ObjCoroutine *newCoroutine(DictuVM *vm, int stackCapacity) {
+    ObjCoroutine *coroutine = ALLOCATE_OBJ(vm, ObjCoroutine, OBJ_COROUTINE);
+    coroutine->state = COROUTINE_CREATED;
+    coroutine->stack = NULL;
+    coroutine->stackCapacity = 0;
+    coroutine->stackTop = NULL;
+    coroutine->frames = NULL;
+    coroutine->frameCount = 0;
+    coroutine->frameCapacity = 0;
+    coroutine->openUpvalues = NULL;
+    coroutine->caller = NULL;
+    coroutine->next = vm->coroutines;
+    vm->coroutines = coroutine;
+
+    push(vm, OBJ_VAL(coroutine));
+    coroutine->stack = ALLOCATE(vm, Value, stackCapacity);
+    coroutine->stackCapacity = stackCapacity;
+    coroutine->stackTop = coroutine->stack;
+    coroutine->frames = ALLOCATE(vm, CallFrame, 4);
+    coroutine->frameCapacity = 4;
+    pop(vm);
+
+    return coroutine;
+}
+
+ObjRange *newRange(DictuVM *vm, double start, double end, double step) {
+    ObjRange *range = ALLOCATE_OBJ(vm, ObjRange, OBJ_RANGE);
+    range->start = start;
+    range->end = end;
+    range->step = step;
+    return range;
+}
+
 ObjDict *newDict(DictuVM *vm) {
     ObjDict *dict = ALLOCATE_OBJ(vm, ObjDict, OBJ_DICT);
     dict->count = 0;
@@ -191,7 +311,13 @@ ObjSet *newSet(DictuVM *vm) {
 }
 
 ObjFile *newFile(DictuVM *vm) {
-    return ALLOCATE_OBJ(vm, ObjFile, OBJ_FILE);
+    ObjFile *file = ALLOCATE_OBJ(vm, ObjFile, OBJ_FILE);
+    file->lineBuffer = NULL;
+    file->lineCapacity = 0;
+    file->buffer = NULL;
+    file->bufferSize = 0;
+    file->used = false;
+    return file;
 }
 
 ObjAbstract *newAbstract(DictuVM *vm, AbstractFreeFn func, AbstractTypeFn type) {
@@ -201,6 +327,7 @@ ObjAbstract *newAbstract(DictuVM *vm, AbstractFreeFn func, AbstractTypeFn type)
     abstract->type = type;
     abstract->grayFunc = NULL;
     abstract->excludeSelf = false;
+    abstract->iterate = NULL;
     initTable(&abstract->values);
 
     return abstract;
@@ -213,6 +340,7 @@ ObjAbstract *newAbstractExcludeSelf(DictuVM *vm, AbstractFreeFn func, AbstractTy
     abstract->type = type;
     abstract->grayFunc = NULL;
     abstract->excludeSelf = true;
+    abstract->iterate = NULL;
     initTable(&abstract->values);
 
     return abstract;
@@ -252,10 +380,23 @@ static uint32_t hashString(const char *key, int length) {
     return hash;
 }
 
+// Builtin names are interned once in the frozen heap shared between VMs,
+// so it is searched before the VM's own strings
+static ObjString *findInterned(DictuVM *vm, const char *chars, int length, uint32_t hash) {
+    if (vm->shared != NULL) {
+        ObjString *interned = tableFindString(&vm->shared->strings, chars, length, hash);
+
+        if (interned != NULL) {
+            return interned;
+        }
+    }
+
+    return tableFindString(&vm->strings, chars, length, hash);
+}
+
 ObjString *takeString(DictuVM *vm, char *chars, int length) {
     uint32_t hash = hashString(chars, length);
-    ObjString *interned = tableFindString(&vm->strings, chars, length,
-                                          hash);
+    ObjString *interned = findInterned(vm, chars, length, hash);
     if (interned != NULL) {
         FREE_ARRAY(vm, char, chars, length + 1);
         return interned;
@@ -268,8 +409,7 @@ ObjString *takeString(DictuVM *vm, char *chars, int length) {
 
 ObjString *takeStringWithLen(DictuVM *vm, char *chars, int length, int character_len) {
     uint32_t hash = hashString(chars, length);
-    ObjString *interned = tableFindString(&vm->strings, chars, length,
-                                          hash);
+    ObjString *interned = findInterned(vm, chars, length, hash);
     if (interned != NULL) {
         FREE_ARRAY(vm, char, chars, length + 1);
         return interned;
@@ -280,10 +420,22 @@ ObjString *takeStringWithLen(DictuVM *vm, char *chars, int length, int character
     return allocateStringWithLen(vm, chars, length, hash, character_len);
 }
 
+ObjString *takeMappedString(DictuVM *vm, char *chars, int length) {
+    uint32_t hash = hashString(chars, length);
+    ObjString *interned = findInterned(vm, chars, length, hash);
+    if (interned != NULL) {
+        unmapFileChars(chars, length);
+        return interned;
+    }
+
+    ObjString *string = allocateString(vm, chars, length, hash);
+    string->mapped = true;
+    return string;
+}
+
 ObjString *copyString(DictuVM *vm, const char *chars, int length) {
     uint32_t hash = hashString(chars, length);
-    ObjString *interned = tableFindString(&vm->strings, chars, length,
-                                          hash);
+    ObjString *interned = findInterned(vm, chars, length, hash);
     if (interned != NULL) return interned;
 
     char *heapChars = ALLOCATE(vm, char, length + 1);
@@ -294,8 +446,7 @@ ObjString *copyString(DictuVM *vm, const char *chars, int length) {
 
 ObjString *copyStringWithLen(DictuVM *vm, const char *chars, int length, int character_len) {
     uint32_t hash = hashString(chars, length);
-    ObjString *interned = tableFindString(&vm->strings, chars, length,
-                                          hash);
+    ObjString *interned = findInterned(vm, chars, length, hash);
     if (interned != NULL) return interned;
 
     char *heapChars = ALLOCATE(vm, char, length + 1);
@@ -313,15 +464,14 @@ ObjUpvalue *newUpvalue(DictuVM *vm, Value *slot) {
     return upvalue;
 }
 
-char *listToString(Value value) {
+static char *valueArrayToString(Value value, ValueArray *values, char open, char close) {
     int size = 50;
-    ObjList *list = AS_LIST(value);
     char *listString = malloc(sizeof(char) * size);
-    memcpy(listString, "[", 1);
+    memcpy(listString, &open, 1);
     int listStringLength = 1;
 
-    for (int i = 0; i < list->values.count; ++i) {
-        Value listValue = list->values.values[i];
+    for (int i = 0; i < values->count; ++i) {
+        Value listValue = values->values[i];
 
         char *element;
         int elementSize;
@@ -369,18 +519,36 @@ char *listToString(Value value) {
             free(element);
         }
 
-        if (i != list->values.count - 1) {
+        if (i != values->count - 1) {
             memcpy(listString + listStringLength, ", ", 2);
             listStringLength += 2;
         }
     }
 
-    memcpy(listString + listStringLength, "]", 1);
+    memcpy(listString + listStringLength, &close, 1);
     listString[listStringLength + 1] = '\0';
 
     return listString;
 }
 
+char *listToString(Value value) {
+    return valueArrayToString(value, &AS_LIST(value)->values, '[', ']');
+}
+
+char *tupleToString(Value value) {
+    return valueArrayToString(value, &AS_TUPLE(value)->values, '(', ')');
+}
+
+char *rangeToString(Value value) {
+    ObjRange *range = AS_RANGE(value);
+
+    int length = snprintf(NULL, 0, "range(%.15g, %.15g, %.15g)", range->start, range->end, range->step) + 1;
+    char *rangeString = malloc(sizeof(char) * length);
+    snprintf(rangeString, length, "range(%.15g, %.15g, %.15g)", range->start, range->end, range->step);
+
+    return rangeString;
+}
+
 char *dictToString(Value value) {
    int count = 0;
    int size = 50;
@@ -573,9 +741,9 @@ char *classToString(Value value) {
     return classString;
 }
 
-static bool listContains(ObjList *list, Value value) {
+static bool listContains(DictuVM *vm, ObjList *list, Value value) {
     for (int i = 0; i < list->values.count; ++i) {
-        if (valuesEqual(list->values.values[i], value)) {
+        if (valuesEqual(vm, list->values.values[i], value)) {
             return true;
         }
     }
@@ -618,7 +786,7 @@ ObjDict *classToDict(DictuVM *vm, Value value) {
                 continue;
             }
 
-            if (listContains(methodsList, OBJ_VAL(klass->publicMethods.entries[i].key))) {
+            if (listContains(vm, methodsList, OBJ_VAL(klass->publicMethods.entries[i].key))) {
                 continue;
             }
 
@@ -793,6 +961,10 @@ char *objectToString(Value value) {
             return listToString(value);
         }
 
+        case OBJ_TUPLE: {
+            return tupleToString(value);
+        }
+
         case OBJ_DICT: {
             return dictToString(value);
         }
@@ -814,6 +986,17 @@ char *objectToString(Value value) {
             return abstract->type(abstract);
         }
 
+        case OBJ_RANGE: {
+            return rangeToString(value);
+        }
+
+        case OBJ_COROUTINE: {
+            char *coroutineString = malloc(sizeof(char) * 12);
+            memcpy(coroutineString, "<Coroutine>", 11);
+            coroutineString[11] = '\0';
+            return coroutineString;
+        }
+
         case OBJ_RESULT: {
             ObjResult *result = AS_RESULT(value);
             if (result->status == SUCCESS) {
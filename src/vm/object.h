@@ -28,6 +28,9 @@
 #define AS_FILE(value)          ((ObjFile*)AS_OBJ(value))
 #define AS_ABSTRACT(value)      ((ObjAbstract*)AS_OBJ(value))
 #define AS_RESULT(value)        ((ObjResult*)AS_OBJ(value))
+#define AS_TUPLE(value)         ((ObjTuple*)AS_OBJ(value))
+#define AS_COROUTINE(value)     ((ObjCoroutine*)AS_OBJ(value))
+#define AS_RANGE(value)         ((ObjRange*)AS_OBJ(value))
 
 #define IS_MODULE(value)          isObjType(value, OBJ_MODULE)
 #define IS_BOUND_METHOD(value)    isObjType(value, OBJ_BOUND_METHOD)
@@ -46,6 +49,9 @@
 #define IS_FILE(value)            isObjType(value, OBJ_FILE)
 #define IS_ABSTRACT(value)        isObjType(value, OBJ_ABSTRACT)
 #define IS_RESULT(value)          isObjType(value, OBJ_RESULT)
+#define IS_TUPLE(value)           isObjType(value, OBJ_TUPLE)
+#define IS_COROUTINE(value)       isObjType(value, OBJ_COROUTINE)
+#define IS_RANGE(value)           isObjType(value, OBJ_RANGE)
 
 typedef enum {
     OBJ_MODULE,
@@ -63,7 +69,10 @@ typedef enum {
     OBJ_FILE,
     OBJ_ABSTRACT,
     OBJ_RESULT,
-    OBJ_UPVALUE
+    OBJ_UPVALUE,
+    OBJ_TUPLE,
+    OBJ_COROUTINE,
+    OBJ_RANGE
 } ObjType;
 
 typedef enum {
@@ -117,6 +126,8 @@ typedef struct {
     int privatePropertyCount;
     int *privatePropertyNames;
     int *privatePropertyIndexes;
+    // Set when the body contains a yield, calling it creates a coroutine
+    bool isCoroutine;
 } ObjFunction;
 
 typedef Value (*NativeFn)(DictuVM *vm, int argCount, Value *args);
@@ -132,11 +143,32 @@ struct sObjString {
     char *chars;
     uint32_t hash;
     int character_len;
+    // chars is a read-only mapping of a file rather than heap memory
+    bool mapped;
 };
 
+// Backing store shared between lists after a slice or shallow copy.
+// Lists sharing a store must call makeListWritable before mutating.
+typedef struct {
+    int refCount;
+    int capacity;
+    Value *values;
+} ListStorage;
+
 struct sObjList {
     Obj obj;
     ValueArray values;
+    // NULL unless the values are a view into storage shared with other lists
+    ListStorage *shared;
+};
+
+struct sObjTuple {
+    Obj obj;
+    ValueArray values;
+    // Tuples are immutable so the hash is computed once, on first use,
+    // if every element is itself immutable.
+    bool isHashed;
+    uint32_t hash;
 };
 
 typedef struct {
@@ -169,11 +201,22 @@ struct sObjFile {
     FILE *file;
     char *path;
     char *openType;
+    // Reused by every line read, grown to fit the longest line so far
+    char *lineBuffer;
+    size_t lineCapacity;
+    // The stdio buffer set by setBufferSize(), writes are flushed straight
+    // away while bufferSize is 0
+    char *buffer;
+    size_t bufferSize;
+    // Set by the first read, write, seek or setBufferSize() on the stream
+    bool used;
 };
 
 typedef void (*AbstractFreeFn)(DictuVM *vm, ObjAbstract *abstract);
 typedef void (*AbstractGrayFn)(DictuVM *vm, ObjAbstract *abstract);
 typedef char* (*AbstractTypeFn)(ObjAbstract *abstract);
+// Sets next and returns true for each value of a for-in loop, false once done
+typedef bool (*AbstractIterFn)(DictuVM *vm, ObjAbstract *abstract, Value *next);
 
 struct sObjAbstract {
     Obj obj;
@@ -183,6 +226,7 @@ struct sObjAbstract {
     AbstractGrayFn grayFunc;
     AbstractTypeFn type;
     bool excludeSelf;
+    AbstractIterFn iterate;
 };
 
 typedef enum {
@@ -220,6 +264,45 @@ typedef struct {
     int upvalueCount;
 } ObjClosure;
 
+typedef struct {
+    ObjClosure *closure;
+    uint8_t *ip;
+    Value *slots;
+} CallFrame;
+
+typedef enum {
+    COROUTINE_CREATED,
+    COROUTINE_SUSPENDED,
+    COROUTINE_RUNNING,
+    COROUTINE_DONE
+} CoroutineState;
+
+struct sObjCoroutine {
+    Obj obj;
+    CoroutineState state;
+    Value *stack;
+    int stackCapacity;
+    // The execution state below is swapped with the VM's on every resume
+    // and yield. While suspended it is the coroutine's own, while running
+    // it is the state of whoever resumed it.
+    Value *stackTop;
+    CallFrame *frames;
+    int frameCount;
+    int frameCapacity;
+    ObjUpvalue *openUpvalues;
+    ObjCoroutine *caller;
+    // Coroutines that may still own open upvalues are chained together
+    // so the collector can close them over before freeing the stack.
+    ObjCoroutine *next;
+};
+
+typedef struct {
+    Obj obj;
+    double start;
+    double end;
+    double step;
+} ObjRange;
+
 typedef struct sObjClass {
     Obj obj;
     ObjString *name;
@@ -272,12 +355,26 @@ ObjNative *newNative(DictuVM *vm, NativeFn function);
 
 ObjString *takeString(DictuVM *vm, char *chars, int length);
 ObjString *takeStringWithLen(DictuVM *vm, char *chars, int length, int character_len);
+// Takes ownership of a mapping made by mapFileChars
+ObjString *takeMappedString(DictuVM *vm, char *chars, int length);
 
 ObjString *copyString(DictuVM *vm, const char *chars, int length);
 ObjString *copyStringWithLen(DictuVM *vm, const char *chars, int length, int character_len);
 
 ObjList *newList(DictuVM *vm);
 
+ObjList *shareList(DictuVM *vm, ObjList *list, int start, int end);
+
+void unshareList(DictuVM *vm, ObjList *list);
+
+void freeList(DictuVM *vm, ObjList *list);
+
+ObjTuple *newTuple(DictuVM *vm);
+
+ObjCoroutine *newCoroutine(DictuVM *vm, int stackCapacity);
+
+ObjRange *newRange(DictuVM *vm, double start, double end, double step);
+
 ObjDict *newDict(DictuVM *vm);
 
 ObjSet *newSet(DictuVM *vm);
@@ -298,6 +395,8 @@ ObjUpvalue *newUpvalue(DictuVM *vm, Value *slot);
 char *setToString(Value value);
 char *dictToString(Value value);
 char *listToString(Value value);
+char *tupleToString(Value value);
+char *rangeToString(Value value);
 char *classToString(Value value);
 ObjDict *classToDict(DictuVM *vm, Value value);
 char *instanceToString(Value value);
@@ -307,6 +406,12 @@ static inline bool isObjType(Value value, ObjType type) {
     return IS_OBJ(value) && AS_OBJ(value)->type == type;
 }
 
+static inline void makeListWritable(DictuVM *vm, ObjList *list) {
+    if (list->shared != NULL) {
+        unshareList(vm, list);
+    }
+}
+
 static inline ObjType getObjType(Value value) {
     return AS_OBJ(value)->type;
 }
@@ -53,6 +53,10 @@ OPCODE(SUPER)
 OPCODE(CLOSURE)
 OPCODE(CLOSE_UPVALUE)
 OPCODE(RETURN)
+OPCODE(YIELD)
+OPCODE(RESUME)
+OPCODE(GET_ITER)
+OPCODE(FOR_ITER)
 OPCODE(EMPTY)
 OPCODE(CLASS)
 OPCODE(SUBCLASS)
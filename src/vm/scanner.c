@@ -214,6 +214,8 @@ static LangTokenType identifierType(Scanner *scanner) {
                         return checkKeyword(scanner, 2, 0, "", TOKEN_IF);
                     case 'm':
                         return checkKeyword(scanner, 2, 4, "port", TOKEN_IMPORT);
+                    case 'n':
+                        return checkKeyword(scanner, 2, 0, "", TOKEN_IN);
                 }
             }
             break;
@@ -235,7 +237,15 @@ static LangTokenType identifierType(Scanner *scanner) {
             if (scanner->current - scanner->start > 1) {
                 switch (scanner->start[1]) {
                     case 'e':
-                        return checkKeyword(scanner, 2, 4, "turn", TOKEN_RETURN);
+                        if (scanner->current - scanner->start > 2) {
+                            switch (scanner->start[2]) {
+                                case 't':
+                                    return checkKeyword(scanner, 3, 3, "urn", TOKEN_RETURN);
+                                case 's':
+                                    return checkKeyword(scanner, 3, 3, "ume", TOKEN_RESUME);
+                            }
+                        }
+                        break;
                 }
             } else {
                 if (scanner->start[1] == '"' || scanner->start[1] == '\'') {
@@ -287,6 +297,8 @@ static LangTokenType identifierType(Scanner *scanner) {
                 }
             }
             break;
+        case 'y':
+            return checkKeyword(scanner, 1, 4, "ield", TOKEN_YIELD);
     }
 
     return TOKEN_IDENTIFIER;
@@ -40,8 +40,9 @@ typedef enum {
     TOKEN_ENUM,
     TOKEN_IF, TOKEN_AND, TOKEN_ELSE, TOKEN_OR, TOKEN_SWITCH, TOKEN_CASE, TOKEN_DEFAULT,
     TOKEN_VAR, TOKEN_CONST, TOKEN_TRUE, TOKEN_FALSE, TOKEN_NIL,
-    TOKEN_FOR, TOKEN_WHILE, TOKEN_BREAK,
+    TOKEN_FOR, TOKEN_IN, TOKEN_WHILE, TOKEN_BREAK,
     TOKEN_RETURN, TOKEN_CONTINUE,
+    TOKEN_YIELD, TOKEN_RESUME,
     TOKEN_WITH, TOKEN_EOF, TOKEN_IMPORT, TOKEN_FROM,
     TOKEN_ERROR
 
@@ -128,12 +128,35 @@ void defineNativeProperty(DictuVM *vm, Table *table, const char *name, Value val
     pop(vm);
 }
 
-bool isValidKey(Value value) {
+bool isValidKey(DictuVM *vm, Value value) {
     if (IS_NIL(value) || IS_BOOL(value) || IS_NUMBER(value) ||
     IS_STRING(value)) {
         return true;
     }
 
+    // Tuples can not change, so they are hashable if everything in them is
+    if (IS_TUPLE(value)) {
+        ObjTuple *tuple = AS_TUPLE(value);
+
+        if (tuple->isHashed) {
+            return true;
+        }
+
+        for (int i = 0; i < tuple->values.count; ++i) {
+            if (!isValidKey(vm, tuple->values.values[i])) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Instances are only hashable through their own __hash__ method
+    if (IS_INSTANCE(value)) {
+        Value method;
+        return tableGet(&AS_INSTANCE(value)->klass->publicMethods, vm->hashString, &method);
+    }
+
     return false;
 }
 
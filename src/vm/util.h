@@ -11,7 +11,7 @@ void defineNative(DictuVM *vm, Table *table, const char *name, NativeFn function
 
 void defineNativeProperty(DictuVM *vm, Table *table, const char *name, Value value);
 
-bool isValidKey(Value value);
+bool isValidKey(DictuVM *vm, Value value);
 
 Value boolNative(DictuVM *vm, int argCount, Value *args);
 
@@ -46,36 +46,99 @@ static inline uint32_t hashBits(uint64_t hash) {
     return (uint32_t) (hash & 0x3fffffff);
 }
 
-static uint32_t hashObject(Obj *object) {
+static inline uint32_t combineHash(uint32_t seed, uint32_t hash) {
+    // From boost's hash_combine()
+    return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+// Calls a user defined hook (__hash__ / __eq__) on an instance. This re-enters
+// the VM so hooks should be kept simple.
+static Value callInstanceHook(DictuVM *vm, Value receiver, Value method, int argCount, Value *args) {
+    ObjBoundMethod *bound = newBoundMethod(vm, receiver, AS_CLOSURE(method));
+    push(vm, OBJ_VAL(bound));
+    Value result = callFunction(vm, OBJ_VAL(bound), argCount, args);
+    pop(vm);
+
+    return result;
+}
+
+static uint32_t hashArray(DictuVM *vm, ValueArray *array, bool *immutable) {
+    uint32_t hash = hashBits(array->count);
+
+    for (int i = 0; i < array->count; ++i) {
+        Value value = array->values[i];
+        hash = combineHash(hash, hashValue(vm, value));
+
+        if (IS_OBJ(value) && !IS_STRING(value) && !(IS_TUPLE(value) && AS_TUPLE(value)->isHashed)) {
+            *immutable = false;
+        }
+    }
+
+    return hash;
+}
+
+static uint32_t hashObject(DictuVM *vm, Obj *object) {
     switch (object->type) {
         case OBJ_STRING: {
             return ((ObjString *) object)->hash;
         }
 
-            // Should never get here
-        default: {
-#ifdef DEBUG_PRINT_CODE
-            printf("Object: ");
-            printValue(OBJ_VAL(object));
-            printf(" not hashable!\n");
-            exit(1);
-#endif
-            return -1;
+        case OBJ_TUPLE: {
+            ObjTuple *tuple = (ObjTuple *) object;
+            if (tuple->isHashed) {
+                return tuple->hash;
+            }
+
+            bool immutable = true;
+            uint32_t hash = hashArray(vm, &tuple->values, &immutable);
+
+            // Only cache the hash if no element can change underneath us
+            if (immutable) {
+                tuple->hash = hash;
+                tuple->isHashed = true;
+            }
+
+            return hash;
+        }
+
+        case OBJ_INSTANCE: {
+            ObjInstance *instance = (ObjInstance *) object;
+            Value method;
+
+            if (tableGet(&instance->klass->publicMethods, vm->hashString, &method)) {
+                Value hash = callInstanceHook(vm, OBJ_VAL(object), method, 0, NULL);
+
+                if (!IS_NUMBER(hash)) {
+                    runtimeError(vm, "__hash__() on '%s' must return a number", instance->klass->name->chars);
+                    // Hooks run re-entrantly so, as with an error inside one, there is nothing to unwind to
+                    exit(70);
+                }
+
+                return hashValue(vm, hash);
+            }
+
+            break;
         }
+
+        default:
+            break;
     }
+
+    // Anything else can not be a key, so is only ever looked up and never found
+    return hashBits((uint64_t) (uintptr_t) object);
 }
 
-static uint32_t hashValue(Value value) {
+uint32_t hashValue(DictuVM *vm, Value value) {
     if (IS_OBJ(value)) {
-        return hashObject(AS_OBJ(value));
+        return hashObject(vm, AS_OBJ(value));
     }
 
     return hashBits(value);
 }
 
-static DictItem *findDictEntry(DictItem *entries, int capacityMask,
+static DictItem *findDictEntry(DictuVM *vm, DictItem *entries, int capacityMask,
                                Value key) {
-    uint32_t index = hashValue(key) & capacityMask;
+    uint32_t index = hashValue(vm, key) & capacityMask;
     DictItem *tombstone = NULL;
 
     for (;;) {
@@ -89,7 +152,7 @@ static DictItem *findDictEntry(DictItem *entries, int capacityMask,
                 // We found a tombstone.
                 if (tombstone == NULL) tombstone = entry;
             }
-        } else if (valuesEqual(key, entry->key)) {
+        } else if (valuesEqual(vm, key, entry->key)) {
             // We found the key.
             return entry;
         }
@@ -100,10 +163,10 @@ static DictItem *findDictEntry(DictItem *entries, int capacityMask,
     }
 }
 
-bool dictGet(ObjDict *dict, Value key, Value *value) {
+bool dictGet(DictuVM *vm, ObjDict *dict, Value key, Value *value) {
     if (dict->count == 0) return false;
 
-    DictItem *entry = findDictEntry(dict->entries, dict->capacityMask, key);
+    DictItem *entry = findDictEntry(vm, dict->entries, dict->capacityMask, key);
     if (IS_EMPTY(entry->key)) return false;
 
     *value = entry->value;
@@ -123,7 +186,7 @@ static void adjustDictCapacity(DictuVM *vm, ObjDict *dict, int capacityMask) {
         DictItem *entry = &dict->entries[i];
         if (IS_EMPTY(entry->key)) continue;
 
-        DictItem *dest = findDictEntry(entries, capacityMask, entry->key);
+        DictItem *dest = findDictEntry(vm, entries, capacityMask, entry->key);
         dest->key = entry->key;
         dest->value = entry->value;
         dict->count++;
@@ -141,7 +204,7 @@ bool dictSet(DictuVM *vm, ObjDict *dict, Value key, Value value) {
         adjustDictCapacity(vm, dict, capacityMask);
     }
 
-    DictItem *entry = findDictEntry(dict->entries, dict->capacityMask, key);
+    DictItem *entry = findDictEntry(vm, dict->entries, dict->capacityMask, key);
     bool isNewKey = IS_EMPTY(entry->key);
 
     entry->key = key;
@@ -158,7 +221,7 @@ bool dictSet(DictuVM *vm, ObjDict *dict, Value key, Value value) {
 bool dictDelete(DictuVM *vm, ObjDict *dict, Value key) {
     if (dict->count == 0) return false;
 
-    DictItem *entry = findDictEntry(dict->entries, dict->capacityMask, key);
+    DictItem *entry = findDictEntry(vm, dict->entries, dict->capacityMask, key);
     if (IS_EMPTY(entry->key)) return false;
 
     // Place a tombstone in the entry.
@@ -183,9 +246,9 @@ void grayDict(DictuVM *vm, ObjDict *dict) {
     }
 }
 
-static SetItem *findSetEntry(SetItem *entries, int capacityMask,
+static SetItem *findSetEntry(DictuVM *vm, SetItem *entries, int capacityMask,
                              Value value) {
-    uint32_t index = hashValue(value) & capacityMask;
+    uint32_t index = hashValue(vm, value) & capacityMask;
     SetItem *tombstone = NULL;
 
     for (;;) {
@@ -199,7 +262,7 @@ static SetItem *findSetEntry(SetItem *entries, int capacityMask,
                 // We found a tombstone.
                 if (tombstone == NULL) tombstone = entry;
             }
-        } else if (valuesEqual(value, entry->value)) {
+        } else if (valuesEqual(vm, value, entry->value)) {
             // We found the key.
             return entry;
         }
@@ -208,10 +271,10 @@ static SetItem *findSetEntry(SetItem *entries, int capacityMask,
     }
 }
 
-bool setGet(ObjSet *set, Value value) {
+bool setGet(DictuVM *vm, ObjSet *set, Value value) {
     if (set->count == 0) return false;
 
-    SetItem *entry = findSetEntry(set->entries, set->capacityMask, value);
+    SetItem *entry = findSetEntry(vm, set->entries, set->capacityMask, value);
     if (IS_EMPTY(entry->value) || entry->deleted) return false;
 
     return true;
@@ -230,7 +293,7 @@ static void adjustSetCapacity(DictuVM *vm, ObjSet *set, int capacityMask) {
         SetItem *entry = &set->entries[i];
         if (IS_EMPTY(entry->value) || entry->deleted) continue;
 
-        SetItem *dest = findSetEntry(entries, capacityMask, entry->value);
+        SetItem *dest = findSetEntry(vm, entries, capacityMask, entry->value);
         dest->value = entry->value;
         set->count++;
     }
@@ -247,7 +310,7 @@ bool setInsert(DictuVM *vm, ObjSet *set, Value value) {
         adjustSetCapacity(vm, set, capacityMask);
     }
 
-    SetItem *entry = findSetEntry(set->entries, set->capacityMask, value);
+    SetItem *entry = findSetEntry(vm, set->entries, set->capacityMask, value);
     bool isNewKey = IS_EMPTY(entry->value) || entry->deleted;
     entry->value = value;
     entry->deleted = false;
@@ -260,8 +323,8 @@ bool setInsert(DictuVM *vm, ObjSet *set, Value value) {
 bool setDelete(DictuVM *vm, ObjSet *set, Value value) {
     if (set->count == 0) return false;
 
-    SetItem *entry = findSetEntry(set->entries, set->capacityMask, value);
-    if (IS_EMPTY(entry->value)) return false;
+    SetItem *entry = findSetEntry(vm, set->entries, set->capacityMask, value);
+    if (IS_EMPTY(entry->value) || entry->deleted) return false;
 
     // Place a tombstone in the entry.
     set->count--;
@@ -276,6 +339,19 @@ bool setDelete(DictuVM *vm, ObjSet *set, Value value) {
     return true;
 }
 
+// Grows the table up front so that count values can be inserted without a rehash
+void setReserve(DictuVM *vm, ObjSet *set, int count) {
+    int capacity = 8;
+
+    while (count > capacity * TABLE_MAX_LOAD) {
+        capacity *= 2;
+    }
+
+    if (capacity - 1 > set->capacityMask) {
+        adjustSetCapacity(vm, set, capacity - 1);
+    }
+}
+
 void graySet(DictuVM *vm, ObjSet *set) {
     for (int i = 0; i <= set->capacityMask; i++) {
         SetItem *entry = &set->entries[i];
@@ -375,6 +451,9 @@ char *valueTypeToString(DictuVM *vm, Value value, int *length) {
             case OBJ_LIST: {
                 CONVERT(list, 4);
             }
+            case OBJ_TUPLE: {
+                CONVERT(tuple, 5);
+            }
             case OBJ_DICT: {
                 CONVERT(dict, 4);
             }
@@ -390,6 +469,12 @@ char *valueTypeToString(DictuVM *vm, Value value, int *length) {
             case OBJ_RESULT: {
                 CONVERT(result, 6);
             }
+            case OBJ_COROUTINE: {
+                CONVERT(coroutine, 9);
+            }
+            case OBJ_RANGE: {
+                CONVERT(range, 5);
+            }
             default:
                 break;
         }
@@ -412,7 +497,7 @@ void printValueError(Value value) {
     free(output);
 }
 
-static bool listComparison(Value a, Value b) {
+static bool listComparison(DictuVM *vm, Value a, Value b) {
     ObjList *list = AS_LIST(a);
     ObjList *listB = AS_LIST(b);
 
@@ -420,14 +505,14 @@ static bool listComparison(Value a, Value b) {
         return false;
 
     for (int i = 0; i < list->values.count; ++i) {
-        if (!valuesEqual(list->values.values[i], listB->values.values[i]))
+        if (!valuesEqual(vm, list->values.values[i], listB->values.values[i]))
             return false;
     }
 
     return true;
 }
 
-static bool dictComparison(Value a, Value b) {
+static bool dictComparison(DictuVM *vm, Value a, Value b) {
     ObjDict *dict = AS_DICT(a);
     ObjDict *dictB = AS_DICT(b);
 
@@ -448,13 +533,13 @@ static bool dictComparison(Value a, Value b) {
 
         Value value;
         // Check if key from dict A is in dict B
-        if (!dictGet(dictB, item->key, &value)) {
+        if (!dictGet(vm, dictB, item->key, &value)) {
             // Key doesn't exist
             return false;
         }
 
         // Key exists
-        if (!valuesEqual(item->value, value)) {
+        if (!valuesEqual(vm, item->value, value)) {
             // Values don't equal
             return false;
         }
@@ -463,7 +548,7 @@ static bool dictComparison(Value a, Value b) {
     return true;
 }
 
-static bool setComparison(Value a, Value b) {
+static bool setComparison(DictuVM *vm, Value a, Value b) {
     ObjSet *set = AS_SET(a);
     ObjSet *setB = AS_SET(b);
 
@@ -483,7 +568,7 @@ static bool setComparison(Value a, Value b) {
             continue;
 
         // Check if key from dict A is in dict B
-        if (!setGet(setB, item->value)) {
+        if (!setGet(vm, setB, item->value)) {
             // Key doesn't exist
             return false;
         }
@@ -492,21 +577,54 @@ static bool setComparison(Value a, Value b) {
     return true;
 }
 
-bool valuesEqual(Value a, Value b) {
+static bool tupleComparison(DictuVM *vm, Value a, Value b) {
+    ObjTuple *tuple = AS_TUPLE(a);
+    ObjTuple *tupleB = AS_TUPLE(b);
+
+    if (tuple->values.count != tupleB->values.count)
+        return false;
+
+    if (tuple->isHashed && tupleB->isHashed && tuple->hash != tupleB->hash)
+        return false;
+
+    for (int i = 0; i < tuple->values.count; ++i) {
+        if (!valuesEqual(vm, tuple->values.values[i], tupleB->values.values[i]))
+            return false;
+    }
+
+    return true;
+}
+
+bool valuesEqual(DictuVM *vm, Value a, Value b) {
     if (IS_OBJ(a) && IS_OBJ(b)) {
         if (AS_OBJ(a)->type != AS_OBJ(b)->type) return false;
 
         switch (AS_OBJ(a)->type) {
             case OBJ_LIST: {
-                return listComparison(a, b);
+                return listComparison(vm, a, b);
+            }
+
+            case OBJ_TUPLE: {
+                return tupleComparison(vm, a, b);
             }
 
             case OBJ_DICT: {
-                return dictComparison(a, b);
+                return dictComparison(vm, a, b);
             }
 
             case OBJ_SET: {
-                return setComparison(a, b);
+                return setComparison(vm, a, b);
+            }
+
+            case OBJ_INSTANCE: {
+                if (a == b) return true;
+
+                Value method;
+                if (tableGet(&AS_INSTANCE(a)->klass->publicMethods, vm->eqString, &method)) {
+                    return !isFalsey(callInstanceHook(vm, a, method, 1, &b));
+                }
+
+                break;
             }
 
                 // Pass through
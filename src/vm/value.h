@@ -12,6 +12,8 @@ typedef struct sObjSet  ObjSet;
 typedef struct sObjFile ObjFile;
 typedef struct sObjAbstract ObjAbstract;
 typedef struct sObjResult ObjResult;
+typedef struct sObjTuple ObjTuple;
+typedef struct sObjCoroutine ObjCoroutine;
 
 // A mask that selects the sign bit.
 #define SIGN_BIT ((uint64_t)1 << 63)
@@ -77,7 +79,7 @@ typedef struct {
     Value *values;
 } ValueArray;
 
-bool valuesEqual(Value a, Value b);
+bool valuesEqual(DictuVM *vm, Value a, Value b);
 
 void initValueArray(ValueArray *array);
 
@@ -89,18 +91,22 @@ void grayDict(DictuVM *vm, ObjDict *dict);
 
 bool dictSet(DictuVM *vm, ObjDict *dict, Value key, Value value);
 
-bool dictGet(ObjDict *dict, Value key, Value *value);
+bool dictGet(DictuVM *vm, ObjDict *dict, Value key, Value *value);
 
 bool dictDelete(DictuVM *vm, ObjDict *dict, Value key);
 
-bool setGet(ObjSet *set, Value value);
+bool setGet(DictuVM *vm, ObjSet *set, Value value);
 
 bool setInsert(DictuVM *vm, ObjSet *set, Value value);
 
 bool setDelete(DictuVM *vm, ObjSet *set, Value value);
 
+void setReserve(DictuVM *vm, ObjSet *set, int count);
+
 void graySet(DictuVM *vm, ObjSet *set);
 
+uint32_t hashValue(DictuVM *vm, Value value);
+
 char *valueToString(Value value);
 
 char *valueTypeToString(DictuVM *vm, Value value, int *length);
@@ -4,6 +4,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 #include "common.h"
 #include "compiler.h"
 #include "debug.h"
@@ -20,12 +24,16 @@
 #include "datatypes/lists/lists.h"
 #include "datatypes/dicts/dicts.h"
 #include "datatypes/sets.h"
+#include "datatypes/tuples.h"
+#include "datatypes/coroutines.h"
+#include "datatypes/ranges.h"
 #include "datatypes/files.h"
 #include "datatypes/class.h"
 #include "datatypes/instance.h"
 #include "datatypes/result/result.h"
 #include "datatypes/enums.h"
 #include "natives.h"
+#include "image.h"
 #include "../optionals/optionals.h"
 #include "value.h"
 
@@ -36,6 +44,125 @@ static void resetStack(DictuVM *vm) {
     vm->compiler = NULL;
 }
 
+static void closeUpvalues(DictuVM *vm, Value *last) {
+    while (vm->openUpvalues != NULL &&
+           vm->openUpvalues->value >= last) {
+        ObjUpvalue *upvalue = vm->openUpvalues;
+
+        // Move the value into the upvalue itself and point the upvalue to
+        // it.
+        upvalue->closed = *upvalue->value;
+        upvalue->value = &upvalue->closed;
+
+        // Pop it off the open upvalue list.
+        vm->openUpvalues = upvalue->next;
+    }
+}
+
+// Exchanges the VM's execution state with the one held by [coroutine].
+// Resuming swaps the coroutine's own state in and keeps the resumer's,
+// yielding or returning swaps them back again.
+static void swapCoroutineState(DictuVM *vm, ObjCoroutine *coroutine) {
+    Value *stackTop = vm->stackTop;
+    CallFrame *frames = vm->frames;
+    int frameCount = vm->frameCount;
+    int frameCapacity = vm->frameCapacity;
+    ObjUpvalue *openUpvalues = vm->openUpvalues;
+
+    vm->stackTop = coroutine->stackTop;
+    vm->frames = coroutine->frames;
+    vm->frameCount = coroutine->frameCount;
+    vm->frameCapacity = coroutine->frameCapacity;
+    vm->openUpvalues = coroutine->openUpvalues;
+
+    coroutine->stackTop = stackTop;
+    coroutine->frames = frames;
+    coroutine->frameCount = frameCount;
+    coroutine->frameCapacity = frameCapacity;
+    coroutine->openUpvalues = openUpvalues;
+}
+
+static void enterCoroutine(DictuVM *vm, ObjCoroutine *coroutine) {
+    swapCoroutineState(vm, coroutine);
+    coroutine->caller = vm->coroutine;
+    coroutine->state = COROUTINE_RUNNING;
+    vm->coroutine = coroutine;
+}
+
+static void leaveCoroutine(DictuVM *vm, CoroutineState state) {
+    ObjCoroutine *coroutine = vm->coroutine;
+
+    swapCoroutineState(vm, coroutine);
+    vm->coroutine = coroutine->caller;
+    coroutine->caller = NULL;
+    coroutine->state = state;
+
+    if (state == COROUTINE_DONE) {
+        // A finished coroutine can never run again so its stack can go now
+        FREE_ARRAY(vm, Value, coroutine->stack, coroutine->stackCapacity);
+        FREE_ARRAY(vm, CallFrame, coroutine->frames, coroutine->frameCapacity);
+        coroutine->stack = NULL;
+        coroutine->stackTop = NULL;
+        coroutine->stackCapacity = 0;
+        coroutine->frames = NULL;
+        coroutine->frameCount = 0;
+        coroutine->frameCapacity = 0;
+    }
+}
+
+// Makes sure the running coroutine has room for [count] more values,
+// growing its stack if not. The main stack is fixed at STACK_MAX.
+static bool reserveStack(DictuVM *vm, int count) {
+    ObjCoroutine *coroutine = vm->coroutine;
+
+    if (coroutine == NULL || vm->stackTop + count <= coroutine->stack + coroutine->stackCapacity) {
+        return true;
+    }
+
+    int used = vm->stackTop - coroutine->stack;
+    int capacity = coroutine->stackCapacity;
+
+    while (capacity < used + count) {
+        capacity = GROW_CAPACITY(capacity);
+    }
+
+    if (capacity > STACK_MAX) {
+        capacity = STACK_MAX;
+    }
+
+    // Natives keep pointers into the stack while they call back into the VM,
+    // so the stack can't be moved from under them
+    bool canMove = used + count <= capacity;
+
+    for (int i = 0; canMove && i < vm->frameCount; i++) {
+        if (vm->frames[i].closure == NULL) {
+            canMove = false;
+        }
+    }
+
+    if (!canMove) {
+        runtimeError(vm, "Coroutine stack overflow.");
+        return false;
+    }
+
+    Value *oldStack = coroutine->stack;
+    coroutine->stack = GROW_ARRAY(vm, coroutine->stack, Value, coroutine->stackCapacity, capacity);
+    coroutine->stackCapacity = capacity;
+
+    // Point everything that refers to a stack slot at the new allocation
+    vm->stackTop = coroutine->stack + used;
+
+    for (int i = 0; i < vm->frameCount; i++) {
+        vm->frames[i].slots = coroutine->stack + (vm->frames[i].slots - oldStack);
+    }
+
+    for (ObjUpvalue *upvalue = vm->openUpvalues; upvalue != NULL; upvalue = upvalue->next) {
+        upvalue->value = coroutine->stack + (upvalue->value - oldStack);
+    }
+
+    return true;
+}
+
 #define HANDLE_UNPACK                                                               \
     if (unpack) {                                                                   \
         if (!IS_LIST(peek(vm, 0))) {                                                \
@@ -43,6 +170,10 @@ static void resetStack(DictuVM *vm) {
             return false;                                                           \
         }                                                                           \
                                                                                     \
+        if (!reserveStack(vm, AS_LIST(peek(vm, 0))->values.count)) {               \
+            return false;                                                           \
+        }                                                                           \
+                                                                                    \
         ObjList *list = AS_LIST(pop(vm));                                     \
                                                                                     \
         for (int i = 0; i < list->values.count; ++i) {                              \
@@ -56,39 +187,58 @@ static void resetStack(DictuVM *vm) {
 #define INSTANCE_HAS_NO_ATTR_ERR RUNTIME_ERROR("'%s' instance has no attribute: '%s'.", instance->klass->name->chars, name->chars)
 
 void runtimeError(DictuVM *vm, const char *format, ...) {
-    for (int i = vm->frameCount - 1; i >= 0; i--) {
-        CallFrame *frame = &vm->frames[i];
+    for (;;) {
+        for (int i = vm->frameCount - 1; i >= 0; i--) {
+            CallFrame *frame = &vm->frames[i];
+
+            if(frame->closure == NULL) {
+                // synthetic frame created by callFunction
+                continue;
+            } 
+            ObjFunction *function = frame->closure->function;
+
+            // -1 because the IP is sitting on the next instruction to be
+            // executed.
+            size_t instruction = frame->ip - function->chunk.code - 1;
+
+            if (function->name == NULL) {
+                log_error("File '%s', {bold}line %d{reset}", function->module->name->chars, function->chunk.lines[instruction]);
+                i = -1;
+            } else {
+                log_error("Function '%s' in '%s', {bold}line %d{reset}", function->name->chars, function->module->name->chars, function->chunk.lines[instruction]);
+            }
 
-        if(frame->closure == NULL) {
-            // synthetic frame created by callFunction
-            continue;
-        } 
-        ObjFunction *function = frame->closure->function;
+            log_pad("");
 
-        // -1 because the IP is sitting on the next instruction to be
-        // executed.
-        size_t instruction = frame->ip - function->chunk.code - 1;
+            va_list args;
+            va_start(args, format);
+            vfprintf(stderr, format, args);
+            fputs("\n\n", stderr);
+            va_end(args);
+        }
 
-        if (function->name == NULL) {
-            log_error("File '%s', {bold}line %d{reset}", function->module->name->chars, function->chunk.lines[instruction]);
-            i = -1;
-        } else {
-            log_error("Function '%s' in '%s', {bold}line %d{reset}", function->name->chars, function->module->name->chars, function->chunk.lines[instruction]);
+        if (vm->coroutine == NULL) {
+            break;
         }
 
-        log_pad("");
+        // The error also ends every coroutine between here and the main stack
+        closeUpvalues(vm, vm->coroutine->stack);
+        leaveCoroutine(vm, COROUTINE_DONE);
+    }
 
-        va_list args;
-        va_start(args, format);
-        vfprintf(stderr, format, args);
-        fputs("\n\n", stderr);
-        va_end(args);
+    // A native which called into the VM through tryCallFunction carries on from
+    // its own frame, so close anything the failed call captured above it
+    for (int i = vm->frameCount - 1; i >= 0; i--) {
+        if (vm->frames[i].closure == NULL) {
+            closeUpvalues(vm, vm->frames[i].slots);
+            break;
+        }
     }
 
     resetStack(vm);
 }
 
-DictuVM *dictuInitVM(bool repl, int argc, char **argv) {
+static DictuVM *newVM(bool repl, int argc, char **argv) {
     DictuVM *vm = malloc(sizeof(*vm));
 
     if (vm == NULL) {
@@ -111,6 +261,7 @@ DictuVM *dictuInitVM(bool repl, int argc, char **argv) {
     vm->grayCapacity = 0;
     vm->grayStack = NULL;
     vm->lastModule = NULL;
+    vm->shared = NULL;
     vm->argc = argc;
     vm->argv = argv;
     initTable(&vm->modules);
@@ -125,6 +276,9 @@ DictuVM *dictuInitVM(bool repl, int argc, char **argv) {
     initTable(&vm->listMethods);
     initTable(&vm->dictMethods);
     initTable(&vm->setMethods);
+    initTable(&vm->tupleMethods);
+    initTable(&vm->coroutineMethods);
+    initTable(&vm->rangeMethods);
     initTable(&vm->fileMethods);
     initTable(&vm->classMethods);
     initTable(&vm->instanceMethods);
@@ -132,8 +286,78 @@ DictuVM *dictuInitVM(bool repl, int argc, char **argv) {
     initTable(&vm->enumMethods);
 
     vm->frames = ALLOCATE(vm, CallFrame, vm->frameCapacity);
+
+    return vm;
+}
+
+static void initVMStrings(DictuVM *vm) {
     vm->initString = copyString(vm, "init", 4);
     vm->annotationString = copyString(vm, "__annotationName", 16);
+    vm->hashString = copyString(vm, "__hash__", 8);
+    vm->eqString = copyString(vm, "__eq__", 6);
+    vm->iterString = copyString(vm, "__iter__", 8);
+}
+
+static void freeVM(DictuVM *vm) {
+    freeTable(vm, &vm->modules);
+    freeTable(vm, &vm->constants);
+    freeTable(vm, &vm->strings);
+
+    // Borrowed tables belong to the shared heap
+    if (vm->shared == NULL || vm->repl) {
+        freeTable(vm, &vm->globals);
+    }
+
+    if (vm->shared == NULL) {
+        freeTable(vm, &vm->numberMethods);
+        freeTable(vm, &vm->boolMethods);
+        freeTable(vm, &vm->nilMethods);
+        freeTable(vm, &vm->stringMethods);
+        freeTable(vm, &vm->listMethods);
+        freeTable(vm, &vm->dictMethods);
+        freeTable(vm, &vm->setMethods);
+        freeTable(vm, &vm->tupleMethods);
+        freeTable(vm, &vm->coroutineMethods);
+        freeTable(vm, &vm->rangeMethods);
+        freeTable(vm, &vm->fileMethods);
+        freeTable(vm, &vm->classMethods);
+        freeTable(vm, &vm->instanceMethods);
+        freeTable(vm, &vm->resultMethods);
+        freeTable(vm, &vm->enumMethods);
+    }
+
+    FREE_ARRAY(vm, CallFrame, vm->frames, vm->frameCapacity);
+    vm->initString = NULL;
+    vm->annotationString = NULL;
+    vm->hashString = NULL;
+    vm->eqString = NULL;
+    vm->iterString = NULL;
+    vm->replVar = NULL;
+    freeObjects(vm);
+}
+
+/**
+ * The builtins, the native functions, the methods of every type and the
+ * parts of List, Dict and Result written in Dictu, are built once into a
+ * frozen heap that every VM in the process borrows rather than building its
+ * own copy. Nothing in it is ever written to again, so VMs on different
+ * threads can read it without any locking, and as every object in it is
+ * permanently marked a VM's collector never traverses or frees any of it.
+ *
+ * The heap lives for as long as any VM refers to it. It can also be
+ * written to an image along with some builtin modules, which later runs
+ * map straight back in rather than building it again.
+ */
+#ifndef _WIN32
+static pthread_mutex_t sharedHeapLock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+static DictuVM *sharedHeap = NULL;
+static int sharedHeapReferences = 0;
+
+static bool sharedHeapFromImage = false;
+
+static void buildSharedHeap(DictuVM *vm) {
+    initVMStrings(vm);
 
     // Native functions
     defineAllNatives(vm);
@@ -146,11 +370,180 @@ DictuVM *dictuInitVM(bool repl, int argc, char **argv) {
     declareListMethods(vm);
     declareDictMethods(vm);
     declareSetMethods(vm);
+    declareTupleMethods(vm);
+    declareCoroutineMethods(vm);
+    declareRangeMethods(vm);
     declareFileMethods(vm);
     declareClassMethods(vm);
     declareInstanceMethods(vm);
     declareResultMethods(vm);
     declareEnumMethods(vm);
+}
+
+static void freezeSharedHeap(DictuVM *vm) {
+    // Anything left over from building it would otherwise live forever
+    collectGarbage(vm);
+
+    for (Obj *object = vm->objects; object != NULL; object = object->next) {
+        object->isDark = true;
+    }
+}
+
+static void freeSharedHeap(DictuVM *vm) {
+    if (sharedHeapFromImage) {
+        freeImage(vm);
+        return;
+    }
+
+    freeVM(vm);
+    free(vm);
+}
+
+static DictuVM *acquireSharedHeap(void) {
+#ifndef _WIN32
+    pthread_mutex_lock(&sharedHeapLock);
+#endif
+
+    if (sharedHeap == NULL) {
+        sharedHeap = newVM(false, 0, NULL);
+        sharedHeapFromImage = false;
+        buildSharedHeap(sharedHeap);
+        freezeSharedHeap(sharedHeap);
+    }
+
+    sharedHeapReferences++;
+    DictuVM *heap = sharedHeap;
+
+#ifndef _WIN32
+    pthread_mutex_unlock(&sharedHeapLock);
+#endif
+
+    return heap;
+}
+
+static void releaseSharedHeap(void) {
+#ifndef _WIN32
+    pthread_mutex_lock(&sharedHeapLock);
+#endif
+
+    if (--sharedHeapReferences == 0) {
+        freeSharedHeap(sharedHeap);
+        sharedHeap = NULL;
+    }
+
+#ifndef _WIN32
+    pthread_mutex_unlock(&sharedHeapLock);
+#endif
+}
+
+// Imported modules are only shared when nothing in them can change
+static bool preloadModule(DictuVM *vm, const char *name) {
+    bool dictuSource = false;
+    int index = findBuiltinModule((char *) name, strlen(name), &dictuSource);
+
+    if (dictuSource) {
+        fprintf(stderr, "Could not preload \"%s\": Module is written in Dictu\n", name);
+        return false;
+    }
+
+    Value module = index == -1 ? EMPTY_VAL : importBuiltinModule(vm, index);
+
+    // Names are matched by prefix when looking them up
+    if (IS_EMPTY(module) || strcmp(AS_MODULE(module)->name->chars, name) != 0) {
+        fprintf(stderr, "Could not preload \"%s\": Unknown module\n", name);
+        return false;
+    }
+
+    Table *values = &AS_MODULE(module)->values;
+
+    for (int i = 0; i < values->capacity; i++) {
+        Value value = values->entries[i].value;
+
+        if (values->entries[i].key != NULL && IS_OBJ(value) && !IS_NATIVE(value) && !IS_STRING(value)) {
+            fprintf(stderr, "Could not preload \"%s\": Module holds values that can not be shared\n", name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool dictuWriteImage(const char *path, char **preload, int preloadCount) {
+    DictuVM *heap = newVM(false, 0, NULL);
+    bool written = true;
+
+    buildSharedHeap(heap);
+
+    for (int i = 0; i < preloadCount && written; i++) {
+        written = preloadModule(heap, preload[i]);
+    }
+
+    if (written) {
+        freezeSharedHeap(heap);
+        written = writeImage(heap, path);
+    }
+
+    freeVM(heap);
+    free(heap);
+
+    return written;
+}
+
+bool dictuLoadImage(const char *path) {
+#ifndef _WIN32
+    pthread_mutex_lock(&sharedHeapLock);
+#endif
+
+    DictuVM *heap = NULL;
+
+    if (sharedHeap != NULL) {
+        fprintf(stderr, "Could not load image \"%s\": Builtins have already been created\n", path);
+    } else {
+        heap = loadImage(path);
+    }
+
+    if (heap != NULL) {
+        sharedHeap = heap;
+        sharedHeapFromImage = true;
+    }
+
+#ifndef _WIN32
+    pthread_mutex_unlock(&sharedHeapLock);
+#endif
+
+    return heap != NULL;
+}
+
+DictuVM *dictuInitVM(bool repl, int argc, char **argv) {
+    DictuVM *vm = newVM(repl, argc, argv);
+    DictuVM *shared = acquireSharedHeap();
+
+    vm->shared = shared;
+    vm->numberMethods = shared->numberMethods;
+    vm->boolMethods = shared->boolMethods;
+    vm->nilMethods = shared->nilMethods;
+    vm->stringMethods = shared->stringMethods;
+    vm->listMethods = shared->listMethods;
+    vm->dictMethods = shared->dictMethods;
+    vm->setMethods = shared->setMethods;
+    vm->tupleMethods = shared->tupleMethods;
+    vm->coroutineMethods = shared->coroutineMethods;
+    vm->rangeMethods = shared->rangeMethods;
+    vm->fileMethods = shared->fileMethods;
+    vm->classMethods = shared->classMethods;
+    vm->instanceMethods = shared->instanceMethods;
+    vm->resultMethods = shared->resultMethods;
+    vm->enumMethods = shared->enumMethods;
+
+    // The REPL defines _ as a global so needs a table of its own
+    if (vm->repl) {
+        tableAddAll(vm, &shared->globals, &vm->globals);
+    } else {
+        vm->globals = shared->globals;
+    }
+
+    // These resolve to the strings interned in the shared heap
+    initVMStrings(vm);
 
     if (vm->repl) {
         vm->replVar = copyString(vm, "_", 1);
@@ -160,30 +553,7 @@ DictuVM *dictuInitVM(bool repl, int argc, char **argv) {
 }
 
 void dictuFreeVM(DictuVM *vm) {
-    if (vm->repl) {
-        freeTable(vm, &vm->constants);
-    }
-
-    freeTable(vm, &vm->modules);
-    freeTable(vm, &vm->globals);
-    freeTable(vm, &vm->constants);
-    freeTable(vm, &vm->strings);
-    freeTable(vm, &vm->numberMethods);
-    freeTable(vm, &vm->boolMethods);
-    freeTable(vm, &vm->nilMethods);
-    freeTable(vm, &vm->stringMethods);
-    freeTable(vm, &vm->listMethods);
-    freeTable(vm, &vm->dictMethods);
-    freeTable(vm, &vm->setMethods);
-    freeTable(vm, &vm->fileMethods);
-    freeTable(vm, &vm->classMethods);
-    freeTable(vm, &vm->instanceMethods);
-    freeTable(vm, &vm->resultMethods);
-    freeTable(vm, &vm->enumMethods);
-    FREE_ARRAY(vm, CallFrame, vm->frames, vm->frameCapacity);
-    vm->initString = NULL;
-    vm->replVar = NULL;
-    freeObjects(vm);
+    freeVM(vm);
 
 #if defined(DEBUG_TRACE_MEM) || defined(DEBUG_FINAL_MEM)
 #ifdef __MINGW32__
@@ -194,6 +564,7 @@ void dictuFreeVM(DictuVM *vm) {
 #endif
 
     free(vm);
+    releaseSharedHeap();
 }
 
 void push(DictuVM *vm, Value value) {
@@ -227,6 +598,27 @@ ObjClosure *compileModuleToClosure(DictuVM *vm, char *name, char *source) {
     return closure;
 }
 
+// Calling a function that yields doesn't run it. The callee and its
+// arguments are moved to the stack of a new coroutine, which is returned
+// in their place and runs the function once resumed.
+static bool newCoroutineCall(DictuVM *vm, ObjClosure *closure, int argCount) {
+    int slotCount = argCount + 1;
+    ObjCoroutine *coroutine = newCoroutine(vm, slotCount + UINT8_COUNT * 2);
+
+    memcpy(coroutine->stack, vm->stackTop - slotCount, sizeof(Value) * slotCount);
+    coroutine->stackTop = coroutine->stack + slotCount;
+
+    CallFrame *frame = &coroutine->frames[coroutine->frameCount++];
+    frame->closure = closure;
+    frame->ip = closure->function->chunk.code;
+    frame->slots = coroutine->stack;
+
+    vm->stackTop -= slotCount;
+    push(vm, OBJ_VAL(coroutine));
+
+    return true;
+}
+
 static bool call(DictuVM *vm, ObjClosure *closure, int argCount) {
     if (argCount < closure->function->arity) {
         if ((argCount + closure->function->isVariadic) == closure->function->arity) {
@@ -272,6 +664,15 @@ static bool call(DictuVM *vm, ObjClosure *closure, int argCount) {
         vm->stackTop -= 2;
         push(vm, OBJ_VAL(list));
     }
+
+    if (closure->function->isCoroutine) {
+        return newCoroutineCall(vm, closure, argCount);
+    }
+
+    if (!reserveStack(vm, UINT8_COUNT)) {
+        return false;
+    }
+
     if (vm->frameCount == vm->frameCapacity) {
         int oldCapacity = vm->frameCapacity;
         vm->frameCapacity = GROW_CAPACITY(vm->frameCapacity);
@@ -629,6 +1030,36 @@ static bool invoke(DictuVM *vm, ObjString *name, int argCount, bool unpack) {
                 return false;
             }
 
+            case OBJ_TUPLE: {
+                Value value;
+                if (tableGet(&vm->tupleMethods, name, &value)) {
+                    return callNativeMethod(vm, value, argCount);
+                }
+
+                runtimeError(vm, "Tuple has no method %s().", name->chars);
+                return false;
+            }
+
+            case OBJ_COROUTINE: {
+                Value value;
+                if (tableGet(&vm->coroutineMethods, name, &value)) {
+                    return callNativeMethod(vm, value, argCount);
+                }
+
+                runtimeError(vm, "Coroutine has no method %s().", name->chars);
+                return false;
+            }
+
+            case OBJ_RANGE: {
+                Value value;
+                if (tableGet(&vm->rangeMethods, name, &value)) {
+                    return callNativeMethod(vm, value, argCount);
+                }
+
+                runtimeError(vm, "Range has no method %s().", name->chars);
+                return false;
+            }
+
             case OBJ_FILE: {
                 Value value;
                 if (tableGet(&vm->fileMethods, name, &value)) {
@@ -761,21 +1192,6 @@ static ObjUpvalue *captureUpvalue(DictuVM *vm, Value *local) {
     return createdUpvalue;
 }
 
-static void closeUpvalues(DictuVM *vm, Value *last) {
-    while (vm->openUpvalues != NULL &&
-           vm->openUpvalues->value >= last) {
-        ObjUpvalue *upvalue = vm->openUpvalues;
-
-        // Move the value into the upvalue itself and point the upvalue to
-        // it.
-        upvalue->closed = *upvalue->value;
-        upvalue->value = &upvalue->closed;
-
-        // Pop it off the open upvalue list.
-        vm->openUpvalues = upvalue->next;
-    }
-}
-
 static void defineMethod(DictuVM *vm, ObjString *name) {
     Value method = peek(vm, 0);
     ObjClass *klass = AS_CLASS(peek(vm, 1));
@@ -826,6 +1242,7 @@ bool isFalsey(Value value) {
            (IS_NUMBER(value) && AS_NUMBER(value) == 0) ||
            (IS_STRING(value) && AS_CSTRING(value)[0] == '\0') ||
            (IS_LIST(value) && AS_LIST(value)->values.count == 0) ||
+           (IS_TUPLE(value) && AS_TUPLE(value)->values.count == 0) ||
            (IS_DICT(value) && AS_DICT(value)->count == 0) ||
            (IS_RESULT(value) && AS_RESULT(value)->status == ERR) ||
            (IS_SET(value) && AS_SET(value)->count == 0);
@@ -862,7 +1279,7 @@ static void copyAnnotations(DictuVM *vm, ObjDict *superAnnotations, ObjDict *kla
         }
 
         Value value;
-        if (dictGet(klassAnnotations, item->key, &value)) {
+        if (dictGet(vm, klassAnnotations, item->key, &value)) {
             continue;
         }
 
@@ -875,6 +1292,8 @@ static void copyAnnotations(DictuVM *vm, ObjDict *superAnnotations, ObjDict *kla
 
 static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
     CallFrame *frame = &vm->frames[vm->frameCount - 1];
+    // Frame counts are per coroutine, only break on the one we started in
+    ObjCoroutine *breakCoroutine = vm->coroutine;
     register uint8_t* ip = frame->ip;
 
     #define READ_BYTE() (*ip++)
@@ -1502,9 +1921,27 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
         }
 
         CASE_CODE(EQUAL): {
-            Value b = pop(vm);
-            Value a = pop(vm);
-            push(vm, BOOL_VAL(valuesEqual(a, b)));
+            if (IS_INSTANCE(peek(vm, 1))) {
+                Value method;
+
+                // a == b is dispatched to a.__eq__(b) when the class defines it
+                if (tableGet(&AS_INSTANCE(peek(vm, 1))->klass->publicMethods, vm->eqString, &method)) {
+                    frame->ip = ip;
+                    if (!call(vm, AS_CLOSURE(method), 1)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+                    frame = &vm->frames[vm->frameCount - 1];
+                    ip = frame->ip;
+                    DISPATCH();
+                }
+            }
+
+            // Operands stay on the stack as nested __eq__ hooks may trigger a GC
+            STORE_FRAME;
+            bool equal = valuesEqual(vm, peek(vm, 1), peek(vm, 0));
+            frame = &vm->frames[vm->frameCount - 1];
+            vm->stackTop -= 2;
+            push(vm, BOOL_VAL(equal));
             DISPATCH();
         }
 
@@ -1626,8 +2063,12 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
             int count = READ_BYTE();
             Value switchValue = peek(vm, count + 1);
             Value caseValue = pop(vm);
+            STORE_FRAME;
             for (int i = 0; i < count; ++i) {
-                if (valuesEqual(switchValue, caseValue)) {
+                bool equal = valuesEqual(vm, switchValue, caseValue);
+                frame = &vm->frames[vm->frameCount - 1];
+
+                if (equal) {
                     i++;
                     while(i <= count) {
                         pop(vm);
@@ -1643,8 +2084,12 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
 
         CASE_CODE(COMPARE_JUMP):{
             uint16_t offset = READ_SHORT();
-            Value a = pop(vm);
-            if (!valuesEqual(peek(vm,0), a)) {
+            STORE_FRAME;
+            bool equal = valuesEqual(vm, peek(vm, 1), peek(vm, 0));
+            frame = &vm->frames[vm->frameCount - 1];
+            pop(vm);
+
+            if (!equal) {
                 ip += offset;
             } else {
                 // switch expression.
@@ -1741,6 +2186,14 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
                 DISPATCH();
             }
 
+            // Preloaded into the shared heap by an image
+            if (vm->shared != NULL && tableGet(&vm->shared->modules, fileName, &moduleVal)) {
+                tableSet(vm, &vm->modules, fileName, moduleVal);
+                vm->lastModule = AS_MODULE(moduleVal);
+                push(vm, moduleVal);
+                DISPATCH();
+            }
+
             Value module = importBuiltinModule(vm, index);
 
             if (IS_EMPTY(module)) {
@@ -1860,11 +2313,14 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
             push(vm, OBJ_VAL(dict));
 
             for (int i = count * 2; i > 0; i -= 2) {
-                if (!isValidKey(peek(vm, i))) {
-                    RUNTIME_ERROR("Dictionary key must be an immutable type.");
+                if (!isValidKey(vm, peek(vm, i))) {
+                    RUNTIME_ERROR("Dictionary key must be a hashable type.");
                 }
 
+                STORE_FRAME;
                 dictSet(vm, dict, peek(vm, i), peek(vm, i - 1));
+                // Hashing an instance key may have called back into the VM
+                frame = &vm->frames[vm->frameCount - 1];
             }
 
             vm->stackTop -= count * 2 + 1;
@@ -1904,6 +2360,28 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
                     RUNTIME_ERROR("List index out of bounds.");
                 }
 
+                case OBJ_TUPLE: {
+                    if (!IS_NUMBER(indexValue)) {
+                        RUNTIME_ERROR("Tuple index must be a number.");
+                    }
+
+                    ObjTuple *tuple = AS_TUPLE(subscriptValue);
+                    int index = AS_NUMBER(indexValue);
+
+                    // Allow negative indexes
+                    if (index < 0)
+                        index = tuple->values.count + index;
+
+                    if (index >= 0 && index < tuple->values.count) {
+                        pop(vm);
+                        pop(vm);
+                        push(vm, tuple->values.values[index]);
+                        DISPATCH();
+                    }
+
+                    RUNTIME_ERROR("Tuple index out of bounds.");
+                }
+
                 case OBJ_STRING: {
                     ObjString *string = AS_STRING(subscriptValue);
                     int len = string->character_len == -1 ? string->length : string->character_len;
@@ -1937,14 +2415,18 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
 
                 case OBJ_DICT: {
                     ObjDict *dict = AS_DICT(subscriptValue);
-                    if (!isValidKey(indexValue)) {
-                        RUNTIME_ERROR("Dictionary key must be an immutable type.");
+                    if (!isValidKey(vm, indexValue)) {
+                        RUNTIME_ERROR("Dictionary key must be a hashable type.");
                     }
 
                     Value v;
-                    pop(vm);
-                    pop(vm);
-                    if (dictGet(dict, indexValue, &v)) {
+                    STORE_FRAME;
+                    bool found = dictGet(vm, dict, indexValue, &v);
+                    frame = &vm->frames[vm->frameCount - 1];
+
+                    if (found) {
+                        pop(vm);
+                        pop(vm);
                         push(vm, v);
                         DISPATCH();
                     }
@@ -1980,6 +2462,7 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
                         index = list->values.count + index;
 
                     if (index >= 0 && index < list->values.count) {
+                        makeListWritable(vm, list);
                         list->values.values[index] = assignValue;
                         pop(vm);
                         pop(vm);
@@ -1993,11 +2476,13 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
 
                 case OBJ_DICT: {
                     ObjDict *dict = AS_DICT(subscriptValue);
-                    if (!isValidKey(indexValue)) {
-                        RUNTIME_ERROR("Dictionary key must be an immutable type.");
+                    if (!isValidKey(vm, indexValue)) {
+                        RUNTIME_ERROR("Dictionary key must be a hashable type.");
                     }
 
+                    STORE_FRAME;
                     dictSet(vm, dict, indexValue, assignValue);
+                    frame = &vm->frames[vm->frameCount - 1];
                     pop(vm);
                     pop(vm);
                     pop(vm);
@@ -2044,12 +2529,16 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
 
                 case OBJ_DICT: {
                     ObjDict *dict = AS_DICT(subscriptValue);
-                    if (!isValidKey(indexValue)) {
-                        RUNTIME_ERROR("Dictionary key must be an immutable type.");
+                    if (!isValidKey(vm, indexValue)) {
+                        RUNTIME_ERROR("Dictionary key must be a hashable type.");
                     }
 
                     Value dictValue;
-                    if (!dictGet(dict, indexValue, &dictValue)) {
+                    STORE_FRAME;
+                    bool found = dictGet(vm, dict, indexValue, &dictValue);
+                    frame = &vm->frames[vm->frameCount - 1];
+
+                    if (!found) {
                         RUNTIME_ERROR("Key %s does not exist within dictionary.", valueToString(indexValue));
                     }
 
@@ -2072,7 +2561,7 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
             Value objectValue = peek(vm, 2);
 
             if (!IS_OBJ(objectValue)) {
-                RUNTIME_ERROR("Can only slice on lists and strings.");
+                RUNTIME_ERROR("Can only slice on lists, tuples and strings.");
             }
 
             if ((!IS_NUMBER(sliceStartIndex) && !IS_EMPTY(sliceStartIndex)) || (!IS_NUMBER(sliceEndIndex) && !IS_EMPTY(sliceEndIndex))) {
@@ -2095,8 +2584,6 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
 
             switch (getObjType(objectValue)) {
                 case OBJ_LIST: {
-                    ObjList *createdList = newList(vm);
-                    push(vm, OBJ_VAL(createdList));
                     ObjList *list = AS_LIST(objectValue);
 
                     if (IS_EMPTY(sliceEndIndex)) {
@@ -2111,12 +2598,35 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
                         }
                     }
 
+                    // The slice shares the list's backing store until either is written to
+                    returnVal = OBJ_VAL(shareList(vm, list, indexStart, indexEnd));
+
+                    break;
+                }
+
+                case OBJ_TUPLE: {
+                    ObjTuple *createdTuple = newTuple(vm);
+                    push(vm, OBJ_VAL(createdTuple));
+                    ObjTuple *tuple = AS_TUPLE(objectValue);
+
+                    if (IS_EMPTY(sliceEndIndex)) {
+                        indexEnd = tuple->values.count;
+                    } else {
+                        indexEnd = AS_NUMBER(sliceEndIndex);
+
+                        if (indexEnd > tuple->values.count) {
+                            indexEnd = tuple->values.count;
+                        } else if (indexEnd < 0) {
+                            indexEnd = tuple->values.count + indexEnd;
+                        }
+                    }
+
                     for (int i = indexStart; i < indexEnd; i++) {
-                        writeValueArray(vm, &createdList->values, list->values.values[i]);
+                        writeValueArray(vm, &createdTuple->values, tuple->values.values[i]);
                     }
 
                     pop(vm);
-                    returnVal = OBJ_VAL(createdList);
+                    returnVal = OBJ_VAL(createdTuple);
 
                     break;
                 }
@@ -2268,8 +2778,18 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
             vm->frameCount--;
 
             if (vm->frameCount == 0) {
-                pop(vm);
-                return INTERPRET_OK;
+                if (vm->coroutine == NULL) {
+                    pop(vm);
+                    return INTERPRET_OK;
+                }
+
+                // The coroutine has finished, its result goes to the resumer
+                leaveCoroutine(vm, COROUTINE_DONE);
+                push(vm, result);
+
+                frame = &vm->frames[vm->frameCount - 1];
+                ip = frame->ip;
+                DISPATCH();
             }
 
             vm->stackTop = frame->slots;
@@ -2277,13 +2797,252 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
 
             frame = &vm->frames[vm->frameCount - 1];
             ip = frame->ip;
-            if (breakFrame != -1 && vm->frameCount == breakFrame) {
+            if (breakFrame != -1 && vm->frameCount == breakFrame && vm->coroutine == breakCoroutine) {
                 return INTERPRET_OK;
             }
 
             DISPATCH();
         }
 
+        CASE_CODE(YIELD): {
+            if (vm->coroutine == NULL) {
+                RUNTIME_ERROR("Can only yield from inside a coroutine.");
+            }
+
+            Value value = pop(vm);
+
+            STORE_FRAME;
+            leaveCoroutine(vm, COROUTINE_SUSPENDED);
+            push(vm, value);
+
+            frame = &vm->frames[vm->frameCount - 1];
+            ip = frame->ip;
+            DISPATCH();
+        }
+
+        CASE_CODE(RESUME): {
+            if (!IS_COROUTINE(peek(vm, 1))) {
+                RUNTIME_ERROR_TYPE("Can only resume a coroutine, got '%s'.", 1);
+            }
+
+            ObjCoroutine *coroutine = AS_COROUTINE(peek(vm, 1));
+
+            if (coroutine->state == COROUTINE_RUNNING) {
+                RUNTIME_ERROR("Cannot resume a running coroutine.");
+            }
+
+            if (coroutine->state == COROUTINE_DONE) {
+                RUNTIME_ERROR("Cannot resume a finished coroutine.");
+            }
+
+            Value value = pop(vm);
+            pop(vm);
+
+            STORE_FRAME;
+            bool started = coroutine->state == COROUTINE_SUSPENDED;
+            enterCoroutine(vm, coroutine);
+
+            // The value becomes the result of the yield it is paused on,
+            // a coroutine that hasn't started yet has nowhere to put it
+            if (started) {
+                push(vm, value);
+            }
+
+            frame = &vm->frames[vm->frameCount - 1];
+            ip = frame->ip;
+            DISPATCH();
+        }
+
+        CASE_CODE(GET_ITER): {
+            // Instances are iterated through whatever their __iter__ returns
+            if (IS_INSTANCE(peek(vm, 0))) {
+                Value method;
+                if (tableGet(&AS_INSTANCE(peek(vm, 0))->klass->publicMethods, vm->iterString, &method)) {
+                    STORE_FRAME;
+                    if (!call(vm, AS_CLOSURE(method), 0)) {
+                        return INTERPRET_RUNTIME_ERROR;
+                    }
+
+                    frame = &vm->frames[vm->frameCount - 1];
+                    ip = frame->ip;
+                }
+            }
+
+            DISPATCH();
+        }
+
+        CASE_CODE(FOR_ITER): {
+            uint8_t slot = READ_BYTE();
+            uint16_t offset = READ_SHORT();
+
+            // The cursor is a plain number updated in place, so stepping
+            // through the builtin iterables never allocates
+            Value iterable = frame->slots[slot];
+            Value *cursor = &frame->slots[slot + 1];
+
+            if (!IS_OBJ(iterable)) {
+                RUNTIME_ERROR_TYPE("'%s' is not iterable.", 1);
+            }
+
+            switch (OBJ_TYPE(iterable)) {
+                case OBJ_LIST:
+                case OBJ_TUPLE: {
+                    ValueArray *values = IS_LIST(iterable) ? &AS_LIST(iterable)->values : &AS_TUPLE(iterable)->values;
+                    int index = AS_NUMBER(*cursor);
+
+                    if (index >= values->count) {
+                        break;
+                    }
+
+                    *cursor = NUMBER_VAL(index + 1);
+                    push(vm, values->values[index]);
+                    DISPATCH();
+                }
+
+                case OBJ_DICT: {
+                    ObjDict *dict = AS_DICT(iterable);
+                    int index = AS_NUMBER(*cursor);
+
+                    while (index <= dict->capacityMask && IS_EMPTY(dict->entries[index].key)) {
+                        index++;
+                    }
+
+                    if (index > dict->capacityMask) {
+                        break;
+                    }
+
+                    *cursor = NUMBER_VAL(index + 1);
+                    push(vm, dict->entries[index].key);
+                    DISPATCH();
+                }
+
+                case OBJ_SET: {
+                    ObjSet *set = AS_SET(iterable);
+                    int index = AS_NUMBER(*cursor);
+
+                    while (index <= set->capacityMask &&
+                           (IS_EMPTY(set->entries[index].value) || set->entries[index].deleted)) {
+                        index++;
+                    }
+
+                    if (index > set->capacityMask) {
+                        break;
+                    }
+
+                    *cursor = NUMBER_VAL(index + 1);
+                    push(vm, set->entries[index].value);
+                    DISPATCH();
+                }
+
+                case OBJ_STRING: {
+                    ObjString *string = AS_STRING(iterable);
+                    int index = AS_NUMBER(*cursor);
+
+                    if (index >= string->length) {
+                        break;
+                    }
+
+                    // The cursor is a byte offset, stepping a whole character at a time
+                    int size = 1;
+                    if (string->character_len != -1 && string->character_len != string->length) {
+                        size = utf8codepointcalcsize((utf8_int8_t *) &string->chars[index]);
+                    }
+
+                    *cursor = NUMBER_VAL(index + size);
+                    push(vm, OBJ_VAL(copyString(vm, &string->chars[index], size)));
+                    DISPATCH();
+                }
+
+                case OBJ_FILE: {
+                    Value line;
+                    if (!nextFileLine(vm, AS_FILE(iterable), &line)) {
+                        break;
+                    }
+
+                    push(vm, line);
+                    DISPATCH();
+                }
+
+                case OBJ_ABSTRACT: {
+                    ObjAbstract *abstract = AS_ABSTRACT(iterable);
+
+                    if (abstract->iterate == NULL) {
+                        RUNTIME_ERROR_TYPE("'%s' is not iterable.", 1);
+                    }
+
+                    Value next;
+                    if (!abstract->iterate(vm, abstract, &next)) {
+                        break;
+                    }
+
+                    push(vm, next);
+                    DISPATCH();
+                }
+
+                case OBJ_RANGE: {
+                    ObjRange *range = AS_RANGE(iterable);
+                    double index = AS_NUMBER(*cursor);
+
+                    if (index >= rangeLength(range)) {
+                        break;
+                    }
+
+                    *cursor = NUMBER_VAL(index + 1);
+                    push(vm, NUMBER_VAL(range->start + index * range->step));
+                    DISPATCH();
+                }
+
+                case OBJ_COROUTINE: {
+                    ObjCoroutine *coroutine = AS_COROUTINE(iterable);
+
+                    // Back from the coroutine with the value it yielded, or
+                    // returned if it has finished
+                    if (AS_NUMBER(*cursor) == 1) {
+                        *cursor = NUMBER_VAL(0);
+
+                        if (coroutine->state != COROUTINE_DONE) {
+                            DISPATCH();
+                        }
+
+                        pop(vm);
+                        break;
+                    }
+
+                    if (coroutine->state == COROUTINE_DONE) {
+                        break;
+                    }
+
+                    if (coroutine->state == COROUTINE_RUNNING) {
+                        RUNTIME_ERROR("Cannot iterate over a running coroutine.");
+                    }
+
+                    // Resume the coroutine and come back to this instruction
+                    // to pick up the value it produces
+                    *cursor = NUMBER_VAL(1);
+                    ip -= 4;
+                    STORE_FRAME;
+
+                    bool started = coroutine->state == COROUTINE_SUSPENDED;
+                    enterCoroutine(vm, coroutine);
+
+                    if (started) {
+                        push(vm, NIL_VAL);
+                    }
+
+                    frame = &vm->frames[vm->frameCount - 1];
+                    ip = frame->ip;
+                    DISPATCH();
+                }
+
+                default: {
+                    RUNTIME_ERROR_TYPE("'%s' is not iterable.", 1);
+                }
+            }
+
+            ip += offset;
+            DISPATCH();
+        }
+
         CASE_CODE(CLASS): {
             ClassType type = READ_BYTE();
             createClass(vm, READ_STRING(), NULL, type);
@@ -2430,6 +3189,13 @@ static DictuInterpretResult runWithBreakFrame(DictuVM *vm, int breakFrame) {
             Value file = frame->slots[slot];
             ObjFile *fileObject = AS_FILE(file);
             fclose(fileObject->file);
+            fileObject->file = NULL;
+            free(fileObject->lineBuffer);
+            fileObject->lineBuffer = NULL;
+            fileObject->lineCapacity = 0;
+            free(fileObject->buffer);
+            fileObject->buffer = NULL;
+            fileObject->bufferSize = 0;
 
             DISPATCH();
         }
@@ -2471,17 +3237,20 @@ DictuInterpretResult dictuInterpret(DictuVM *vm, char *moduleName, char *source)
 
     return result;
 }
-Value callFunction(DictuVM* vm, Value function, int argCount, Value* args) {
-    if(!IS_FUNCTION(function) && !IS_CLOSURE(function)){
+DictuInterpretResult tryCallFunction(DictuVM* vm, Value function, int argCount, Value* args, Value* value) {
+    if(!IS_FUNCTION(function) && !IS_CLOSURE(function) && !IS_BOUND_METHOD(function)){
         if(IS_NATIVE(function)) {
             NativeFn native = AS_NATIVE(function);
-            return native(vm, argCount, args);
+            *value = native(vm, argCount, args);
+            return IS_EMPTY(*value) ? INTERPRET_RUNTIME_ERROR : INTERPRET_OK;
         }
         runtimeError(vm, "Value passed to callFunction is not callable");
-        return EMPTY_VAL;
+        return INTERPRET_RUNTIME_ERROR;
     }
     int currentFrameCount = vm->frameCount;
     Value* currentStack = vm->stackTop;
+    ObjUpvalue *currentUpvalues = vm->openUpvalues;
+    ObjCoroutine *currentCoroutine = vm->coroutine;
     if (vm->frameCount == vm->frameCapacity) {
         int oldCapacity = vm->frameCapacity;
         vm->frameCapacity = GROW_CAPACITY(vm->frameCapacity);
@@ -2492,16 +3261,40 @@ Value callFunction(DictuVM* vm, Value function, int argCount, Value* args) {
     uint8_t code[4] = {OP_CALL, argCount, 0, OP_RETURN};
     frame->ip = code;
     frame->closure = NULL;
+    frame->slots = currentStack;
     push(vm, function);
     for(int i = 0; i < argCount; i++) {
         push(vm, args[i]);
     }
     DictuInterpretResult result = runWithBreakFrame(vm, currentFrameCount+1);
     if(result != INTERPRET_OK) {
-        exit(70);
+        // The error reset the stack, so put back everything below the call. An error
+        // inside a coroutine also ended the coroutine, leaving nothing to return to
+        if (vm->coroutine == currentCoroutine) {
+            vm->stackTop = currentStack;
+            vm->frameCount = currentFrameCount;
+            vm->openUpvalues = currentUpvalues;
+        }
+        return result;
     }
-    Value v = pop(vm);
+    *value = pop(vm);
     vm->stackTop = currentStack;
     vm->frameCount--;
-    return v;
+    return INTERPRET_OK;
+}
+
+Value callFunction(DictuVM* vm, Value function, int argCount, Value* args) {
+    if(IS_NATIVE(function)) {
+        NativeFn native = AS_NATIVE(function);
+        return native(vm, argCount, args);
+    }
+    Value value;
+    DictuInterpretResult result = tryCallFunction(vm, function, argCount, args, &value);
+    if(result != INTERPRET_OK) {
+        if(!IS_FUNCTION(function) && !IS_CLOSURE(function) && !IS_BOUND_METHOD(function)) {
+            return EMPTY_VAL;
+        }
+        exit(70);
+    }
+    return value;
 }
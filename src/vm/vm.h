@@ -9,12 +9,6 @@
 // TODO: Work out the maximum stack size at compilation time
 #define STACK_MAX (64 * UINT8_COUNT)
 
-typedef struct {
-    ObjClosure *closure;
-    uint8_t *ip;
-    Value *slots;
-} CallFrame;
-
 struct _vm {
     Compiler *compiler;
     Value stack[STACK_MAX];
@@ -52,11 +46,31 @@ struct _vm {
     Obj **grayStack;
     int argc;
     char **argv;
+    Table tupleMethods;
+    ObjString *hashString;
+    ObjString *eqString;
+    Table coroutineMethods;
+    // The coroutine currently running, NULL when on the main stack
+    ObjCoroutine *coroutine;
+    ObjCoroutine *coroutines;
+    Table rangeMethods;
+    ObjString *iterString;
+    // The frozen VM holding the builtins this one borrows, NULL for the
+    // frozen VM itself
+    struct _vm *shared;
+    // Collections are put off while above 0, for work that only allocates
+    // objects which are all still reachable when it finishes
+    int gcPaused;
 };
 
 #define OK     0
 #define NOTOK -1
 
+// Coroutines run on stacks of their own rather than the VM's
+static inline Value *stackBase(DictuVM *vm) {
+    return vm->coroutine != NULL ? vm->coroutine->stack : vm->stack;
+}
+
 void push(DictuVM *vm, Value value);
 
 Value peek(DictuVM *vm, int distance);
@@ -71,4 +85,7 @@ ObjClosure *compileModuleToClosure(DictuVM *vm, char *name, char *source);
 
 Value callFunction(DictuVM* vm, Value function, int argCount, Value* args);
 
+// As callFunction, but a runtime error is returned rather than exiting
+DictuInterpretResult tryCallFunction(DictuVM* vm, Value function, int argCount, Value* args, Value* value);
+
 #endif
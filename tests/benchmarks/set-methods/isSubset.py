@@ -0,0 +1,11 @@
+import time
+
+a = set(range(100000))
+b = set(i * 7 for i in range(1000))
+
+start = time.perf_counter()
+
+for _ in range(100):
+    b <= a
+
+print(time.perf_counter() - start)